@@ -131,6 +131,42 @@ namespace ECSEngine {
 		return hash;
 	}
 
+	size_t Murmur64(Stream<void> data, size_t seed) {
+		constexpr size_t MULTIPLIER = 0xc6a4a7935bd1e995ULL;
+		constexpr int SHIFT = 47;
+
+		size_t hash = seed ^ (data.size * MULTIPLIER);
+		const unsigned char* bytes = (const unsigned char*)data.buffer;
+		size_t block_count = data.size / sizeof(size_t);
+		for (size_t index = 0; index < block_count; index++) {
+			size_t block;
+			memcpy(&block, bytes + index * sizeof(size_t), sizeof(block));
+
+			block *= MULTIPLIER;
+			block ^= block >> SHIFT;
+			block *= MULTIPLIER;
+
+			hash ^= block;
+			hash *= MULTIPLIER;
+		}
+
+		const unsigned char* tail = bytes + block_count * sizeof(size_t);
+		size_t remainder = data.size & (sizeof(size_t) - 1);
+		if (remainder > 0) {
+			for (size_t index = 0; index < remainder; index++) {
+				hash ^= (size_t)tail[index] << (index * 8);
+			}
+			hash *= MULTIPLIER;
+		}
+
+		hash ^= hash >> SHIFT;
+		hash *= MULTIPLIER;
+		hash ^= hash >> SHIFT;
+		return hash;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
 	unsigned int Cantor(unsigned int a, unsigned int b) {
 		return ((((a + b + 1) * (a + b)) >> 1) + b) * 0x8da6b343;
 	}
@@ -511,6 +511,10 @@ namespace ECSEngine {
 
 	ECSENGINE_API unsigned int fnv1a(Stream<void> data);
 
+	// A 64 bit hash (MurmurHash64A) that consumes 8 bytes per step. It is meant to be used for content
+	// hashing of large buffers, like entire files, where the 32 bit hashes have a too high collision rate
+	ECSENGINE_API size_t Murmur64(Stream<void> data, size_t seed = 0);
+
 	ECSENGINE_API unsigned int Cantor(unsigned int x, unsigned int y);
 
 	ECSENGINE_API unsigned int Cantor(unsigned int x, unsigned int y, unsigned int z);
@@ -74,6 +74,7 @@ namespace ECSEngine {
 	void Archetype::CallEntityCopy(unsigned int stream_index, unsigned int base_index, unsigned char deallocate_index, const void* source_data, bool deallocate_previous)
 	{
 		ArchetypeBase* base = GetBase(base_index);
+		base->EnsureUniqueBuffers();
 		void* component = base->GetComponentByIndex(stream_index, m_user_defined_components[deallocate_index]);
 		const ComponentInfo* component_info = m_unique_infos + m_unique_components[m_user_defined_components[deallocate_index]].value;
 		alignas(alignof(void*)) char temporary_storage[ECS_COMPONENT_MAX_BYTE_SIZE];
@@ -124,6 +125,7 @@ namespace ECSEngine {
 			unsigned int base_count = GetBaseCount();
 			for (unsigned int base_index = 0; base_index < base_count; base_index++) {
 				ArchetypeBase* base = GetBase(base_index);
+				base->EnsureUniqueBuffers();
 				unsigned int entity_count = base->EntityCount();
 				for (unsigned int entity_index = 0; entity_index < entity_count; entity_index++) {
 					void* current_component = base->GetComponentByIndex(entity_index, signature_index);
@@ -142,6 +144,7 @@ namespace ECSEngine {
 			const ComponentInfo* current_info = &m_unique_infos[m_unique_components[signature_index].value];
 
 			ArchetypeBase* base = GetBase(base_index);
+			base->EnsureUniqueBuffers();
 			unsigned int entity_count = base->EntityCount();
 			for (unsigned int entity_index = 0; entity_index < entity_count; entity_index++) {
 				void* current_component = base->GetComponentByIndex(entity_index, signature_index);
@@ -167,6 +170,7 @@ namespace ECSEngine {
 		const ComponentInfo* current_info = &m_unique_infos[m_unique_components[signature_index].value];
 
 		ArchetypeBase* base = GetBase(info.base_archetype);
+		base->EnsureUniqueBuffers();
 		void* current_component = base->GetComponentByIndex(info.stream_index, signature_index);
 		current_info->CallDeallocateFunction(current_component);
 	}
@@ -214,8 +218,11 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
-	void Archetype::CopyOther(const Archetype* other)
+	void Archetype::CopyOther(const Archetype* other, bool copy_on_write)
 	{
+		// The components with buffers need a deep copy, which cannot be deferred
+		copy_on_write &= other->m_user_defined_components.count == 0;
+
 		SharedComponentSignature shared_signature;
 		shared_signature.count = other->m_shared_components.count;
 		shared_signature.indices = other->m_shared_components.indices;
@@ -223,11 +230,16 @@ namespace ECSEngine {
 		for (size_t base_index = 0; base_index < other->GetBaseCount(); base_index++) {
 			shared_signature.instances = (SharedInstance*)other->GetBaseInstances(base_index);
 			const ArchetypeBase* copy_base = other->GetBase(base_index);
-			CreateBaseArchetype(shared_signature, copy_base->m_capacity);
+			CreateBaseArchetype(shared_signature, 0);
 
 			// Copy the data into the base archetype now
 			ArchetypeBase* current_base = GetBase(base_index);
-			current_base->CopyOther(copy_base);
+			if (!copy_on_write || !current_base->CopyOtherOnWrite(copy_base)) {
+				if (copy_base->m_capacity > 0) {
+					current_base->Resize(copy_base->m_capacity);
+				}
+				current_base->CopyOther(copy_base);
+			}
 		}
 	}
 
@@ -321,7 +333,7 @@ namespace ECSEngine {
 	ArchetypeBase* Archetype::FindBase(SharedComponentSignature shared_signature)
 	{
 		unsigned int index = FindBaseIndex(shared_signature);
-		return index != -1 ? &m_base_archetypes[index].archetype : nullptr;
+		return index != -1 ? GetBase(index) : nullptr;
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -329,7 +341,7 @@ namespace ECSEngine {
 	ArchetypeBase* Archetype::FindBase(VectorComponentSignature shared_signature, VectorComponentSignature shared_instances)
 	{
 		unsigned int index = FindBaseIndex(shared_signature, shared_instances);
-		return index != -1 ? &m_base_archetypes[index].archetype : nullptr;
+		return index != -1 ? GetBase(index) : nullptr;
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
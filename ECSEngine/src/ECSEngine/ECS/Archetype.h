@@ -72,7 +72,9 @@ namespace ECSEngine {
 			unsigned int archetype_starting_size = ECS_ARCHETYPE_DEFAULT_BASE_RESERVE_COUNT
 		);
 
-		void CopyOther(const Archetype* other);
+		// When copy on write is set, the bases whose components have no buffers reference the storage of the
+		// Other bases instead of copying it (look at ArchetypeBase::CopyOtherOnWrite)
+		void CopyOther(const Archetype* other, bool copy_on_write = false);
 
 		// It will deallocate all of its base archetypes and then itself
 		void Deallocate();
@@ -135,6 +137,8 @@ namespace ECSEngine {
 			return GetBaseInstances(base_index)[shared_component_index];
 		}
 
+		// It doesn't clone the storage shared by a copy on write. The write functions of the base clone it, while
+		// Writing through the raw pointers requires a call to ArchetypeBase::EnsureUniqueBuffers
 		ArchetypeBase* GetBase(unsigned int index);
 
 		const ArchetypeBase* GetBase(unsigned int index) const;
@@ -2,11 +2,37 @@
 #include "ArchetypeBase.h"
 #include "../Allocators/MemoryManager.h"
 #include "../Utilities/Crash.h"
+#include "../Multithreading/ConcurrentPrimitives.h"
 
 #define GROW_FACTOR (1.5f)
 
 namespace ECSEngine {
 
+	// The copy on write clones are rare, a single lock for all the bases is enough. It is held for all the changes of
+	// The shared references, such that a base cannot be shared and detached at the same time
+	static SpinLock shared_buffers_lock;
+
+	// The records whose last reference was dropped by a base of another allocator. The allocators are used without locks
+	// By the entity manager that owns them, such that only the bases of the owning allocator can release the storage
+	static SpinLock pending_release_lock;
+	static std::atomic<ArchetypeBaseSharedBuffers*> pending_release_buffers;
+
+	// Drops a reference to the shared storage and releases it when it was the last one
+	static void ReleaseSharedBuffers(ArchetypeBaseSharedBuffers* shared_buffers, const MemoryManager* releasing_allocator) {
+		if (shared_buffers->reference_count.fetch_sub(1, ECS_ACQ_REL) == 1) {
+			if (shared_buffers->allocator == releasing_allocator) {
+				shared_buffers->allocator->DeallocateTs(shared_buffers->allocation);
+				Free(shared_buffers);
+			}
+			else {
+				pending_release_lock.Lock();
+				shared_buffers->next_pending = pending_release_buffers.load(ECS_RELAXED);
+				pending_release_buffers.store(shared_buffers, ECS_RELEASE);
+				pending_release_lock.Unlock();
+			}
+		}
+	}
+
 	// --------------------------------------------------------------------------------------------------------------------
 
 	ArchetypeBase::ArchetypeBase() {}
@@ -97,8 +123,46 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	bool ArchetypeBase::CopyOtherOnWrite(const ArchetypeBase* other)
+	{
+		ECS_CRASH_CONDITION_RETURN(m_capacity == 0, false, "Trying to copy on write into a base archetype that is not empty.");
+		if (other->m_capacity == 0) {
+			// There is nothing to share
+			return true;
+		}
+
+		// The other base can take back or detach its storage from another thread in the meantime
+		shared_buffers_lock.Lock();
+		ArchetypeBaseSharedBuffers* shared_buffers = other->m_shared_buffers.Load();
+		if (shared_buffers != nullptr && shared_buffers->allocator != other->m_memory_manager) {
+			shared_buffers_lock.Unlock();
+			return false;
+		}
+
+		if (shared_buffers == nullptr) {
+			shared_buffers = (ArchetypeBaseSharedBuffers*)Malloc(sizeof(ArchetypeBaseSharedBuffers));
+			shared_buffers->reference_count.store(1, ECS_RELAXED);
+			shared_buffers->allocator = other->m_memory_manager;
+			shared_buffers->allocation = other->m_buffers;
+			shared_buffers->next_pending = nullptr;
+			other->m_shared_buffers.Store(shared_buffers);
+		}
+		shared_buffers->reference_count.fetch_add(1, ECS_RELAXED);
+
+		m_buffers = other->m_buffers;
+		m_entities = other->m_entities;
+		m_size = other->m_size;
+		m_capacity = other->m_capacity;
+		m_shared_buffers.Store(shared_buffers);
+		shared_buffers_lock.Unlock();
+		return true;
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	template<typename Functor>
 	void CopyEntitiesInternal(ArchetypeBase* archetype, ComponentSignature components, unsigned int copy_position, Functor&& functor) {
+		archetype->EnsureUniqueBuffers();
 		for (size_t index = 0; index < components.count; index++) {
 			unsigned char component_index = archetype->FindComponentIndex(components.indices[index]);
 			ECS_CRASH_CONDITION(component_index != UCHAR_MAX, "Incorrect component {#} when trying to copy entities. The component is missing from the base archetype.", components.indices[index].value);
@@ -134,6 +198,7 @@ namespace ECSEngine {
 		const EntityPool* entity_pool
 	)
 	{
+		EnsureUniqueBuffers();
 		for (unsigned int entity_index = 0; entity_index < copy_position.y; entity_index++) {
 			EntityInfo entity_info = entity_pool->GetInfo(entities[entity_index]);
 
@@ -165,6 +230,7 @@ namespace ECSEngine {
 		ComponentSignature components_to_copy
 	)
 	{
+		EnsureUniqueBuffers();
 		ComponentSignature source_components = source_archetype->m_components;
 
 		ECS_STACK_CAPACITY_STREAM_DYNAMIC(unsigned int, cached_stream_indices, copy_position.y);
@@ -283,9 +349,22 @@ namespace ECSEngine {
 
 	// Only a single allocation is made
 	void ArchetypeBase::Deallocate() {
-		if (m_entities != nullptr && m_buffers != nullptr) {
-			m_memory_manager->Deallocate(m_buffers);
+		ArchetypeBaseSharedBuffers* shared_buffers = m_shared_buffers.Load();
+		if (shared_buffers != nullptr) {
+			shared_buffers_lock.Lock();
+			// Another thread might have cloned it in the meantime
+			shared_buffers = m_shared_buffers.Load();
+			if (shared_buffers != nullptr) {
+				m_shared_buffers.Store(nullptr);
+				ReleaseSharedBuffers(shared_buffers, m_memory_manager);
+			}
+			shared_buffers_lock.Unlock();
+		}
+		if (shared_buffers == nullptr && m_entities != nullptr && m_buffers != nullptr) {
+			// The storage is always allocated with the thread safe variant, since the clones can happen from worker threads
+			m_memory_manager->DeallocateTs(m_buffers);
 		}
+		ReleasePendingSharedBuffers(m_memory_manager);
 		m_size = 0;
 		m_capacity = 0;
 		m_entities = nullptr;
@@ -294,6 +373,92 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	// Reallocates the storage to the given capacity and drops the reference to the shared storage, if there is one.
+	// The shared buffers lock must be held when the storage is shared
+	static void ResizeImpl(ArchetypeBase* base, unsigned int count) {
+		// TODO: Small copies could be handled by first copying into a temporary stack buffer,
+		// deallocating the buffers and then allocate the new block. But the problem is that because
+		// of different alignment it might copy invalid blocks. Aligning the stack buffer to the same
+		// current alignment of the buffer is a solution but it might not be worthwhile doing that if
+		// so much work is required
+
+		size_t new_total_byte_size = base->MemoryOf(count);
+
+		void** old_buffers = base->m_buffers;
+		ArchetypeBaseSharedBuffers* old_shared_buffers = base->m_shared_buffers.Load();
+
+		// The new storage is built in locals and published only at the end. The read only queries can read the
+		// Pointers of a shared base from other threads while it is cloned, they must see either the old storage,
+		// Which is kept alive by its reference, or the fully initialized new one
+		// The thread safe variants are needed since the copy on write clones can happen from worker threads
+		void* allocation = base->m_memory_manager->AllocateTs(new_total_byte_size);
+		uintptr_t ptr = (uintptr_t)allocation;
+		void** new_buffers = (void**)ptr;
+		ptr += sizeof(void*) * base->m_components.count;
+
+		// Copy the entities first
+		Entity* new_entities = (Entity*)ptr;
+
+		ptr += sizeof(Entity) * count;
+		ptr = AlignPointer(ptr, ECS_CACHE_LINE_SIZE);
+
+		if (base->m_size > 0) {
+			memcpy(new_entities, OffsetPointer(old_buffers, sizeof(void*) * base->m_components.count), sizeof(Entity) * base->m_size);
+		}
+
+		// Now copy the components
+		for (size_t component_index = 0; component_index < base->m_components.count; component_index++) {
+			unsigned short component_size = base->m_infos[base->m_components.indices[component_index].value].size;
+			new_buffers[component_index] = (void*)ptr;
+			if (base->m_size > 0) {
+				memcpy(new_buffers[component_index], old_buffers[component_index], component_size * base->m_size);
+			}
+
+			ptr = AlignPointer(ptr + component_size * count, ECS_CACHE_LINE_SIZE);
+		}
+
+		// Pairs with the acquire fence of the readers (look at ArchetypeBase::GetStoragePointers)
+		std::atomic_thread_fence(ECS_RELEASE);
+		base->m_buffers = new_buffers;
+		base->m_entities = new_entities;
+
+		// Now set the new capacity
+		if (old_shared_buffers != nullptr) {
+			// The other references still use the old storage, it must only be released. The store publishes the new
+			// Storage for the writers that check the reference without the lock
+			base->m_shared_buffers.Store(nullptr);
+			ReleaseSharedBuffers(old_shared_buffers, base->m_memory_manager);
+		}
+		else if (base->m_capacity > 0) {
+			base->m_memory_manager->DeallocateTs(old_buffers);
+		}
+		base->m_capacity = count;
+		ArchetypeBase::ReleasePendingSharedBuffers(base->m_memory_manager);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	void ArchetypeBase::EnsureUniqueBuffersSlow()
+	{
+		// Multiple threads can write to the same base at the same time, only the first one must clone
+		shared_buffers_lock.Lock();
+		ArchetypeBaseSharedBuffers* shared_buffers = m_shared_buffers.Load();
+		if (shared_buffers != nullptr) {
+			if (shared_buffers->reference_count.load(ECS_ACQUIRE) == 1 && shared_buffers->allocator == m_memory_manager) {
+				// All the other references were dropped and the storage is from our allocator, it can be taken back
+				m_shared_buffers.Store(nullptr);
+				Free(shared_buffers);
+			}
+			else {
+				// Resizing to the same capacity clones the storage and drops the reference
+				ResizeImpl(this, m_capacity);
+			}
+		}
+		shared_buffers_lock.Unlock();
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	unsigned char ArchetypeBase::FindComponentIndex(Component component) const
 	{
 		for (size_t index = 0; index < m_components.count; index++) {
@@ -317,6 +482,7 @@ namespace ECSEngine {
 	// --------------------------------------------------------------------------------------------------------------------
 
 	void ArchetypeBase::GetBuffers(void** buffers, ComponentSignature signature) {
+		EnsureUniqueBuffers();
 		for (size_t component = 0; component <= signature.count; component++) {
 			unsigned char component_index = FindComponentIndex(signature.indices[component]);
 			buffers[component] = m_buffers[component_index];
@@ -327,6 +493,7 @@ namespace ECSEngine {
 
 	void* ArchetypeBase::GetComponent(EntityInfo info, Component component)
 	{
+		EnsureUniqueBuffers();
 		unsigned char component_index = FindComponentIndex(component);
 		ECS_CRASH_CONDITION_RETURN(component_index != UCHAR_MAX, nullptr, "The entity {#} does not have component {#} when trying to retrieve it.", m_entities[info.stream_index].value);
 		return GetComponentByIndex(info, component_index);
@@ -350,64 +517,73 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
-	void ArchetypeBase::Resize(unsigned int count) {
-		// TODO: Small copies could be handled by first copying into a temporary stack buffer,
-		// deallocating the buffers and then allocate the new block. But the problem is that because
-		// of different alignment it might copy invalid blocks. Aligning the stack buffer to the same
-		// current alignment of the buffer is a solution but it might not be worthwhile doing that if
-		// so much work is required
-
-		size_t per_entity_size = 0;
-
-		size_t new_total_byte_size = sizeof(Entity) * count + sizeof(void*) * m_components.count;
-		for (size_t component_index = 0; component_index < m_components.count; component_index++) {
-			per_entity_size += m_infos[m_components.indices[component_index].value].size;
+	void ArchetypeBase::ReleasePendingSharedBuffers(MemoryManager* allocator)
+	{
+		if (pending_release_buffers.load(ECS_ACQUIRE) == nullptr) {
+			return;
 		}
-		// Add a cache line for component alignment
-		new_total_byte_size += per_entity_size * count + m_components.count * ECS_CACHE_LINE_SIZE;
-
-		void** old_buffers = m_buffers;
-
-		void* allocation = m_memory_manager->Allocate(new_total_byte_size);
-		uintptr_t ptr = (uintptr_t)allocation;
-		m_buffers = (void**)ptr;
-		ptr += sizeof(void*) * m_components.count;
-
-		// Copy the entities first
-		m_entities = (Entity*)ptr;
-
-		ptr += sizeof(Entity) * count;
-		ptr = AlignPointer(ptr, ECS_CACHE_LINE_SIZE);
 
-		if (m_size > 0) {
-			memcpy(m_entities, OffsetPointer(old_buffers, sizeof(void*) * m_components.count), sizeof(Entity) * m_size);
+		pending_release_lock.Lock();
+		ArchetypeBaseSharedBuffers* previous = nullptr;
+		ArchetypeBaseSharedBuffers* current = pending_release_buffers.load(ECS_RELAXED);
+		while (current != nullptr) {
+			ArchetypeBaseSharedBuffers* next = current->next_pending;
+			if (current->allocator == allocator) {
+				if (previous == nullptr) {
+					pending_release_buffers.store(next, ECS_RELAXED);
+				}
+				else {
+					previous->next_pending = next;
+				}
+				allocator->DeallocateTs(current->allocation);
+				Free(current);
+			}
+			else {
+				previous = current;
+			}
+			current = next;
 		}
+		pending_release_lock.Unlock();
+	}
 
-		// Now copy the components
-		for (size_t component_index = 0; component_index < m_components.count; component_index++) {
-			unsigned short component_size = m_infos[m_components.indices[component_index].value].size;
-			m_buffers[component_index] = (void*)ptr;
-			if (m_size > 0) {
-				memcpy(m_buffers[component_index], old_buffers[component_index], component_size * m_size);
-			}
+	// --------------------------------------------------------------------------------------------------------------------
 
-			ptr = AlignPointer(ptr + component_size * count, ECS_CACHE_LINE_SIZE);
+	void ArchetypeBase::Resize(unsigned int count) {
+		if (m_shared_buffers.Load() != nullptr) {
+			shared_buffers_lock.Lock();
+			ResizeImpl(this, count);
+			shared_buffers_lock.Unlock();
+		}
+		else {
+			ResizeImpl(this, count);
 		}
+	}
 
-		// Now set the new capacity
-		if (m_capacity > 0) {
-			m_memory_manager->Deallocate(old_buffers);
+	size_t ArchetypeBase::MemoryOf(unsigned int count) const
+	{
+		size_t per_entity_size = 0;
+
+		size_t total_byte_size = sizeof(Entity) * count + sizeof(void*) * m_components.count;
+		for (size_t component_index = 0; component_index < m_components.count; component_index++) {
+			per_entity_size += m_infos[m_components.indices[component_index].value].size;
 		}
-		m_capacity = count;
+		// Add a cache line for component alignment
+		total_byte_size += per_entity_size * count + m_components.count * ECS_CACHE_LINE_SIZE;
+		return total_byte_size;
 	}
 
+	// --------------------------------------------------------------------------------------------------------------------
+
 	unsigned int ArchetypeBase::Reserve(unsigned int count)
 	{
 		if (m_size + count > m_capacity) {
 			unsigned int default_reserve = (unsigned int)((float)m_capacity * GROW_FACTOR + 3);
-			// This can happen for small sizes
+			// This can happen for small sizes. The resize also clones the storage if it is shared
 			Resize(default_reserve < count ? count : default_reserve);
 		}
+		else {
+			EnsureUniqueBuffers();
+		}
 		return m_size;
 	}
 
@@ -433,6 +609,7 @@ namespace ECSEngine {
 
 	void ArchetypeBase::RemoveEntity(unsigned int stream_index, EntityPool* pool)
 	{
+		EnsureUniqueBuffers();
 		m_size--;
 		// If it is the last entity, skip the update of the components and that of the entity info
 		if (stream_index == m_size) {
@@ -454,6 +631,7 @@ namespace ECSEngine {
 
 	void ArchetypeBase::SetEntities(Stream<Entity> entities, unsigned int copy_position)
 	{
+		EnsureUniqueBuffers();
 		memcpy(m_entities + copy_position, entities.buffer, sizeof(Entity) * entities.size);
 	}
 
@@ -470,6 +648,7 @@ namespace ECSEngine {
 
 	void ArchetypeBase::UpdateComponentByIndex(unsigned int stream_index, unsigned char component_index, const void* data)
 	{
+		EnsureUniqueBuffers();
 		void* component_data = GetComponentByIndex(stream_index, component_index);
 		memcpy(component_data, data, m_infos[m_components.indices[component_index].value].size);
 	}
@@ -3,11 +3,50 @@
 #include "../Containers/Stream.h"
 #include "InternalStructures.h"
 #include "../Utilities/BasicTypes.h"
+#include "../Multithreading/ConcurrentPrimitives.h"
 
 namespace ECSEngine {
 
 	struct MemoryManager;
 
+	// When a base archetype is copied on write, the original and the copies reference the same allocation through
+	// This record. The allocation belongs to the allocator it was made from, and it is released into it when the
+	// Last reference is dropped. When that reference belongs to a base of another allocator, the record is queued
+	// Instead and the bases of the owning allocator release it (look at ArchetypeBase::ReleasePendingSharedBuffers)
+	struct ArchetypeBaseSharedBuffers {
+		std::atomic<unsigned int> reference_count;
+		MemoryManager* allocator;
+		void* allocation;
+		// The next record in the pending release list
+		ArchetypeBaseSharedBuffers* next_pending;
+	};
+
+	// The reference of a base to its shared record. It is read without locks by the writes to the base, while the
+	// Clones can detach it from other threads, such that the accesses are atomic. Copying it copies the current value
+	struct ArchetypeBaseSharedBuffersReference {
+		ECS_INLINE ArchetypeBaseSharedBuffersReference() {
+			value.store(nullptr, ECS_RELAXED);
+		}
+		ECS_INLINE ArchetypeBaseSharedBuffersReference(const ArchetypeBaseSharedBuffersReference& other) {
+			value.store(other.Load(), ECS_RELAXED);
+		}
+		ECS_INLINE ArchetypeBaseSharedBuffersReference& operator = (const ArchetypeBaseSharedBuffersReference& other) {
+			value.store(other.Load(), ECS_RELAXED);
+			return *this;
+		}
+
+		ECS_INLINE ArchetypeBaseSharedBuffers* Load() const {
+			return value.load(ECS_ACQUIRE);
+		}
+
+		// The release store publishes the buffers that were written before it
+		ECS_INLINE void Store(ArchetypeBaseSharedBuffers* shared_buffers) {
+			value.store(shared_buffers, ECS_RELEASE);
+		}
+
+		std::atomic<ArchetypeBaseSharedBuffers*> value;
+	};
+
 	struct ECSENGINE_API ArchetypeBase {
 		ArchetypeBase();
 
@@ -36,6 +75,14 @@ namespace ECSEngine {
 		// By default, it will deep copy the components but you can disable this
 		void CopyOther(const ArchetypeBase* other, bool deep_copy = true);
 
+		// Instead of copying the entities and the components, it references the storage of the other base, which
+		// Is cloned only when one of the two bases is written to. This base must be empty. It should be used only for
+		// Bases whose components have no buffers, since the buffers would be referenced by both bases.
+		// The other base is modified only to record that its storage is shared. It returns false, without doing
+		// Anything, when the other base references itself the storage of another base, since that storage can go
+		// Away without this base knowing about it
+		bool CopyOtherOnWrite(const ArchetypeBase* other);
+
 		// Splats the same value of the component to all entities
 		void CopySplatComponents(
 			uint2 copy_position,
@@ -96,6 +143,17 @@ namespace ECSEngine {
 
 		void Deallocate();
 
+		// If the storage is shared with other bases, it makes a private copy of it. It is called by all the write
+		// Functions of this base and it can be called from multiple threads at the same time. The pointer accessors
+		// (GetComponentByIndex, the Archetype base getters) don't clone, the callers that write through them call it
+		ECS_INLINE void EnsureUniqueBuffers() {
+			if (m_shared_buffers.Load() != nullptr) {
+				EnsureUniqueBuffersSlow();
+			}
+		}
+
+		void EnsureUniqueBuffersSlow();
+
 		ECS_INLINE unsigned int EntityCount() const {
 			return m_size;
 		}
@@ -123,7 +181,8 @@ namespace ECSEngine {
 			return GetComponentByIndex(info.stream_index, component_index);
 		}
 
-		// The component index will be used to directly index into the buffers
+		// The component index will be used to directly index into the buffers. It doesn't clone a shared storage,
+		// Call EnsureUniqueBuffers before writing through the pointer
 		ECS_INLINE void* GetComponentByIndex(unsigned int stream_index, unsigned char component_index) {
 			return OffsetPointer(m_buffers[component_index], stream_index * m_infos[m_components.indices[component_index].value].size);
 		}
@@ -136,10 +195,33 @@ namespace ECSEngine {
 			return OffsetPointer(m_buffers[component_index], stream_index * m_infos[m_components.indices[component_index].value].size);
 		}
 
+		// Reads the entity and component pointers of a base whose shared storage can be cloned by a writer from another
+		// Thread at the same time. They point either to the shared storage, which is kept alive by the other references,
+		// Or to the fully initialized clone, which has the same contents
+		ECS_INLINE void GetStoragePointers(const Entity** entities, void*** buffers) const {
+			*entities = m_entities;
+			*buffers = m_buffers;
+			// Pairs with the release fence of the clone
+			std::atomic_thread_fence(ECS_ACQUIRE);
+		}
+
 		// It will copy the entities - consider using the other variant since it will alias the 
 		// values inside the chunks and no copies are needed
 		void GetEntitiesCopy(Entity* entities) const;
 
+		ECS_INLINE bool IsBufferShared() const {
+			return m_shared_buffers.Load() != nullptr;
+		}
+
+		// Returns the byte size of the storage allocation for the given entity capacity
+		size_t MemoryOf(unsigned int count) const;
+
+		// Releases the shared storages of the given allocator whose last reference was dropped by a base of another
+		// Allocator. It is called by the resizes and the deallocations of the bases of that allocator and it must be
+		// Called before the allocator is cleared. It must not be called while the allocator is used from other threads
+		// Without its thread safe functions
+		static void ReleasePendingSharedBuffers(MemoryManager* allocator);
+
 		void Resize(unsigned int count);
 
 		// It will grow the capacity in case there is not enough space
@@ -176,6 +258,9 @@ namespace ECSEngine {
 		const ComponentInfo* m_infos;
 		// Unique components indices - only reference
 		ComponentSignature m_components;
+		// It is set when the storage is shared with other bases, nullptr otherwise. It changes only while holding
+		// The shared buffers lock
+		mutable ArchetypeBaseSharedBuffersReference m_shared_buffers;
 	};
 
 }
@@ -876,6 +876,8 @@ namespace ECSEngine {
 						}
 					}
 					});
+				// The asset fields were written in place
+				entity_manager->MarkSharedComponentHashIndexDirty(component);
 			}
 			});
 
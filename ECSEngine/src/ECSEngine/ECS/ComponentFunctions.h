@@ -37,6 +37,14 @@ namespace ECSEngine {
 
 	typedef bool (*SharedComponentCompareFunction)(SharedComponentCompareFunctionData* data);
 
+	struct SharedComponentHashFunctionData {
+		void* function_data;
+		const void* data;
+	};
+
+	// The hash must be consistent with the compare function - instances that compare equal must have the same hash
+	typedef unsigned int (*SharedComponentHashFunction)(SharedComponentHashFunctionData* data);
+
 	struct ComponentFunctions {
 		ECS_INLINE ComponentFunctions() {
 			memset(this, 0, sizeof(*this));
@@ -59,6 +67,10 @@ namespace ECSEngine {
 		Copyable* data = nullptr;
 		// If this flag is set, the function will use the same data as the copy deallocate
 		bool use_copy_deallocate_data = false;
+		// Optional, it receives the same data as the compare function. When a compare function is given
+		// Without a hash function, the instances of the component cannot be looked up by hash and they
+		// Are searched linearly
+		SharedComponentHashFunction hash_function = nullptr;
 	};
 	
 }
\ No newline at end of file
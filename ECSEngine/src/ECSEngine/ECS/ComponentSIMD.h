@@ -0,0 +1,123 @@
+#pragma once
+#include "../Core.h"
+#include "../Math/Transform.h"
+#include "Components.h"
+#include "ForEach.h"
+
+namespace ECSEngine {
+
+	// These helpers transpose the AoS Translation, Rotation and Scale component columns into the SIMD math types
+	// And back, Vector3::ElementCount() entities at a time. When the count is smaller than the SIMD width, the unused
+	// Lanes are filled with the default value of the component (0 translation, identity rotation, unit scale) such that
+	// The math on them stays well defined, and the scatters write only the valid lanes
+
+	template<int stride, int offset>
+	ECS_INLINE Vec8f ECS_VECTORCALL GatherComponentLane(const void* components, size_t count, float default_value) {
+		if (count == Vec8f::size()) {
+			return GatherStride<stride, offset>(components);
+		}
+		return GatherStrideMasked<stride, offset>(components, count, Vec8f(default_value));
+	}
+
+	// The pointer can be nullptr for an optional component, in which case the default translation is returned
+	ECS_INLINE Vector3 ECS_VECTORCALL GatherTranslations(const Translation* translations, size_t count) {
+		if (translations == nullptr) {
+			return Vector3::Splat(Vec8f(0.0f));
+		}
+		return Vector3(
+			GatherComponentLane<3, 0>(translations, count, 0.0f),
+			GatherComponentLane<3, 1>(translations, count, 0.0f),
+			GatherComponentLane<3, 2>(translations, count, 0.0f)
+		);
+	}
+
+	// The pointer can be nullptr for an optional component, in which case the identity rotation is returned
+	ECS_INLINE Quaternion ECS_VECTORCALL GatherRotations(const Rotation* rotations, size_t count) {
+		if (rotations == nullptr) {
+			return QuaternionIdentity();
+		}
+		return Quaternion(
+			GatherComponentLane<4, 0>(rotations, count, 0.0f),
+			GatherComponentLane<4, 1>(rotations, count, 0.0f),
+			GatherComponentLane<4, 2>(rotations, count, 0.0f),
+			GatherComponentLane<4, 3>(rotations, count, 1.0f)
+		);
+	}
+
+	// The pointer can be nullptr for an optional component, in which case the unit scale is returned
+	ECS_INLINE Vector3 ECS_VECTORCALL GatherScales(const Scale* scales, size_t count) {
+		if (scales == nullptr) {
+			return Vector3::Splat(Vec8f(1.0f));
+		}
+		return Vector3(
+			GatherComponentLane<3, 0>(scales, count, 1.0f),
+			GatherComponentLane<3, 1>(scales, count, 1.0f),
+			GatherComponentLane<3, 2>(scales, count, 1.0f)
+		);
+	}
+
+	// Any of the pointers can be nullptr, for the optional components
+	ECS_INLINE Transform GatherTransforms(const Translation* translations, const Rotation* rotations, const Scale* scales, size_t count) {
+		return Transform(GatherTranslations(translations, count), GatherRotations(rotations, count), GatherScales(scales, count));
+	}
+
+	ECS_INLINE void ECS_VECTORCALL ScatterTranslations(Vector3 values, Translation* translations, size_t count) {
+		if (count == Vector3::ElementCount()) {
+			values.Scatter(translations);
+		}
+		else {
+			values.ScatterPartial(translations, count);
+		}
+	}
+
+	ECS_INLINE void ECS_VECTORCALL ScatterRotations(Quaternion values, Rotation* rotations, size_t count) {
+		if (count == Quaternion::ElementCount()) {
+			values.Scatter(rotations);
+		}
+		else {
+			values.ScatterPartial(rotations, count);
+		}
+	}
+
+	ECS_INLINE void ECS_VECTORCALL ScatterScales(Vector3 values, Scale* scales, size_t count) {
+		if (count == Vector3::ElementCount()) {
+			values.Scatter(scales);
+		}
+		else {
+			values.ScatterPartial(scales, count);
+		}
+	}
+
+	// Any of the pointers can be nullptr, in which case that part of the transform is not written
+	ECS_INLINE void ScatterTransforms(const Transform* transforms, Translation* translations, Rotation* rotations, Scale* scales, size_t count) {
+		if (translations != nullptr) {
+			ScatterTranslations(transforms->position, translations, count);
+		}
+		if (rotations != nullptr) {
+			ScatterRotations(transforms->rotation, rotations, count);
+		}
+		if (scales != nullptr) {
+			ScatterScales(transforms->scale, scales, count);
+		}
+	}
+
+	// To be called from a ForEachBatch functor. It splits the batch into groups of SIMD width entities and calls
+	// The functor with (size_t offset, size_t count) for each one of them. The offset is to be applied to the component
+	// Pointers of the batch, which are contiguous, before they are given to the gather and scatter functions. Example:
+	//
+	// static void IntegrateVelocities(ForEachBatchData* data, Translation* translations, const Velocity* velocities) {
+	//		ForEachBatchSIMD(data, [&](size_t offset, size_t count) {
+	//			Vector3 positions = GatherTranslations(translations + offset, count);
+	//			...
+	//			ScatterTranslations(positions, translations + offset, count);
+	//		});
+	// }
+	template<typename Functor>
+	ECS_INLINE void ForEachBatchSIMD(const ForEachBatchData* data, Functor&& functor) {
+		for (size_t offset = 0; offset < data->count; offset += Vector3::ElementCount()) {
+			size_t count = data->count - offset;
+			functor(offset, count < Vector3::ElementCount() ? count : Vector3::ElementCount());
+		}
+	}
+
+}
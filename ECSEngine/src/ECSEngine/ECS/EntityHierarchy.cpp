@@ -3,6 +3,7 @@
 #include "../Utilities/Crash.h"
 #include "../Utilities/Serialization/SerializationHelpers.h"
 #include "../Utilities/ReaderWriterInterface.h"
+#include "../Allocators/ResizableLinearAllocator.h"
 
 #define ROOT_STARTING_SIZE ECS_KB
 #define NODE_TABLE_INITIAL_SIZE ECS_KB * 4
@@ -31,6 +32,19 @@ namespace ECSEngine {
 
     typedef EntityHierarchy::Node Node;
 
+    // Grows the table once such that the given number of entries can be inserted without any other growth
+    template<typename Table>
+    static void ReserveTable(Table& table, MemoryManager* allocator, unsigned int count) {
+        unsigned int capacity = (unsigned int)HashTablePowerOfTwoCapacityForElements(table.GetCount() + count);
+        unsigned int old_capacity = table.GetCapacity();
+        if (capacity > old_capacity) {
+            void* old_allocation = table.Resize(allocator->Allocate(table.MemoryOf(capacity)), capacity);
+            if (old_capacity > 0) {
+                allocator->Deallocate(old_allocation);
+            }
+        }
+    }
+
     // -----------------------------------------------------------------------------------------------------------------------------
 
     EntityHierarchy::EntityHierarchy(MemoryManager* memory_manager, unsigned int root_initial_size, unsigned int node_table_initial_size)
@@ -84,9 +98,12 @@ namespace ECSEngine {
             node->static_children[child_index] = node->static_children[node->child_count - 1];
         }
         else if (node->child_count == ECS_ENTITY_HIERARCHY_STATIC_STORAGE + 1) {
-            // Transition from allocated buffer to static storage
-            memcpy(node->static_children, node->allocated_children, sizeof(node->static_children));
-            allocator->Deallocate(node->allocated_children);
+            // Transition from allocated buffer to static storage. The pointer must be read before
+            // The static storage overwrites it
+            Node** allocated_children = node->allocated_children;
+            allocated_children[child_index] = allocated_children[node->child_count - 1];
+            memcpy(node->static_children, allocated_children, sizeof(node->static_children));
+            allocator->Deallocate(allocated_children);
         }
         else {
             node->allocated_children[child_index] = node->allocated_children[node->child_count - 1];
@@ -96,6 +113,84 @@ namespace ECSEngine {
 
     // -----------------------------------------------------------------------------------------------------------------------------
 
+    void EntityHierarchy::RemoveLastChildFromNode(Node* node) {
+        if (node->child_count == ECS_ENTITY_HIERARCHY_STATIC_STORAGE + 1) {
+            Node** allocated_children = node->allocated_children;
+            memcpy(node->static_children, allocated_children, sizeof(node->static_children));
+            allocator->Deallocate(allocated_children);
+        }
+        node->child_count--;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------
+
+    void EntityHierarchy::AppendChildrenToNode(Node* node, Stream<Node*> children) {
+        unsigned int new_child_count = node->child_count + (unsigned int)children.size;
+        if (new_child_count <= ECS_ENTITY_HIERARCHY_STATIC_STORAGE) {
+            children.CopyTo(node->static_children + node->child_count);
+        }
+        else {
+            Node** new_children = (Node**)allocator->Allocate(sizeof(Node*) * new_child_count);
+            memcpy(new_children, node->Children(), sizeof(Node*) * node->child_count);
+            children.CopyTo(new_children + node->child_count);
+            if (node->IsPointer()) {
+                allocator->Deallocate(node->allocated_children);
+            }
+            node->allocated_children = new_children;
+        }
+        node->child_count = new_child_count;
+
+        for (size_t index = 0; index < children.size; index++) {
+            children[index]->parent = node;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------
+
+    void EntityHierarchy::AddChildren(Entity parent, Stream<Entity> children)
+    {
+        if (children.size == 0) {
+            return;
+        }
+
+        Node* parent_node = nullptr;
+        if (parent.value != Entity::Invalid()) {
+            unsigned int parent_node_table_index = node_table.Find(parent);
+            ECS_CRASH_CONDITION_RETURN_VOID(parent_node_table_index != -1, "EntityHierarchy: Trying to add children to a parent that wasn't added to the hierarchy.");
+            parent_node = node_table.GetValueFromIndex(parent_node_table_index);
+        }
+        else {
+            ReserveTable(roots, allocator, children.size);
+        }
+        ReserveTable(node_table, allocator, children.size);
+
+        // The children nodes are recorded in order to be appended to the parent at once
+        ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 32, ECS_MB * 64);
+        Stream<Node*> child_nodes;
+        child_nodes.Initialize(&stack_allocator, parent_node != nullptr ? children.size : 0);
+
+        for (size_t index = 0; index < children.size; index++) {
+            Node* node = (Node*)allocator->Allocate(sizeof(Node));
+            node->entity = children[index];
+            node->parent = nullptr;
+            node->child_count = 0;
+            node_table.InsertDynamic(allocator, node, children[index]);
+
+            if (parent_node != nullptr) {
+                child_nodes[index] = node;
+            }
+            else {
+                roots.InsertDynamic(allocator, {}, children[index]);
+            }
+        }
+
+        if (parent_node != nullptr) {
+            AppendChildrenToNode(parent_node, child_nodes);
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------
+
     void EntityHierarchy::AddEntry(Entity parent, Entity child)
     {
         Node* node = (Node*)allocator->Allocate(sizeof(Node));
@@ -171,10 +266,23 @@ namespace ECSEngine {
         if (child->parent != nullptr) {
             RemoveChildFromNode(child->parent, child);
         }
+        else if (new_parent == nullptr) {
+            // It is already a root
+            return;
+        }
+        else {
+            // It stops being a root
+            roots.Erase(child->entity);
+        }
+
         child->parent = new_parent;
         if (new_parent != nullptr) {
             AddChildToNode(new_parent, child);
         }
+        else {
+            // It becomes a root
+            roots.InsertDynamic(allocator, {}, child->entity);
+        }
     }
 
     void EntityHierarchy::ChangeParent(Entity new_parent, Entity child)
@@ -194,6 +302,66 @@ namespace ECSEngine {
 
     // -----------------------------------------------------------------------------------------------------------------------------
 
+    void EntityHierarchy::ChangeParents(Entity new_parent, Stream<Entity> children)
+    {
+        if (children.size == 0) {
+            return;
+        }
+
+        Node* parent_node = nullptr;
+        if (new_parent != Entity::Invalid()) {
+            unsigned int new_parent_index = node_table.Find(new_parent);
+            ECS_CRASH_CONDITION(new_parent_index != -1, "EntityHierarchy: Could not change the parent of the entities to {#}. The new parent doesn't exist.", new_parent.value);
+            parent_node = node_table.GetValueFromIndex(new_parent_index);
+        }
+        else {
+            ReserveTable(roots, allocator, children.size);
+        }
+
+        ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 32, ECS_MB * 64);
+        ResizableStream<Node*> moved_nodes(&stack_allocator, parent_node != nullptr ? children.size : 0);
+
+        for (size_t index = 0; index < children.size; index++) {
+            unsigned int child_index = node_table.Find(children[index]);
+            ECS_CRASH_CONDITION(child_index != -1, "EntityHierarchy: Could not change the parent of entity {#}. It doesn't exist in the hierarchy.", children[index].value);
+            Node* child_node = node_table.GetValueFromIndex(child_index);
+            if (child_node->parent == parent_node) {
+                continue;
+            }
+
+            if (parent_node != nullptr) {
+                // The new parent cannot be moved under its own subtree
+                const Node* ancestor = parent_node;
+                while (ancestor != nullptr && ancestor != child_node) {
+                    ancestor = ancestor->parent;
+                }
+                ECS_CRASH_CONDITION(ancestor == nullptr, "EntityHierarchy: Could not change the parent of entity {#} to {#}. The new parent is inside its subtree.",
+                    children[index].value, new_parent.value);
+            }
+
+            if (child_node->parent != nullptr) {
+                RemoveChildFromNode(child_node->parent, child_node);
+            }
+            else {
+                roots.Erase(child_node->entity);
+            }
+
+            if (parent_node != nullptr) {
+                moved_nodes.Add(child_node);
+            }
+            else {
+                child_node->parent = nullptr;
+                roots.InsertDynamic(allocator, {}, child_node->entity);
+            }
+        }
+
+        if (parent_node != nullptr) {
+            AppendChildrenToNode(parent_node, moved_nodes.ToStream());
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------
+
     bool EntityHierarchy::Exists(Entity entity) const
     {
         return node_table.Find(entity) != -1;
@@ -212,24 +380,33 @@ namespace ECSEngine {
             RemoveChildFromNode(node->parent, node);
         }
 
-        // Remove the node from the roots, if it is one
-        unsigned int root_index = roots.Find(entity);
-        if (root_index != -1) {
-            roots.EraseFromIndex(root_index);
-        }
-        
-        // Destroy the children as well
-        Stream<Node*> children = node->ChildrenStream();
-        for (size_t index = 0; index < children.size; index++) {
-            RemoveEntry(children[index]->entity);
+        else {
+            // Remove the node from the roots, if it is one
+            unsigned int root_index = roots.Find(entity);
+            if (root_index != -1) {
+                roots.EraseFromIndex(root_index);
+            }
         }
 
-        // At last, deallocate the node and remove it from the node table
-        if (children.size > ECS_ENTITY_HIERARCHY_STATIC_STORAGE) {
-            allocator->Deallocate(children.buffer);
+        // Destroy the subtree in post order. Always descend into the last child, such that it can be removed
+        // From its parent without a search once it is released. The parent pointers are enough to walk back
+        Node* current = node;
+        while (true) {
+            if (current->child_count > 0) {
+                current = current->Children()[current->child_count - 1];
+                continue;
+            }
+
+            Node* parent = current->parent;
+            node_table.Erase(current->entity);
+            allocator->Deallocate(current);
+            if (current == node) {
+                break;
+            }
+
+            RemoveLastChildFromNode(parent);
+            current = parent;
         }
-        allocator->Deallocate(node);
-        node_table.EraseFromIndex(node_index);
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------
@@ -304,6 +481,63 @@ namespace ECSEngine {
 
     // -----------------------------------------------------------------------------------------------------------------------------
 
+    EntityHierarchyLevels EntityHierarchy::GetLevels(Entity entity, AllocatorPolymorphic allocator) const {
+        // The node pointers are kept alongside the entities, such that the children don't need a table lookup
+        ResizableStream<const Node*> nodes(allocator, 0);
+        ResizableStream<Entity> entities(allocator, 0);
+        ResizableStream<unsigned int> parent_indices(allocator, 0);
+        ResizableStream<unsigned int> level_offsets(allocator, 0);
+
+        auto add_children = [&](const Node* node, unsigned int parent_index) {
+            Stream<Node*> children = node->ChildrenStream();
+            for (size_t index = 0; index < children.size; index++) {
+                nodes.Add(children[index]);
+                entities.Add(children[index]->entity);
+                parent_indices.Add(parent_index);
+            }
+        };
+
+        if (entity == Entity::Invalid()) {
+            nodes.Reserve(node_table.GetCount());
+            entities.Reserve(node_table.GetCount());
+            parent_indices.Reserve(node_table.GetCount());
+            roots.ForEachIndexConst([&](unsigned int index) {
+                Entity root = roots.GetIdentifierFromIndex(index);
+                nodes.Add(node_table.GetValue(root));
+                entities.Add(root);
+                parent_indices.Add(-1);
+            });
+        }
+        else {
+            Node* node = nullptr;
+            if (node_table.TryGetValue(entity, node)) {
+                add_children(node, -1);
+            }
+        }
+
+        unsigned int level_start = 0;
+        while (level_start < entities.size) {
+            level_offsets.Add(level_start);
+            unsigned int level_end = entities.size;
+            for (unsigned int index = level_start; index < level_end; index++) {
+                add_children(nodes[index], index);
+            }
+            level_start = level_end;
+        }
+        if (entities.size > 0) {
+            level_offsets.Add(entities.size);
+        }
+
+        nodes.FreeBuffer();
+        EntityHierarchyLevels levels;
+        levels.entities = entities.ToStream();
+        levels.parent_indices = parent_indices.ToStream();
+        levels.level_offsets = level_offsets.ToStream();
+        return levels;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------
+
     Entity EntityHierarchy::GetParent(Entity entity) const
     {
         Entity parent;
@@ -18,6 +18,29 @@ namespace ECSEngine {
 
 #define ECS_ENTITY_HIERARCHY_STATIC_STORAGE (2)
 
+	// The entities of a hierarchy (or of a subtree) ordered level by level. The entities of a level depend
+	// Only on the entities of the previous levels, such that a level can be split between multiple threads
+	struct EntityHierarchyLevels {
+		ECS_INLINE unsigned int LevelCount() const {
+			return level_offsets.size > 0 ? level_offsets.size - 1 : 0;
+		}
+
+		ECS_INLINE Stream<Entity> GetLevel(unsigned int level) const {
+			return entities.SliceAt(level_offsets[level], level_offsets[level + 1] - level_offsets[level]);
+		}
+
+		ECS_INLINE void Deallocate(AllocatorPolymorphic allocator) {
+			entities.Deallocate(allocator);
+			parent_indices.Deallocate(allocator);
+			level_offsets.Deallocate(allocator);
+		}
+
+		Stream<Entity> entities;
+		// For each entity, the index of its parent inside the entities stream, or -1 for the entities of the first level
+		Stream<unsigned int> parent_indices;
+		// The entities of a level are in the range [level_offsets[level], level_offsets[level + 1])
+		Stream<unsigned int> level_offsets;
+	};
 
 	struct ECSENGINE_API EntityHierarchy {
 		struct Node;
@@ -104,8 +127,8 @@ namespace ECSEngine {
 		// If the parent is -1, then the child will be placed as a root
 		void AddEntry(Entity parent, Entity child);
 		
-		// TODO: Implement this - much faster than adding each child invidually
-		// If the parent is -1, the children will be placed at the root
+		// If the parent is -1, the children will be placed at the root. The children must not be in the hierarchy already.
+		// The tables and the children of the parent are grown only once for the entire batch
 		void AddChildren(Entity parent, Stream<Entity> children);
 
 		// The allocator should already be initialized
@@ -114,6 +137,11 @@ namespace ECSEngine {
 		// Updates the parent of an entity to another parent. It assumes that the new_parent and the child exist in the hierarchy
 		void ChangeParent(Entity new_parent, Entity child);
 
+		// Moves the given entities, together with their subtrees, under the new parent. If the new parent is -1, they become
+		// Roots. The new parent must not be inside the subtree of any of the children. The children of the new parent are grown
+		// Only once for the entire batch
+		void ChangeParents(Entity new_parent, Stream<Entity> children);
+
 		// Returns true if the entity is a root or a child of another entity
 		bool Exists(Entity entity) const;
 
@@ -137,6 +165,11 @@ namespace ECSEngine {
 		// The iterator doesn't contain the entity itself
 		NestedChildIterator GetNestedChildIterator(Entity entity) const;
 
+		// Returns the entities of the subtree of the given entity, without the entity itself, level by level. If the entity is -1,
+		// It returns the entire hierarchy, starting with the roots. The buffers are allocated from the given allocator,
+		// Preferably a temporary one
+		EntityHierarchyLevels GetLevels(Entity entity, AllocatorPolymorphic allocator) const;
+
 		// It returns an invalid entity in case the entity does not have a parent (doesn't exist, or it is a root)
 		Entity GetParent(Entity entity) const;
 
@@ -147,17 +180,23 @@ namespace ECSEngine {
 		// Returns true if the entity is a root, else false (can return false if the entity has not yet been inserted)
 		bool IsRoot(Entity entity) const;
 
-		// It will eliminate all the children as well
+		// It will eliminate all the children as well. The subtree is walked without recursion and without temporary storage
 		void RemoveEntry(Entity entity);
 
 	private:
 		void AddChildToNode(Node* node, Node* child);
 
+		// Appends the children to the node, with a single allocation. It only sets the parent of the children
+		void AppendChildrenToNode(Node* node, Stream<Node*> children);
+
 		// Changes the child's parent to be the new parent
 		void ChangeParentTo(Node* new_parent, Node* child);
 
 		void RemoveChildFromNode(Node* node, Node* child);
 
+		// Removes the last child of the node, without searching for it
+		void RemoveLastChildFromNode(Node* node);
+
 	public:
 
 		struct Node {
@@ -4,6 +4,8 @@
 #include "ArchetypeQueryCache.h"
 #include "Components.h"
 #include "../Utilities/StreamUtilities.h"
+#include "../Utilities/Timer.h"
+#include "../Profiling/AllocatorProfilingGlobal.h"
 
 #define ENTITY_MANAGER_DEFAULT_UNIQUE_COMPONENTS (1 << 7)
 #define ENTITY_MANAGER_DEFAULT_SHARED_COMPONENTS (1 << 7)
@@ -56,6 +58,13 @@ namespace ECSEngine {
 		ComponentSignature components_with_data;
 	};
 
+	struct DeferredCreateReservedEntities {
+		Stream<Entity> entities;
+		bool exclude_from_hierarchy;
+		ComponentSignature unique_components;
+		SharedComponentSignature shared_components;
+	};
+
 	struct DeferredDeleteEntities {
 		Stream<Entity> entities;
 	};
@@ -245,6 +254,7 @@ namespace ECSEngine {
 		DEFERRED_REMOVE_ENTITIES_FROM_HIERARCHY,
 		DEFERRED_TRY_REMOVE_ENTITIES_FROM_HIERARCHY,
 		DEFERRED_CHANGE_ENTITY_PARENT_HIERARCHY,
+		DEFERRED_CREATE_RESERVED_ENTITIES,
 		DEFERRED_CALLBACK_COUNT
 	};
 
@@ -527,6 +537,140 @@ namespace ECSEngine {
 		entity_manager->m_global_component_capacity = new_capacity;
 	}
 
+	static unsigned int SharedComponentInstanceHash(const SharedComponentInfo* component_info, const void* data) {
+		if (component_info->compare_entry.hash_function != nullptr) {
+			SharedComponentHashFunctionData hash_data;
+			hash_data.function_data = component_info->compare_entry.data;
+			hash_data.data = data;
+			return component_info->compare_entry.hash_function(&hash_data);
+		}
+		return fnv1a({ data, component_info->info.size });
+	}
+
+	static bool SharedComponentInstanceEquals(const SharedComponentInfo* component_info, const void* first, const void* second) {
+		if (component_info->compare_entry.function != nullptr) {
+			SharedComponentCompareFunctionData compare_data;
+			compare_data.function_data = component_info->compare_entry.data;
+			compare_data.first = first;
+			compare_data.second = second;
+			return component_info->compare_entry.function(&compare_data);
+		}
+		return memcmp(first, second, component_info->info.size) == 0;
+	}
+
+	static void SharedComponentHashIndexDeallocate(EntityManager* entity_manager, SharedComponentInfo* component_info) {
+		SharedComponentHashIndex* hash_index = &component_info->hash_index;
+		hash_index->table.Deallocate(entity_manager->SmallAllocator());
+		if (hash_index->capacity > 0) {
+			// The hashes are in the same allocation as the next instances
+			entity_manager->m_small_memory_manager.Deallocate(hash_index->next_instance);
+		}
+		memset(hash_index, 0, sizeof(*hash_index));
+	}
+
+	static void SharedComponentHashIndexInsert(EntityManager* entity_manager, SharedComponentInfo* component_info, SharedInstance instance) {
+		if (!component_info->HasHashIndex()) {
+			return;
+		}
+
+		SharedComponentHashIndex* hash_index = &component_info->hash_index;
+		if ((unsigned int)instance.value >= hash_index->capacity) {
+			unsigned int new_capacity = max(max((unsigned int)instance.value + 1, hash_index->capacity * 2), 16u);
+			void* allocation = entity_manager->m_small_memory_manager.Allocate((sizeof(short) + sizeof(unsigned int)) * new_capacity);
+			short* new_next_instance = (short*)allocation;
+			unsigned int* new_instance_hashes = (unsigned int*)OffsetPointer(allocation, sizeof(short) * new_capacity);
+			if (hash_index->capacity > 0) {
+				memcpy(new_next_instance, hash_index->next_instance, sizeof(short) * hash_index->capacity);
+				memcpy(new_instance_hashes, hash_index->instance_hashes, sizeof(unsigned int) * hash_index->capacity);
+				entity_manager->m_small_memory_manager.Deallocate(hash_index->next_instance);
+			}
+			hash_index->next_instance = new_next_instance;
+			hash_index->instance_hashes = new_instance_hashes;
+			hash_index->capacity = new_capacity;
+		}
+
+		unsigned int hash = SharedComponentInstanceHash(component_info, component_info->instances[instance.value]);
+		hash_index->instance_hashes[instance.value] = hash;
+		unsigned int table_index = hash_index->table.Find(hash);
+		if (table_index == -1) {
+			hash_index->next_instance[instance.value] = -1;
+			hash_index->table.InsertDynamic(entity_manager->SmallAllocator(), instance.value, hash);
+		}
+		else {
+			// Make it the head of the chain
+			short* head = hash_index->table.GetValuePtrFromIndex(table_index);
+			hash_index->next_instance[instance.value] = *head;
+			*head = instance.value;
+		}
+	}
+
+	static void SharedComponentHashIndexRemove(SharedComponentInfo* component_info, SharedInstance instance) {
+		SharedComponentHashIndex* hash_index = &component_info->hash_index;
+		if (!component_info->HasHashIndex() || (unsigned int)instance.value >= hash_index->capacity) {
+			return;
+		}
+
+		unsigned int table_index = hash_index->table.Find(hash_index->instance_hashes[instance.value]);
+		if (table_index == -1) {
+			return;
+		}
+
+		short* head = hash_index->table.GetValuePtrFromIndex(table_index);
+		if (*head == instance.value) {
+			short next = hash_index->next_instance[instance.value];
+			if (next == -1) {
+				hash_index->table.EraseFromIndex(table_index);
+			}
+			else {
+				*head = next;
+			}
+		}
+		else {
+			short previous = *head;
+			while (previous != -1 && hash_index->next_instance[previous] != instance.value) {
+				previous = hash_index->next_instance[previous];
+			}
+			if (previous != -1) {
+				hash_index->next_instance[previous] = hash_index->next_instance[instance.value];
+			}
+		}
+	}
+
+	// Recomputes the hashes of all the instances. It is needed after the data is changed in place or when the
+	// Compare or the hash function of the component change
+	static void SharedComponentHashIndexRebuild(EntityManager* entity_manager, SharedComponentInfo* component_info) {
+		SharedComponentHashIndexDeallocate(entity_manager, component_info);
+		if (!component_info->HasHashIndex()) {
+			return;
+		}
+
+		unsigned int instance_count = component_info->instances.stream.size;
+		if (instance_count > 0) {
+			component_info->hash_index.table.Initialize(entity_manager->SmallAllocator(), HashTablePowerOfTwoCapacityForElements(instance_count));
+			component_info->instances.stream.ForEachIndex([&](unsigned int index) {
+				SharedComponentHashIndexInsert(entity_manager, component_info, { (short)index });
+			});
+		}
+	}
+
+	// Returns -1 if there is no such instance. The index must not be dirty
+	static short SharedComponentHashIndexFind(const SharedComponentInfo* component_info, const void* data, unsigned int hash) {
+		const SharedComponentHashIndex* hash_index = &component_info->hash_index;
+		unsigned int table_index = hash_index->table.Find(hash);
+		if (table_index == -1) {
+			return -1;
+		}
+
+		short instance = hash_index->table.GetValueFromIndex(table_index);
+		while (instance != -1) {
+			if (hash_index->instance_hashes[instance] == hash && SharedComponentInstanceEquals(component_info, data, component_info->instances[instance])) {
+				return instance;
+			}
+			instance = hash_index->next_instance[instance];
+		}
+		return -1;
+	}
+
 #pragma region Write Component
 
 	static void CommitWriteComponent(EntityManager* manager, void* _data, void* _additional_data) {
@@ -1038,6 +1182,30 @@ namespace ECSEngine {
 		});
 	}
 
+	// The additional data, if given, is interpreted as an uint2* where the archetype indices are written
+	static void CommitCreateReservedEntities(EntityManager* manager, void* _data, void* _additional_data) {
+		DeferredCreateReservedEntities* data = (DeferredCreateReservedEntities*)_data;
+
+		uint2 archetype_indices = manager->FindOrCreateArchetypeBase(data->unique_components, data->shared_components);
+		ArchetypeBase* base_archetype = manager->GetBase(archetype_indices.x, archetype_indices.y);
+
+		unsigned int copy_position = base_archetype->Reserve(data->entities.size);
+		// The entities already exist in the pool, only their infos need to be set
+		manager->m_entity_pool->AllocateReserved(data->entities, archetype_indices, copy_position);
+
+		base_archetype->SetEntities(data->entities, copy_position);
+		base_archetype->m_size += data->entities.size;
+
+		if (!data->exclude_from_hierarchy) {
+			// Add the entities as roots
+			manager->AddEntitiesToParentCommit(data->entities, Entity::Invalid());
+		}
+
+		if (_additional_data != nullptr) {
+			*(uint2*)_additional_data = archetype_indices;
+		}
+	}
+
 #pragma endregion
 
 #pragma region Copy entities
@@ -1400,7 +1568,7 @@ namespace ECSEngine {
 
 			// Update the entity archetype references
 			for (size_t base_index = 0; base_index < archetype->GetBaseCount(); base_index++) {
-				const ArchetypeBase* base = archetype->GetBase(base_index);
+				const ArchetypeBase* base = const_archetype->GetBase(base_index);
 				for (size_t entity_index = 0; entity_index < base->m_size; entity_index++) {
 					// Use the variant without checks, since the data here should be valid
 					// (only in an insane circumstance where this memory gets corrupted that
@@ -1524,6 +1692,14 @@ namespace ECSEngine {
 			manager->m_shared_components[data->component.value].info.TryCallCopyFunction(allocation, data->data, false);
 		}
 
+		if (data->data != nullptr) {
+			SharedComponentHashIndexInsert(manager, &manager->m_shared_components[data->component.value], { (short)instance_index });
+		}
+		else {
+			// The data is going to be written afterwards
+			manager->m_shared_components[data->component.value].hash_index.is_dirty = true;
+		}
+
 		// Assert that the maximal amount of shared instance is not reached
 		if (_additional_data != nullptr) {
 			SharedInstance* instance = (SharedInstance*)_additional_data;
@@ -1580,6 +1756,8 @@ namespace ECSEngine {
 
 		void* instance_data = manager->m_shared_components[data->component.value].instances[data->instance.value];
 
+		SharedComponentHashIndexRemove(&manager->m_shared_components[data->component.value], data->instance);
+
 		// We also need to deallocate the buffers, if any
 		manager->m_shared_components[data->component.value].info.TryCallDeallocateFunction(instance_data);
 		Deallocate(manager->SmallAllocator(), instance_data);
@@ -1772,10 +1950,7 @@ namespace ECSEngine {
 
 	static void CommitAddEntitiesToParentHierarchy(EntityManager* manager, void* _data, void* _additional_data) {
 		DeferredAddEntitiesToParentHierarchy* data = (DeferredAddEntitiesToParentHierarchy*)_data;
-
-		for (size_t index = 0; index < data->entities.size; index++) {
-			manager->m_hierarchy.AddEntry(data->parent, data->entities[index]);
-		}
+		manager->m_hierarchy.AddChildren(data->parent, data->entities);
 	}
 
 #pragma endregion
@@ -1908,7 +2083,8 @@ namespace ECSEngine {
 		CommitAddEntitiesToParentHierarchy,
 		CommitRemoveEntitiesFromHierarchy,
 		CommitTryRemoveEntitiesFromHierarchy,
-		CommitChangeEntityParentHierarchy
+		CommitChangeEntityParentHierarchy,
+		CommitCreateReservedEntities
 	};
 
 	static_assert(ECS_COUNTOF(DEFERRED_CALLBACKS) == DEFERRED_CALLBACK_COUNT);
@@ -1977,6 +2153,10 @@ namespace ECSEngine {
 		ArchetypeQueryCache::DefaultAllocator(query_cache_allocator, m_memory_manager);
 		m_query_cache = (ArchetypeQueryCache*)m_memory_manager->Allocate(sizeof(ArchetypeQueryCache));
 		*m_query_cache = ArchetypeQueryCache(this, query_cache_allocator);
+
+		m_copy_on_write_source = nullptr;
+		m_copy_on_write_copies = ResizableStream<EntityManager*>(ECS_MALLOC_ALLOCATOR, 0);
+		m_compact_cursor = {};
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -2689,6 +2869,8 @@ namespace ECSEngine {
 		void* instance_data = GetSharedData(component, instance);
 		const ComponentInfo* component_info = &m_shared_components[component.value].info;
 		component_info->CallDeallocateFunction(instance_data);
+		// The buffers of the instance are reset in place
+		m_shared_components[component.value].hash_index.is_dirty = true;
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -2697,6 +2879,8 @@ namespace ECSEngine {
 		void* instance_data = GetSharedData(component, instance);
 		const ComponentInfo* component_info = &m_shared_components[component.value].info;
 		component_info->TryCallDeallocateFunction(instance_data);
+		// The buffers of the instance are reset in place
+		m_shared_components[component.value].hash_index.is_dirty = true;
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -2756,9 +2940,11 @@ namespace ECSEngine {
 		auto instances = m_shared_components[old_component.value].instances;
 		auto named_instances = m_shared_components[old_component.value].named_instances;
 		auto compare_entry = m_shared_components[old_component.value].compare_entry;
+		auto hash_index = m_shared_components[old_component.value].hash_index;
 		m_shared_components[old_component.value].instances.stream.capacity = 0;
 		m_shared_components[old_component.value].named_instances.m_capacity = 0;
 		m_shared_components[old_component.value].compare_entry = {};
+		memset(&m_shared_components[old_component.value].hash_index, 0, sizeof(hash_index));
 
 		// Always use size 0 allocator size because we will transfer the arena to the new slot
 		// In this way we avoid creating a new allocator and transfer all the existing data to it
@@ -2771,6 +2957,7 @@ namespace ECSEngine {
 		m_shared_components[new_component.value].instances = instances;
 		m_shared_components[new_component.value].named_instances = named_instances;
 		m_shared_components[new_component.value].compare_entry = compare_entry;
+		m_shared_components[new_component.value].hash_index = hash_index;
 
 		SwapComponentInfoUserDefinedInfo(this, &m_shared_components[old_component.value].info, &m_shared_components[new_component.value].info);
 
@@ -3061,6 +3248,9 @@ namespace ECSEngine {
 		else {
 			m_shared_components[component.value].compare_entry.data = CopyableCopy(compare_entry.data, ComponentAllocator());
 		}
+
+		// The hashes depend on the compare and the hash functions
+		SharedComponentHashIndexRebuild(this, &m_shared_components[component.value]);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -3084,6 +3274,9 @@ namespace ECSEngine {
 
 	void EntityManager::ClearAll(bool maintain_components)
 	{
+		// The copy on write links must be ended before the storage is released
+		DetachCopyOnWrite(false);
+
 		// Only the main memory manager must be cleared, since all the other structures are allocated from it.
 		
 		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 128, ECS_MB * 128);
@@ -3220,10 +3413,138 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
-	void EntityManager::CopyOther(const EntityManager* entity_manager)
+	static void ReportCompactReclaimedMemory(MemoryManager* allocator, size_t byte_count) {
+		if (byte_count > 0 && allocator->m_profiling_mode) {
+			AllocatorProfilingAddReclaimedMemory(allocator, byte_count);
+		}
+	}
+
+	EntityManagerCompactResult EntityManager::CompactCommit(const EntityManagerCompactOptions& options)
+	{
+		EntityManagerCompactResult result;
+		Timer timer;
+
+		size_t archetype_reclaimed_bytes = 0;
+		size_t shared_instance_reclaimed_bytes = 0;
+		auto finish = [&](bool finished) {
+			ReportCompactReclaimedMemory(m_memory_manager, archetype_reclaimed_bytes);
+			ReportCompactReclaimedMemory(&m_small_memory_manager, shared_instance_reclaimed_bytes);
+			result.reclaimed_bytes = archetype_reclaimed_bytes + shared_instance_reclaimed_bytes;
+			result.finished = finished;
+			if (finished) {
+				m_compact_cursor = {};
+			}
+			return result;
+		};
+
+		auto is_budget_exceeded = [&]() {
+			return options.time_budget_us > 0 && timer.GetDuration(ECS_TIMER_DURATION_US) >= options.time_budget_us;
+		};
+
+		// The archetypes are visited before the shared instances, such that the instances which were referenced only
+		// By the destroyed bases are unregistered in the same round. The cursor can be past the end, if archetypes
+		// Were destroyed since the previous call, in which case the loop simply ends
+		while (m_compact_cursor.archetype_index < m_archetypes.size) {
+			unsigned int archetype_index = m_compact_cursor.archetype_index;
+			Archetype* archetype = m_archetypes.buffer + archetype_index;
+			while (m_compact_cursor.base_index < archetype->m_base_archetypes.size) {
+				if (is_budget_exceeded()) {
+					return finish(false);
+				}
+
+				unsigned int base_index = m_compact_cursor.base_index;
+				ArchetypeBase* base = archetype->GetBase(base_index);
+				if (base->m_size == 0) {
+					size_t storage_size = base->m_capacity > 0 && !base->IsBufferShared() ? base->MemoryOf(base->m_capacity) : 0;
+					if (options.destroy_empty_bases) {
+						archetype_reclaimed_bytes += storage_size;
+						DestroyArchetypeBaseCommit(archetype_index, base_index);
+						result.destroyed_base_count++;
+						// The last base was swapped in its place, it is visited at the same index
+						continue;
+					}
+					else if (storage_size > 0) {
+						// Shrinking to an entity count of 0 would still allocate the component pointers, release the storage instead
+						archetype_reclaimed_bytes += storage_size;
+						base->Deallocate();
+						result.shrunk_base_count++;
+					}
+				}
+				else if (!base->IsBufferShared() && (float)base->m_size < (float)base->m_capacity * options.shrink_occupancy) {
+					// The entities keep their stream indices, the entity infos don't need to be changed
+					size_t previous_storage_size = base->MemoryOf(base->m_capacity);
+					base->ShrinkToFit();
+					archetype_reclaimed_bytes += previous_storage_size - base->MemoryOf(base->m_capacity);
+					result.shrunk_base_count++;
+				}
+				m_compact_cursor.base_index++;
+			}
+
+			m_compact_cursor.base_index = 0;
+			if (archetype->m_base_archetypes.size == 0 && options.destroy_empty_archetypes) {
+				// The last archetype is swapped in its place, it is visited at the same index
+				DestroyArchetypeCommit(archetype_index);
+				result.destroyed_archetype_count++;
+			}
+			else {
+				m_compact_cursor.archetype_index++;
+			}
+		}
+
+		if (options.unregister_unreferenced_shared_instances) {
+			// The stack allocation is made once, for the largest instance count, instead of once per component,
+			// Since the stack allocations are released only when the function returns
+			unsigned int max_instance_count = 0;
+			for (unsigned int index = m_compact_cursor.shared_component_index; index < m_shared_components.size; index++) {
+				if (ExistsSharedComponent({ (short)index })) {
+					max_instance_count = max(max_instance_count, m_shared_components[index].instances.stream.capacity);
+				}
+			}
+			ECS_STACK_CAPACITY_STREAM_DYNAMIC(bool, instance_bitmask_storage, max_instance_count);
+
+			while (m_compact_cursor.shared_component_index < m_shared_components.size) {
+				if (is_budget_exceeded()) {
+					return finish(false);
+				}
+
+				Component component = { (short)m_compact_cursor.shared_component_index };
+				if (ExistsSharedComponent(component)) {
+					SharedComponentInfo* component_info = &m_shared_components[component.value];
+					unsigned int instance_count = component_info->instances.stream.capacity;
+					// The bitmask function clears the entries of this component only
+					CapacityStream<bool> instance_bitmask = { instance_bitmask_storage.buffer, 0, instance_count };
+					UnreferencedSharedInstanceBitmask(component, instance_bitmask);
+					// The named instances are treated as referenced, unregistering them would leave their names dangling
+					component_info->named_instances.ForEachConst([&](SharedInstance instance, ResourceIdentifier identifier) {
+						instance_bitmask[instance.value] = true;
+					});
+
+					// The instances are kept at their slots when one of them is removed, the bitmask stays valid
+					for (unsigned int index = 0; index < instance_count; index++) {
+						SharedInstance instance = { (short)index };
+						if (!instance_bitmask[index] && ExistsSharedInstanceOnly(component, instance)) {
+							UnregisterSharedInstanceCommit(component, instance);
+							shared_instance_reclaimed_bytes += component_info->info.size;
+							result.unregistered_shared_instance_count++;
+						}
+					}
+				}
+				m_compact_cursor.shared_component_index++;
+			}
+		}
+
+		return finish(true);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	void EntityManager::CopyOther(const EntityManager* entity_manager, bool copy_on_write)
 	{
 		// TODO: Enforce that everything is cleared out? Otherwise some deallocations
 		// Might be lost
+		DetachCopyOnWrite(false);
+		// The archetypes are replaced, a compaction in progress starts over
+		m_compact_cursor = {};
 
 		// Copy the entities first using the entity pool
 		m_entity_pool->CopyEntities(entity_manager->m_entity_pool);
@@ -3295,6 +3616,7 @@ namespace ECSEngine {
 
 				unsigned int other_capacity = entity_manager->m_shared_components[index].instances.stream.capacity;
 				m_shared_components[index].instances.Initialize(SmallAllocator(), other_capacity);
+				memset(&m_shared_components[index].hash_index, 0, sizeof(m_shared_components[index].hash_index));
 
 				if (entity_manager->m_shared_components[index].instances.stream.size > 0) {
 					m_shared_components[index].instances.stream.Copy(entity_manager->m_shared_components[index].instances.stream);
@@ -3312,6 +3634,9 @@ namespace ECSEngine {
 					});
 				}
 
+				// The hash index is rebuilt instead of copied, since the other one might be dirty
+				SharedComponentHashIndexRebuild(this, &m_shared_components[index]);
+
 				// If there are any named instances, allocate them separately
 				if (entity_manager->m_shared_components[index].named_instances.GetCount() > 0) {
 					size_t blit_size = entity_manager->m_shared_components[index].named_instances.MemoryOf(entity_manager->m_shared_components[index].named_instances.GetCapacity());
@@ -3380,7 +3705,12 @@ namespace ECSEngine {
 				)
 			);
 
-			m_archetypes[index].CopyOther(entity_manager->m_archetypes.buffer + index);
+			m_archetypes[index].CopyOther(entity_manager->m_archetypes.buffer + index, copy_on_write);
+		}
+
+		if (copy_on_write) {
+			m_copy_on_write_source = entity_manager;
+			entity_manager->m_copy_on_write_copies.Add(this);
 		}
 
 		// If the hierarchy allocator doesn't exist, initialize it now
@@ -3636,6 +3966,65 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	uint2 EntityManager::CreateReservedEntitiesCommit(
+		Stream<Entity> entities,
+		ComponentSignature unique_components,
+		SharedComponentSignature shared_components,
+		bool exclude_from_hierarchy
+	) {
+		DeferredCreateReservedEntities commit_data;
+		commit_data.entities = entities;
+		commit_data.exclude_from_hierarchy = exclude_from_hierarchy;
+		commit_data.unique_components = unique_components;
+		commit_data.shared_components = shared_components;
+
+		uint2 archetype_indices;
+		CommitCreateReservedEntities(this, &commit_data, &archetype_indices);
+		return archetype_indices;
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	void EntityManager::CreateReservedEntities(
+		Stream<Entity> entities,
+		ComponentSignature unique_components,
+		SharedComponentSignature shared_components,
+		bool exclude_from_hierarchy,
+		DeferredActionParameters parameters,
+		DebugInfo debug_info
+	) {
+		size_t allocation_size = sizeof(DeferredCreateReservedEntities) + sizeof(Component) * unique_components.count
+			+ (sizeof(Component) + sizeof(SharedInstance)) * shared_components.count;
+		allocation_size += parameters.entities_are_stable ? 0 : entities.MemoryOf(entities.size);
+
+		void* allocation = AllocateTemporaryBuffer(allocation_size);
+		uintptr_t buffer = (uintptr_t)allocation;
+		DeferredCreateReservedEntities* data = (DeferredCreateReservedEntities*)allocation;
+		buffer += sizeof(*data);
+
+		data->exclude_from_hierarchy = exclude_from_hierarchy;
+
+		data->unique_components.indices = (Component*)buffer;
+		data->unique_components.count = unique_components.count;
+		memcpy(data->unique_components.indices, unique_components.indices, sizeof(Component) * unique_components.count);
+		buffer += sizeof(Component) * unique_components.count;
+
+		data->shared_components.indices = (Component*)buffer;
+		data->shared_components.count = shared_components.count;
+		memcpy(data->shared_components.indices, shared_components.indices, sizeof(Component) * shared_components.count);
+		buffer += sizeof(Component) * shared_components.count;
+
+		data->shared_components.instances = (SharedInstance*)buffer;
+		memcpy(data->shared_components.instances, shared_components.instances, sizeof(SharedInstance) * shared_components.count);
+		buffer += sizeof(SharedInstance) * shared_components.count;
+
+		data->entities = GetEntitiesFromActionParameters(entities, parameters, buffer);
+
+		WriteCommandStream(this, parameters, { DataPointer(allocation, DEFERRED_CREATE_RESERVED_ENTITIES), debug_info });
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	void EntityManager::CreateEntities(
 		unsigned int count,
 		ComponentSignature unique_components, 
@@ -4229,9 +4618,63 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	void EntityManager::DetachCopyOnWrite(bool keep_storage)
+	{
+		// The copies reference storage that belongs to our allocator, they need their own before it goes away
+		for (unsigned int index = 0; index < m_copy_on_write_copies.size; index++) {
+			EntityManager* copy = m_copy_on_write_copies[index];
+			for (unsigned int archetype_index = 0; archetype_index < copy->m_archetypes.size; archetype_index++) {
+				Archetype* archetype = copy->m_archetypes.buffer + archetype_index;
+				for (unsigned int base_index = 0; base_index < archetype->m_base_archetypes.size; base_index++) {
+					archetype->m_base_archetypes[base_index].archetype.EnsureUniqueBuffers();
+				}
+			}
+			copy->m_copy_on_write_source = nullptr;
+		}
+		m_copy_on_write_copies.FreeBuffer();
+
+		// The bases of the source keep the shared records even after all the copies are gone, these must be released as well
+		for (unsigned int archetype_index = 0; archetype_index < m_archetypes.size; archetype_index++) {
+			Archetype* archetype = m_archetypes.buffer + archetype_index;
+			for (unsigned int base_index = 0; base_index < archetype->m_base_archetypes.size; base_index++) {
+				ArchetypeBase* base = &archetype->m_base_archetypes[base_index].archetype;
+				if (keep_storage) {
+					base->EnsureUniqueBuffers();
+				}
+				else if (base->IsBufferShared()) {
+					// Only drop the reference, the source might still use the storage
+					base->Deallocate();
+				}
+			}
+		}
+
+		if (m_copy_on_write_source != nullptr) {
+			m_copy_on_write_source->m_copy_on_write_copies.RemoveSwapBackByValue(this, "The copy on write source does not reference the entity manager");
+			m_copy_on_write_source = nullptr;
+		}
+
+		// The copies queued the storage they referenced, since it belongs to our allocator
+		ArchetypeBase::ReleasePendingSharedBuffers(m_memory_manager);
+
+#ifdef ECSENGINE_DEBUG
+		// The callers release the memory of the entity manager after the detach. A base that still shares its storage
+		// Would have it released later on through an allocator that might not exist anymore
+		for (unsigned int archetype_index = 0; archetype_index < m_archetypes.size; archetype_index++) {
+			const Archetype* archetype = m_archetypes.buffer + archetype_index;
+			for (unsigned int base_index = 0; base_index < archetype->m_base_archetypes.size; base_index++) {
+				ECS_ASSERT(!archetype->m_base_archetypes[base_index].archetype.IsBufferShared(), "EntityManager: A base archetype still shares its storage after the copy on write detach.");
+			}
+		}
+#endif
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	void EntityManager::EndFrame()
 	{
 		Flush();
+		// The copies on write that were detached in the meantime might have left storage of our allocator to be released
+		ArchetypeBase::ReleasePendingSharedBuffers(m_memory_manager);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -4372,6 +4815,10 @@ namespace ECSEngine {
 		for (unsigned int index = 0; index < pending_command_stream_count; index++) {
 			Flush(m_pending_command_streams[index]);
 		}
+
+		// All the creation commands for the reserved entities were executed, the ones that are still
+		// Pending were abandoned and must be rolled back
+		m_entity_pool->FlushReservations();
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -4447,6 +4894,10 @@ namespace ECSEngine {
 
 	SharedInstance EntityManager::FindOrCreateSharedInstanceCommit(Component component, const void* data)
 	{
+		ECS_CRASH_CONDITION_RETURN(ExistsSharedComponent(component), SharedInstance::Invalid(), "EntityManager: There is no shared component {#} when trying to "
+			"find or create a shared instance.", component.value);
+		RefreshSharedComponentHashIndexCommit(component);
+
 		SharedInstance instance = GetSharedComponentInstance(component, data);
 		if (!instance.IsValid()) {
 			instance = RegisterSharedInstanceCommit(component, data);
@@ -4604,7 +5055,9 @@ namespace ECSEngine {
 
 	void* EntityManager::GetComponentWithIndex(EntityInfo info, unsigned char component_index)
 	{
-		return GetBase(info.main_archetype, info.base_archetype)->GetComponentByIndex(info, component_index);
+		ArchetypeBase* base = GetBase(info.main_archetype, info.base_archetype);
+		base->EnsureUniqueBuffers();
+		return base->GetComponentByIndex(info, component_index);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -4966,7 +5419,12 @@ namespace ECSEngine {
 
 	void* EntityManager::GetSharedData(Component component, SharedInstance instance)
 	{
-		return (void*)((const EntityManager*)this)->GetSharedData(component, instance);
+		const void* data = ((const EntityManager*)this)->GetSharedData(component, instance);
+		if (data != nullptr) {
+			// The data can be modified in place through the returned pointer
+			MarkSharedComponentHashIndexDirty(component);
+		}
+		return (void*)data;
 	}
 
 	const void* EntityManager::GetSharedData(Component component, SharedInstance instance) const
@@ -4989,7 +5447,12 @@ namespace ECSEngine {
 
 	void* EntityManager::GetNamedSharedData(Component component, Stream<char> identifier)
 	{
-		return (void*)((const EntityManager*)this)->GetNamedSharedData(component, identifier);
+		const void* data = ((const EntityManager*)this)->GetNamedSharedData(component, identifier);
+		if (data != nullptr) {
+			// The data can be modified in place through the returned pointer
+			MarkSharedComponentHashIndexDirty(component);
+		}
+		return (void*)data;
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -5015,6 +5478,42 @@ namespace ECSEngine {
 		ECS_CRASH_CONDITION_RETURN(component_size != -1, { -1 },  "EntityManager: There is no shared component allocated at {#}. Cannot retrieve shared instance data.",
 			component.value);
 
+		const SharedComponentInfo* component_info = &m_shared_components[component.value];
+		if (component_info->HasHashIndex() && !component_info->hash_index.is_dirty) {
+			return { SharedComponentHashIndexFind(component_info, data, SharedComponentInstanceHash(component_info, data)) };
+		}
+		return GetSharedComponentInstanceLinear(component, data);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	SharedInstance EntityManager::GetSharedComponentInstanceHashed(Component component, const void* data, unsigned int hash) const
+	{
+		ECS_CRASH_CONDITION_RETURN(ExistsSharedComponent(component), { -1 }, "EntityManager: There is no shared component {#} when trying to "
+			"get a shared instance by hash.", component.value);
+
+		const SharedComponentInfo* component_info = &m_shared_components[component.value];
+		if (component_info->HasHashIndex() && !component_info->hash_index.is_dirty) {
+			return { SharedComponentHashIndexFind(component_info, data, hash) };
+		}
+		return GetSharedComponentInstanceLinear(component, data);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	unsigned int EntityManager::GetSharedComponentInstanceHash(Component component, const void* data) const
+	{
+		ECS_CRASH_CONDITION_RETURN(ExistsSharedComponent(component), 0, "EntityManager: There is no shared component {#} when trying to "
+			"hash a shared instance.", component.value);
+		return SharedComponentInstanceHash(&m_shared_components[component.value], data);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	SharedInstance EntityManager::GetSharedComponentInstanceLinear(Component component, const void* data) const
+	{
+		unsigned int component_size = m_shared_components[component.value].info.size;
+
 		short instance_index = -1;
 		// Check to see if we have a compare function. If we do, use that
 		if (m_shared_components[component.value].compare_entry.function != nullptr) {
@@ -5083,6 +5582,10 @@ namespace ECSEngine {
 
 	SharedInstance EntityManager::GetOrCreateSharedComponentInstanceCommit(Component component, const void* data, bool* created_instance)
 	{
+		ECS_CRASH_CONDITION_RETURN(ExistsSharedComponent(component), SharedInstance::Invalid(), "EntityManager: There is no shared component {#} when trying to "
+			"get or create a shared instance.", component.value);
+		RefreshSharedComponentHashIndexCommit(component);
+
 		SharedInstance existing_instance = GetSharedComponentInstance(component, data);
 		if (!existing_instance.IsValid()) {
 			if (created_instance != nullptr) {
@@ -5108,6 +5611,13 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	bool EntityManager::IsSharedComponentHashIndexValid(Component component) const
+	{
+		return m_shared_components[component.value].HasHashIndex() && !m_shared_components[component.value].hash_index.is_dirty;
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	unsigned int EntityManager::GetSharedComponentInstanceCount(Component component) const
 	{
 		ECS_CRASH_CONDITION(ExistsSharedComponent(component), "EntityManager: Trying to retrieve instance count for shared component {#}, but it doesn't exist.", component.value);
@@ -5388,6 +5898,13 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	void EntityManager::PrepareEntityReservations(unsigned int count)
+	{
+		m_entity_pool->PrepareReservations(count);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	void EntityManager::PerformEntityComponentOperationsCommit(Entity entity, const PerformEntityComponentOperationsData& data) {
 		ECS_CRASH_CONDITION_RETURN_VOID(data.added_unique_components_data.size == 0 || data.added_unique_components_data.size == data.added_unique_components.count, 
 			"EntityManager: Invalid number of unique component data buffers specified for call `PerformEntityComponentOperationsCommit`");
@@ -5726,6 +6243,7 @@ namespace ECSEngine {
 		m_shared_components[component.value].info.size = size;
 		m_shared_components[component.value].instances.Initialize(SmallAllocator(), 0);
 		m_shared_components[component.value].named_instances.Initialize(SmallAllocator(), 0);
+		memset(&m_shared_components[component.value].hash_index, 0, sizeof(m_shared_components[component.value].hash_index));
 		m_shared_components[component.value].info.name = StringCopy(SmallAllocator(), component_name);
 
 		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 16, ECS_MB);
@@ -5849,6 +6367,33 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	void EntityManager::RebuildSharedComponentHashIndexCommit(Component component)
+	{
+		ECS_CRASH_CONDITION(ExistsSharedComponent(component), "EntityManager: There is no shared component {#} when trying to rebuild its hash index.",
+			component.value);
+		SharedComponentHashIndexRebuild(this, &m_shared_components[component.value]);
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	void EntityManager::MarkSharedComponentHashIndexDirty(Component component)
+	{
+		ECS_CRASH_CONDITION(ExistsSharedComponent(component), "EntityManager: There is no shared component {#} when trying to mark its hash index as dirty.",
+			component.value);
+		m_shared_components[component.value].hash_index.is_dirty = true;
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
+	void EntityManager::RefreshSharedComponentHashIndexCommit(Component component)
+	{
+		if (m_shared_components[component.value].hash_index.is_dirty) {
+			RebuildSharedComponentHashIndexCommit(component);
+		}
+	}
+
+	// --------------------------------------------------------------------------------------------------------------------
+
 	SharedInstance EntityManager::RegisterSharedInstanceCommit(Component component, const void* data, bool copy_buffers) {
 		DeferredCreateSharedInstance commit_data;
 		commit_data.component = component;
@@ -5876,6 +6421,7 @@ namespace ECSEngine {
 		ECS_CRASH_CONDITION(m_shared_components[component.value].instances.ExistsItem(instance.value), "EntityManager: Too many shared instances created for component {#}.",
 			GetSharedComponentName(component));
 		m_shared_components[component.value].instances.AllocateIndex(instance.value);
+		m_shared_components[component.value].hash_index.is_dirty = true;
 
 		if (data != nullptr && copy_buffers) {
 			// Call the copy function
@@ -6052,6 +6598,8 @@ namespace ECSEngine {
 			void* new_allocation = m_small_memory_manager.Allocate(new_size);
 			data = new_allocation;
 		});
+		// The data is going to be written afterwards
+		m_shared_components[component.value].hash_index.is_dirty = true;
 	}
 
 	void* EntityManager::ResizeGlobalComponent(Component component, unsigned int new_size) {
@@ -6123,6 +6671,9 @@ namespace ECSEngine {
 	// --------------------------------------------------------------------------------------------------------------------
 
 	void EntityManager::Reset() {
+		// The copy on write links must be ended before the storage is released
+		DetachCopyOnWrite(false);
+
 		// Free the allocator of the query cache
 		FreeAllocatorFrom(m_query_cache->allocator, m_memory_manager->m_backup);
 
@@ -6159,6 +6710,19 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------------------------------------
 
+	// Keeps the hash index in sync with the new data. When the index is dirty, it will be rebuilt anyway
+	static void SetSharedInstanceData(EntityManager* entity_manager, Component component, SharedInstance instance, const void* data) {
+		SharedComponentInfo* component_info = &entity_manager->m_shared_components[component.value];
+		bool update_hash_index = component_info->HasHashIndex() && !component_info->hash_index.is_dirty;
+		if (update_hash_index) {
+			SharedComponentHashIndexRemove(component_info, instance);
+		}
+		memcpy(component_info->instances[instance.value], data, component_info->info.size);
+		if (update_hash_index) {
+			SharedComponentHashIndexInsert(entity_manager, component_info, instance);
+		}
+	}
+
 	void EntityManager::SetSharedComponentData(Component component, SharedInstance instance, const void* data)
 	{
 		ECS_CRASH_CONDITION(ExistsSharedComponent(component), "EntityManager: The component {#} doesn't exist when trying to set shared component data.", component.value);
@@ -6166,8 +6730,7 @@ namespace ECSEngine {
 		ECS_CRASH_CONDITION(ExistsSharedInstanceOnly(component, instance), "EntityManager: The instance {#} doesn't exist when trying to set "
 			"shared component data for component {#}.", GetSharedComponentName(component), instance.value);
 
-		unsigned int component_size = SharedComponentSize(component);
-		memcpy(m_shared_components[component.value].instances[instance.value], data, component_size);
+		SetSharedInstanceData(this, component, instance, data);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -6187,8 +6750,7 @@ namespace ECSEngine {
 			identifier
 		);
 
-		unsigned int component_size = SharedComponentSize(component);
-		memcpy(m_shared_components[component.value].instances[instance.value], data, component_size);
+		SetSharedInstanceData(this, component, instance, data);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------
@@ -6337,7 +6899,8 @@ namespace ECSEngine {
 	// --------------------------------------------------------------------------------------------------------------------
 
 	void* EntityManager::TryGetComponent(Entity entity, Component component) {
-		return (void*)((const EntityManager*)this)->TryGetComponent(entity, component);
+		EntityInfo info = GetEntityInfo(entity);
+		return TryGetComponent(info, component);
 	}
 
 	const void* EntityManager::TryGetComponent(Entity entity, Component component) const {
@@ -6348,6 +6911,8 @@ namespace ECSEngine {
 	// --------------------------------------------------------------------------------------------------------------------
 
 	void* EntityManager::TryGetComponent(EntityInfo info, Component component) {
+		// The pointer can be written to, the base must not share its storage anymore
+		GetBase(info.main_archetype, info.base_archetype)->EnsureUniqueBuffers();
 		return (void*)((const EntityManager*)this)->TryGetComponent(info, component);
 	}
 
@@ -6423,11 +6988,13 @@ namespace ECSEngine {
 		ECS_CRASH_CONDITION_RETURN(ExistsSharedInstance(component, instance), false, "EntityManager: Trying to merge invalid shared instance {#} for component {#}", instance.value,
 			GetSharedComponentName(component));
 
-		const void* instance_data = GetSharedData(component, instance);
-		bool was_matched = ForEachSharedInstance<true>(component, [this, component, instance, instance_data](SharedInstance current_instance) {
+		// Use the const accessor, the mutable one marks the hash index as dirty
+		const EntityManager* const_this = this;
+		const void* instance_data = const_this->GetSharedData(component, instance);
+		bool was_matched = ForEachSharedInstance<true>(component, [this, const_this, component, instance, instance_data](SharedInstance current_instance) {
 			if (current_instance != instance) {
 				bool are_equal = false;
-				const void* current_instance_data = GetSharedData(component, current_instance);
+				const void* current_instance_data = const_this->GetSharedData(component, current_instance);
 				if (m_shared_components[component.value].compare_entry.function != nullptr) {
 					SharedComponentCompareFunctionData compare_data;
 					compare_data.function_data = m_shared_components[component.value].compare_entry.data;
@@ -6556,6 +7123,7 @@ namespace ECSEngine {
 		}
 		CopyableDeallocate(m_shared_components[component.value].info.data, ComponentAllocator());
 
+		SharedComponentHashIndexDeallocate(this, &m_shared_components[component.value]);
 		m_shared_components[component.value].instances.FreeBuffer();
 		m_shared_components[component.value].info.size = -1;
 		m_small_memory_manager.Deallocate(m_shared_components[component.value].info.name.buffer);
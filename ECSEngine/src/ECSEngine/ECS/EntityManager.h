@@ -115,6 +115,38 @@ namespace ECSEngine {
 		Stream<const void*> added_unique_components_data = {};
 	};
 
+	struct EntityManagerCompactOptions {
+		// The pass stops once this many microseconds elapsed and the next call continues from where it stopped.
+		// When 0, the whole entity manager is compacted in a single call
+		size_t time_budget_us = 0;
+		// The bases whose entity count over capacity ratio is under this value are shrunk to fit
+		float shrink_occupancy = 0.5f;
+		bool destroy_empty_bases = true;
+		// The main archetypes that are left without any base are destroyed as well
+		bool destroy_empty_archetypes = true;
+		// Opt in - the shared instances that no entity references can still be held by the user, for example registered
+		// Ahead of the entities that use them, and unregistering them would leave those handles dangling. The named
+		// Shared instances are kept even when this is set, since they can still be looked up
+		bool unregister_unreferenced_shared_instances = false;
+	};
+
+	struct EntityManagerCompactCursor {
+		unsigned int archetype_index = 0;
+		unsigned int base_index = 0;
+		unsigned int shared_component_index = 0;
+	};
+
+	struct EntityManagerCompactResult {
+		// The archetype storage and the shared instance data that was given back to the allocators by this call
+		size_t reclaimed_bytes = 0;
+		unsigned int shrunk_base_count = 0;
+		unsigned int destroyed_base_count = 0;
+		unsigned int destroyed_archetype_count = 0;
+		unsigned int unregistered_shared_instance_count = 0;
+		// When false, the time budget was reached before the pass went through everything
+		bool finished = false;
+	};
+
 	// A functor that is called by the entity manager to generate component functions when a component that has missing
 	// Component functions is registered. This improves the QoL for developing inside the Editor for Global components,
 	// Since the user inside the module cannot specify auto generated component functions. For this reason, this functor
@@ -484,8 +516,29 @@ namespace ECSEngine {
 
 		void ClearCache();
 
-		// It will copy everything. The components, the shared components, the archetypes, the entities inside the entity pool
-		void CopyOther(const EntityManager* entity_manager);
+		// ---------------------------------------------------------------------------------------------------
+
+		/*
+			Gives back the memory that the archetypes keep after many entities were removed. The under occupied bases are
+			Reallocated to their entity count, the empty bases and archetypes are destroyed and, when requested in the options, the
+			Unreferenced shared instances are unregistered. The entities keep their stream indices, only the archetype and base indices of the entities from
+			The bases or archetypes that are swapped in place of the destroyed ones change, which are updated like for any other
+			Destroy call. The bases whose storage is shared with a copy on write are skipped. When a time budget is given, the pass
+			Stops after the budget is exceeded and the next call continues from that point, such that it can be spread over
+			Multiple frames - the structural changes made between the calls are picked up on the next round. The reclaimed
+			Bytes are reported to the allocator profiling when the allocators are in profiling mode (look at
+			AllocatorProfilingGetReclaimedMemory).
+			It must be called outside the system execution, when there are no pending deferred calls. Single threaded
+		*/
+		EntityManagerCompactResult CompactCommit(const EntityManagerCompactOptions& options = {});
+
+		// ---------------------------------------------------------------------------------------------------
+
+		// It will copy everything. The components, the shared components, the archetypes, the entities inside the entity pool.
+		// When copy on write is set, the archetype bases whose components have no buffers are not copied, they reference the
+		// Storage of the other entity manager and each side clones a base only when writing to it for the first time.
+		// The two entity managers stay linked until one of them is cleared, reset or detached (look at DetachCopyOnWrite)
+		void CopyOther(const EntityManager* entity_manager, bool copy_on_write = false);
 
 		// Copies the current state of the query cache
 		void CopyQueryCache(ArchetypeQueryCache* query_cache, AllocatorPolymorphic allocator);
@@ -590,6 +643,28 @@ namespace ECSEngine {
 			bool exclude_from_hierarchy = false
 		);
 
+		// Creates the entities that were obtained with ReserveEntity/ReserveEntities.
+		// It will crash if any of the entities is not a pending reservation.
+		// Returns the indices of the archetype where these entities have been added
+		uint2 CreateReservedEntitiesCommit(
+			Stream<Entity> entities,
+			ComponentSignature unique_components,
+			SharedComponentSignature shared_components,
+			bool exclude_from_hierarchy = false
+		);
+
+		// Deferred Call
+		// Creates the entities that were obtained with ReserveEntity/ReserveEntities. The entities can be referenced
+		// Right away, for example as parents or inside components, since their values are already known
+		void CreateReservedEntities(
+			Stream<Entity> entities,
+			ComponentSignature unique_components,
+			SharedComponentSignature shared_components,
+			bool exclude_from_hierarchy = false,
+			DeferredActionParameters parameters = {},
+			DebugInfo debug_info = ECS_DEBUG_INFO
+		);
+
 		// Deferred Call
 		// The entities generated cannot be determined right now since it is deferred for later
 		// Filling a buffer with the entities generated will induce a syncronization barrier which may be too costly
@@ -735,6 +810,17 @@ namespace ECSEngine {
 
 		// ---------------------------------------------------------------------------------------------------
 
+		// Ends all the copy on write links of this entity manager. The copies made from it receive their own storage and,
+		// If keep storage is set, this entity manager as well. When keep storage is false, the bases that referenced the
+		// Storage of another entity manager are left empty, which is meant for when this instance is about to be released.
+		// It must be called before the memory of an entity manager that took part in a copy on write is released without
+		// Going through ClearAll or Reset, which call it themselves. The storage of this entity manager that the copies
+		// Released is reclaimed at the end. Single threaded - the linked entity managers must not be used in the meantime,
+		// Since their bases are cloned as well
+		void DetachCopyOnWrite(bool keep_storage = true);
+
+		// ---------------------------------------------------------------------------------------------------
+
 		// Destroys the archetype if it is empty (it has no entities).
 		void DestroyArchetypeEmptyCommit(unsigned int main_index);
 
@@ -1064,6 +1150,8 @@ namespace ECSEngine {
 				unsigned int base_count = archetype->GetBaseCount();
 				for (unsigned int base_index = 0; base_index < base_count; base_index++) {
 					ArchetypeBase* base_archetype = archetype->GetBase(base_index);
+					// The functor receives writable pointers
+					base_archetype->EnsureUniqueBuffers();
 					base_initialize(archetype, base_index);
 
 					unsigned int entity_count = base_archetype->EntityCount();
@@ -1206,6 +1294,8 @@ namespace ECSEngine {
 				unsigned char component_index = archetype->FindUniqueComponentIndex(component);
 				for (unsigned int base_index = 0; base_index < base_count; base_index++) {
 					ArchetypeBase* archetype_base = archetype->GetBase(base_index);
+					// The functor receives writable pointers
+					archetype_base->EnsureUniqueBuffers();
 					unsigned int entity_count = archetype_base->EntityCount();
 					for (unsigned int entity_index = 0; entity_index < entity_count; entity_index++) {
 						Entity entity = archetype_base->GetEntityAtIndex(entity_index);
@@ -1344,11 +1434,17 @@ namespace ECSEngine {
 		// Executes all deferred calls inside a command stream
 		void Flush(EntityManagerCommandStream command_stream);
 
-		// Verifies if the entity is still valid. It might become invalid if another system deleted it in the meantime
+		// Verifies if the entity is still valid. It might become invalid if another system deleted it in the meantime.
+		// The reserved entities that were not yet created do not exist
 		ECS_INLINE bool ExistsEntity(Entity entity) const {
 			return m_entity_pool->IsValid(entity);
 		}
 
+		// Returns true if the entity was reserved with ReserveEntity/ReserveEntities and it was not yet created
+		ECS_INLINE bool IsEntityReserved(Entity entity) const {
+			return m_entity_pool->IsReserved(entity);
+		}
+
 		// Returns true if the given entity exists in the hierarchy, else false
 		ECS_INLINE bool ExistsEntityInHierarchy(Entity entity) const {
 			return m_hierarchy.Exists(entity);
@@ -1639,6 +1735,9 @@ namespace ECSEngine {
 		// Make sure the values are not modified
 		void ECS_VECTORCALL GetEntitiesExclude(const ArchetypeQueryExclude& query, CapacityStream<Entity*>* entities) const;
 
+		// The data can be modified through the returned pointer, such that the hash index of the component is marked
+		// As dirty and the lookups by data fall back to the linear search until the next rebuild. Use the const variant
+		// When only reading, it is safe to be called from multiple threads
 		void* GetSharedData(Component component, SharedInstance instance);
 
 		const void* GetSharedData(Component component, SharedInstance instance) const;
@@ -1656,12 +1755,25 @@ namespace ECSEngine {
 		// Returns the number of shared component named instances. It ensures that the component is valid
 		unsigned int GetNamedSharedInstanceCount(Component component) const;
 
+		// The same as GetSharedData, it marks the hash index of the component as dirty
 		void* GetNamedSharedData(Component component, Stream<char> identifier);
 
 		const void* GetNamedSharedData(Component component, Stream<char> identifier) const;
 
+		// Uses the hash index of the component when it is valid, else it compares against all the instances
 		SharedInstance GetSharedComponentInstance(Component component, const void* data) const;
 
+		// The same as the data variant, but with the hash already computed with GetSharedComponentInstanceHash,
+		// Such that it can be computed once for many lookups or in parallel
+		SharedInstance GetSharedComponentInstanceHashed(Component component, const void* data, unsigned int hash) const;
+
+		// The hash that the instance with this data has in the hash index. It uses the hash function of the
+		// Component, if it has one, else the bytes are hashed
+		unsigned int GetSharedComponentInstanceHash(Component component, const void* data) const;
+
+		// Compares against all the instances, without using the hash index
+		SharedInstance GetSharedComponentInstanceLinear(Component component, const void* data) const;
+
 		SharedInstance GetSharedComponentInstance(Component component, Entity entity) const;
 
 		// This overload is faster than the entity variant, if this info is readily available
@@ -1677,6 +1789,10 @@ namespace ECSEngine {
 		// Fills in all the shared instances that are registered for that component
 		void GetSharedComponentInstanceAll(Component component, CapacityStream<SharedInstance>& shared_instances) const;
 
+		// Returns true if the lookups by data use the hash index. It is not valid when the component has a compare
+		// Function without a hash function, or after MarkSharedComponentHashIndexDirty was called, until the next rebuild
+		bool IsSharedComponentHashIndexValid(Component component) const;
+
 		// Returns the number of instances created for the given component
 		unsigned int GetSharedComponentInstanceCount(Component component) const;
 
@@ -1772,6 +1888,13 @@ namespace ECSEngine {
 
 		// ---------------------------------------------------------------------------------------------------
 
+		// Main thread only. Prepares count entities that can be reserved from any thread without a lock with
+		// ReserveEntity/ReserveEntities until the next Flush. The reserved entities that were not created
+		// With CreateReservedEntities until the Flush are rolled back and their handles become invalid
+		void PrepareEntityReservations(unsigned int count);
+
+		// ---------------------------------------------------------------------------------------------------
+
 		// Performs a bulk of operations on a single entity such that the data is transferred across archetypes
 		// Only once. It is the most efficient way of adding/deleting unique/shared components at once. At the moment,
 		// There is only the commit version, if the deferred version will be needed, it will be added later on.
@@ -1882,6 +2005,17 @@ namespace ECSEngine {
 
 		// ---------------------------------------------------------------------------------------------------
 
+		// Recomputes the hashes of all the instances of the component. The find or create functions call
+		// This automatically when the index was marked as dirty
+		void RebuildSharedComponentHashIndexCommit(Component component);
+
+		// Must be called after the data of the instances was modified in place through the mutable accessors.
+		// The lookups fall back to the linear search until the next rebuild. It is not thread safe
+		void MarkSharedComponentHashIndexDirty(Component component);
+
+		// Rebuilds the hash index only if it was marked as dirty since the last rebuild
+		void RefreshSharedComponentHashIndexCommit(Component component);
+
 		// The value is stable. If the data pointer is nullptr, it will not copy anything
 		SharedInstance RegisterSharedInstanceCommit(Component component, const void* data, bool copy_buffers = true);
 
@@ -1952,6 +2086,22 @@ namespace ECSEngine {
 
 		// ---------------------------------------------------------------------------------------------------
 
+		// Can be called from any thread. Returns an entity whose handle can be referenced right away and which must be
+		// Created with CreateReservedEntities before the next Flush. Until then, ExistsEntity returns false for it and
+		// The entity info accessors crash. Returns Entity::Invalid() if the prepared entities are exhausted, in which
+		// Case the normal deferred creation must be used
+		ECS_INLINE Entity ReserveEntity() {
+			return m_entity_pool->Reserve();
+		}
+
+		// Can be called from any thread. Reserves all the entities or none of them.
+		// Returns false if there are not enough prepared entities
+		ECS_INLINE bool ReserveEntities(Stream<Entity> entities) {
+			return m_entity_pool->Reserve(entities);
+		}
+
+		// ---------------------------------------------------------------------------------------------------
+
 		// Immediate call. It will deallocate the data used by the shared instances and reallocate
 		// the data but it will not copy any old data.
 		void ResizeSharedComponent(Component component, unsigned int new_size);
@@ -1979,10 +2129,10 @@ namespace ECSEngine {
 
 		// ---------------------------------------------------------------------------------------------------
 
-		// If the component or the instance doesn't exist, it will assert
+		// If the component or the instance doesn't exist, it will assert. It keeps the hash index up to date
 		void SetSharedComponentData(Component component, SharedInstance instance, const void* data);
 
-		// If the component or the instance doesn't exist, it will assert
+		// If the component or the instance doesn't exist, it will assert. It keeps the hash index up to date
 		void SetNamedSharedComponentData(Component component, Stream<char> identifier, const void* data);
 
 		// ---------------------------------------------------------------------------------------------------
@@ -2286,6 +2436,15 @@ namespace ECSEngine {
 		// Must be blittable, if the data size is different from 0
 		Stream<void> m_auto_generate_component_functions_data;
 		EntityManagerAutoGenerateComponentFunctionsFunctor m_auto_generate_component_functions_functor;
+
+		// The entity manager whose archetype storage is referenced by this one after a copy on write, nullptr if there is none
+		const EntityManager* m_copy_on_write_source;
+		// The entity managers that reference the archetype storage of this one after a copy on write.
+		// It uses Malloc, such that it is not affected by the clears of the main memory manager
+		mutable ResizableStream<EntityManager*> m_copy_on_write_copies;
+
+		// Where CompactCommit continues from when it stopped because of its time budget
+		EntityManagerCompactCursor m_compact_cursor;
 	};
 
 	// Uses the internal indexing of the entity manager
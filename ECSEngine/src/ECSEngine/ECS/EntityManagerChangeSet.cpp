@@ -917,6 +917,8 @@ namespace ECSEngine {
 
 			EntityInfo entity_info = entity_manager->GetEntityInfo(changes.entity);
 			ArchetypeBase* base_archetype = entity_manager->GetBase(entity_info);
+			// The entity might have stayed in a base that shares its storage, it is written directly below
+			base_archetype->EnsureUniqueBuffers();
 			for (size_t index = 0; index < changes.unique_changes.size; index++) {
 				if (changes.unique_changes[index].change_type == ECS_CHANGE_SET_ADD || changes.unique_changes[index].change_type == ECS_CHANGE_SET_UPDATE) {
 					// There is a unique component to be deserialized
@@ -213,20 +213,26 @@ namespace ECSEngine {
 	}
 
 	// Initializes data related to unique_data and shared_data for an archetype base
-	// The component map must have been called before hand
+	// The component map must have been called before hand. When the unique components are only read, the base
+	// Is not cloned if its storage is shared after a copy on write
 	static void InitializeForEachDataForArchetypeBase(
 		ForEachEntityBatchImplementationTaskData* data,
-		World* world
+		World* world,
+		bool read_only_unique
 	) {
-		const Archetype* archetype = world->entity_manager->GetArchetype(data->archetype_indices.x);
-		ArchetypeBase* base = world->entity_manager->GetBase(data->archetype_indices.x, data->archetype_indices.y);
-		data->entities = base->m_entities;
-		data->archetype_buffers = base->m_buffers;
+		const EntityManager* entity_manager = world->entity_manager;
+		const Archetype* archetype = entity_manager->GetArchetype(data->archetype_indices.x);
+		if (!read_only_unique) {
+			world->entity_manager->GetBase(data->archetype_indices.x, data->archetype_indices.y)->EnsureUniqueBuffers();
+		}
+		const ArchetypeBase* base = entity_manager->GetBase(data->archetype_indices.x, data->archetype_indices.y);
+		base->GetStoragePointers(&data->entities, &data->archetype_buffers);
 
 		const Component* shared_components = archetype->GetSharedSignature().indices;
 		const SharedInstance* shared_instances = archetype->GetBaseInstances(data->archetype_indices.y);
 		for (unsigned char shared_component_index = 0; shared_component_index < data->shared_component_map_count; shared_component_index++) {
-			data->shared_data[shared_component_index] = world->entity_manager->GetSharedData(
+			// Use the const accessor, this is called from the worker threads as well
+			data->shared_data[shared_component_index] = (void*)entity_manager->GetSharedData(
 				shared_components[data->shared_component_map[shared_component_index]],
 				shared_instances[data->shared_component_map[shared_component_index]]
 			);
@@ -235,7 +241,7 @@ namespace ECSEngine {
 		for (unsigned char shared_index = 0; shared_index < data->optional_shared_component_map_count; shared_index++) {
 			unsigned char current_index = offset + shared_index;
 			if (data->shared_component_map[current_index] != UCHAR_MAX) {
-				data->shared_data[current_index] = world->entity_manager->GetSharedData(
+				data->shared_data[current_index] = (void*)entity_manager->GetSharedData(
 					shared_components[data->shared_component_map[current_index]],
 					shared_instances[data->shared_component_map[current_index]]
 				);
@@ -322,7 +328,7 @@ namespace ECSEngine {
 			size_t deferred_call_allocation_size = sizeof(DeferredAction) * deferred_calls_capacity + sizeof(EntityManagerCommandStream);
 
 			for (size_t index = 0; index < query_result.archetypes.size; index++) {
-				Archetype* archetype = world->entity_manager->GetArchetype(query_result.archetypes[index]);
+				const Archetype* archetype = world->entity_manager->GetArchetype(query_result.archetypes[index]);
 				unsigned int base_count = archetype->GetBaseCount();
 
 				// Get the component and shared component map
@@ -349,10 +355,11 @@ namespace ECSEngine {
 				}
 
 				for (unsigned int base_index = 0; base_index < base_count; base_index++) {
-					ArchetypeBase* base = archetype->GetBase(base_index);
+					// The initialization below clones the base only if the query writes to it
+					const ArchetypeBase* base = archetype->GetBase(base_index);
 					unsigned int entity_count = base->EntityCount();
 					task_data.archetype_indices.y = base_index;
-					InitializeForEachDataForArchetypeBase(&task_data, world);
+					InitializeForEachDataForArchetypeBase(&task_data, world, scheduler_info->read_only_unique);
 
 					EntityManagerCommandStream* command_stream = nullptr;
 
@@ -600,7 +607,7 @@ namespace ECSEngine {
 		ArchetypeQuery query = InitializeForEachData(&task_data, world, functor, data, query_descriptor, &stack_allocator, &archetype_indices);
 
 		for (unsigned int index = 0; index < archetype_indices.size; index++) {
-			Archetype* archetype = entity_manager->GetArchetype(archetype_indices[index]);
+			const Archetype* archetype = entity_manager->GetArchetype(archetype_indices[index]);
 			unsigned int base_count = archetype->GetBaseCount();
 
 			task_data.archetype_indices.x = archetype_indices[index];
@@ -609,13 +616,14 @@ namespace ECSEngine {
 			entity_manager->FindArchetypeSharedComponentVector(task_data.archetype_indices.x, query.shared, task_data.shared_component_map);
 
 			for (unsigned int base_index = 0; base_index < base_count; base_index++) {
-				ArchetypeBase* base = archetype->GetBase(base_index);
+				// The initialization below clones the base only if the query writes to it
+				const ArchetypeBase* base = archetype->GetBase(base_index);
 				task_data.command_stream = nullptr;
 				task_data.archetype_indices.y = base_index;
 				task_data.count = base->EntityCount();
 				task_data.entity_offset = 0;
 
-				InitializeForEachDataForArchetypeBase(&task_data, world);
+				InitializeForEachDataForArchetypeBase(&task_data, world, query_descriptor.read_only_unique);
 				if constexpr (is_batch) {
 					ForEachBatchThreadTask(0, world, &task_data);
 				}
@@ -993,6 +1001,15 @@ namespace ECSEngine {
 			}
 		}
 
+		// --------------------------------------------------------------------------------------------------------------------
+
+		void MarkSharedComponentsHashIndexDirty(World* world, ComponentSignature components)
+		{
+			for (unsigned char index = 0; index < components.count; index++) {
+				world->entity_manager->MarkSharedComponentHashIndexDirty(components[index]);
+			}
+		}
+
 	}
 
 	//template<typename Query>
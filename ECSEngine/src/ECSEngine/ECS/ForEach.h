@@ -565,6 +565,12 @@ namespace ECSEngine {
 			}
 		}
 
+		// Returns true if none of the unique components of the pack is written
+		template<typename... Components>
+		constexpr bool IsTemplatePackUniqueReadOnly() {
+			return ((Components::IsShared() || Components::IsExclude() || Components::Access() == ECS_READ) && ...);
+		}
+
 		enum FOR_EACH_OPTIONS : unsigned char {
 			FOR_EACH_NONE = 0,
 			FOR_EACH_IS_BATCH = 1 << 0,
@@ -573,6 +579,34 @@ namespace ECSEngine {
 
 		ECSENGINE_API void IncrementWorldQueryIndex(World* world);
 
+		ECSENGINE_API void MarkSharedComponentsHashIndexDirty(World* world, ComponentSignature components);
+
+		// The shared instances that the functor writes to are modified in place, such that the hash index of
+		// Those components must be marked as dirty
+		template<typename... Components>
+		void MarkTemplatePackSharedWritesDirty(World* world) {
+			constexpr size_t count = sizeof...(Components);
+			if constexpr (count > 0) {
+				constexpr bool is_shared_write[count] = {
+					(Components::IsShared() && !Components::IsExclude() && Components::Access() != ECS_READ)...
+				};
+				constexpr short component_ids[count] = {
+					Components::Type::ID()...
+				};
+
+				Component written_components[count];
+				ComponentSignature written_signature = { written_components, 0 };
+				for (size_t index = 0; index < count; index++) {
+					if (is_shared_write[index]) {
+						written_signature[written_signature.count++] = { component_ids[index] };
+					}
+				}
+				if (written_signature.count > 0) {
+					MarkSharedComponentsHashIndexDirty(world, written_signature);
+				}
+			}
+		}
+
 		// Retrieves the components from the parameter pack and writes them into a ArchetypeQueryDescriptor
 		// For which you must specify the name and the template parameter name
 #define GET_COMPONENT_SIGNATURE_FROM_TEMPLATE_PACK(query_descriptor_name, template_pack_name) \
@@ -600,6 +634,7 @@ namespace ECSEngine {
 			query_descriptor_name.unique_optional, \
 			query_descriptor_name.shared_optional \
 		); \
+		query_descriptor_name.read_only_unique = IsTemplatePackUniqueReadOnly<template_pack_name...>(); \
 \
 		ECS_CRASH_CONDITION(query_descriptor_name.unique_exclude.count == 0 && query_descriptor_name.shared_exclude.count == 0, "ECS ForEach:" \
 			" You must specify the exclude components in the Function template parameter pack");
@@ -634,6 +669,7 @@ namespace ECSEngine {
 					}
 
 					GET_COMPONENT_SIGNATURE_FROM_TEMPLATE_PACK(query_descriptor, Components);
+					MarkTemplatePackSharedWritesDirty<Components...>(world);
 
 					ForEachTypeSafeWrapperData<Functor, EmptyMisc> wrapper_data{ functor, function_pointer_data };
 					if constexpr (~type_options & FOR_EACH_IS_COMMIT) {
@@ -733,6 +769,7 @@ namespace ECSEngine {
 					}
 
 					GET_COMPONENT_SIGNATURE_FROM_TEMPLATE_PACK(query_descriptor, Components);
+					MarkTemplatePackSharedWritesDirty<Components...>(world);
 
 
 					ForEachTypeSafeWrapperData<Functor, EmptyMisc> wrapper_data{ functor, function_pointer_data };
@@ -815,6 +852,7 @@ namespace ECSEngine {
 					}
 
 					GET_COMPONENT_SIGNATURE_FROM_TEMPLATE_PACK(query_descriptor, Components);
+					MarkTemplatePackSharedWritesDirty<SharedComponent, Components...>(world);
 
 					// Must insert the shared component at the very beginning
 					bool allow_missing_component_group = SharedComponent::IsOptional();
@@ -0,0 +1,290 @@
+#include "ecspch.h"
+#include "HeadlessWorldRunner.h"
+#include "../Containers/Hashing.h"
+#include "../Utilities/Reflection/Reflection.h"
+
+namespace ECSEngine {
+
+	// The allocator that each run uses for its task manager, task scheduler and keyboard. The world itself
+	// Creates its own global memory manager from the descriptor
+#define RUNNER_ALLOCATOR_CAPACITY ECS_MB * 32
+#define RUNNER_ALLOCATOR_BACKUP_CAPACITY ECS_MB * 128
+
+	// ---------------------------------------------------------------------------------------------------------------------
+
+	// Hashes the fields of the type one by one, such that the padding between them is skipped. The nested
+	// Types are descended into when they are reflected, else their bytes are hashed as is
+	static void HashReflectedFields(
+		size_t& hash, 
+		const Reflection::ReflectionManager* reflection_manager, 
+		const Reflection::ReflectionType* type, 
+		const void* data
+	) {
+		for (size_t index = 0; index < type->fields.size; index++) {
+			const Reflection::ReflectionFieldInfo& info = type->fields[index].info;
+			const void* field_data = OffsetPointer(data, info.pointer_offset);
+			const Reflection::ReflectionType* nested_type = nullptr;
+			if (info.basic_type == Reflection::ReflectionBasicFieldType::UserDefined && (info.stream_type == Reflection::ReflectionStreamFieldType::Basic
+				|| info.stream_type == Reflection::ReflectionStreamFieldType::BasicTypeArray)) {
+				nested_type = reflection_manager->TryGetType(type->fields[index].definition);
+			}
+
+			if (nested_type != nullptr) {
+				unsigned short element_count = info.stream_type == Reflection::ReflectionStreamFieldType::BasicTypeArray ? info.basic_type_count : 1;
+				size_t element_size = info.byte_size / element_count;
+				for (unsigned short element_index = 0; element_index < element_count; element_index++) {
+					HashReflectedFields(hash, reflection_manager, nested_type, OffsetPointer(field_data, element_size * element_index));
+				}
+			}
+			else {
+				hash = Murmur64({ field_data, info.byte_size }, hash);
+			}
+		}
+	}
+
+	size_t ComputeEntityManagerStateHash(const EntityManager* entity_manager, const Reflection::ReflectionManager* reflection_manager) {
+		size_t hash = 0;
+		auto add = [&hash](Stream<void> data) {
+			hash = Murmur64(data, hash);
+		};
+		// Hashes count elements of the component, field by field when its type is reflected
+		auto add_component = [&](const ComponentInfo& info, const void* data, size_t count) {
+			const Reflection::ReflectionType* type = nullptr;
+			if (reflection_manager != nullptr && info.name.size > 0) {
+				type = reflection_manager->TryGetType(info.name);
+			}
+			if (type != nullptr) {
+				for (size_t index = 0; index < count; index++) {
+					HashReflectedFields(hash, reflection_manager, type, OffsetPointer(data, index * info.size));
+				}
+			}
+			else {
+				add({ data, count * info.size });
+			}
+		};
+		auto add_value = [&add](size_t value) {
+			add({ &value, sizeof(value) });
+		};
+
+		unsigned int archetype_count = entity_manager->GetArchetypeCount();
+		add_value(archetype_count);
+		for (unsigned int archetype_index = 0; archetype_index < archetype_count; archetype_index++) {
+			const Archetype* archetype = entity_manager->GetArchetype(archetype_index);
+			ComponentSignature unique_signature = archetype->GetUniqueSignature();
+			ComponentSignature shared_signature = archetype->GetSharedSignature();
+			add({ unique_signature.indices, unique_signature.count * sizeof(Component) });
+			add({ shared_signature.indices, shared_signature.count * sizeof(Component) });
+
+			unsigned int base_count = archetype->GetBaseCount();
+			add_value(base_count);
+			for (unsigned int base_index = 0; base_index < base_count; base_index++) {
+				const ArchetypeBase* base = archetype->GetBase(base_index);
+				unsigned int entity_count = base->EntityCount();
+				add({ archetype->GetBaseInstances(base_index), shared_signature.count * sizeof(SharedInstance) });
+				add_value(entity_count);
+				add({ base->m_entities, entity_count * sizeof(Entity) });
+
+				for (unsigned char component_index = 0; component_index < unique_signature.count; component_index++) {
+					const ComponentInfo& info = entity_manager->m_unique_components[unique_signature[component_index].value];
+					if (info.copy_function == nullptr) {
+						add_component(info, base->m_buffers[component_index], entity_count);
+					}
+				}
+			}
+		}
+
+		for (unsigned int component_index = 0; component_index < entity_manager->m_shared_components.size; component_index++) {
+			Component component = (short)component_index;
+			if (entity_manager->ExistsSharedComponent(component)) {
+				const ComponentInfo& info = entity_manager->m_shared_components[component_index].info;
+				add_value(component_index);
+				entity_manager->ForEachSharedInstance(component, [&](SharedInstance instance) {
+					add_value(instance.value);
+					if (info.copy_function == nullptr) {
+						add_component(info, entity_manager->GetSharedData(component, instance), 1);
+					}
+				});
+			}
+		}
+
+		entity_manager->ForAllGlobalComponents([&](const void* data, Component component) {
+			add_value(component.value);
+			unsigned int global_index = SearchBytes(entity_manager->m_global_components, entity_manager->m_global_component_count, component.value);
+			const ComponentInfo& info = entity_manager->m_global_components_info[global_index];
+			if (info.copy_function == nullptr) {
+				add_component(info, data, 1);
+			}
+		});
+
+		return hash;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+
+	// Runs a single entry to completion, on the calling thread, using a task manager with the given number of threads
+	static void RunHeadlessWorld(const HeadlessWorldRunnerEntry* entry, unsigned int entry_index, unsigned int thread_count, HeadlessWorldRunnerResult* result) {
+		result->frame_hashes.size = 0;
+		if (!ValidateWorldDescriptor(&entry->descriptor)) {
+			result->status = ECS_HEADLESS_WORLD_RUNNER_INVALID_DESCRIPTOR;
+			return;
+		}
+
+		// Each run has its own task manager, such that the worlds don't interfere with each other,
+		// And its own allocator, since the allocators are not thread safe
+		GlobalMemoryManager runner_allocator;
+		CreateGlobalMemoryManager(&runner_allocator, RUNNER_ALLOCATOR_CAPACITY, ECS_KB, RUNNER_ALLOCATOR_BACKUP_CAPACITY);
+
+		TaskManager* task_manager = (TaskManager*)runner_allocator.Allocate(sizeof(TaskManager));
+		new (task_manager) TaskManager(thread_count, &runner_allocator, entry->descriptor.per_thread_temporary_memory_size);
+		task_manager->CreateThreads();
+		ECS_FORMAT_TEMP_STRING(thread_name, "Headless World {#}", entry_index);
+		task_manager->SetDebuggingNames(thread_name);
+
+		TaskScheduler* task_scheduler = (TaskScheduler*)runner_allocator.Allocate(sizeof(TaskScheduler) + sizeof(MemoryManager));
+		MemoryManager* task_scheduler_allocator = (MemoryManager*)OffsetPointer(task_scheduler, sizeof(TaskScheduler));
+		TaskScheduler::DefaultAllocator(task_scheduler_allocator, &runner_allocator);
+		new (task_scheduler) TaskScheduler(task_scheduler_allocator);
+
+		// The stand-in input, which receives nothing unless the frame function fills it in
+		Mouse mouse;
+		Keyboard keyboard(&runner_allocator);
+
+		WorldDescriptor descriptor = entry->descriptor;
+		descriptor.graphics = nullptr;
+		descriptor.graphics_descriptor = nullptr;
+		descriptor.mouse = &mouse;
+		descriptor.keyboard = &keyboard;
+		descriptor.task_manager = task_manager;
+		descriptor.task_scheduler = task_scheduler;
+		// The debug drawer needs graphics
+		descriptor.debug_drawer = nullptr;
+		descriptor.debug_drawer_allocator_size = 0;
+
+		World world(descriptor);
+		world.task_manager->SetWorld(&world);
+		SetStopSimulationStatus(world.system_manager, false);
+
+		HeadlessWorldRunnerFunctionData function_data;
+		function_data.world = &world;
+		function_data.world_index = entry_index;
+		function_data.frame_index = 0;
+		function_data.user_data = entry->user_data;
+
+		result->status = ECS_HEADLESS_WORLD_RUNNER_PASSED;
+		if (entry->setup_function != nullptr && !entry->setup_function(&function_data)) {
+			result->status = ECS_HEADLESS_WORLD_RUNNER_SETUP_FAILED;
+		}
+		else {
+			PrepareWorld(&world);
+			for (size_t frame_index = 0; frame_index < entry->frame_count; frame_index++) {
+				function_data.frame_index = frame_index;
+				if (entry->frame_function != nullptr && !entry->frame_function(&function_data)) {
+					break;
+				}
+
+				world.SetDeltaTime(entry->delta_time);
+				DoFrame(&world);
+				result->frame_hashes.Add(ComputeEntityManagerStateHash(world.entity_manager, entry->reflection_manager));
+
+				mouse.Update();
+				keyboard.Update();
+				if (GetStopSimulationStatus(world.system_manager)) {
+					break;
+				}
+			}
+
+			if (entry->finish_function != nullptr) {
+				function_data.frame_index = result->frame_hashes.size;
+				entry->finish_function(&function_data);
+			}
+		}
+
+		task_manager->TerminateThreads(true);
+		DestroyWorld(&world);
+		runner_allocator.Free();
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+
+	Stream<HeadlessWorldRunnerResult> RunHeadlessWorlds(
+		Stream<HeadlessWorldRunnerEntry> entries,
+		AllocatorPolymorphic allocator,
+		const HeadlessWorldRunnerOptions& options
+	) {
+		Stream<HeadlessWorldRunnerResult> results;
+		results.Initialize(allocator, entries.size);
+		// Allocate the hashes up front, such that the runs don't need to allocate from this allocator
+		for (size_t index = 0; index < entries.size; index++) {
+			results[index].frame_hashes.Initialize(allocator, entries[index].frame_count);
+			results[index].first_mismatch_frame = -1;
+		}
+
+		unsigned int thread_count = options.thread_count == 0 ? std::thread::hardware_concurrency() : options.thread_count;
+		unsigned int concurrent_world_count = options.concurrent_world_count;
+		if (concurrent_world_count == 0) {
+			concurrent_world_count = min(thread_count, (unsigned int)entries.size);
+		}
+		concurrent_world_count = ClampMax(concurrent_world_count, (unsigned int)entries.size);
+		unsigned int threads_per_world = max(thread_count / max(concurrent_world_count, 1u), 1u);
+
+		// Each driver thread takes the next entry that was not run yet, such that the longer runs don't keep the others waiting
+		std::atomic<unsigned int> next_entry_index = 0;
+		auto driver = [&]() {
+			unsigned int entry_index = next_entry_index.fetch_add(1, ECS_RELAXED);
+			while (entry_index < entries.size) {
+				RunHeadlessWorld(entries.buffer + entry_index, entry_index, threads_per_world, results.buffer + entry_index);
+				entry_index = next_entry_index.fetch_add(1, ECS_RELAXED);
+			}
+		};
+
+		if (concurrent_world_count > 1) {
+			std::thread* drivers = (std::thread*)Allocate(allocator, sizeof(std::thread) * (concurrent_world_count - 1));
+			for (unsigned int index = 0; index < concurrent_world_count - 1; index++) {
+				new (drivers + index) std::thread(driver);
+			}
+			// The calling thread drives worlds as well
+			driver();
+			for (unsigned int index = 0; index < concurrent_world_count - 1; index++) {
+				drivers[index].join();
+				drivers[index].~thread();
+			}
+			Deallocate(allocator, drivers);
+		}
+		else {
+			driver();
+		}
+
+		// Compare the hashes only after all the worlds finished, since a reference can run concurrently with its dependents
+		for (size_t index = 0; index < entries.size; index++) {
+			unsigned int reference_index = entries[index].reference_index;
+			if (reference_index == -1 || results[index].status != ECS_HEADLESS_WORLD_RUNNER_PASSED) {
+				continue;
+			}
+
+			ECS_ASSERT(reference_index < entries.size && reference_index != index, "Invalid headless world runner reference index");
+			const HeadlessWorldRunnerResult& reference = results[reference_index];
+			if (reference.status == ECS_HEADLESS_WORLD_RUNNER_INVALID_DESCRIPTOR || reference.status == ECS_HEADLESS_WORLD_RUNNER_SETUP_FAILED) {
+				results[index].status = ECS_HEADLESS_WORLD_RUNNER_REFERENCE_FAILED;
+				continue;
+			}
+
+			Stream<size_t> hashes = results[index].frame_hashes;
+			size_t compare_count = min(hashes.size, reference.frame_hashes.size);
+			size_t frame_index = 0;
+			for (; frame_index < compare_count; frame_index++) {
+				if (hashes[frame_index] != reference.frame_hashes[frame_index]) {
+					break;
+				}
+			}
+			if (frame_index < compare_count || hashes.size != reference.frame_hashes.size) {
+				results[index].first_mismatch_frame = frame_index;
+				results[index].status = ECS_HEADLESS_WORLD_RUNNER_MISMATCH;
+			}
+		}
+
+		return results;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "../Core.h"
+#include "World.h"
+
+#define ECS_HEADLESS_WORLD_RUNNER_DEFAULT_DELTA_TIME (1.0f / 60.0f)
+
+namespace ECSEngine {
+
+	namespace Reflection {
+		struct ReflectionManager;
+	}
+
+	struct HeadlessWorldRunnerFunctionData {
+		World* world;
+		// The index of the entry that this world was created from
+		unsigned int world_index;
+		// The index of the frame that is about to be run. It is 0 for the setup function and it is
+		// The number of frames that were run for the finish function
+		size_t frame_index;
+		void* user_data;
+	};
+
+	// Called after the world is created and before it is prepared. It should register the components, create the entities
+	// And add the scheduler elements to the world's task scheduler. Return false to fail the run of this world
+	typedef bool (*HeadlessWorldRunnerSetupFunction)(HeadlessWorldRunnerFunctionData* data);
+
+	// Called before each frame. It can feed the stand-in mouse and keyboard (for example from an input replay)
+	// Or modify the entities (for example from a state replay). Return false to stop the world before this frame
+	typedef bool (*HeadlessWorldRunnerFrameFunction)(HeadlessWorldRunnerFunctionData* data);
+
+	// Called after the last frame, before the world is destroyed
+	typedef void (*HeadlessWorldRunnerFinishFunction)(HeadlessWorldRunnerFunctionData* data);
+
+	struct HeadlessWorldRunnerEntry {
+		// The graphics, mouse, keyboard, task manager, task scheduler and debug drawer are created by the runner,
+		// The values given here are ignored. The resource manager can be shared, but it must not be written while running
+		WorldDescriptor descriptor;
+		HeadlessWorldRunnerSetupFunction setup_function = nullptr;
+		HeadlessWorldRunnerFrameFunction frame_function = nullptr;
+		HeadlessWorldRunnerFinishFunction finish_function = nullptr;
+		// It is passed as is to all the functions. When multiple entries share it, the functions must be thread safe
+		void* user_data = nullptr;
+		size_t frame_count = 0;
+		// A fixed delta time is used, such that the runs don't depend on the timing of the machine
+		float delta_time = ECS_HEADLESS_WORLD_RUNNER_DEFAULT_DELTA_TIME;
+		// The index of the entry whose frame hashes this world must reproduce, or -1 if it has no reference
+		unsigned int reference_index = -1;
+		// Optional, the types of the components are looked up by the component name. When given, the components are hashed
+		// Field by field, such that their padding does not enter the hash. It is only read, such that it can be shared
+		const Reflection::ReflectionManager* reflection_manager = nullptr;
+	};
+
+	struct HeadlessWorldRunnerOptions {
+		// The total number of threads that the worlds can use. When 0, the hardware concurrency is used
+		unsigned int thread_count = 0;
+		// How many worlds are stepped at the same time. The threads are partitioned between these worlds, each one
+		// Having its own task manager. When 0, it is the minimum between the entry count and the thread count
+		unsigned int concurrent_world_count = 0;
+	};
+
+	enum ECS_HEADLESS_WORLD_RUNNER_STATUS : unsigned char {
+		ECS_HEADLESS_WORLD_RUNNER_PASSED,
+		ECS_HEADLESS_WORLD_RUNNER_INVALID_DESCRIPTOR,
+		ECS_HEADLESS_WORLD_RUNNER_SETUP_FAILED,
+		// The frame hashes differ from the ones of the reference world
+		ECS_HEADLESS_WORLD_RUNNER_MISMATCH,
+		// The reference world could not be run, such that no comparison was made
+		ECS_HEADLESS_WORLD_RUNNER_REFERENCE_FAILED
+	};
+
+	struct HeadlessWorldRunnerResult {
+		ECS_INLINE bool Passed() const {
+			return status == ECS_HEADLESS_WORLD_RUNNER_PASSED;
+		}
+
+		// The state hash after each frame that was run
+		Stream<size_t> frame_hashes;
+		// The first frame whose hash differs from the reference, or -1 if there is no such frame.
+		// When one of the worlds stopped earlier, the first frame that the other one has in addition is reported
+		size_t first_mismatch_frame;
+		ECS_HEADLESS_WORLD_RUNNER_STATUS status;
+	};
+
+	// Hashes the entities, the unique, shared and global components and the archetype layout. The components that have
+	// Buffers (the ones with a copy function) are not hashed, since their data contains pointers which differ between
+	// Worlds - only their presence in the archetypes is. Two entity managers which went through the same sequence of
+	// Operations produce the same hash. When the reflection manager is given, the components whose type is found are
+	// Hashed field by field. The others are hashed as raw bytes, which requires them to have no padding, since the padding
+	// Bytes are not guaranteed to be the same between worlds and would report false mismatches
+	ECSENGINE_API size_t ComputeEntityManagerStateHash(
+		const EntityManager* entity_manager, 
+		const Reflection::ReflectionManager* reflection_manager = nullptr
+	);
+
+	/*
+		Runs the worlds described by the entries without graphics and without the editor, stepping multiple worlds at the same
+		Time, and compares the state hash of each frame of a world against the one of its reference world. This is meant to run
+		Determinism and replay checks in batches, using all the cores of the machine. The worlds receive a stand-in mouse and
+		Keyboard, which can be driven from the frame function. The results are allocated from the given allocator, the allocator
+		Is used only from the calling thread. For each result, deallocate the frame hashes and then the stream itself
+	*/
+	ECSENGINE_API Stream<HeadlessWorldRunnerResult> RunHeadlessWorlds(
+		Stream<HeadlessWorldRunnerEntry> entries,
+		AllocatorPolymorphic allocator,
+		const HeadlessWorldRunnerOptions& options = {}
+	);
+
+}
@@ -53,7 +53,8 @@ namespace ECSEngine {
 	EntityPool::EntityPool(
 		MemoryManager* memory_manager,
 		unsigned int pool_power_of_two
-	) : m_memory_manager(memory_manager), m_pool_power_of_two(pool_power_of_two), m_entity_infos(memory_manager, 1) {}
+	) : m_memory_manager(memory_manager), m_pool_power_of_two(pool_power_of_two), m_entity_infos(memory_manager, 1), m_reservations(nullptr),
+		m_reservation_count(0), m_reservation_capacity(0), m_reservation_index(0) {}
 	
 	// ------------------------------------------------------------------------------------------------------------
 
@@ -103,7 +104,13 @@ namespace ECSEngine {
 		return { entity.index >> entity_pool->m_pool_power_of_two, entity.index & ((1 << entity_pool->m_pool_power_of_two) - 1) };
 	}
 
-	static Entity EntityPoolAllocateImplementation(EntityPool* entity_pool, unsigned short archetype = -1, unsigned short base_archetype = -1, unsigned int stream_index = -1) {	
+	static Entity EntityPoolAllocateImplementation(
+		EntityPool* entity_pool, 
+		unsigned short archetype = -1, 
+		unsigned short base_archetype = -1, 
+		unsigned int stream_index = -1, 
+		unsigned char* previous_generation_count = nullptr
+	) {	
 		EntityInfo info;
 		info.main_archetype = archetype;
 		info.base_archetype = base_archetype;
@@ -114,6 +121,9 @@ namespace ECSEngine {
 		auto construct_info = [=](unsigned int pool_index) {
 			unsigned int entity_index = entity_pool->m_entity_infos[pool_index].stream.ReserveOne();
 			EntityInfo* current_info = entity_pool->m_entity_infos[pool_index].stream.ElementPointer(entity_index);
+			if (previous_generation_count != nullptr) {
+				*previous_generation_count = current_info->generation_count;
+			}
 			unsigned char new_generation_count = current_info->generation_count + 1;
 			memcpy(current_info, &info, sizeof(info));
 			current_info->generation_count = new_generation_count == 0 ? 1 : new_generation_count;
@@ -288,6 +298,41 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------------
 
+	void EntityPool::AllocateReserved(Stream<Entity> entities, uint2 archetype_indices, unsigned int copy_position) {
+		for (size_t index = 0; index < entities.size; index++) {
+			ECS_CRASH_CONDITION(IsReserved(entities[index]), "EntityPool: Entity {#} is not a reserved entity when trying to create it.", entities[index].index);
+
+			uint2 entity_indices = GetPoolAndEntityIndex(this, entities[index]);
+			EntityInfo* current_info = m_entity_infos[entity_indices.x].stream.ElementPointer(entity_indices.y);
+			current_info->base_archetype = archetype_indices.y;
+			current_info->main_archetype = archetype_indices.x;
+			current_info->stream_index = copy_position + index;
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// The reserved entities have these sentinel values until they are created with AllocateReserved
+	static bool IsReservedEntityInfo(EntityInfo info) {
+		return info.main_archetype == ECS_MAIN_ARCHETYPE_MAX_COUNT - 1 && info.base_archetype == ECS_BASE_ARCHETYPE_MAX_COUNT - 1
+			&& info.stream_index == ECS_ENTITY_POOL_RESERVED_STREAM_INDEX;
+	}
+
+	// Returns true if the slot of the entity is taken with the same generation count, including the reserved entities
+	static bool IsEntitySlotInUse(const EntityPool* entity_pool, Entity entity) {
+		uint2 entity_indices = GetPoolAndEntityIndex(entity_pool, entity);
+		if (entity_indices.x >= entity_pool->m_entity_infos.size || !entity_pool->m_entity_infos[entity_indices.x].is_in_use) {
+			return false;
+		}
+		if (entity_pool->m_entity_infos[entity_indices.x].stream.ExistsItem(entity_indices.y)) {
+			EntityInfo info = entity_pool->m_entity_infos[entity_indices.x].stream[entity_indices.y];
+			return info.generation_count == entity.generation_count;
+		}
+		return false;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
 	static EntityInfo GetInfoCrashCheck(
 		const EntityPool* entity_pool,
 		Entity entity,
@@ -333,6 +378,8 @@ namespace ECSEngine {
 			}
 		}
 
+		ECS_CRASH_CONDITION_RETURN_EX(!IsReservedEntityInfo(info), {}, "EntityPool: Entity {#} is reserved, but it was not yet created.",
+			file, function, line, entity.index);
 		return info;
 	}
 
@@ -381,6 +428,8 @@ namespace ECSEngine {
 			}
 		}
 
+		ECS_CRASH_CONDITION_RETURN_EX(!IsReservedEntityInfo(*info), nullptr, "EntityPool: Entity {#} is reserved, but it was not yet created.",
+			file, function, line, entity.index);
 		return info;
 	}
 
@@ -440,16 +489,42 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------------
 
-	bool EntityPool::IsValid(Entity entity) const {
-		uint2 entity_indices = GetPoolAndEntityIndex(this, entity);
-		if (entity_indices.x >= m_entity_infos.size || !m_entity_infos[entity_indices.x].is_in_use) {
-			return false;
+	unsigned int EntityPool::FlushReservations()
+	{
+		// The index can go past the count when the threads tried to reserve after the slots were exhausted
+		unsigned int handed_out_count = min(m_reservation_index.load(ECS_RELAXED), m_reservation_count);
+
+		// The handed out entities that were not created must be invalidated, since their handles can be referenced
+		unsigned int rollback_count = 0;
+		for (unsigned int index = 0; index < handed_out_count; index++) {
+			if (IsReserved(m_reservations[index].entity)) {
+				Deallocate(m_reservations[index].entity);
+				rollback_count++;
+			}
 		}
-		if (m_entity_infos[entity_indices.x].stream.ExistsItem(entity_indices.y)) {
-			EntityInfo info = m_entity_infos[entity_indices.x].stream[entity_indices.y];
-			return info.generation_count == entity.generation_count;
+
+		// The slots that were not handed out are placed back into the free lists with their previous generation count,
+		// Such that preparing reservations each frame does not advance the generation counters
+		for (unsigned int index = handed_out_count; index < m_reservation_count; index++) {
+			uint2 entity_indices = GetPoolAndEntityIndex(this, m_reservations[index].entity);
+			EntityInfo* info = m_entity_infos[entity_indices.x].stream.ElementPointer(entity_indices.y);
+			info->generation_count = m_reservations[index].previous_generation_count;
+			m_entity_infos[entity_indices.x].stream.Remove(entity_indices.y);
+
+			if (m_entity_infos[entity_indices.x].stream.size == 0) {
+				DeallocatePool(entity_indices.x);
+			}
 		}
-		return false;
+
+		m_reservation_count = 0;
+		m_reservation_index.store(0, ECS_RELAXED);
+		return rollback_count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool EntityPool::IsValid(Entity entity) const {
+		return IsEntitySlotInUse(this, entity) && !IsReservedEntityInfo(GetInfoNoChecks(entity));
 	}
 
 	// ------------------------------------------------------------------------------------------------------------
@@ -538,7 +613,7 @@ namespace ECSEngine {
 		// Iterate from the high values until a value is found to be empty. Stop after an iteration count
 		for (size_t index = 0; index < ITERATION_STOP_COUNT; index++) {
 			unsigned int entity_index = max_value - (unsigned int)index;
-			if (!IsValid(entity_index)) {
+			if (!IsEntitySlotInUse(this, entity_index)) {
 				return entity_index;
 			}
 		}
@@ -556,7 +631,7 @@ namespace ECSEngine {
 		// Iterate from the high values until a value is found to be empty. Stop after an iteration count
 		for (size_t index = 0; index < total_iterations; index++) {
 			unsigned int entity_index = max_value - (unsigned int)index;
-			if (!IsValid(entity_index)) {
+			if (!IsEntitySlotInUse(this, entity_index)) {
 				entities[current_count++] = entity_index;
 				if (current_count == entities.size) {
 					return true;
@@ -578,7 +653,7 @@ namespace ECSEngine {
 			Entity entity = max_value - uint_exclude_size - index;
 			// Check to see if this entity exists in the excluded_entities
 			if (SearchBytes(excluded_entities, entity) == -1) {
-				if (!IsValid(entity)) {
+				if (!IsEntitySlotInUse(this, entity)) {
 					return entity;
 				}
 			}
@@ -599,7 +674,7 @@ namespace ECSEngine {
 			Entity entity = max_value - uint_exclude_size - index;
 			// Check to see if this entity exists in the excluded entities
 			if (SearchBytes(excluded_entities, entity) == -1) {
-				if (!IsValid(entity)) {
+				if (!IsEntitySlotInUse(this, entity)) {
 					entities[current_count++] = entity;
 					if (entities.size == current_count) {
 						return true;
@@ -629,6 +704,74 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------------
 
+	bool EntityPool::IsReserved(Entity entity) const
+	{
+		return IsEntitySlotInUse(this, entity) && IsReservedEntityInfo(GetInfoNoChecks(entity));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void EntityPool::PrepareReservations(unsigned int count)
+	{
+		ECS_CRASH_CONDITION(m_reservation_index.load(ECS_RELAXED) == 0, "EntityPool: Preparing reservations while some of the previous ones "
+			"were already handed out. FlushReservations must be called before.");
+		if (count <= m_reservation_count) {
+			return;
+		}
+
+		if (count > m_reservation_capacity) {
+			Reservation* new_reservations = (Reservation*)m_memory_manager->Allocate(sizeof(Reservation) * count);
+			if (m_reservations != nullptr) {
+				memcpy(new_reservations, m_reservations, sizeof(Reservation) * m_reservation_count);
+				m_memory_manager->Deallocate(m_reservations);
+			}
+			m_reservations = new_reservations;
+			m_reservation_capacity = count;
+		}
+
+		// The slots are allocated right away, such that the main thread allocations cannot take them, but they
+		// Have the reserved infos until they are created
+		for (unsigned int index = m_reservation_count; index < count; index++) {
+			m_reservations[index].entity = EntityPoolAllocateImplementation(
+				this,
+				ECS_MAIN_ARCHETYPE_MAX_COUNT - 1,
+				ECS_BASE_ARCHETYPE_MAX_COUNT - 1,
+				ECS_ENTITY_POOL_RESERVED_STREAM_INDEX,
+				&m_reservations[index].previous_generation_count
+			);
+		}
+		m_reservation_count = count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	Entity EntityPool::Reserve()
+	{
+		// A single atomic increment, there is no need to undo it when the slots are exhausted
+		// Since the flush clamps the index to the count
+		unsigned int index = m_reservation_index.fetch_add(1, ECS_RELAXED);
+		return index < m_reservation_count ? m_reservations[index].entity : Entity::Invalid();
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool EntityPool::Reserve(Stream<Entity> entities)
+	{
+		unsigned int index = m_reservation_index.load(ECS_RELAXED);
+		do {
+			if (index > m_reservation_count || m_reservation_count - index < entities.size) {
+				return false;
+			}
+		} while (!m_reservation_index.compare_exchange_weak(index, index + (unsigned int)entities.size, ECS_RELAXED));
+
+		for (size_t entity_index = 0; entity_index < entities.size; entity_index++) {
+			entities[entity_index] = m_reservations[index + entity_index].entity;
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
 	void EntityPool::Reset()
 	{
 		m_memory_manager->Clear();	
@@ -14,6 +14,7 @@
 #include "ComponentFunctions.h"
 #include "../Utilities/StringUtilities.h"
 #include "../Utilities/Reflection/ReflectionMacros.h"
+#include "../Multithreading/ConcurrentPrimitives.h"
 
 #define ECS_ARCHETYPE_MAX_COMPONENTS 15
 #define ECS_ARCHETYPE_MAX_SHARED_COMPONENTS 15
@@ -376,12 +377,33 @@ namespace ECSEngine {
 		ECS_ALLOCATOR_TYPE type_allocator_type;
 	};
 
+	// Maps the content hash of the shared instances to the instances, such that the instance with given data
+	// Can be found without comparing against all the instances. The instances with the same hash are chained
+	struct SharedComponentHashIndex {
+		// The value is the first instance of the chain of that hash
+		HashTable<short, unsigned int, HashFunctionPowerOfTwo> table;
+		// These are indexed by the instance value. The next instance is -1 for the last one in the chain
+		short* next_instance;
+		unsigned int* instance_hashes;
+		unsigned int capacity;
+		// Set by MarkSharedComponentHashIndexDirty, when the data of the instances was modified in place.
+		// While dirty, the const lookups fall back to the linear search and the next commit lookup rebuilds the index
+		bool is_dirty;
+	};
+
 	struct SharedComponentInfo {
+		// The hash index is maintained only when the component has no compare function, in which case
+		// The data is hashed as is, or when it has both a compare and a hash function
+		ECS_INLINE bool HasHashIndex() const {
+			return compare_entry.function == nullptr || compare_entry.hash_function != nullptr;
+		}
+
 		ComponentInfo info;
 		ResizableStableReferenceStream<void*> instances;
 		HashTableDefault<SharedInstance> named_instances;
 
 		SharedComponentCompareEntry compare_entry;
+		SharedComponentHashIndex hash_index;
 	};
 
 	struct ECSENGINE_API ComponentSignature {
@@ -487,13 +509,16 @@ namespace ECSEngine {
 
 	typedef CapacityStream<DeferredAction> EntityManagerCommandStream;
 
+	// The stream index that the entity info of a reserved, but not yet created, entity has
+#define ECS_ENTITY_POOL_RESERVED_STREAM_INDEX ((1 << 24) - 1)
+
 	struct ECSENGINE_API EntityPool {
 		EntityPool(
 			MemoryManager* memory_manager,
 			unsigned int pool_power_of_two
 		);
 
-		ECS_CLASS_DEFAULT_CONSTRUCTOR_AND_ASSIGNMENT(EntityPool);
+		ECS_CLASS_MEMCPY_CONSTRUCTOR_AND_ASSIGNMENT_OPERATORS(EntityPool);
 
 		// Allocates a single Entity
 		Entity Allocate();
@@ -515,6 +540,10 @@ namespace ECSEngine {
 
 		void AllocateSpecific(Stream<Entity> entities, uint2 archetype_indices, unsigned int copy_position);
 
+		// Turns reserved entities into normal entities by setting their infos. It will crash if any of the
+		// Entities is not a reserved one
+		void AllocateReserved(Stream<Entity> entities, uint2 archetype_indices, unsigned int copy_position);
+
 		void CreatePool();
 
 		void CopyEntities(const EntityPool* entity_pool);
@@ -594,12 +623,36 @@ namespace ECSEngine {
 		// The tag should be the bit position, not the actual value
 		bool HasTag(Entity entity, unsigned char tag) const;
 
-		// Checks to see if the given entity is valid in the current context
+		// Checks to see if the given entity is valid in the current context. The reserved entities
+		// That were not yet created are not valid, use IsReserved for them
 		bool IsValid(Entity entity) const;
 
 		// Returns the generation count of the index at that index or -1 if it doesn't exist
 		unsigned int IsEntityAt(unsigned int stream_index) const;
 
+		// Returns true if the entity was handed out by Reserve and it was not yet allocated with AllocateReserved
+		bool IsReserved(Entity entity) const;
+
+		// Main thread only. Releases the slots that were not handed out, deallocates the reserved entities
+		// That were not allocated with AllocateReserved, such that their handles become invalid, and ends the
+		// Reservation window. Returns the number of reserved entities that were rolled back
+		unsigned int FlushReservations();
+
+		// Main thread only. Takes count slots out of the free lists, with their next generation count, such that
+		// They can be handed out by Reserve from any thread without a lock. The previous slots that were not handed
+		// Out are kept. Until FlushReservations is called, the slots are counted as alive entities, so the pool
+		// Should not be copied or serialized while a reservation window is open
+		void PrepareReservations(unsigned int count);
+
+		// Can be called from any thread. Returns an entity, with the correct generation count, that can
+		// Be used right away as a reference, but IsValid returns false for it until it is allocated. The entity must be created with AllocateReserved before the next
+		// FlushReservations, else it is rolled back. Returns Entity::Invalid() if the prepared slots are exhausted
+		Entity Reserve();
+
+		// Can be called from any thread. Reserves all the entities or none of them.
+		// Returns false if there are not enough prepared slots
+		bool Reserve(Stream<Entity> entities);
+
 		// As if nothing is allocated
 		void Reset();
 
@@ -620,10 +673,22 @@ namespace ECSEngine {
 			bool is_in_use;
 		};
 
+		struct Reservation {
+			Entity entity;
+			// Used to restore the slot exactly as it was when it is released without being handed out
+			unsigned char previous_generation_count;
+		};
+
 		MemoryManager* m_memory_manager;
 		ResizableStream<TaggedStableReferenceStream> m_entity_infos;
 		//unsigned int m_pool_capacity;
 		unsigned int m_pool_power_of_two;
+
+		Reservation* m_reservations;
+		unsigned int m_reservation_count;
+		unsigned int m_reservation_capacity;
+		// Can go past the reservation count when the prepared slots are exhausted
+		std::atomic<unsigned int> m_reservation_index;
 	};
 
 	struct WriteInstrument;
@@ -0,0 +1,622 @@
+#include "ecspch.h"
+#include "SpatialQuery.h"
+#include "EntityManager.h"
+#include "World.h"
+#include "../Math/Conversion.h"
+#include "../Multithreading/ParallelFor.h"
+
+// The tree is balanced, so this is enough for billions of entries
+#define TRAVERSAL_STACK_CAPACITY 256
+
+#define UPDATE_MIN_BATCH_SIZE 256
+#define UPDATE_MAX_BATCH_COUNT 64
+
+namespace ECSEngine {
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Half the surface area, which is what the insertion cost compares
+	static float AABBHalfSurfaceArea(const AABBScalar& aabb) {
+		float3 extents = aabb.max - aabb.min;
+		return extents.x * extents.y + extents.y * extents.z + extents.z * extents.x;
+	}
+
+	static bool AABBContains(const AABBScalar& outer, const AABBScalar& inner) {
+		return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+			&& outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+	}
+
+	static AABBScalar EnlargeAABB(const AABBScalar& aabb, float margin) {
+		float3 margin_vector = float3::Splat(margin);
+		return { aabb.min - margin_vector, aabb.max + margin_vector };
+	}
+
+	// Returns the distance along the ray where it enters the AABB, or FLT_MAX if it doesn't hit it before the max distance.
+	// The inverse direction has infinities for the axes that are parallel to the ray
+	static float RayAABBDistance(float3 origin, float3 inverse_direction, float max_distance, const AABBScalar& aabb) {
+		float t_min = 0.0f;
+		float t_max = max_distance;
+		for (size_t axis = 0; axis < 3; axis++) {
+			float first = (aabb.min[axis] - origin[axis]) * inverse_direction[axis];
+			float second = (aabb.max[axis] - origin[axis]) * inverse_direction[axis];
+			// The NaN from 0 * inf, when the origin is on the slab plane, is discarded by the comparisons
+			float near_distance = first < second ? first : second;
+			float far_distance = first < second ? second : first;
+			t_min = near_distance > t_min ? near_distance : t_min;
+			t_max = far_distance < t_max ? far_distance : t_max;
+			if (t_min > t_max) {
+				return FLT_MAX;
+			}
+		}
+		return t_min;
+	}
+
+	static AABBScalar GetEntityWorldBounds(const EntityManager* entity_manager, Entity entity, const AABBScalar& local_bounds) {
+		const Translation* translation = entity_manager->TryGetComponent<Translation>(entity);
+		const Rotation* rotation = entity_manager->TryGetComponent<Rotation>(entity);
+		const Scale* scale = entity_manager->TryGetComponent<Scale>(entity);
+
+		float3 translation_value = translation != nullptr ? translation->value : float3::Splat(0.0f);
+		float3 scale_value = scale != nullptr ? scale->value : float3::Splat(1.0f);
+		if (rotation != nullptr) {
+			return TransformAABB(local_bounds, translation_value, QuaternionToMatrix(rotation->value), scale_value);
+		}
+		// Without rotation, the matrix multiplications can be avoided
+		return TranslateAABB(ScaleAABBFromOrigin(local_bounds, scale_value), translation_value);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static unsigned int AllocateNode(SpatialQueryIndex* index) {
+		unsigned int node_index;
+		if (index->free_node != ECS_SPATIAL_QUERY_NULL_NODE) {
+			node_index = index->free_node;
+			index->free_node = index->nodes[node_index].parent;
+		}
+		else {
+			node_index = index->nodes.ReserveRange();
+		}
+
+		SpatialQueryNode* node = &index->nodes[node_index];
+		node->parent = ECS_SPATIAL_QUERY_NULL_NODE;
+		node->children[0] = ECS_SPATIAL_QUERY_NULL_NODE;
+		node->children[1] = ECS_SPATIAL_QUERY_NULL_NODE;
+		node->entry = ECS_SPATIAL_QUERY_NULL_NODE;
+		node->height = 0;
+		return node_index;
+	}
+
+	static void FreeNode(SpatialQueryIndex* index, unsigned int node_index) {
+		index->nodes[node_index].parent = index->free_node;
+		index->nodes[node_index].height = -1;
+		index->free_node = node_index;
+	}
+
+	static void ReplaceChild(SpatialQueryIndex* index, unsigned int parent, unsigned int old_child, unsigned int new_child) {
+		if (parent != ECS_SPATIAL_QUERY_NULL_NODE) {
+			SpatialQueryNode* parent_node = &index->nodes[parent];
+			parent_node->children[parent_node->children[0] == old_child ? 0 : 1] = new_child;
+		}
+		else {
+			index->root = new_child;
+		}
+	}
+
+	// Promotes the grand children of the taller side of the node when the heights of the children differ by more than 1.
+	// Returns the index of the node that takes the place of the given one
+	static unsigned int BalanceNode(SpatialQueryIndex* index, unsigned int a_index) {
+		SpatialQueryNode* nodes = index->nodes.buffer;
+		SpatialQueryNode* a = nodes + a_index;
+		if (a->IsLeaf() || a->height < 2) {
+			return a_index;
+		}
+
+		int balance = nodes[a->children[1]].height - nodes[a->children[0]].height;
+		if (balance > 1 || balance < -1) {
+			// The taller child is rotated up, such that it becomes the parent of the node
+			unsigned int taller_side = balance > 1 ? 1 : 0;
+			unsigned int up_index = a->children[taller_side];
+			unsigned int other_index = a->children[1 - taller_side];
+			SpatialQueryNode* up = nodes + up_index;
+			unsigned int first_grandchild = up->children[0];
+			unsigned int second_grandchild = up->children[1];
+
+			up->children[0] = a_index;
+			up->parent = a->parent;
+			a->parent = up_index;
+			ReplaceChild(index, up->parent, a_index, up_index);
+
+			// The taller grandchild stays with the promoted node, the other one replaces it as the child of the node
+			unsigned int kept_grandchild = first_grandchild;
+			unsigned int moved_grandchild = second_grandchild;
+			if (nodes[first_grandchild].height <= nodes[second_grandchild].height) {
+				kept_grandchild = second_grandchild;
+				moved_grandchild = first_grandchild;
+			}
+			up->children[1] = kept_grandchild;
+			a->children[taller_side] = moved_grandchild;
+			nodes[moved_grandchild].parent = a_index;
+
+			a->aabb = GetCombinedAABB(nodes[other_index].aabb, nodes[moved_grandchild].aabb);
+			a->height = 1 + std::max(nodes[other_index].height, nodes[moved_grandchild].height);
+			up->aabb = GetCombinedAABB(a->aabb, nodes[kept_grandchild].aabb);
+			up->height = 1 + std::max(a->height, nodes[kept_grandchild].height);
+			return up_index;
+		}
+		return a_index;
+	}
+
+	// Walks from the node to the root, balancing and refitting the ancestors
+	static void RefitAncestors(SpatialQueryIndex* index, unsigned int node_index) {
+		while (node_index != ECS_SPATIAL_QUERY_NULL_NODE) {
+			node_index = BalanceNode(index, node_index);
+
+			SpatialQueryNode* node = &index->nodes[node_index];
+			const SpatialQueryNode* first = &index->nodes[node->children[0]];
+			const SpatialQueryNode* second = &index->nodes[node->children[1]];
+			node->height = 1 + std::max(first->height, second->height);
+			node->aabb = GetCombinedAABB(first->aabb, second->aabb);
+
+			node_index = node->parent;
+		}
+	}
+
+	static void InsertLeaf(SpatialQueryIndex* index, unsigned int leaf) {
+		if (index->root == ECS_SPATIAL_QUERY_NULL_NODE) {
+			index->root = leaf;
+			index->nodes[leaf].parent = ECS_SPATIAL_QUERY_NULL_NODE;
+			return;
+		}
+
+		// The sibling is chosen by descending into the child that increases the surface area the least,
+		// until creating a new parent at the current node is cheaper than descending
+		AABBScalar leaf_aabb = index->nodes[leaf].aabb;
+		unsigned int sibling = index->root;
+		while (!index->nodes[sibling].IsLeaf()) {
+			const SpatialQueryNode* node = &index->nodes[sibling];
+			float area = AABBHalfSurfaceArea(node->aabb);
+			float combined_area = AABBHalfSurfaceArea(GetCombinedAABB(node->aabb, leaf_aabb));
+
+			float cost = 2.0f * combined_area;
+			// The cost that the ancestors pay for pushing the leaf further down
+			float inheritance_cost = 2.0f * (combined_area - area);
+
+			float child_costs[2];
+			for (size_t child = 0; child < 2; child++) {
+				const SpatialQueryNode* child_node = &index->nodes[node->children[child]];
+				float child_combined_area = AABBHalfSurfaceArea(GetCombinedAABB(child_node->aabb, leaf_aabb));
+				child_costs[child] = child_node->IsLeaf() ? child_combined_area : child_combined_area - AABBHalfSurfaceArea(child_node->aabb);
+				child_costs[child] += inheritance_cost;
+			}
+
+			if (cost < child_costs[0] && cost < child_costs[1]) {
+				break;
+			}
+			sibling = node->children[child_costs[0] < child_costs[1] ? 0 : 1];
+		}
+
+		unsigned int old_parent = index->nodes[sibling].parent;
+		unsigned int new_parent = AllocateNode(index);
+		SpatialQueryNode* new_parent_node = &index->nodes[new_parent];
+		new_parent_node->parent = old_parent;
+		new_parent_node->aabb = GetCombinedAABB(leaf_aabb, index->nodes[sibling].aabb);
+		new_parent_node->height = index->nodes[sibling].height + 1;
+		new_parent_node->children[0] = sibling;
+		new_parent_node->children[1] = leaf;
+		ReplaceChild(index, old_parent, sibling, new_parent);
+		index->nodes[sibling].parent = new_parent;
+		index->nodes[leaf].parent = new_parent;
+
+		RefitAncestors(index, index->nodes[leaf].parent);
+	}
+
+	static void RemoveLeaf(SpatialQueryIndex* index, unsigned int leaf) {
+		if (leaf == index->root) {
+			index->root = ECS_SPATIAL_QUERY_NULL_NODE;
+			return;
+		}
+
+		unsigned int parent = index->nodes[leaf].parent;
+		const SpatialQueryNode* parent_node = &index->nodes[parent];
+		unsigned int grandparent = parent_node->parent;
+		unsigned int sibling = parent_node->children[parent_node->children[0] == leaf ? 1 : 0];
+
+		// The sibling takes the place of the parent
+		ReplaceChild(index, grandparent, parent, sibling);
+		index->nodes[sibling].parent = grandparent;
+		FreeNode(index, parent);
+		RefitAncestors(index, grandparent);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::Initialize(AllocatorPolymorphic _allocator, unsigned int initial_capacity, float _margin)
+	{
+		allocator = _allocator;
+		margin = _margin;
+		root = ECS_SPATIAL_QUERY_NULL_NODE;
+		free_node = ECS_SPATIAL_QUERY_NULL_NODE;
+		entries.Initialize(allocator, initial_capacity);
+		// A tree with n leaves has n - 1 internal nodes
+		nodes.Initialize(allocator, initial_capacity > 0 ? initial_capacity * 2 - 1 : 0);
+		if (initial_capacity > 0) {
+			entity_table.Initialize(allocator, PowerOfTwoGreater(initial_capacity));
+		}
+		else {
+			entity_table.Reset();
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::Deallocate()
+	{
+		nodes.FreeBuffer();
+		entries.FreeBuffer();
+		entity_table.Deallocate(allocator);
+		root = ECS_SPATIAL_QUERY_NULL_NODE;
+		free_node = ECS_SPATIAL_QUERY_NULL_NODE;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::Clear()
+	{
+		nodes.size = 0;
+		entries.size = 0;
+		entity_table.Clear();
+		root = ECS_SPATIAL_QUERY_NULL_NODE;
+		free_node = ECS_SPATIAL_QUERY_NULL_NODE;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	unsigned int SpatialQueryIndex::GetHeight() const
+	{
+		return root == ECS_SPATIAL_QUERY_NULL_NODE ? 0 : nodes[root].height;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::Insert(Entity entity, const AABBScalar& local_bounds, const AABBScalar& world_bounds)
+	{
+		ECS_ASSERT(!Exists(entity), "Spatial query index: the entity is already inserted");
+
+		unsigned int entry_index = entries.ReserveRange();
+		unsigned int node_index = AllocateNode(this);
+		entries[entry_index] = { entity, node_index, local_bounds, world_bounds };
+		nodes[node_index].entry = entry_index;
+		nodes[node_index].aabb = EnlargeAABB(world_bounds, margin);
+		entity_table.InsertDynamic(allocator, entry_index, entity);
+
+		InsertLeaf(this, node_index);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::Insert(const EntityManager* entity_manager, Entity entity, const AABBScalar& local_bounds)
+	{
+		Insert(entity, local_bounds, GetEntityWorldBounds(entity_manager, entity, local_bounds));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool SpatialQueryIndex::Remove(Entity entity)
+	{
+		unsigned int table_index = entity_table.Find(entity);
+		if (table_index == -1) {
+			return false;
+		}
+
+		unsigned int entry_index = entity_table.GetValueFromIndex(table_index);
+		entity_table.EraseFromIndex(table_index);
+
+		unsigned int node_index = entries[entry_index].node;
+		RemoveLeaf(this, node_index);
+		FreeNode(this, node_index);
+
+		entries.RemoveSwapBack(entry_index);
+		if (entry_index < entries.size) {
+			// Patch the references of the entry that was swapped in
+			nodes[entries[entry_index].node].entry = entry_index;
+			*entity_table.GetValuePtr(entries[entry_index].entity) = entry_index;
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool SpatialQueryIndex::UpdateBounds(Entity entity, const AABBScalar& world_bounds)
+	{
+		unsigned int entry_index = entity_table.GetValue(entity);
+		SpatialQueryEntry* entry = &entries[entry_index];
+		entry->bounds = world_bounds;
+		if (AABBContains(nodes[entry->node].aabb, world_bounds)) {
+			return false;
+		}
+
+		RemoveLeaf(this, entry->node);
+		nodes[entry->node].aabb = EnlargeAABB(world_bounds, margin);
+		InsertLeaf(this, entry->node);
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::SetLocalBounds(Entity entity, const AABBScalar& local_bounds)
+	{
+		entries[entity_table.GetValue(entity)].local_bounds = local_bounds;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	unsigned int SpatialQueryIndex::UpdateFromTransforms(const EntityManager* entity_manager, TaskManager* task_manager)
+	{
+		if (entries.size == 0) {
+			return 0;
+		}
+
+		// The component lookups and the transforms are done in parallel directly into the entries. The entries
+		// that need to be moved are marked with a bit per entry, since usually only a few of them exit their fat bounds
+		size_t mask_count = SlotsFor(entries.size, 64);
+		size_t* moved_mask = (size_t*)Allocate(allocator, sizeof(size_t) * mask_count * 2, alignof(size_t));
+		size_t* destroyed_mask = moved_mask + mask_count;
+		memset(moved_mask, 0, sizeof(size_t) * mask_count * 2);
+
+		// The batches are multiples of 64 entries, such that each batch writes its own mask words
+		ParallelForBatches(task_manager, mask_count, UPDATE_MIN_BATCH_SIZE / 64, UPDATE_MAX_BATCH_COUNT, [&](size_t word_offset, size_t word_count, size_t batch_index) {
+			size_t entry_end = std::min((word_offset + word_count) * 64, (size_t)entries.size);
+			for (size_t index = word_offset * 64; index < entry_end; index++) {
+				SpatialQueryEntry* entry = &entries[index];
+				if (!entity_manager->ExistsEntity(entry->entity)) {
+					destroyed_mask[index / 64] |= (size_t)1 << (index % 64);
+					continue;
+				}
+				entry->bounds = GetEntityWorldBounds(entity_manager, entry->entity, entry->local_bounds);
+				if (!AABBContains(nodes[entry->node].aabb, entry->bounds)) {
+					moved_mask[index / 64] |= (size_t)1 << (index % 64);
+				}
+			}
+		});
+
+		// The entities are collected before removing them, because the removal swaps the entries and the masks
+		// Are indexed by the entry position. All of them are removed only after the masks were walked
+		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 4, ECS_MB * 16);
+		ResizableStream<Entity> destroyed_entities(&stack_allocator, 256);
+		unsigned int moved_count = 0;
+		for (size_t word = 0; word < mask_count; word++) {
+			size_t moved_word = moved_mask[word];
+			while (moved_word != 0) {
+				unsigned int bit = FirstLSB64(moved_word);
+				moved_word &= moved_word - 1;
+
+				SpatialQueryEntry* entry = &entries[word * 64 + bit];
+				RemoveLeaf(this, entry->node);
+				nodes[entry->node].aabb = EnlargeAABB(entry->bounds, margin);
+				InsertLeaf(this, entry->node);
+				moved_count++;
+			}
+
+			size_t destroyed_word = destroyed_mask[word];
+			while (destroyed_word != 0) {
+				unsigned int bit = FirstLSB64(destroyed_word);
+				destroyed_word &= destroyed_word - 1;
+				destroyed_entities.Add(entries[word * 64 + bit].entity);
+			}
+		}
+
+		for (unsigned int index = 0; index < destroyed_entities.size; index++) {
+			Remove(destroyed_entities[index]);
+		}
+
+		ECSEngine::Deallocate(allocator, moved_mask);
+		return moved_count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// The functor receives the entry index of the leaves whose node AABB passes the test and returns false to stop the traversal
+	template<typename NodeTest, typename LeafFunctor>
+	static void TraverseSpatialQueryIndex(const SpatialQueryIndex* index, NodeTest&& node_test, LeafFunctor&& leaf_functor) {
+		if (index->root == ECS_SPATIAL_QUERY_NULL_NODE) {
+			return;
+		}
+
+		ECS_STACK_CAPACITY_STREAM(unsigned int, stack, TRAVERSAL_STACK_CAPACITY);
+		stack.Add(index->root);
+		while (stack.size > 0) {
+			const SpatialQueryNode* node = &index->nodes[stack[--stack.size]];
+			if (node_test(node->aabb)) {
+				if (node->IsLeaf()) {
+					if (!leaf_functor(node->entry)) {
+						return;
+					}
+				}
+				else {
+					stack.AddAssert(node->children[0]);
+					stack.AddAssert(node->children[1]);
+				}
+			}
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryAABB(const AABBScalar& aabb, CapacityStream<Entity>* entities) const
+	{
+		TraverseSpatialQueryIndex(this, [&](const AABBScalar& node_aabb) {
+			return AABBOverlap(node_aabb, aabb);
+		}, [&](unsigned int entry_index) {
+			if (AABBOverlap(entries[entry_index].bounds, aabb)) {
+				if (entities->size == entities->capacity) {
+					return false;
+				}
+				entities->Add(entries[entry_index].entity);
+			}
+			return true;
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryRadius(float3 center, float radius, CapacityStream<Entity>* entities) const
+	{
+		float squared_radius = radius * radius;
+		TraverseSpatialQueryIndex(this, [&](const AABBScalar& node_aabb) {
+			return AABBToPointSquaredDistance(node_aabb, center) <= squared_radius;
+		}, [&](unsigned int entry_index) {
+			if (AABBToPointSquaredDistance(entries[entry_index].bounds, center) <= squared_radius) {
+				if (entities->size == entities->capacity) {
+					return false;
+				}
+				entities->Add(entries[entry_index].entity);
+			}
+			return true;
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryNearest(float3 point, unsigned int count, CapacityStream<SpatialQueryHit>* hits, float max_distance) const
+	{
+		count = std::min(count, hits->capacity - hits->size);
+		if (count == 0 || root == ECS_SPATIAL_QUERY_NULL_NODE) {
+			return;
+		}
+
+		// The hits are kept sorted by the squared distance. Once count hits are found, the farthest one
+		// bounds the search, and the closer child is visited first such that the bound shrinks quickly
+		SpatialQueryHit* found = hits->buffer + hits->size;
+		unsigned int found_count = 0;
+		float bound = max_distance == FLT_MAX ? FLT_MAX : max_distance * max_distance;
+
+		struct StackEntry {
+			unsigned int node;
+			float squared_distance;
+		};
+		ECS_STACK_CAPACITY_STREAM(StackEntry, stack, TRAVERSAL_STACK_CAPACITY);
+		stack.Add({ root, AABBToPointSquaredDistance(nodes[root].aabb, point) });
+		while (stack.size > 0) {
+			StackEntry current = stack[--stack.size];
+			if (current.squared_distance > bound) {
+				continue;
+			}
+
+			const SpatialQueryNode* node = &nodes[current.node];
+			if (node->IsLeaf()) {
+				const SpatialQueryEntry* entry = &entries[node->entry];
+				float squared_distance = AABBToPointSquaredDistance(entry->bounds, point);
+				if (squared_distance <= bound) {
+					unsigned int insert_index = found_count < count ? found_count++ : count - 1;
+					while (insert_index > 0 && found[insert_index - 1].distance > squared_distance) {
+						found[insert_index] = found[insert_index - 1];
+						insert_index--;
+					}
+					found[insert_index] = { entry->entity, squared_distance };
+					if (found_count == count) {
+						bound = found[count - 1].distance;
+					}
+				}
+			}
+			else {
+				float first_distance = AABBToPointSquaredDistance(nodes[node->children[0]].aabb, point);
+				float second_distance = AABBToPointSquaredDistance(nodes[node->children[1]].aabb, point);
+				// The closer child is pushed last, such that it is popped first
+				if (first_distance < second_distance) {
+					stack.AddAssert({ node->children[1], second_distance });
+					stack.AddAssert({ node->children[0], first_distance });
+				}
+				else {
+					stack.AddAssert({ node->children[0], first_distance });
+					stack.AddAssert({ node->children[1], second_distance });
+				}
+			}
+		}
+
+		for (unsigned int index = 0; index < found_count; index++) {
+			found[index].distance = sqrt(found[index].distance);
+		}
+		hits->size += found_count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool SpatialQueryIndex::RayCast(const SpatialQueryRay& ray, SpatialQueryHit* hit) const
+	{
+		float3 inverse_direction = float3::Splat(1.0f) / ray.direction;
+		hit->entity = Entity::Invalid();
+		hit->distance = ray.max_distance;
+
+		TraverseSpatialQueryIndex(this, [&](const AABBScalar& node_aabb) {
+			return RayAABBDistance(ray.origin, inverse_direction, hit->distance, node_aabb) != FLT_MAX;
+		}, [&](unsigned int entry_index) {
+			float distance = RayAABBDistance(ray.origin, inverse_direction, hit->distance, entries[entry_index].bounds);
+			if (distance != FLT_MAX) {
+				hit->entity = entries[entry_index].entity;
+				hit->distance = distance;
+			}
+			return true;
+		});
+		return hit->entity.IsValid();
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryAABBBatch(Stream<AABBScalar> aabbs, CapacityStream<Entity>* results, TaskManager* task_manager) const
+	{
+		ParallelFor(task_manager, aabbs.size, [&](size_t index) {
+			QueryAABB(aabbs[index], results + index);
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryRadiusBatch(Stream<float3> centers, float radius, CapacityStream<Entity>* results, TaskManager* task_manager) const
+	{
+		ParallelFor(task_manager, centers.size, [&](size_t index) {
+			QueryRadius(centers[index], radius, results + index);
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::QueryNearestBatch(
+		Stream<float3> points,
+		unsigned int count,
+		CapacityStream<SpatialQueryHit>* results,
+		TaskManager* task_manager,
+		float max_distance
+	) const
+	{
+		ParallelFor(task_manager, points.size, [&](size_t index) {
+			QueryNearest(points[index], count, results + index, max_distance);
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void SpatialQueryIndex::RayCastBatch(Stream<SpatialQueryRay> rays, SpatialQueryHit* hits, TaskManager* task_manager) const
+	{
+		// The ray casts are cheap compared to the other queries, so these are batched
+		ParallelForBatches(task_manager, rays.size, 16, UPDATE_MAX_BATCH_COUNT, [&](size_t offset, size_t count, size_t batch_index) {
+			for (size_t index = offset; index < offset + count; index++) {
+				RayCast(rays[index], hits + index);
+			}
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	SpatialQueryIndex* GetOrCreateSpatialQueryIndex(World* world, float margin)
+	{
+		SpatialQueryIndex* index = world->entity_manager->TryGetGlobalComponent<SpatialQueryIndex>();
+		if (index == nullptr) {
+			index = world->entity_manager->RegisterGlobalComponentCommit<SpatialQueryIndex>(nullptr);
+			index->Initialize(world->GetGlobalComponentAllocator(), 0, margin);
+		}
+		return index;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,158 @@
+// ECS_REFLECT
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Containers/HashTable.h"
+#include "../Math/AABB.h"
+#include "../Utilities/Reflection/ReflectionMacros.h"
+#include "InternalStructures.h"
+#include "Components.h"
+
+#define ECS_SPATIAL_QUERY_NULL_NODE (unsigned int)-1
+
+namespace ECSEngine {
+
+	struct EntityManager;
+	struct TaskManager;
+	struct World;
+
+	struct SpatialQueryNode {
+		ECS_INLINE bool IsLeaf() const {
+			return children[0] == ECS_SPATIAL_QUERY_NULL_NODE;
+		}
+
+		// For leaves, this is the fat AABB of the entry
+		AABBScalar aabb;
+		// For the nodes in the free list, this is the next free node
+		unsigned int parent;
+		unsigned int children[2];
+		// Only valid for the leaves
+		unsigned int entry;
+		// Leaves have the height 0, the free nodes -1
+		int height;
+	};
+
+	struct SpatialQueryEntry {
+		Entity entity;
+		unsigned int node;
+		// The bounds of the entity in its own space. These are transformed by UpdateFromTransforms
+		AABBScalar local_bounds;
+		// The tight world space bounds. The queries test these ones for the leaves
+		AABBScalar bounds;
+	};
+
+	struct SpatialQueryHit {
+		Entity entity;
+		// For the nearest queries, it is the distance to the bounds of the entity. For the ray casts,
+		// it is the distance along the ray to the entry point into the bounds
+		float distance;
+	};
+
+	struct SpatialQueryRay {
+		float3 origin;
+		// It doesn't need to be normalized, the distances are expressed in units of its length
+		float3 direction;
+		float max_distance = FLT_MAX;
+	};
+
+	// A dynamic AABB tree over entities that any module can use to find the entities in a region, the closest
+	// entities to a point or the first entity that a ray hits. The leaves store the bounds enlarged by a margin,
+	// such that small movements don't change the tree, and the tree is kept balanced with rotations.
+	// The queries can be called concurrently with each other, but not with the functions that modify the index
+	struct ECSENGINE_API ECS_REFLECT_GLOBAL_COMPONENT_PRIVATE SpatialQueryIndex {
+		ECS_INLINE constexpr static short ID() {
+			return ECS_GLOBAL_COMPONENT_BASE + 1;
+		}
+
+		ECS_INLINE AllocatorPolymorphic Allocator() const {
+			return allocator;
+		}
+
+		// The margin is added on each side of the leaf bounds
+		void Initialize(AllocatorPolymorphic allocator, unsigned int initial_capacity = 0, float margin = 0.1f);
+
+		void Deallocate();
+
+		// Removes all the entries, but keeps the allocations
+		void Clear();
+
+		ECS_INLINE bool Exists(Entity entity) const {
+			return entity_table.Find(entity) != -1;
+		}
+
+		ECS_INLINE unsigned int GetCount() const {
+			return entries.size;
+		}
+
+		// Returns the height of the tree, 0 for an empty or a single entry tree
+		unsigned int GetHeight() const;
+
+		// The entity must not be already inserted. The world bounds are used as they are until the next update,
+		// the local bounds are the ones that UpdateFromTransforms uses
+		void Insert(Entity entity, const AABBScalar& local_bounds, const AABBScalar& world_bounds);
+
+		// Inserts the entity with the local bounds transformed by its Translation, Rotation and Scale components
+		void Insert(const EntityManager* entity_manager, Entity entity, const AABBScalar& local_bounds);
+
+		// Returns false if the entity is not inserted
+		bool Remove(Entity entity);
+
+		// Changes the world bounds of an entity. Returns true if the entity had to be moved inside the tree,
+		// which happens only when the new bounds exit the enlarged bounds of the leaf
+		bool UpdateBounds(Entity entity, const AABBScalar& world_bounds);
+
+		// Changes the local bounds of an entity, the world bounds are updated at the next UpdateFromTransforms
+		void SetLocalBounds(Entity entity, const AABBScalar& local_bounds);
+
+		// Recomputes the world bounds of all the entries from their Translation, Rotation and Scale components.
+		// The entities that no longer exist are removed. The bounds are computed in parallel when a task manager is given,
+		// while the tree is updated afterwards only for the entries that exited their enlarged bounds.
+		// Returns the count of entries that were moved inside the tree
+		unsigned int UpdateFromTransforms(const EntityManager* entity_manager, TaskManager* task_manager = nullptr);
+
+		// Adds all the entities whose bounds overlap the AABB. The entities that don't fit are dropped
+		void QueryAABB(const AABBScalar& aabb, CapacityStream<Entity>* entities) const;
+
+		// Adds all the entities whose bounds are inside or intersect the sphere. The entities that don't fit are dropped
+		void QueryRadius(float3 center, float radius, CapacityStream<Entity>* entities) const;
+
+		// Fills in the closest count entities to the point, sorted by the distance to their bounds, which is 0
+		// for the bounds that contain the point. Only the entities closer than the max distance are considered.
+		// The hits are added to the stream, the count is clamped by the remaining capacity
+		void QueryNearest(float3 point, unsigned int count, CapacityStream<SpatialQueryHit>* hits, float max_distance = FLT_MAX) const;
+
+		// Returns true if the ray hits the bounds of an entity and fills in the closest one
+		bool RayCast(const SpatialQueryRay& ray, SpatialQueryHit* hit) const;
+
+		// The batched variants run the queries in parallel when a task manager is given. Each query has its own output stream
+		void QueryAABBBatch(Stream<AABBScalar> aabbs, CapacityStream<Entity>* results, TaskManager* task_manager = nullptr) const;
+
+		void QueryRadiusBatch(Stream<float3> centers, float radius, CapacityStream<Entity>* results, TaskManager* task_manager = nullptr) const;
+
+		void QueryNearestBatch(
+			Stream<float3> points,
+			unsigned int count,
+			CapacityStream<SpatialQueryHit>* results,
+			TaskManager* task_manager = nullptr,
+			float max_distance = FLT_MAX
+		) const;
+
+		// The rays that don't hit anything have the hit entity set to Entity::Invalid()
+		void RayCastBatch(Stream<SpatialQueryRay> rays, SpatialQueryHit* hits, TaskManager* task_manager = nullptr) const;
+
+		[[ECS_MAIN_ALLOCATOR, ECS_REFERENCE_ALLOCATOR]]
+		AllocatorPolymorphic allocator;
+		ResizableStream<SpatialQueryNode> nodes; ECS_SKIP_REFLECTION()
+		ResizableStream<SpatialQueryEntry> entries; ECS_SKIP_REFLECTION()
+		// Maps the entity to its index in the entries
+		HashTable<unsigned int, Entity, HashFunctionPowerOfTwo> entity_table; ECS_SKIP_REFLECTION()
+		unsigned int root;
+		unsigned int free_node;
+		float margin;
+	};
+
+	// The index is not created by default. The modules that need it call this function in their initialize tasks,
+	// and they are the ones that must keep it up to date with UpdateFromTransforms or UpdateBounds
+	ECSENGINE_API SpatialQueryIndex* GetOrCreateSpatialQueryIndex(World* world, float margin = 0.1f);
+
+}
@@ -193,6 +193,9 @@ namespace ECSEngine {
 		ComponentSignature shared_exclude = {};
 		ComponentSignature unique_optional = {};
 		ComponentSignature shared_optional = {};
+		// When set, the unique components are only read, such that the archetype bases whose storage is shared
+		// After a copy on write are iterated without cloning them
+		bool read_only_unique = false;
 	};
 
 }
\ No newline at end of file
@@ -133,6 +133,7 @@ namespace ECSEngine {
 			allocation = OffsetPointer(allocation, sizeof(DebugDrawer));
 
 			*debug_drawer = DebugDrawer(debug_drawer_allocator, resource_manager, thread_count);		
+			debug_drawer->SetTaskManager(task_manager);
 		}
 		else {
 			debug_drawer = descriptor.debug_drawer;
@@ -152,6 +153,9 @@ namespace ECSEngine {
 		}
 		world->task_manager->ClearThreadAllocators();
 
+		// The entity manager memory is released without clearing it, the copy on write links must be ended here
+		world->entity_manager->DetachCopyOnWrite(false);
+
 		if (world->memory->Belongs(world->graphics)) {
 			// Destory the graphics object
 			DestroyGraphics(world->graphics);
@@ -361,7 +365,7 @@ namespace ECSEngine {
 
 	// ---------------------------------------------------------------------------------------------------------------------
 
-	void CopyWorld(World* destination_world, const World* source_world) {
+	void CopyWorld(World* destination_world, const World* source_world, bool copy_on_write) {
 		// We don't want to clear the physical pages, they might be used again in this call
 		ClearWorld(destination_world, false);
 
@@ -369,7 +373,7 @@ namespace ECSEngine {
 		// The task manager (static tasks) and the resource manager, if the user specified so, if the pointers are different. 
 		// If it is the same resource manager instance, then the resources don't need to be copied.
 
-		destination_world->entity_manager->CopyOther(source_world->entity_manager);
+		destination_world->entity_manager->CopyOther(source_world->entity_manager, copy_on_write);
 		destination_world->system_manager->CopyOther(source_world->system_manager);
 		destination_world->task_scheduler->CopyOther(source_world->task_scheduler);
 		destination_world->task_manager->AddTasksFromOther(source_world->task_manager);
@@ -161,8 +161,10 @@ namespace ECSEngine {
 	ECSENGINE_API void PauseWorld(World* world);
 
 	// Clears the destination world and then copies all the data from the source world. It assumes
-	// That the destination world was initialized at least once.
-	ECSENGINE_API void CopyWorld(World* destination_world, const World* source_world);
+	// That the destination world was initialized at least once. When copy on write is set, the archetype
+	// Storage of the entity manager is shared between the two worlds until one of them writes to it (look at
+	// EntityManager::CopyOther). The link is ended when either of the worlds is cleared or destroyed
+	ECSENGINE_API void CopyWorld(World* destination_world, const World* source_world, bool copy_on_write = false);
 
 	// These are functions that can be used from C++ to tell the editor to stop
 	// The simulation
@@ -5,7 +5,14 @@
 #include "../Rendering/RenderingStructures.h"
 #include "../Rendering/Graphics.h"
 #include "../Rendering/GraphicsHelpers.h"
+#include "../Rendering/MeshOptimization.h"
 #include "../Allocators/AllocatorPolymorphic.h"
+#include "../Multithreading/ParallelFor.h"
+
+// The amount of vertices below which a mesh is not split between multiple threads
+#define PARALLEL_VERTEX_BATCH_SIZE (ECS_KB * 16)
+// The maximum amount of batches in which the vertices of a single mesh are split
+#define PARALLEL_VERTEX_MAX_BATCH_COUNT 64
 
 namespace ECSEngine {
 
@@ -14,6 +21,78 @@ namespace ECSEngine {
 
 		// -------------------------------------------------------------------------------------------------------------------------------
 
+		// Returns the address of the first element if the accessor can be read directly from its buffer, else nullptr
+		static const void* GetAccessorDirectData(const cgltf_accessor* accessor) {
+			if (accessor->is_sparse || accessor->buffer_view == nullptr || accessor->buffer_view->buffer->data == nullptr) {
+				return nullptr;
+			}
+			return OffsetPointer(accessor->buffer_view->buffer->data, accessor->buffer_view->offset + accessor->offset);
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		// Float accessors, which are the common case for the positions, normals, UVs and weights, are copied directly
+		// out of the buffer. The rest go through cgltf, which converts each element separately
+		static bool ReadAccessorFloats(const cgltf_accessor* accessor, unsigned int component_count, float* values) {
+			const void* data = GetAccessorDirectData(accessor);
+			size_t element_byte_size = component_count * sizeof(float);
+			if (data != nullptr && accessor->component_type == cgltf_component_type_r_32f && accessor->stride >= element_byte_size) {
+				if (accessor->stride == element_byte_size) {
+					memcpy(values, data, element_byte_size * accessor->count);
+				}
+				else {
+					for (size_t index = 0; index < accessor->count; index++) {
+						memcpy(values + index * component_count, OffsetPointer(data, index * accessor->stride), element_byte_size);
+					}
+				}
+				return true;
+			}
+
+			bool success = true;
+			for (size_t index = 0; index < accessor->count && success; index++) {
+				success &= (bool)cgltf_accessor_read_float(accessor, index, values + index * component_count, component_count);
+			}
+			return success;
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		template<typename IntegerType>
+		static void ReadAccessorIndicesStrided(const void* data, size_t stride, Stream<unsigned int> indices) {
+			for (size_t index = 0; index < indices.size; index++) {
+				indices[index] = *(const IntegerType*)OffsetPointer(data, index * stride);
+			}
+		}
+
+		// The indices stream must have the accessor count as size
+		static void ReadAccessorIndices(const cgltf_accessor* accessor, Stream<unsigned int> indices) {
+			const void* data = GetAccessorDirectData(accessor);
+			if (data != nullptr) {
+				switch (accessor->component_type) {
+				case cgltf_component_type_r_32u:
+					if (accessor->stride == sizeof(unsigned int)) {
+						memcpy(indices.buffer, data, indices.MemoryOf(indices.size));
+					}
+					else {
+						ReadAccessorIndicesStrided<unsigned int>(data, accessor->stride, indices);
+					}
+					return;
+				case cgltf_component_type_r_16u:
+					ReadAccessorIndicesStrided<unsigned short>(data, accessor->stride, indices);
+					return;
+				case cgltf_component_type_r_8u:
+					ReadAccessorIndicesStrided<unsigned char>(data, accessor->stride, indices);
+					return;
+				}
+			}
+
+			for (size_t index = 0; index < indices.size; index++) {
+				indices[index] = cgltf_accessor_read_index(accessor, index);
+			}
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
 		// This makes an allocation
 		static Stream<float> GetScalarValues(
 			AllocatorPolymorphic allocator,
@@ -27,9 +106,7 @@ namespace ECSEngine {
 			ECS_ASSERT(values.buffer != nullptr);
 
 			values.size = accessor->count * component_count;
-			for (size_t index = 0; index < accessor->count && *success; index++) {
-				*success &= (bool)cgltf_accessor_read_float(accessor, index, values.buffer + index * component_count, component_count);
-			}
+			*success &= ReadAccessorFloats(accessor, component_count, values.buffer);
 
 			return values;
 		}
@@ -39,11 +116,52 @@ namespace ECSEngine {
 		// Does not make an allocation
 		static bool GetScalarValues(const cgltf_accessor* accessor, unsigned int component_count, Stream<float>* values) {
 			values->size = accessor->count * component_count;
-			bool success = true;
-			for (size_t index = 0; index < accessor->count && success; index++) {
-				success &= (bool)cgltf_accessor_read_float(accessor, index, values->buffer + index * component_count, component_count);
+			return ReadAccessorFloats(accessor, component_count, values->buffer);
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		// Calls the functor with (Stream<float3> batch_positions, size_t batch_index) for ranges of the positions
+		template<typename Functor>
+		static size_t ParallelForPositionBatches(TaskManager* task_manager, Stream<float3> positions, Functor&& functor) {
+			return ParallelForBatches(task_manager, positions.size, PARALLEL_VERTEX_BATCH_SIZE, PARALLEL_VERTEX_MAX_BATCH_COUNT, [&](size_t batch_offset, size_t batch_count, size_t batch_index) {
+				functor(Stream<float3>(positions.buffer + batch_offset, batch_count), batch_index);
+			});
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		static void ScaleMeshPositions(Stream<float3> positions, float scale_factor) {
+			// Scaling with the same factor on all axis basically means multiplying the coordinates by the given scale factor
+			Vec8f splatted_factor(scale_factor);
+			Stream<float> float_positions = { positions.buffer, positions.size * 3 };
+			ApplySIMDConstexpr(float_positions.size, Vec8f::size(), [&](auto is_full_iteration, size_t index, size_t count) {
+				if constexpr (is_full_iteration) {
+					Vec8f current_positions = Vec8f().load(float_positions.buffer + index);
+					current_positions *= splatted_factor;
+					current_positions.store(float_positions.buffer + index);
+				}
+				else {
+					Vec8f current_positions = Vec8f().load_partial(count, float_positions.buffer + index);
+					current_positions *= splatted_factor;
+					current_positions.store_partial(count, float_positions.buffer + index);
+				}
+			});
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		static AABBScalar GetPositionsBoundingBox(Stream<float3> positions, TaskManager* task_manager) {
+			AABBScalar batch_bounds[PARALLEL_VERTEX_MAX_BATCH_COUNT];
+			size_t batch_count = ParallelForPositionBatches(task_manager, positions, [&](Stream<float3> batch_positions, size_t batch_index) {
+				batch_bounds[batch_index] = GetMeshBoundingBox(batch_positions);
+			});
+
+			AABBScalar bounds = ReverseInfiniteAABBScalar();
+			for (size_t index = 0; index < batch_count; index++) {
+				bounds = GetCombinedAABB(bounds, batch_bounds[index]);
 			}
-			return success;
+			return bounds;
 		}
 
 		// -------------------------------------------------------------------------------------------------------------------------------
@@ -476,16 +594,37 @@ namespace ECSEngine {
 
 		// -------------------------------------------------------------------------------------------------------------------------------
 
-		static void InvertMeshZAxis(Stream<float3> positions, Stream<float3> normals, Stream<unsigned int> indices) {
-			// Invert the position Z axis
-			for (size_t subindex = 0; subindex < positions.size; subindex++) {
-				positions[subindex].z = -positions[subindex].z;
-			}
+		static void InvertFloat3ZAxis(Stream<float3> values) {
+			// The Z component is every third float, such that 3 vectors (8 float3s) have a fixed pattern of sign flips
+			const Vec8f sign_masks[3] = {
+				Vec8f(0.0f, 0.0f, -0.0f, 0.0f, 0.0f, -0.0f, 0.0f, 0.0f),
+				Vec8f(-0.0f, 0.0f, 0.0f, -0.0f, 0.0f, 0.0f, -0.0f, 0.0f),
+				Vec8f(0.0f, -0.0f, 0.0f, 0.0f, -0.0f, 0.0f, 0.0f, -0.0f)
+			};
 
-			// Invert the normals Z axis
-			for (size_t subindex = 0; subindex < normals.size; subindex++) {
-				normals[subindex].z = -normals[subindex].z;
-			}
+			Stream<float> float_values = { values.buffer, values.size * 3 };
+			ApplySIMDConstexpr(float_values.size, Vec8f::size() * ECS_COUNTOF(sign_masks), [&](auto is_full_iteration, size_t index, size_t count) {
+				if constexpr (is_full_iteration) {
+					for (size_t subindex = 0; subindex < ECS_COUNTOF(sign_masks); subindex++) {
+						float* current_values = float_values.buffer + index + subindex * Vec8f::size();
+						Vec8f current_vector = Vec8f().load(current_values);
+						current_vector ^= sign_masks[subindex];
+						current_vector.store(current_values);
+					}
+				}
+				else {
+					for (size_t subindex = 2; subindex < count; subindex += 3) {
+						float_values[index + subindex] = -float_values[index + subindex];
+					}
+				}
+			});
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
+		static void InvertMeshZAxis(Stream<float3> positions, Stream<float3> normals, Stream<unsigned int> indices) {
+			InvertFloat3ZAxis(positions);
+			InvertFloat3ZAxis(normals);
 
 			// The winding order of the vertices must be changed
 			// Start from 1 in order to avoid an add
@@ -497,6 +636,24 @@ namespace ECSEngine {
 
 		// -------------------------------------------------------------------------------------------------------------------------------
 
+		static void OffsetMeshIndices(Stream<unsigned int> indices, unsigned int offset) {
+			Vec8ui vector_offset(offset);
+			ApplySIMDConstexpr(indices.size, Vec8ui::size(), [&](auto is_full_iteration, size_t index, size_t count) {
+				if constexpr (is_full_iteration) {
+					Vec8ui current_indices = Vec8ui().load(indices.buffer + index);
+					current_indices += vector_offset;
+					current_indices.store(indices.buffer + index);
+				}
+				else {
+					for (size_t subindex = 0; subindex < count; subindex++) {
+						indices[index + subindex] += offset;
+					}
+				}
+			});
+		}
+
+		// -------------------------------------------------------------------------------------------------------------------------------
+
 	}
 
 	// -------------------------------------------------------------------------------------------------------------------------------
@@ -582,6 +739,17 @@ namespace ECSEngine {
 
 	// -------------------------------------------------------------------------------------------------------------------------------
 
+	GLTFData LoadGLTFFileFromMemory(Stream<void> file_data, Stream<wchar_t> path, AllocatorPolymorphic allocator, CapacityStream<char>* error_message) {
+		ECS_STACK_CAPACITY_STREAM(char, temp_path, 512);
+		ConvertWideCharsToASCII(path, temp_path);
+		temp_path[temp_path.size] = '\0';
+		return LoadGLTFFileImpl(error_message, temp_path, allocator, [=](const cgltf_options* options, cgltf_data** data) {
+			return cgltf_parse(options, file_data.buffer, file_data.size, data);
+		});
+	}
+
+	// -------------------------------------------------------------------------------------------------------------------------------
+
 	bool LoadMeshBufferSizesFromGLTF(const cgltf_node* node, GLTFMeshBufferSizes* buffer_sizes, CapacityStream<char>* error_message) {
 		size_t primitive_count = node->mesh->primitives_count;
 
@@ -650,9 +818,7 @@ namespace ECSEngine {
 				unsigned int index_count = primitive->indices->count;
 
 				mesh.indices = Stream<unsigned int>(Allocate(allocator, (sizeof(unsigned int) * index_count)), index_count);
-				for (unsigned int index_index = 0; index_index < index_count; index_index++) {
-					mesh.indices[index_index] = cgltf_accessor_read_index(primitive->indices, index_index);
-				}
+				ReadAccessorIndices(primitive->indices, mesh.indices);
 			}
 
 			// Invert the z axis if necessary
@@ -663,63 +829,85 @@ namespace ECSEngine {
 		return true;
 	}
 
-	// Does not load the name
-	bool LoadCoalescedMeshFromGLTF(
-		GLTFMesh& mesh,
+	// Mirrors the attributes that are loaded by CoalescedMeshFromAttribute, such that the offsets
+	// of each primitive can be determined before any of them is loaded
+	static bool LoadCoalescedPrimitiveBufferSizesFromGLTF(
+		const cgltf_primitive* primitive, 
+		GLTFMeshBufferSizes* buffer_sizes, 
+		CapacityStream<char>* error_message
+	) {
+		unsigned int attribute_count = primitive->attributes_count;
+		for (unsigned int attribute_index = 0; attribute_index < attribute_count; attribute_index++) {
+			const cgltf_attribute* attribute = &primitive->attributes[attribute_index];
+			if (strcmp(attribute->name, "TEXCOORD_1") == 0) {
+				continue;
+			}
+
+			unsigned int count = MeshBufferSizeFromAttribute(attribute, error_message);
+			if (count == -1) {
+				return false;
+			}
+			AddToMeshBufferSizes(buffer_sizes, attribute->type, count);
+		}
+
+		if (primitive->indices != nullptr) {
+			buffer_sizes->index_count += primitive->indices->count;
+		}
+		return true;
+	}
+
+	// Does not load the name. The buffer sizes must contain the offsets where the primitive is written,
+	// and these are incremented with the counts of the primitive
+	static bool LoadCoalescedPrimitiveFromGLTF(
+		const GLTFMesh& mesh,
 		GLTFMeshBufferSizes* buffer_sizes,
 		const cgltf_node* nodes,
 		size_t node_index,
+		size_t primitive_index,
 		size_t node_count,
 		bool invert_z_axis,
 		CapacityStream<char>* error_message
 	) {
-		unsigned int primitive_count = nodes[node_index].mesh->primitives_count;
-
-		for (size_t primitive_index = 0; primitive_index < primitive_count; primitive_index++) {
-			const cgltf_primitive* primitive = &nodes[node_index].mesh->primitives[primitive_index];
-			unsigned int attribute_count = primitive->attributes_count;
+		const cgltf_primitive* primitive = &nodes[node_index].mesh->primitives[primitive_index];
+		unsigned int attribute_count = primitive->attributes_count;
 
-			Stream<float3> positions = { mesh.positions.buffer + buffer_sizes->count[ECS_MESH_POSITION], buffer_sizes->count[ECS_MESH_POSITION] };
-			Stream<float3> normals = { mesh.normals.buffer + buffer_sizes->count[ECS_MESH_NORMAL], buffer_sizes->count[ECS_MESH_NORMAL] };
+		Stream<float3> positions = { mesh.positions.buffer + buffer_sizes->count[ECS_MESH_POSITION], buffer_sizes->count[ECS_MESH_POSITION] };
+		Stream<float3> normals = { mesh.normals.buffer + buffer_sizes->count[ECS_MESH_NORMAL], buffer_sizes->count[ECS_MESH_NORMAL] };
 
-			for (unsigned int attribute_index = 0; attribute_index < attribute_count; attribute_index++) {
-				const cgltf_attribute* attribute = &primitive->attributes[attribute_index];
+		for (unsigned int attribute_index = 0; attribute_index < attribute_count; attribute_index++) {
+			const cgltf_attribute* attribute = &primitive->attributes[attribute_index];
 
-				GLTFMeshBufferSizes before_sizes = *buffer_sizes;
-				bool is_valid = CoalescedMeshFromAttribute(
-					mesh,
-					buffer_sizes,
-					attribute,
-					nodes[node_index].skin,
-					nodes,
-					node_index,
-					node_count,
-					error_message
-				);
-				if (!is_valid) {
-					return false;
-				}
+			bool is_valid = CoalescedMeshFromAttribute(
+				mesh,
+				buffer_sizes,
+				attribute,
+				nodes[node_index].skin,
+				nodes,
+				node_index,
+				node_count,
+				error_message
+			);
+			if (!is_valid) {
+				return false;
 			}
+		}
 
-			positions.size = buffer_sizes->count[ECS_MESH_POSITION] - positions.size;
-			normals.size = buffer_sizes->count[ECS_MESH_NORMAL] - normals.size;
-			ECS_ASSERT(positions.size == normals.size, "Mismatch between mesh position and normal vertex count.");
+		positions.size = buffer_sizes->count[ECS_MESH_POSITION] - positions.size;
+		normals.size = buffer_sizes->count[ECS_MESH_NORMAL] - normals.size;
+		ECS_ASSERT(positions.size == normals.size, "Mismatch between mesh position and normal vertex count.");
 
-			Stream<unsigned int> indices = { nullptr, 0 };
-			if (primitive->indices != nullptr) {
-				unsigned int index_count = primitive->indices->count;
+		Stream<unsigned int> indices = { nullptr, 0 };
+		if (primitive->indices != nullptr) {
+			unsigned int index_count = primitive->indices->count;
 
-				indices = { mesh.indices.buffer + buffer_sizes->index_count, index_count };
-				buffer_sizes->index_count += index_count;
-				for (unsigned int index_index = 0; index_index < index_count; index_index++) {
-					indices[index_index] = cgltf_accessor_read_index(primitive->indices, index_index);
-				}
-			}
+			indices = { mesh.indices.buffer + buffer_sizes->index_count, index_count };
+			buffer_sizes->index_count += index_count;
+			ReadAccessorIndices(primitive->indices, indices);
+		}
 
-			// Invert the z axis if necessary
-			if (invert_z_axis) {
-				InvertMeshZAxis(positions, normals, indices);
-			}
+		// Invert the z axis if necessary
+		if (invert_z_axis) {
+			InvertMeshZAxis(positions, normals, indices);
 		}
 
 		return true;
@@ -853,18 +1041,25 @@ namespace ECSEngine {
 		bool allocate_names = false;
 		bool coallesce_names = false;
 		bool determine_submesh_bounding_box = true;
+		bool center_object_midpoint = false;
 		CapacityStream<char>* error_message = nullptr;
 		AllocatorPolymorphic temporary_allocator = ECS_MALLOC_ALLOCATOR;
 		AllocatorPolymorphic permanent_allocator = ECS_MALLOC_ALLOCATOR;
 		float scale_factor = 1.0f;
+		TaskManager* task_manager = nullptr;
+		const MeshOptimizationOptions* optimization = nullptr;
 
 		if (options != nullptr) {
 			allocate_names = options->allocate_submesh_name;
 			coallesce_names = options->coalesce_submesh_name_allocations;
+			determine_submesh_bounding_box = options->deduce_submesh_bounds;
+			center_object_midpoint = options->center_object_midpoint;
 			error_message = options->error_message;
 			temporary_allocator = options->temporary_buffer_allocator;
 			permanent_allocator = options->permanent_allocator;
 			scale_factor = options->scale_factor;
+			task_manager = options->task_manager;
+			optimization = options->optimization;
 		}
 
 		// Preallocate the buffers
@@ -895,69 +1090,135 @@ namespace ECSEngine {
 		}
 		uintptr_t submesh_name_ptr = (uintptr_t)submesh_name_allocation;
 
-		GLTFMeshBufferSizes resetted_buffer_sizes;
+		// Determine first the offsets of each primitive, such that the primitives can be loaded independently
+		struct CoalescedPrimitive {
+			unsigned int node_index;
+			unsigned int primitive_index;
+			unsigned int submesh_index;
+			GLTFMeshBufferSizes offsets;
+			AABBScalar bounds;
+		};
+
+		CoalescedPrimitive* primitives = (CoalescedPrimitive*)Allocate(temporary_allocator, sizeof(CoalescedPrimitive) * data.mesh_count);
+		size_t primitive_count = 0;
+		GLTFMeshBufferSizes running_buffer_sizes;
 
-		unsigned int submesh_index = 0;
+		unsigned int submesh_count = 0;
 		bool success = internal::ForEachMeshInGLTF(data, [&](const cgltf_node* nodes, size_t index, size_t node_count) {
-			GLTFMeshBufferSizes previous_buffer_size = resetted_buffer_sizes;
-			bool success = LoadCoalescedMeshFromGLTF(*mesh, &resetted_buffer_sizes, nodes, index, node_count, invert_z_axis, error_message);
-			if (success) {
-				Submesh submesh;
-				submesh.index_buffer_offset = previous_buffer_size.index_count;
-				submesh.vertex_buffer_offset = previous_buffer_size.count[ECS_MESH_POSITION];
-				submesh.index_count = resetted_buffer_sizes.index_count - previous_buffer_size.index_count;
-				submesh.vertex_count = resetted_buffer_sizes.count[ECS_MESH_POSITION] - previous_buffer_size.count[ECS_MESH_POSITION];
-
-				Stream<char> name = nodes[index].name;
-				if (allocate_names) {
-					if (!coallesce_names) {
-						submesh_name_allocation = Allocate(permanent_allocator, strlen(nodes[index].name) * sizeof(char));
-						submesh_name_ptr = (uintptr_t)submesh_name_allocation;
+			Submesh submesh;
+			submesh.index_buffer_offset = running_buffer_sizes.index_count;
+			submesh.vertex_buffer_offset = running_buffer_sizes.count[ECS_MESH_POSITION];
+
+			size_t node_primitive_count = nodes[index].mesh->primitives_count;
+			for (size_t primitive_index = 0; primitive_index < node_primitive_count; primitive_index++) {
+				ECS_ASSERT(primitive_count < data.mesh_count);
+				primitives[primitive_count].node_index = index;
+				primitives[primitive_count].primitive_index = primitive_index;
+				primitives[primitive_count].submesh_index = submesh_count;
+				primitives[primitive_count].offsets = running_buffer_sizes;
+				primitive_count++;
+
+				if (!LoadCoalescedPrimitiveBufferSizesFromGLTF(&nodes[index].mesh->primitives[primitive_index], &running_buffer_sizes, error_message)) {
+					return false;
+				}
+			}
+
+			for (size_t buffer_index = 0; buffer_index < ECS_MESH_BUFFER_COUNT; buffer_index++) {
+				ECS_ASSERT(running_buffer_sizes.count[buffer_index] <= sizes->count[buffer_index], "Invalid GLTF mesh buffer sizes.");
+			}
+			ECS_ASSERT(running_buffer_sizes.index_count <= sizes->index_count, "Invalid GLTF mesh buffer sizes.");
+
+			submesh.index_count = running_buffer_sizes.index_count - submesh.index_buffer_offset;
+			submesh.vertex_count = running_buffer_sizes.count[ECS_MESH_POSITION] - submesh.vertex_buffer_offset;
+			submesh.bounds = determine_submesh_bounding_box ? ReverseInfiniteAABBScalar() : InfiniteAABBScalar();
+
+			Stream<char> name = nodes[index].name;
+			if (allocate_names) {
+				if (!coallesce_names) {
+					submesh_name_allocation = Allocate(permanent_allocator, strlen(nodes[index].name) * sizeof(char));
+					submesh_name_ptr = (uintptr_t)submesh_name_allocation;
+				}
+				submesh.name.InitializeFromBuffer(submesh_name_ptr, name.size);
+				submesh.name.CopyOther(name);
+			}
+
+			submeshes[submesh_count++] = submesh;
+			return true;
+		});
+
+		if (success) {
+			// Each primitive is decoded, transformed, remapped to the vertex offset of its submesh, scaled and bounded separately
+			const cgltf_node* nodes = data.data->nodes;
+			size_t node_count = data.data->nodes_count;
+			std::atomic<bool> has_failed = false;
+			ParallelFor(task_manager, primitive_count, [&](size_t index) {
+				CoalescedPrimitive* primitive = primitives + index;
+				GLTFMeshBufferSizes primitive_buffer_sizes = primitive->offsets;
+
+				ECS_STACK_CAPACITY_STREAM(char, primitive_error_message, 512);
+				bool primitive_success = LoadCoalescedPrimitiveFromGLTF(
+					*mesh, 
+					&primitive_buffer_sizes, 
+					nodes,
+					primitive->node_index, 
+					primitive->primitive_index, 
+					node_count, 
+					invert_z_axis, 
+					error_message != nullptr ? &primitive_error_message : nullptr
+				);
+				if (!primitive_success) {
+					// Only the first failure is reported
+					if (!has_failed.exchange(true, ECS_RELAXED) && error_message != nullptr) {
+						error_message->AddStreamSafe(primitive_error_message);
 					}
-					submesh.name.InitializeFromBuffer(submesh_name_ptr, name.size);
-					submesh.name.CopyOther(name);
+					return;
 				}
-				
-				if (determine_submesh_bounding_box) {
-					Stream<float3> positions = { mesh->positions.buffer + submesh.vertex_buffer_offset, submesh.vertex_count };
-					submesh.bounds = GetMeshBoundingBox(positions);
+
+				Stream<float3> positions = {
+					mesh->positions.buffer + primitive->offsets.count[ECS_MESH_POSITION],
+					primitive_buffer_sizes.count[ECS_MESH_POSITION] - primitive->offsets.count[ECS_MESH_POSITION]
+				};
+				Stream<unsigned int> indices = {
+					mesh->indices.buffer + primitive->offsets.index_count,
+					primitive_buffer_sizes.index_count - primitive->offsets.index_count
+				};
+
+				// We need to remap the indices according to the vertex offset of the submesh
+				OffsetMeshIndices(indices, submeshes[primitive->submesh_index].vertex_buffer_offset);
+
+				// The scaling is done before the bounding box, such that the bounds don't need to be scaled afterwards
+				if (scale_factor != 1.0f) {
+					ScaleMeshPositions(positions, scale_factor);
 				}
-				else {
-					submesh.bounds = InfiniteAABBScalar();
+
+				if (determine_submesh_bounding_box) {
+					primitive->bounds = GetMeshBoundingBox(positions);
 				}
+			});
+			success = !has_failed.load(ECS_RELAXED);
 
-				submeshes[submesh_index++] = submesh;
+			if (success && determine_submesh_bounding_box) {
+				for (size_t index = 0; index < primitive_count; index++) {
+					AABBScalar* submesh_bounds = &submeshes[primitives[index].submesh_index].bounds;
+					*submesh_bounds = GetCombinedAABB(*submesh_bounds, primitives[index].bounds);
+				}
 			}
-			return success;
-		});
+		}
+		Deallocate(temporary_allocator, primitives);
 
 		if (!success) {
 			// Deallocate the buffer
 			FreeCoalescedGLTFMesh(*mesh, temporary_allocator);
 		}
 		else {
-			// We need to remap the indices according to the vertex offset of the submesh
-			for (size_t index = 0; index < data.mesh_count; index++) {
-				for (unsigned int index_index = 0; index_index < submeshes[index].index_count; index_index++) {
-					mesh->indices[submeshes[index].index_buffer_offset + index_index] += submeshes[index].vertex_buffer_offset;
-				}
-			}
-
-			// We also need to scale the gltf mesh, if required
-			if (scale_factor != 1.0f) {
-				ScaleGLTFMeshes({ mesh, 1 }, scale_factor);
-				// Check the bounding boxes as well - those need to be scaled here
-				if (determine_submesh_bounding_box) {
-					for (size_t index = 0; index < data.mesh_count; index++) {
-						submeshes[index].bounds = ScaleAABBFromOrigin(submeshes[index].bounds, float3::Splat(scale_factor));
-					}
-				}
+			if (optimization != nullptr) {
+				OptimizeCoalescedMesh(mesh, { submeshes, submesh_count }, optimization, temporary_allocator);
 			}
 
-			if (options->center_object_midpoint) {
+			if (center_object_midpoint) {
 				float3 translation = GLTFMeshOriginToCenter(mesh);
 				// Translate the aabb for each submesh as well
-				for (size_t index = 0; index < data.mesh_count; index++) {
+				for (size_t index = 0; index < submesh_count; index++) {
 					submeshes[index].bounds = TranslateAABB(submeshes[index].bounds, -translation);
 				}
 			}
@@ -1637,22 +1898,14 @@ namespace ECSEngine {
 
 	// -------------------------------------------------------------------------------------------------------------------------------
 
-	void ScaleGLTFMeshes(Stream<GLTFMesh> meshes, float scale_factor)
+	void ScaleGLTFMeshes(Stream<GLTFMesh> meshes, float scale_factor, TaskManager* task_manager)
 	{
 		if (scale_factor != 1.0f) {
-			// Scaling with the same factor on all axis basically means multiplying the coordinates by the given scale factor
-			Vec8f splatted_factor(scale_factor);
-
-			for (size_t index = 0; index < meshes.size; index++) {
-				size_t vertex_count = meshes[index].positions.size;
-				Stream<float> float_positions = { meshes[index].positions.buffer, vertex_count * 3 };
-				ApplySIMD(float_positions, float_positions, splatted_factor.size(), splatted_factor.size(), [=](const float* input, float* output, size_t count) {
-					Vec8f positions = Vec8f().load(input);
-					positions *= splatted_factor;
-					positions.store(output);
-					return count;
+			ParallelFor(task_manager, meshes.size, [&](size_t index) {
+				ParallelForPositionBatches(task_manager, meshes[index].positions, [&](Stream<float3> batch_positions, size_t batch_index) {
+					ScaleMeshPositions(batch_positions, scale_factor);
 				});
-			}
+			});
 		}
 	}
 
@@ -1665,21 +1918,31 @@ namespace ECSEngine {
 
 	// -------------------------------------------------------------------------------------------------------------------------------
 
-	void GetGLTFMeshesBoundingBox(Stream<GLTFMesh> meshes, AABBScalar* bounding_boxes)
+	void GetGLTFMeshesBoundingBox(Stream<GLTFMesh> meshes, AABBScalar* bounding_boxes, TaskManager* task_manager)
 	{
-		for (size_t index = 0; index < meshes.size; index++) {
-			bounding_boxes[index] = GetGLTFMeshBoundingBox(meshes.buffer + index);
-		}
+		ParallelFor(task_manager, meshes.size, [&](size_t index) {
+			bounding_boxes[index] = GetPositionsBoundingBox(meshes[index].positions, task_manager);
+		});
 	}
 
 	// -------------------------------------------------------------------------------------------------------------------------------
 
-	AABBScalar GetGLTFMeshesCombinedBoundingBox(Stream<GLTFMesh> meshes)
+	AABBScalar GetGLTFMeshesCombinedBoundingBox(Stream<GLTFMesh> meshes, TaskManager* task_manager)
 	{
 		AABBScalar bounding_box = ReverseInfiniteAABBScalar();
-		for (size_t index = 0; index < meshes.size; index++) {
-			AABBScalar current_bounding_box = GetGLTFMeshBoundingBox(meshes.buffer + index);
-			bounding_box = GetCombinedAABB(bounding_box, current_bounding_box);
+		if (task_manager != nullptr) {
+			AABBScalar* bounding_boxes = (AABBScalar*)Malloc(sizeof(AABBScalar) * meshes.size);
+			GetGLTFMeshesBoundingBox(meshes, bounding_boxes, task_manager);
+			for (size_t index = 0; index < meshes.size; index++) {
+				bounding_box = GetCombinedAABB(bounding_box, bounding_boxes[index]);
+			}
+			Free(bounding_boxes);
+		}
+		else {
+			for (size_t index = 0; index < meshes.size; index++) {
+				AABBScalar current_bounding_box = GetGLTFMeshBoundingBox(meshes.buffer + index);
+				bounding_box = GetCombinedAABB(bounding_box, current_bounding_box);
+			}
 		}
 		
 		return bounding_box;
@@ -18,6 +18,8 @@ namespace ECSEngine {
 	};
 	struct MemoryManager;
 	struct Graphics;
+	struct TaskManager;
+	struct MeshOptimizationOptions;
 
 	struct GLTFMesh {
 		GLTFMesh() {}
@@ -45,6 +47,11 @@ namespace ECSEngine {
 	// If it fails it returns a data pointer nullptr
 	ECSENGINE_API GLTFData LoadGLTFFileFromMemory(Stream<void> file_data, AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR, CapacityStream<char>* error_message = nullptr);
 
+	// If it fails it returns a data pointer nullptr. The path is not read, it is used only to resolve
+	// the external buffers that a .gltf file can reference relative to its location. For .glb files the
+	// binary chunk references the file data, so it must be kept alive until the GLTFData is freed
+	ECSENGINE_API GLTFData LoadGLTFFileFromMemory(Stream<void> file_data, Stream<wchar_t> path, AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR, CapacityStream<char>* error_message = nullptr);
+
 	ECSENGINE_API bool LoadMeshFromGLTF(
 		GLTFData data,
 		GLTFMesh& mesh,
@@ -98,6 +105,14 @@ namespace ECSEngine {
 		// and offset the vertices such that the origin is at the center of
 		// the object
 		bool center_object_midpoint = false;
+
+		// If this is set, the primitives are decoded, transformed, scaled and bounded in parallel on this
+		// task manager. The calling thread takes part in the work, so it can be a thread of the task manager
+		TaskManager* task_manager = nullptr;
+
+		// If this is set, the vertices and the indices of the submeshes are optimized after they are decoded,
+		// which can reduce the vertex and index counts. The bounds are computed before the optimization
+		const MeshOptimizationOptions* optimization = nullptr;
 	};
 
 	// Coallesces on the CPU side the values to be directly copied to the GPU
@@ -250,13 +265,16 @@ namespace ECSEngine {
 
 	ECSENGINE_API void FreeGLTFFile(GLTFData data);
 
-	ECSENGINE_API void ScaleGLTFMeshes(Stream<GLTFMesh> meshes, float scale_factor);
+	// If the task manager is specified, the meshes and the vertices of large meshes are split between its threads
+	ECSENGINE_API void ScaleGLTFMeshes(Stream<GLTFMesh> meshes, float scale_factor, TaskManager* task_manager = nullptr);
 	
 	ECSENGINE_API AABBScalar GetGLTFMeshBoundingBox(const GLTFMesh* mesh);
 
-	ECSENGINE_API void GetGLTFMeshesBoundingBox(Stream<GLTFMesh> meshes, AABBScalar* bounding_boxes);
+	// If the task manager is specified, the meshes and the vertices of large meshes are split between its threads
+	ECSENGINE_API void GetGLTFMeshesBoundingBox(Stream<GLTFMesh> meshes, AABBScalar* bounding_boxes, TaskManager* task_manager = nullptr);
 
-	ECSENGINE_API AABBScalar GetGLTFMeshesCombinedBoundingBox(Stream<GLTFMesh> meshes);
+	// If the task manager is specified, the meshes and the vertices of large meshes are split between its threads
+	ECSENGINE_API AABBScalar GetGLTFMeshesCombinedBoundingBox(Stream<GLTFMesh> meshes, TaskManager* task_manager = nullptr);
 
 	// Updates the location of the vertices such that the origin is at the center of the object
 	// Returns the translation that was performed (the center of the previous mesh)
@@ -3,37 +3,63 @@
 #include "../Containers/Stream.h"
 #include "../Containers/Deck.h"
 #include "../Utilities/BasicTypes.h"
+#include "Vector.h"
 
 namespace ECSEngine {
 
 	// This is an acceleration structure that helps to accelerate queries on directions
 	// The directions need to be given in normalized form. It quantizez the [-1.0, 1.0]
 	// Range into equidistant partitions where the directions are gathered based on a certain
-	// Axis. Then you can perform accelerated queries against directions in a certain range
+	// Axis. Then you can perform accelerated queries against directions in a certain range.
+	// When a secondary axis is given, the partitions are a 2D grid over both axes, which
+	// Culls more of the directions for the range queries at the cost of more partitions
 
 	// TODO: Change this name to DirectionPartitioning to better match what it does?
 
-	template<ECS_AXIS axis, typename Entry>
+	template<ECS_AXIS axis, typename Entry, ECS_AXIS secondary_axis = ECS_AXIS_COUNT>
 	struct SphericalPartitioning {
+		static_assert(axis != secondary_axis, "SphericalPartitioning: the secondary axis must be different from the main axis");
+
 		struct Chunk {
-			float3 directions[8];
+			ECS_INLINE float3 Direction(unsigned int index) const {
+				return { xs[index], ys[index], zs[index] };
+			}
+
+			ECS_INLINE void SetDirection(unsigned int index, float3 direction) {
+				xs[index] = direction.x;
+				ys[index] = direction.y;
+				zs[index] = direction.z;
+			}
+
+			// The directions are stored as SoA such that a chunk is compared in a single SIMD pass
+			float xs[8];
+			float ys[8];
+			float zs[8];
 			Entry entries[8];
 			unsigned int count;
 			unsigned int next_chunk;
 		};
 
-		unsigned int GetPartitionIndex(float3 normalized_direction) const {
-			float axis_value = normalized_direction.x;
-			if constexpr (axis == ECS_AXIS_Y) {
-				axis_value = normalized_direction.y;
-			}
-			else if constexpr (axis == ECS_AXIS_Z) {
-				axis_value = normalized_direction.z;
-			}
+		ECS_INLINE constexpr static bool IsTwoDimensional() {
+			return secondary_axis != ECS_AXIS_COUNT;
+		}
+
+		// Returns the partition index along a single axis for the given component value
+		unsigned int GetAxisPartitionIndex(float axis_value) const {
 			axis_value += 1.0f;
-			axis_value *= (float)(partitions.size / 2);
+			axis_value *= (float)axis_partition_count * 0.5f;
+			// Slightly denormalized directions can fall outside the range
+			axis_value = axis_value < 0.0f ? 0.0f : axis_value;
 			unsigned int unsigned_value = (unsigned int)axis_value;
-			return unsigned_value == partitions.size ? partitions.size - 1 : unsigned_value;
+			return unsigned_value >= axis_partition_count ? axis_partition_count - 1 : unsigned_value;
+		}
+
+		unsigned int GetPartitionIndex(float3 normalized_direction) const {
+			unsigned int partition_index = GetAxisPartitionIndex(normalized_direction[axis]);
+			if constexpr (IsTwoDimensional()) {
+				partition_index += GetAxisPartitionIndex(normalized_direction[secondary_axis]) * axis_partition_count;
+			}
+			return partition_index;
 		}
 
 		void Add(float3 normalized_direction, const Entry& entry) {
@@ -45,7 +71,7 @@ namespace ECSEngine {
 			Chunk* chunk_ptr = nullptr;
 			unsigned int chunk_index = partitions[index];
 			if (chunk_index == -1) {
-				chunk_index = chunks.ReserveIndex();
+				chunk_index = chunks.ReserveAndUpdateSize();
 				partitions[index] = chunk_index;
 				chunk_ptr = &chunks[chunk_index];
 				chunk_ptr->count = 0;
@@ -66,18 +92,18 @@ namespace ECSEngine {
 
 		// Chunk must be the last chunk in a chain
 		void AddToChunk(Chunk* chunk, float3 normalized_direction, const Entry& entry) {
-			if (chunk->count < ECS_COUNTOF(chunk->directions)) {
-				chunk->directions[chunk->count] = normalized_direction;
+			if (chunk->count < ECS_COUNTOF(chunk->entries)) {
+				chunk->SetDirection(chunk->count, normalized_direction);
 				chunk->entries[chunk->count] = entry;
 				chunk->count++;
 			}
 			else {
-				size_t new_entry_index = chunks.ReserveIndex();
+				size_t new_entry_index = chunks.ReserveAndUpdateSize();
 				ECS_ASSERT(new_entry_index < UINT_MAX);
 				unsigned int u_new_entry_index = (unsigned int)new_entry_index;
 				chunk->next_chunk = u_new_entry_index;
 				Chunk* new_chunk = &chunks[new_entry_index];
-				new_chunk->directions[0] = normalized_direction;
+				new_chunk->SetDirection(0, normalized_direction);
 				new_chunk->entries[0] = entry;
 				new_chunk->count = 1;
 				new_chunk->next_chunk = -1;
@@ -90,49 +116,107 @@ namespace ECSEngine {
 			AddToChunk(partition_chunk, normal, entry);
 		}
 
-		// The functor receives as parameters (float3 normalized_direction, Entry entry);
+		// Returns a bit mask with the entries of the chunk whose dot product with the direction is in the [min_dot, max_dot] range
+		static unsigned int ECS_VECTORCALL GetChunkDotMask(const Chunk* chunk, Vector3 direction, Vec8f min_dot, Vec8f max_dot) {
+			Vec8f dot = Dot(Vector3(Vec8f().load(chunk->xs), Vec8f().load(chunk->ys), Vec8f().load(chunk->zs)), direction);
+			unsigned int mask = to_bits(dot >= min_dot && dot <= max_dot);
+			return mask & ((1 << chunk->count) - 1);
+		}
+
+		// Returns a bit mask with the entries of the chunk whose components are all in the epsilon range of the direction
+		static unsigned int ECS_VECTORCALL GetChunkEpsilonMask(const Chunk* chunk, Vector3 direction, Vec8f epsilon) {
+			Vec8fb x_mask = abs(Vec8f().load(chunk->xs) - direction.x) <= epsilon;
+			Vec8fb y_mask = abs(Vec8f().load(chunk->ys) - direction.y) <= epsilon;
+			Vec8fb z_mask = abs(Vec8f().load(chunk->zs) - direction.z) <= epsilon;
+			unsigned int mask = to_bits(x_mask && y_mask && z_mask);
+			return mask & ((1 << chunk->count) - 1);
+		}
+
+		// The functor receives as parameter (const Chunk* chunk). For early exit, it must return true to stop
 		template<bool early_exit = false, typename Functor>
-		bool ForEachInPartition(unsigned int partition_index, Functor&& functor) const {
+		bool ForEachChunkInPartition(unsigned int partition_index, Functor&& functor) const {
 			unsigned int chunk_index = partitions[partition_index];
 			if (chunk_index != -1) {
 				const Chunk* chunk = &chunks[chunk_index];
 				while (chunk != nullptr) {
-					for (unsigned int index = 0; index < chunk->count; index++) {
-						if constexpr (early_exit) {
-							if (functor(chunk->directions[index], chunk->entries[index])) {
-								return true;
-							}
-						}
-						else {
-							functor(chunk->directions[index], chunk->entries[index]);
+					if constexpr (early_exit) {
+						if (functor(chunk)) {
+							return true;
 						}
 					}
+					else {
+						functor(chunk);
+					}
 					chunk = chunk->next_chunk == -1 ? nullptr : &chunks[chunk->next_chunk];
 				}
 			}
 			return false;
 		}
 
-		// The functor receives as parameters (float3 normalized_direction, Entry entry)
-		// The strict mode means that only the main partitions is iterated. In non strict mode
-		// The immediate lower and upper partitions are checked as well
+		// The functor receives as parameter (const Chunk* chunk). It visits all the partitions that overlap the [min, max] ranges
+		// Of the partitioned axes. The secondary range is ignored for the single axis partitioning
 		template<bool early_exit = false, typename Functor>
-		bool ForEachEntry(float3 normalized_direction, Functor&& functor, bool strict_mode = true) const {
-			unsigned int partition_index = GetPartitionIndex(normalized_direction);
-			bool exit = ForEachInPartition<early_exit>(partition_index, functor);
-			if (exit) {
-				return true;
-			}
-			if (!strict_mode) {
-				if (partition_index > 0) {
-					exit = ForEachInPartition<early_exit>(partition_index - 1, functor);
-					if (exit) {
+		bool ForEachChunkInAxisRange(float2 range, float2 secondary_range, Functor&& functor) const {
+			unsigned int first_partition = GetAxisPartitionIndex(range.x);
+			unsigned int last_partition = GetAxisPartitionIndex(range.y);
+			unsigned int first_secondary_partition = 0;
+			unsigned int last_secondary_partition = 0;
+			if constexpr (IsTwoDimensional()) {
+				first_secondary_partition = GetAxisPartitionIndex(secondary_range.x);
+				last_secondary_partition = GetAxisPartitionIndex(secondary_range.y);
+			}
+
+			for (unsigned int secondary_index = first_secondary_partition; secondary_index <= last_secondary_partition; secondary_index++) {
+				for (unsigned int index = first_partition; index <= last_partition; index++) {
+					if (ForEachChunkInPartition<early_exit>(secondary_index * axis_partition_count + index, functor)) {
 						return true;
 					}
 				}
-				if (partition_index < partitions.size - 1) {
-					exit = ForEachInPartition<early_exit>(partition_index + 1, functor);
-					if (exit) {
+			}
+			return false;
+		}
+
+		// The functor receives as parameters (float3 normalized_direction, Entry entry);
+		template<bool early_exit = false, typename Functor>
+		bool ForEachInPartition(unsigned int partition_index, Functor&& functor) const {
+			return ForEachChunkInPartition<early_exit>(partition_index, [&](const Chunk* chunk) {
+				for (unsigned int index = 0; index < chunk->count; index++) {
+					if constexpr (early_exit) {
+						if (functor(chunk->Direction(index), chunk->entries[index])) {
+							return true;
+						}
+					}
+					else {
+						functor(chunk->Direction(index), chunk->entries[index]);
+					}
+				}
+				return false;
+			});
+		}
+
+		// The functor receives as parameters (float3 normalized_direction, Entry entry)
+		// The strict mode means that only the main partitions is iterated. In non strict mode
+		// The immediate lower and upper partitions are checked as well, on both axes for the
+		// 2D partitioning
+		template<bool early_exit = false, typename Functor>
+		bool ForEachEntry(float3 normalized_direction, Functor&& functor, bool strict_mode = true) const {
+			if (strict_mode) {
+				return ForEachInPartition<early_exit>(GetPartitionIndex(normalized_direction), functor);
+			}
+
+			auto neighbour_range = [this](float axis_value) {
+				unsigned int partition = GetAxisPartitionIndex(axis_value);
+				return uint2{ partition > 0 ? partition - 1 : 0, partition < axis_partition_count - 1 ? partition + 1 : partition };
+			};
+
+			uint2 range = neighbour_range(normalized_direction[axis]);
+			uint2 secondary_range = { 0, 0 };
+			if constexpr (IsTwoDimensional()) {
+				secondary_range = neighbour_range(normalized_direction[secondary_axis]);
+			}
+			for (unsigned int secondary_index = secondary_range.x; secondary_index <= secondary_range.y; secondary_index++) {
+				for (unsigned int index = range.x; index <= range.y; index++) {
+					if (ForEachInPartition<early_exit>(secondary_index * axis_partition_count + index, functor)) {
 						return true;
 					}
 				}
@@ -143,29 +227,80 @@ namespace ECSEngine {
 		// It will call the functor for each entry that has the components in the given epsilon range
 		template<bool early_exit = false, typename Functor>
 		bool ForEachEntryWithEpsilon(float3 normalized_direction, float epsilon, Functor&& functor, bool strict_mode = true) const {
-			return ForEachEntry<early_exit>(normalized_direction, [&](float3 current_direction, const Entry& current_entry) {
-				if (CompareMask(current_direction, normalized_direction, float3::Splat(epsilon))) {
-					if constexpr (early_exit) {
-						return functor(current_direction, current_entry);
-					}
-					else {
-						functor(current_direction, current_entry);
+			Vector3 simd_direction = Vector3::Splat(normalized_direction);
+			Vec8f simd_epsilon = epsilon;
+			auto chunk_functor = [&](const Chunk* chunk) {
+				unsigned int mask = GetChunkEpsilonMask(chunk, simd_direction, simd_epsilon);
+				return ForEachBit<early_exit>(chunk, mask, functor);
+			};
+
+			if (strict_mode) {
+				return ForEachChunkInPartition<early_exit>(GetPartitionIndex(normalized_direction), chunk_functor);
+			}
+			// The partitions that can contain matches are those that overlap the epsilon range, which
+			// Is a tighter bound than the neighbour partitions for small epsilons
+			float2 range = { normalized_direction[axis] - epsilon, normalized_direction[axis] + epsilon };
+			float2 secondary_range = range;
+			if constexpr (IsTwoDimensional()) {
+				secondary_range = { normalized_direction[secondary_axis] - epsilon, normalized_direction[secondary_axis] + epsilon };
+			}
+			return ForEachChunkInAxisRange<early_exit>(range, secondary_range, chunk_functor);
+		}
+
+		// Calls the functor (float3 normalized_direction, Entry entry) for all the entries whose dot product with the
+		// Given direction is in the [min_dot, max_dot] range. Two unit directions with a dot product of at least min_dot
+		// Have each component closer than sqrt(2 - 2 * min_dot), which bounds the partitions that are visited
+		template<bool early_exit = false, typename Functor>
+		bool ForEachEntryInDotRange(float3 normalized_direction, float min_dot, float max_dot, Functor&& functor) const {
+			Vector3 simd_direction = Vector3::Splat(normalized_direction);
+			Vec8f simd_min_dot = min_dot;
+			Vec8f simd_max_dot = max_dot;
+
+			float component_distance = min_dot >= 1.0f ? 0.0f : sqrt(2.0f - 2.0f * (min_dot < -1.0f ? -1.0f : min_dot));
+			float2 range = { normalized_direction[axis] - component_distance, normalized_direction[axis] + component_distance };
+			float2 secondary_range = range;
+			if constexpr (IsTwoDimensional()) {
+				secondary_range = { normalized_direction[secondary_axis] - component_distance, normalized_direction[secondary_axis] + component_distance };
+			}
+			return ForEachChunkInAxisRange<early_exit>(range, secondary_range, [&](const Chunk* chunk) {
+				unsigned int mask = GetChunkDotMask(chunk, simd_direction, simd_min_dot, simd_max_dot);
+				return ForEachBit<early_exit>(chunk, mask, functor);
+			});
+		}
+
+		// Calls the functor (float3 normalized_direction, Entry entry) for the entries of the chunk that are set in the mask
+		template<bool early_exit = false, typename Functor>
+		static bool ForEachBit(const Chunk* chunk, unsigned int mask, Functor&& functor) {
+			while (mask != 0) {
+				unsigned int index = FirstLSB(mask);
+				mask &= mask - 1;
+				if constexpr (early_exit) {
+					if (functor(chunk->Direction(index), chunk->entries[index])) {
+						return true;
 					}
 				}
-				return false;
-			}, strict_mode);
+				else {
+					functor(chunk->Direction(index), chunk->entries[index]);
+				}
+			}
+			return false;
 		}
 
+		// The partition size is the count of partitions along each partitioned axis. For the 2D partitioning,
+		// There are partition_size * partition_size partitions
 		void Initialize(AllocatorPolymorphic allocator, size_t partition_size, size_t deck_power_exponent, size_t initial_chunk_count) {
-			partitions.Initialize(allocator, partition_size);
+			axis_partition_count = (unsigned int)partition_size;
+			size_t total_partition_count = IsTwoDimensional() ? partition_size * partition_size : partition_size;
+			partitions.Initialize(allocator, total_partition_count);
 			// Make the initial partitions -1
-			memset(partitions.buffer, -1, partitions.MemoryOf(partition_size));
+			memset(partitions.buffer, -1, partitions.MemoryOf(total_partition_count));
 			chunks.Initialize(allocator, initial_chunk_count, deck_power_exponent);
 		}
 
 		DeckPowerOfTwo<Chunk> chunks;
 		// Here store the indices into the values
 		Stream<unsigned int> partitions;
+		unsigned int axis_partition_count;
 	};
 
-}
\ No newline at end of file
+}
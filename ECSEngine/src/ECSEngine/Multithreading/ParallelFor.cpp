@@ -0,0 +1,66 @@
+#include "ecspch.h"
+#include "ParallelFor.h"
+#include "TaskManager.h"
+#include "ConcurrentPrimitives.h"
+
+namespace ECSEngine {
+
+	// The state is allocated with Malloc and it is reference counted, since the helper tasks can start running
+	// after the parallel for has returned, in which case they only release their reference
+	struct ParallelForState {
+		std::atomic<size_t> next_item;
+		std::atomic<size_t> finished_items;
+		std::atomic<unsigned int> reference_count;
+		size_t item_count;
+		ParallelForFunction function;
+		void* functor;
+	};
+
+	static void ParallelForRunItems(ParallelForState* state) {
+		size_t item_index = state->next_item.fetch_add(1, ECS_RELAXED);
+		while (item_index < state->item_count) {
+			state->function(state->functor, item_index);
+			state->finished_items.fetch_add(1, ECS_RELEASE);
+			item_index = state->next_item.fetch_add(1, ECS_RELAXED);
+		}
+	}
+
+	static void ParallelForReleaseState(ParallelForState* state) {
+		if (state->reference_count.fetch_sub(1, ECS_ACQ_REL) == 1) {
+			Free(state);
+		}
+	}
+
+	static ECS_THREAD_TASK(ParallelForHelperTask) {
+		ParallelForState* state = (ParallelForState*)_data;
+		ParallelForRunItems(state);
+		ParallelForReleaseState(state);
+	}
+
+	void ParallelFor(TaskManager* task_manager, size_t item_count, ParallelForFunction function, void* functor) {
+		unsigned int helper_count = task_manager != nullptr ? task_manager->GetThreadCount() - 1 : 0;
+		helper_count = item_count > 0 ? (unsigned int)min((size_t)helper_count, item_count - 1) : 0;
+		if (helper_count == 0) {
+			for (size_t index = 0; index < item_count; index++) {
+				function(functor, index);
+			}
+			return;
+		}
+
+		ParallelForState* state = (ParallelForState*)Malloc(sizeof(ParallelForState));
+		state->next_item.store(0, ECS_RELAXED);
+		state->finished_items.store(0, ECS_RELAXED);
+		state->reference_count.store(helper_count + 1, ECS_RELAXED);
+		state->item_count = item_count;
+		state->function = function;
+		state->functor = functor;
+
+		task_manager->AddDynamicTaskGroupAndWake(ParallelForHelperTask, STRING(ParallelForHelperTask), state, helper_count, 0, true);
+		ParallelForRunItems(state);
+		while (state->finished_items.load(ECS_ACQUIRE) < item_count) {
+			GiveSliceToProcessorThread();
+		}
+		ParallelForReleaseState(state);
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "../Core.h"
+#include "../Utilities/Utilities.h"
+
+namespace ECSEngine {
+
+	struct TaskManager;
+
+	typedef void (*ParallelForFunction)(void* functor, size_t item_index);
+
+	// Calls the function for all items. The items are handed out one at a time to the calling thread and to helper
+	// tasks, such that items of uneven sizes are balanced. The calling thread waits only for the items that are
+	// already in progress, so it can be a task manager thread, even when all the other threads are busy.
+	// Without a task manager, the items are processed serially
+	ECSENGINE_API void ParallelFor(TaskManager* task_manager, size_t item_count, ParallelForFunction function, void* functor);
+
+	// Calls the functor with (size_t item_index) for all items
+	template<typename Functor>
+	ECS_INLINE void ParallelFor(TaskManager* task_manager, size_t item_count, Functor&& functor) {
+		ParallelFor(task_manager, item_count, [](void* functor, size_t item_index) {
+			(*(std::remove_reference_t<Functor>*)functor)(item_index);
+		}, &functor);
+	}
+
+	// Calls the functor with (size_t batch_offset, size_t batch_count, size_t batch_index) for consecutive ranges
+	// of the items. The batches have at least min_batch_size items and there are at most max_batch_count of them.
+	// Returns the batch count. Use ParallelForBatchCount to size the per batch outputs before the call
+	template<typename Functor>
+	ECS_INLINE size_t ParallelForBatches(TaskManager* task_manager, size_t item_count, size_t min_batch_size, size_t max_batch_count, Functor&& functor) {
+		size_t batch_size = max(min_batch_size, SlotsFor(item_count, max_batch_count));
+		size_t batch_count = SlotsFor(item_count, batch_size);
+		ParallelFor(task_manager, batch_count, [&](size_t batch_index) {
+			size_t batch_offset = batch_index * batch_size;
+			functor(batch_offset, min(batch_size, item_count - batch_offset), batch_index);
+		});
+		return batch_count;
+	}
+
+	// Returns the count of batches that ParallelForBatches uses for these parameters
+	ECS_INLINE size_t ParallelForBatchCount(size_t item_count, size_t min_batch_size, size_t max_batch_count) {
+		return SlotsFor(item_count, max(min_batch_size, SlotsFor(item_count, max_batch_count)));
+	}
+
+}
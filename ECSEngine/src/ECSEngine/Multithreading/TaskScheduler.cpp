@@ -89,6 +89,17 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------------
 
+	// Returns true if none of the unique components of the query, including the optional ones, is written
+	static bool IsQueryUniqueReadOnly(const TaskComponentQuery& query) {
+		const ECS_ACCESS_TYPE* component_access = query.ComponentAccess();
+		for (size_t index = 0; index < query.component_count; index++) {
+			if (component_access[index] != ECS_READ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	void TaskScheduler::InitializeSchedulerInfo(World* world)
 	{
 		query_infos.size = 0;
@@ -106,11 +117,13 @@ namespace ECSEngine {
 					ComponentSignature shared_exclude = current_query.ExcludeSharedSignature();
 
 					ArchetypeQueryExclude query{ unique, shared, unique_exclude, shared_exclude };
+					query_infos[query_infos.size].read_only_unique = IsQueryUniqueReadOnly(current_query);
 					query_infos[query_infos.size++].query_handle = world->entity_manager->RegisterQueryCommit(query);
 				}
 				else {
 					if (current_query.component_count > 0 || current_query.shared_component_count > 0) {
 						ArchetypeQuery query{ unique, shared };
+						query_infos[query_infos.size].read_only_unique = IsQueryUniqueReadOnly(current_query);
 						query_infos[query_infos.size++].query_handle = world->entity_manager->RegisterQueryCommit(query);
 					}
 				}
@@ -29,7 +29,9 @@ namespace ECSEngine {
 		unsigned short batch_size;
 
 		unsigned int query_handle;
-
+		// None of the unique components of the query is written, such that the archetype bases whose storage is
+		// Shared after a copy on write can be iterated without cloning them
+		bool read_only_unique;
 
 		union {
 			// The fine locking wrapper data
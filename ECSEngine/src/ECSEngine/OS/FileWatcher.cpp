@@ -0,0 +1,385 @@
+#include "ecspch.h"
+#include "FileWatcher.h"
+#include "FileOS.h"
+#include "../Utilities/Path.h"
+#include "../Utilities/StringUtilities.h"
+#include "../Utilities/ForEachFiles.h"
+
+// The maximum size that ReadDirectoryChangesW accepts for network drives
+#define NOTIFICATION_BUFFER_SIZE ECS_KB * 64
+
+namespace ECSEngine {
+
+	namespace OS {
+
+		struct FileWatcherNative {
+			HANDLE directory_handle;
+			HANDLE event;
+			OVERLAPPED overlapped;
+			// ReadDirectoryChangesW requires the buffer to be DWORD aligned
+			alignas(DWORD) char buffer[NOTIFICATION_BUFFER_SIZE];
+		};
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool IsPathIncluded(const FileWatcher* watcher, Stream<wchar_t> relative_path) {
+			if (watcher->options.include_paths.size > 0) {
+				size_t index = 0;
+				for (; index < watcher->options.include_paths.size; index++) {
+					Stream<wchar_t> include_path = watcher->options.include_paths[index];
+					if (relative_path.StartsWith(include_path) && (relative_path.size == include_path.size
+						|| relative_path[include_path.size] == ECS_OS_PATH_SEPARATOR)) {
+						break;
+					}
+				}
+				if (index == watcher->options.include_paths.size) {
+					return false;
+				}
+			}
+
+			if (watcher->options.extensions.size > 0) {
+				Stream<wchar_t> extension = PathExtension(relative_path);
+				for (size_t index = 0; index < watcher->options.extensions.size; index++) {
+					if (extension == watcher->options.extensions[index]) {
+						return true;
+					}
+				}
+				return false;
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static void AddChange(FileWatcher* watcher, Stream<wchar_t> relative_path, ECS_FILE_WATCHER_CHANGE flags) {
+			if (!IsPathIncluded(watcher, relative_path)) {
+				return;
+			}
+
+			unsigned int table_index = watcher->change_table.Find(relative_path);
+			if (table_index != -1) {
+				FileWatcherChange* change = watcher->changes.buffer + watcher->change_table.GetValueFromIndex(table_index);
+				// A file that was removed and then added again is reported as modified, since
+				// The consumers only care that the contents might be different
+				if ((change->flags & ECS_FILE_WATCHER_CHANGE_REMOVED) != 0 && (flags & ECS_FILE_WATCHER_CHANGE_ADDED) != 0) {
+					change->flags &= ~ECS_FILE_WATCHER_CHANGE_REMOVED;
+					flags = (flags & ~ECS_FILE_WATCHER_CHANGE_ADDED) | ECS_FILE_WATCHER_CHANGE_MODIFIED;
+				}
+				change->flags |= flags;
+			}
+			else {
+				FileWatcherChange change;
+				change.path = StringCopy(watcher->allocator, relative_path);
+				change.flags = flags;
+				unsigned int change_index = watcher->changes.Add(change);
+				watcher->change_table.InsertDynamic(watcher->allocator, change_index, change.path);
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool BeginNativeRead(FileWatcher* watcher) {
+			FileWatcherNative* native = (FileWatcherNative*)watcher->native_data;
+			DWORD notify_filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+			ResetEvent(native->event);
+			memset(&native->overlapped, 0, sizeof(native->overlapped));
+			native->overlapped.hEvent = native->event;
+			return ReadDirectoryChangesW(
+				native->directory_handle,
+				native->buffer,
+				sizeof(native->buffer),
+				watcher->options.recursive,
+				notify_filter,
+				nullptr,
+				&native->overlapped,
+				nullptr
+			);
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static void ParseNativeNotifications(FileWatcher* watcher, DWORD byte_count) {
+			FileWatcherNative* native = (FileWatcherNative*)watcher->native_data;
+			if (byte_count == 0) {
+				// The OS could not fit all the notifications in the buffer and discarded them
+				watcher->overflow = true;
+				return;
+			}
+
+			const char* current = native->buffer;
+			while (true) {
+				const FILE_NOTIFY_INFORMATION* information = (const FILE_NOTIFY_INFORMATION*)current;
+				Stream<wchar_t> relative_path = { information->FileName, information->FileNameLength / sizeof(wchar_t) };
+
+				ECS_FILE_WATCHER_CHANGE flags = ECS_FILE_WATCHER_CHANGE_NONE;
+				switch (information->Action) {
+				case FILE_ACTION_ADDED:
+					flags = ECS_FILE_WATCHER_CHANGE_ADDED;
+					break;
+				case FILE_ACTION_REMOVED:
+					flags = ECS_FILE_WATCHER_CHANGE_REMOVED;
+					break;
+				case FILE_ACTION_MODIFIED:
+					flags = ECS_FILE_WATCHER_CHANGE_MODIFIED;
+					break;
+				case FILE_ACTION_RENAMED_OLD_NAME:
+					flags = ECS_FILE_WATCHER_CHANGE_REMOVED | ECS_FILE_WATCHER_CHANGE_RENAMED;
+					break;
+				case FILE_ACTION_RENAMED_NEW_NAME:
+					flags = ECS_FILE_WATCHER_CHANGE_ADDED | ECS_FILE_WATCHER_CHANGE_RENAMED;
+					break;
+				}
+
+				if (flags != ECS_FILE_WATCHER_CHANGE_NONE) {
+					AddChange(watcher, relative_path, flags);
+				}
+
+				if (information->NextEntryOffset == 0) {
+					break;
+				}
+				current += information->NextEntryOffset;
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static void DeallocateNative(FileWatcher* watcher) {
+			FileWatcherNative* native = (FileWatcherNative*)watcher->native_data;
+			if (native != nullptr) {
+				// Cancel the pending read and wait for it, since the OS writes into the buffer
+				CancelIoEx(native->directory_handle, &native->overlapped);
+				DWORD byte_count = 0;
+				GetOverlappedResult(native->directory_handle, &native->overlapped, &byte_count, TRUE);
+				CloseHandle(native->event);
+				CloseHandle(native->directory_handle);
+				ECSEngine::Deallocate(watcher->allocator, native);
+				watcher->native_data = nullptr;
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool InitializeNative(FileWatcher* watcher) {
+			HANDLE directory_handle = CreateFile(
+				watcher->directory.buffer,
+				FILE_LIST_DIRECTORY,
+				FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+				NULL,
+				OPEN_EXISTING,
+				FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+				NULL
+			);
+			if (directory_handle == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+
+			HANDLE event = CreateEvent(NULL, TRUE, FALSE, NULL);
+			if (event == NULL) {
+				CloseHandle(directory_handle);
+				return false;
+			}
+
+			FileWatcherNative* native = (FileWatcherNative*)Allocate(watcher->allocator, sizeof(FileWatcherNative), alignof(FileWatcherNative));
+			native->directory_handle = directory_handle;
+			native->event = event;
+			watcher->native_data = native;
+
+			if (!BeginNativeRead(watcher)) {
+				// Some file systems do not support the notifications
+				CloseHandle(event);
+				CloseHandle(directory_handle);
+				ECSEngine::Deallocate(watcher->allocator, native);
+				watcher->native_data = nullptr;
+				return false;
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static void UpdateNative(FileWatcher* watcher) {
+			FileWatcherNative* native = (FileWatcherNative*)watcher->native_data;
+
+			DWORD byte_count = 0;
+			while (GetOverlappedResult(native->directory_handle, &native->overlapped, &byte_count, FALSE)) {
+				ParseNativeNotifications(watcher, byte_count);
+				if (!BeginNativeRead(watcher)) {
+					// The directory might have been deleted or moved. Report an overflow
+					// Such that the consumer rescans and continue by polling
+					DeallocateNative(watcher);
+					watcher->overflow = true;
+					return;
+				}
+			}
+
+			if (GetLastError() != ERROR_IO_INCOMPLETE) {
+				DeallocateNative(watcher);
+				watcher->overflow = true;
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		// When report_changes is false, it only records the current state
+		static void ScanPolling(FileWatcher* watcher, bool report_changes) {
+			watcher->polling_scan_index++;
+
+			auto functor = [watcher, report_changes](Stream<wchar_t> path) {
+				Stream<wchar_t> relative_path = path.SliceAt(watcher->directory.size + 1);
+				if (!IsPathIncluded(watcher, relative_path)) {
+					return true;
+				}
+
+				size_t last_write = 0;
+				if (!GetFileTimes(path, nullptr, nullptr, &last_write)) {
+					// The file might have been removed in the meantime, it will be reported as removed
+					return true;
+				}
+
+				unsigned int table_index = watcher->polling_entries.Find(relative_path);
+				if (table_index == -1) {
+					FileWatcher::PollingEntry entry = { last_write, watcher->polling_scan_index };
+					watcher->polling_entries.InsertDynamic(watcher->allocator, entry, StringCopy(watcher->allocator, relative_path));
+					if (report_changes) {
+						AddChange(watcher, relative_path, ECS_FILE_WATCHER_CHANGE_ADDED);
+					}
+				}
+				else {
+					FileWatcher::PollingEntry* entry = watcher->polling_entries.GetValuePtrFromIndex(table_index);
+					entry->scan_index = watcher->polling_scan_index;
+					if (entry->last_write != last_write) {
+						entry->last_write = last_write;
+						if (report_changes) {
+							AddChange(watcher, relative_path, ECS_FILE_WATCHER_CHANGE_MODIFIED);
+						}
+					}
+				}
+				return true;
+			};
+
+			if (watcher->options.recursive) {
+				ForEachFileInDirectoryRecursive(watcher->directory, functor);
+			}
+			else {
+				ForEachFileInDirectory(watcher->directory, functor);
+			}
+
+			// The entries that were not seen in this scan were removed
+			watcher->polling_entries.ForEachIndex([&](unsigned int index) {
+				const FileWatcher::PollingEntry* entry = watcher->polling_entries.GetValuePtrFromIndex(index);
+				if (entry->scan_index != watcher->polling_scan_index) {
+					Stream<wchar_t> relative_path = watcher->polling_entries.GetIdentifierFromIndex(index).AsWide();
+					if (report_changes) {
+						AddChange(watcher, relative_path, ECS_FILE_WATCHER_CHANGE_REMOVED);
+					}
+					ECSEngine::Deallocate(watcher->allocator, relative_path.buffer);
+					watcher->polling_entries.EraseFromIndex(index);
+					return true;
+				}
+				return false;
+			});
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static void DeallocatePolling(FileWatcher* watcher) {
+			watcher->polling_entries.ForEachConst([watcher](const FileWatcher::PollingEntry& entry, ResourceIdentifier identifier) {
+				ECSEngine::Deallocate(watcher->allocator, identifier.ptr);
+			});
+			watcher->polling_entries.Deallocate(watcher->allocator);
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		void FileWatcher::ClearChanges()
+		{
+			for (unsigned int index = 0; index < changes.size; index++) {
+				ECSEngine::Deallocate(allocator, changes[index].path.buffer);
+			}
+			changes.Clear();
+			change_table.Clear();
+			overflow = false;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		void FileWatcher::Deallocate()
+		{
+			if (!IsInitialized()) {
+				return;
+			}
+
+			ClearChanges();
+			changes.FreeBuffer();
+			change_table.Deallocate(allocator);
+
+			if (IsPolling()) {
+				DeallocatePolling(this);
+			}
+			else {
+				DeallocateNative(this);
+			}
+
+			// The coalesced copies are a single allocation each
+			options.include_paths.Deallocate(allocator);
+			options.extensions.Deallocate(allocator);
+			directory.Deallocate(allocator);
+			memset(this, 0, sizeof(*this));
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		bool FileWatcher::Initialize(AllocatorPolymorphic _allocator, Stream<wchar_t> _directory, const FileWatcherOptions& _options)
+		{
+			memset(this, 0, sizeof(*this));
+			if (!ExistsFileOrFolder(_directory)) {
+				return false;
+			}
+
+			allocator = _allocator;
+			// Remove a trailing separator, since the relative paths are obtained by skipping the directory and a separator
+			if (_directory.size > 0 && _directory.Last() == ECS_OS_PATH_SEPARATOR) {
+				_directory.size--;
+			}
+			// The copy is null terminated, as the OS functions expect
+			directory = StringCopy(allocator, _directory);
+			options = _options;
+			options.include_paths = StreamCoalescedDeepCopy(_options.include_paths, allocator);
+			options.extensions = StreamCoalescedDeepCopy(_options.extensions, allocator);
+
+			changes.Initialize(allocator, 0);
+			polling_timer.SetNewStart();
+
+			if (options.force_polling || !InitializeNative(this)) {
+				// Record the current state, such that only the following changes are reported
+				ScanPolling(this, false);
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		void FileWatcher::Update()
+		{
+			if (!IsInitialized()) {
+				return;
+			}
+
+			if (!IsPolling()) {
+				UpdateNative(this);
+				if (IsPolling()) {
+					// The native watching failed, record the current state such that the polling can continue from it
+					ScanPolling(this, false);
+				}
+			}
+			else if (polling_timer.HasPassedAndReset(ECS_TIMER_DURATION_MS, (float)options.polling_interval_ms)) {
+				ScanPolling(this, true);
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+	}
+
+}
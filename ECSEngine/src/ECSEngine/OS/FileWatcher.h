@@ -0,0 +1,111 @@
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Containers/HashTable.h"
+#include "../Utilities/Timer.h"
+
+namespace ECSEngine {
+
+	namespace OS {
+
+#define ECS_FILE_WATCHER_DEFAULT_POLLING_INTERVAL_MS 1000
+
+		enum ECS_FILE_WATCHER_CHANGE : unsigned char {
+			ECS_FILE_WATCHER_CHANGE_NONE = 0,
+			ECS_FILE_WATCHER_CHANGE_ADDED = 1 << 0,
+			ECS_FILE_WATCHER_CHANGE_REMOVED = 1 << 1,
+			ECS_FILE_WATCHER_CHANGE_MODIFIED = 1 << 2,
+			// Set together with added for the new name and together with removed for the old name
+			ECS_FILE_WATCHER_CHANGE_RENAMED = 1 << 3
+		};
+
+		ECS_ENUM_BITWISE_OPERATIONS(ECS_FILE_WATCHER_CHANGE);
+
+		struct FileWatcherChange {
+			// Relative to the watched directory, using the OS path separator
+			Stream<wchar_t> path;
+			// All the notifications that were received for this path since the changes were last cleared
+			ECS_FILE_WATCHER_CHANGE flags;
+		};
+
+		struct FileWatcherOptions {
+			// Only the changes whose relative path is inside one of these relative directories (or is one of these
+			// Relative files) are kept. When empty, all the changes are kept
+			Stream<Stream<wchar_t>> include_paths = {};
+			// Only the files with one of these extensions (with the dot) are kept. When empty, all the files are kept
+			Stream<Stream<wchar_t>> extensions = {};
+			bool recursive = true;
+			// Don't use the OS notifications, rescan the directory instead
+			bool force_polling = false;
+			size_t polling_interval_ms = ECS_FILE_WATCHER_DEFAULT_POLLING_INTERVAL_MS;
+		};
+
+		/*
+			Reports the files that changed inside a directory, such that the callers don't need to walk the entire directory
+			And stat every file to find out what changed. It uses the OS directory change notifications and falls back to
+			Rescanning the directory at an interval when they are not available (or when requested). Multiple notifications
+			For the same path are coalesced into a single change, and the changes are accumulated until they are cleared,
+			Such that a consumer can process them in a batch. Everything must be called from the same thread.
+		*/
+		struct ECSENGINE_API FileWatcher {
+			// Releases the paths of the current changes and resets the overflow flag
+			void ClearChanges();
+
+			void Deallocate();
+
+			ECS_INLINE Stream<FileWatcherChange> GetChanges() const {
+				return changes.ToStream();
+			}
+
+			// If this returns true, the changes should be retrieved and then cleared
+			ECS_INLINE bool HasChanges() const {
+				return changes.size > 0 || overflow;
+			}
+
+			// Returns true if the directory can be watched. If the OS notifications cannot be used for this directory,
+			// It will use polling and still return true. The include paths and the extensions are copied
+			bool Initialize(AllocatorPolymorphic allocator, Stream<wchar_t> directory, const FileWatcherOptions& options = {});
+
+			ECS_INLINE bool IsInitialized() const {
+				return directory.size > 0;
+			}
+
+			ECS_INLINE bool IsPolling() const {
+				return native_data == nullptr;
+			}
+
+			// When this is set, some notifications were lost because too many changes happened at once.
+			// The consumer should rescan everything that it is interested in
+			ECS_INLINE bool IsOverflowed() const {
+				return overflow;
+			}
+
+			// Must be called periodically. It does not block, it only collects the notifications that already arrived
+			void Update();
+
+			struct PollingEntry {
+				size_t last_write;
+				unsigned int scan_index;
+			};
+
+			AllocatorPolymorphic allocator;
+			Stream<wchar_t> directory;
+			FileWatcherOptions options;
+			bool overflow;
+
+			ResizableStream<FileWatcherChange> changes;
+			// Maps a relative path to its index inside the changes, such that repeated notifications are merged
+			HashTableDefault<unsigned int> change_table;
+
+			// The OS specific state. It is nullptr when polling
+			void* native_data;
+
+			// These are used only when polling
+			HashTableDefault<PollingEntry> polling_entries;
+			unsigned int polling_scan_index;
+			Timer polling_timer;
+		};
+
+	}
+
+}
@@ -1,6 +1,7 @@
 #include "ecspch.h"
 #include "AllocatorProfiling.h"
 #include "../Containers/SoA.h"
+#include "CPUFrameProfilerGlobal.h"
 
 namespace ECSEngine {
 
@@ -48,6 +49,7 @@ namespace ECSEngine {
 			entry_data[index].peak_memory_usage = 0;
 			entry_data[index].peak_block_count = 0;
 			entry_data[index].peak_suballocator_count = 0;
+			entry_data[index].reclaimed_memory = 0;
 			entry_data[index].lock.Unlock();
 			entry_data[index].custom_usage = custom_usage_function;
 			entry_data[index].custom_exit = custom_exit_function;
@@ -87,6 +89,15 @@ namespace ECSEngine {
 		entry_data[index].current_frame_deallocations.fetch_add(1, ECS_RELAXED);
 	}
 
+	void AllocatorProfiling::AddReclaimedMemory(const void* address, size_t byte_count)
+	{
+		size_t index = Find(address);
+		// The allocator might not be registered, in which case there is nothing to record
+		if (index != -1) {
+			entry_data[index].reclaimed_memory.fetch_add(byte_count, ECS_RELAXED);
+		}
+	}
+
 	void AllocatorProfiling::Clear()
 	{
 		for (unsigned int index = 0; index < address_size; index++) {
@@ -131,6 +142,9 @@ namespace ECSEngine {
 				current_usage = GetAllocatorCurrentUsage(AllocatorPolymorphic{ (AllocatorBase*)addresses[index] });
 			}
 			entry_data[index].current_usage.Add(current_usage);
+			// Let the CPU capture record the usage as well, such that it can be seen alongside the frame timeline.
+			// It is sampled once per frame, recording it per allocation would flood the capture
+			CPUFrameProfilerCounter(entry_data[index].name, current_usage);
 			entry_data[index].allocations.Add(entry_data[index].current_frame_allocations);
 			entry_data[index].deallocations.Add(entry_data[index].current_frame_deallocations);
 			
@@ -145,6 +159,12 @@ namespace ECSEngine {
 		return SearchBytes(addresses, address_size, (size_t)address);
 	}
 
+	size_t AllocatorProfiling::GetReclaimedMemory(const void* address) const
+	{
+		size_t index = Find(address);
+		return index != -1 ? entry_data[index].reclaimed_memory.load(ECS_RELAXED) : 0;
+	}
+
 	void AllocatorProfiling::Initialize(AllocatorPolymorphic _allocator, unsigned int _entry_capacity)
 	{
 		const size_t INITIAL_COUNT = 8;
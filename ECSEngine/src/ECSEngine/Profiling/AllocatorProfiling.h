@@ -30,6 +30,10 @@ namespace ECSEngine {
 
 		void AddDeallocation(const void* address);
 
+		// Records memory that was given back to the allocator by a compaction or a trim of its user,
+		// As opposed to the regular deallocations
+		void AddReclaimedMemory(const void* address, size_t byte_count);
+
 		// This will clear everything
 		// And remove all allocators (and exit them from the profiling mode)
 		void Clear();
@@ -43,6 +47,10 @@ namespace ECSEngine {
 		// Returns -1 if it doesn't find it
 		size_t Find(const void* address) const;
 
+		// Returns the total byte count that was recorded with AddReclaimedMemory for the allocator,
+		// Or 0 if the allocator is not profiled
+		size_t GetReclaimedMemory(const void* address) const;
+
 		void Initialize(AllocatorPolymorphic allocator, unsigned int entry_capacity);
 
 		void RemoveEntry(const void* address);
@@ -74,6 +82,8 @@ namespace ECSEngine {
 			SpinLock lock;
 			unsigned int current_frame_allocations;
 			std::atomic<unsigned int> current_frame_deallocations;
+			// The total byte count that was reported as reclaimed since the entry was added
+			std::atomic<size_t> reclaimed_memory;
 
 			// All these values are per frame
 			Statistic<unsigned int> allocations;
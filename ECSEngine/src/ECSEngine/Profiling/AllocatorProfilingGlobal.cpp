@@ -32,4 +32,14 @@ namespace ECSEngine {
 		ECS_ALLOCATOR_PROFILING_GLOBAL->AddDeallocation(address);
 	}
 
+	void AllocatorProfilingAddReclaimedMemory(const void* address, size_t byte_count)
+	{
+		ECS_ALLOCATOR_PROFILING_GLOBAL->AddReclaimedMemory(address, byte_count);
+	}
+
+	size_t AllocatorProfilingGetReclaimedMemory(const void* address)
+	{
+		return ECS_ALLOCATOR_PROFILING_GLOBAL->GetReclaimedMemory(address);
+	}
+
 }
\ No newline at end of file
@@ -32,4 +32,9 @@ namespace ECSEngine {
 
 	ECSENGINE_API void AllocatorProfilingAddDeallocation(const void* address);
 
+	ECSENGINE_API void AllocatorProfilingAddReclaimedMemory(const void* address, size_t byte_count);
+
+	// Returns 0 if the allocator is not profiled
+	ECSENGINE_API size_t AllocatorProfilingGetReclaimedMemory(const void* address);
+
 }
\ No newline at end of file
@@ -162,6 +162,10 @@ namespace ECSEngine {
 
 	void CPUFrameProfiler::Clear()
 	{
+		// The captured events reference the entry names, which are released with the thread arenas
+		if (capture != nullptr) {
+			capture->CopyEventNames();
+		}
 		// Clear every thread, unitialize the timer and clear the frame statistics
 		for (size_t index = 0; index < threads.size; index++) {
 			threads[index].Clear();
@@ -182,6 +186,9 @@ namespace ECSEngine {
 		for (size_t index = 0; index < threads.size; index++) {
 			threads[index].EndFrame(frame_cycle_delta);
 		}
+		if (capture != nullptr) {
+			capture->AddFrame(start_frame_cycle_count, frame_cycle_stamp);
+		}
 	}
 
 	float CPUFrameProfiler::GetSimulationFrameTime(ECS_STATISTIC_VALUE_TYPE value_type) const
@@ -211,11 +218,20 @@ namespace ECSEngine {
 	void CPUFrameProfiler::Push(unsigned int thread_id, Stream<char> name, unsigned char tag)
 	{
 		threads[thread_id].Push(name, entry_capacity, tag);
+		if (capture != nullptr) {
+			capture->BeginScope(thread_id);
+		}
 	}
 
 	void CPUFrameProfiler::Pop(unsigned int thread_id, float value)
 	{
-		threads[thread_id].Pop(value);
+		CPUFrameProfilerThread* thread = &threads[thread_id];
+		thread->Pop(value);
+		if (capture != nullptr) {
+			// The entry name lives in the thread arena, such that it is stable until the next Clear
+			const CPUFrameProfilerEntry* entry = &thread->roots[thread->root_index][thread->child_index];
+			capture->EndScope(thread_id, entry->name, entry->tag);
+		}
 	}
 
 	size_t CPUFrameProfiler::ReduceCPUUsageToSamplesToGraph(unsigned int thread_id, Stream<float2> samples, double spike_threshold, unsigned int sample_offset) const {
@@ -272,6 +288,7 @@ namespace ECSEngine {
 		overall_frame_time.Initialize(allocator, entry_capacity);
 		timer.SetUninitialized();
 		start_frame_cycle_count = 0;
+		capture = nullptr;
 	}
 
 	void CPUFrameProfiler::Initialize(
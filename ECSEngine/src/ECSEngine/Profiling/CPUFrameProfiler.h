@@ -5,6 +5,7 @@
 #include "../Containers/Stacks.h"
 #include "../Allocators/MemoryManager.h"
 #include "../Utilities/Timer.h"
+#include "CPUFrameProfilerCapture.h"
 
 namespace ECSEngine {
 
@@ -135,6 +136,11 @@ namespace ECSEngine {
 		// An accurate result
 		void RefreshOverallTime();
 
+		// The capture must be initialized with the same thread count. It can be nullptr to detach it
+		ECS_INLINE void SetCapture(CPUFrameProfilerCapture* _capture) {
+			capture = _capture;
+		}
+
 		void StartFrame();
 
 		Stream<CPUFrameProfilerThread> threads;
@@ -150,6 +156,8 @@ namespace ECSEngine {
 		// time is deduced from the next StartFrame call which will determine the value from start
 		Timer timer;
 		size_t start_frame_cycle_count;
+		// When set, the scopes and the frames are also recorded with their timestamps
+		CPUFrameProfilerCapture* capture;
 	};
 
 }
\ No newline at end of file
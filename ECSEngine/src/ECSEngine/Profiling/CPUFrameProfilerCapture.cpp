@@ -0,0 +1,369 @@
+#include "ecspch.h"
+#include "CPUFrameProfilerCapture.h"
+#include "../Utilities/File.h"
+#include "../Utilities/StringUtilities.h"
+#include "../Utilities/Utilities.h"
+
+#define NAME_TABLE_INITIAL_CAPACITY 256
+#define EXPORT_BUFFERING_CAPACITY ECS_KB * 64
+#define EXPORT_MAX_NAME_SIZE 512
+
+namespace ECSEngine {
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static size_t RingCapacity(unsigned int capacity) {
+		return IsPowerOfTwo(capacity) ? capacity : PowerOfTwoGreater(capacity);
+	}
+
+	// Calls the functor for each event that is still present in the ring, from the oldest to the newest
+	template<typename Functor>
+	static bool ForEachRingEvent(CPUFrameProfilerCaptureEvent* events, size_t write_index, size_t mask, Functor&& functor) {
+		size_t capacity = mask + 1;
+		size_t first_index = write_index > capacity ? write_index - capacity : 0;
+		for (size_t index = first_index; index < write_index; index++) {
+			if (!functor(events + (index & mask))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Reserves the next slot of a ring that can be written from multiple threads
+	static CPUFrameProfilerCaptureEvent* AcquireSharedRingEvent(CPUFrameProfilerCaptureEvent* events, std::atomic<size_t>& write_index, size_t mask) {
+		size_t index = write_index.fetch_add(1, ECS_RELAXED);
+		return events + (index & mask);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::AddMarker(unsigned int thread_id, Stream<char> name)
+	{
+		if (capturing) {
+			CPUFrameProfilerCaptureEvent* event = nullptr;
+			if (thread_id == -1) {
+				event = AcquireSharedRingEvent(frame_events, frame_write_index, frame_event_mask);
+			}
+			else {
+				CPUFrameProfilerCaptureThread* thread = threads.buffer + thread_id;
+				event = thread->events + (thread->write_index & thread_event_mask);
+				thread->write_index++;
+			}
+			event->start = OS::Rdtsc();
+			event->end = event->start;
+			event->name = name.buffer;
+			event->name_size = name.size;
+			event->type = ECS_CPU_FRAME_PROFILER_CAPTURE_MARKER;
+			event->tag = 0;
+			event->thread_id = USHORT_MAX;
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::AddCounter(Stream<char> name, size_t value)
+	{
+		if (capturing) {
+			CPUFrameProfilerCaptureEvent* event = AcquireSharedRingEvent(counter_events, counter_write_index, counter_event_mask);
+			event->start = OS::Rdtsc();
+			event->end = value;
+			event->name = name.buffer;
+			event->name_size = name.size;
+			event->type = ECS_CPU_FRAME_PROFILER_CAPTURE_COUNTER;
+			event->tag = 0;
+			event->thread_id = USHORT_MAX;
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::AddFrame(size_t start, size_t end)
+	{
+		if (capturing) {
+			CPUFrameProfilerCaptureEvent* event = AcquireSharedRingEvent(frame_events, frame_write_index, frame_event_mask);
+			event->start = start;
+			event->end = end;
+			event->name = "Frame";
+			event->name_size = 5;
+			event->type = ECS_CPU_FRAME_PROFILER_CAPTURE_FRAME;
+			event->tag = 0;
+			event->thread_id = USHORT_MAX;
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::CopyEventNames()
+	{
+		auto copy_name = [&](CPUFrameProfilerCaptureEvent* event) {
+			Stream<char> name = { event->name, event->name_size };
+			unsigned int table_index = names.Find(name);
+			if (table_index == -1) {
+				name = StringCopy(allocator, name);
+				names.InsertDynamic(allocator, name, name);
+			}
+			else {
+				name = names.GetValueFromIndex(table_index);
+			}
+			event->name = name.buffer;
+			return true;
+		};
+
+		for (size_t index = 0; index < threads.size; index++) {
+			ForEachRingEvent(threads[index].events, threads[index].write_index, thread_event_mask, copy_name);
+		}
+		ForEachRingEvent(frame_events, frame_write_index.load(ECS_RELAXED), frame_event_mask, copy_name);
+		ForEachRingEvent(counter_events, counter_write_index.load(ECS_RELAXED), counter_event_mask, copy_name);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::Deallocate()
+	{
+		HashTableDeallocate<true, false>(names, allocator);
+		for (size_t index = 0; index < threads.size; index++) {
+			ECSEngine::Deallocate(allocator, threads[index].events);
+		}
+		ECSEngine::Deallocate(allocator, threads.buffer);
+		ECSEngine::Deallocate(allocator, frame_events);
+		ECSEngine::Deallocate(allocator, counter_events);
+		threads = {};
+		frame_events = nullptr;
+		counter_events = nullptr;
+		capturing = false;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Writes the string between quotes, escaping the characters that JSON doesn't accept
+	static void AddJSONString(CapacityStream<char>& characters, Stream<char> string) {
+		characters.Add('"');
+		string.size = min(string.size, (size_t)EXPORT_MAX_NAME_SIZE);
+		for (size_t index = 0; index < string.size; index++) {
+			char character = string[index];
+			if (character == '"' || character == '\\') {
+				characters.Add('\\');
+				characters.Add(character);
+			}
+			else if ((unsigned char)character < ' ') {
+				characters.Add(' ');
+			}
+			else {
+				characters.Add(character);
+			}
+		}
+		characters.Add('"');
+	}
+
+	bool CPUFrameProfilerCapture::ExportChromeTrace(Stream<wchar_t> path, CapacityStream<char>* error_message)
+	{
+		// The rings are written without synchronization, the events could be torn while they are read
+		if (capturing) {
+			ECS_FORMAT_ERROR_MESSAGE(error_message, "Cannot export the CPU profiler trace {#} while the capture is active", path);
+			return false;
+		}
+
+		ECS_FILE_HANDLE file_handle = -1;
+		ECS_FILE_STATUS_FLAGS status = FileCreate(path, &file_handle, ECS_FILE_ACCESS_WRITE_ONLY | ECS_FILE_ACCESS_TEXT | ECS_FILE_ACCESS_TRUNCATE_FILE,
+			ECS_FILE_CREATE_READ_WRITE, error_message);
+		if (status != ECS_FILE_STATUS_OK) {
+			return false;
+		}
+
+		double cycles_per_microsecond = stop_duration_ns == 0 ? 1.0 : (double)(stop_cycles - start_cycles) / ((double)stop_duration_ns / 1000.0);
+		auto to_microseconds = [&](size_t cycles) {
+			// The frame spans can start slightly before the capture
+			return cycles < start_cycles ? 0.0 : (double)(cycles - start_cycles) / cycles_per_microsecond;
+		};
+
+		CapacityStream<void> buffering;
+		buffering.Initialize(ECS_MALLOC_ALLOCATOR, EXPORT_BUFFERING_CAPACITY);
+
+		bool write_failed = false;
+		bool is_first_event = true;
+		ECS_STACK_CAPACITY_STREAM(char, line, EXPORT_MAX_NAME_SIZE * 2 + 512);
+		auto write_line = [&]() {
+			if (!WriteFile(file_handle, line.ToStream(), buffering)) {
+				write_failed = true;
+			}
+			line.size = 0;
+			return !write_failed;
+		};
+		auto begin_event = [&]() {
+			line.AddStreamAssert(is_first_event ? "\n{" : ",\n{");
+			is_first_event = false;
+		};
+
+		line.AddStreamAssert("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		write_line();
+
+		// The frames get their own track, after the threads
+		unsigned int frame_track = threads.size;
+		for (unsigned int index = 0; index <= threads.size && !write_failed; index++) {
+			begin_event();
+			FormatString(line, "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{#},\"args\":{\"name\":", index);
+			if (index == frame_track) {
+				line.AddStreamAssert("\"Frames\"}}");
+			}
+			else {
+				FormatString(line, "\"Thread {#}\"}}", index);
+			}
+			write_line();
+		}
+
+		for (unsigned int index = 0; index < threads.size && !write_failed; index++) {
+			ForEachRingEvent(threads[index].events, threads[index].write_index, thread_event_mask, [&](const CPUFrameProfilerCaptureEvent* event) {
+				begin_event();
+				line.AddStreamAssert("\"name\":");
+				AddJSONString(line, { event->name, event->name_size });
+				double start = to_microseconds(event->start);
+				if (event->type == ECS_CPU_FRAME_PROFILER_CAPTURE_MARKER) {
+					FormatString(line, ",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":{#},\"ts\":{#}}", index, start);
+				}
+				else {
+					double duration = to_microseconds(event->end) - start;
+					FormatString(line, ",\"ph\":\"X\",\"pid\":0,\"tid\":{#},\"ts\":{#},\"dur\":{#},\"args\":{\"tag\":{#}}}", index, start, duration, (unsigned int)event->tag);
+				}
+				return write_line();
+			});
+		}
+
+		auto write_shared_event = [&](const CPUFrameProfilerCaptureEvent* event) {
+			begin_event();
+			line.AddStreamAssert("\"name\":");
+			AddJSONString(line, { event->name, event->name_size });
+			double start = to_microseconds(event->start);
+			if (event->type == ECS_CPU_FRAME_PROFILER_CAPTURE_COUNTER) {
+				FormatString(line, ",\"ph\":\"C\",\"pid\":0,\"ts\":{#},\"args\":{\"value\":{#}}}", start, event->end);
+			}
+			else if (event->type == ECS_CPU_FRAME_PROFILER_CAPTURE_MARKER) {
+				FormatString(line, ",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":{#},\"ts\":{#}}", frame_track, start);
+			}
+			else {
+				double duration = to_microseconds(event->end) - start;
+				FormatString(line, ",\"ph\":\"X\",\"pid\":0,\"tid\":{#},\"ts\":{#},\"dur\":{#}}", frame_track, start, duration);
+			}
+			return write_line();
+		};
+
+		if (!write_failed) {
+			ForEachRingEvent(frame_events, frame_write_index.load(ECS_RELAXED), frame_event_mask, write_shared_event);
+		}
+		if (!write_failed) {
+			ForEachRingEvent(counter_events, counter_write_index.load(ECS_RELAXED), counter_event_mask, write_shared_event);
+		}
+
+		if (!write_failed) {
+			line.AddStreamAssert("\n]}\n");
+			write_line();
+		}
+
+		bool close_success = CloseFile(file_handle, buffering);
+		buffering.Deallocate(ECS_MALLOC_ALLOCATOR);
+		if (write_failed || !close_success) {
+			ECS_FORMAT_ERROR_MESSAGE(error_message, "Failed to write the CPU profiler trace {#}", path);
+			return false;
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	size_t CPUFrameProfilerCapture::GetDroppedEventCount() const
+	{
+		size_t dropped_count = 0;
+		for (size_t index = 0; index < threads.size; index++) {
+			if (threads[index].write_index > thread_event_mask + 1) {
+				dropped_count += threads[index].write_index - thread_event_mask - 1;
+			}
+		}
+		auto add_shared_dropped_count = [&](const std::atomic<size_t>& write_index, size_t mask) {
+			size_t write_count = write_index.load(ECS_RELAXED);
+			if (write_count > mask + 1) {
+				dropped_count += write_count - mask - 1;
+			}
+		};
+		add_shared_dropped_count(frame_write_index, frame_event_mask);
+		add_shared_dropped_count(counter_write_index, counter_event_mask);
+		return dropped_count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::Initialize(
+		AllocatorPolymorphic _allocator,
+		unsigned int thread_count,
+		unsigned int thread_event_capacity,
+		unsigned int frame_event_capacity,
+		unsigned int counter_event_capacity
+	)
+	{
+		allocator = _allocator;
+		thread_event_mask = RingCapacity(thread_event_capacity) - 1;
+		frame_event_mask = RingCapacity(frame_event_capacity) - 1;
+		counter_event_mask = RingCapacity(counter_event_capacity) - 1;
+
+		static_assert((sizeof(CPUFrameProfilerCaptureThread) % ECS_CACHE_LINE_SIZE) == 0);
+
+		// Align these to a cache line boundary such that the threads don't false share the write indices
+		void* threads_allocation = ECSEngine::Allocate(allocator, threads.MemoryOf(thread_count), ECS_CACHE_LINE_SIZE);
+		threads.InitializeFromBuffer(threads_allocation, thread_count);
+		for (unsigned int index = 0; index < thread_count; index++) {
+			threads[index].events = (CPUFrameProfilerCaptureEvent*)ECSEngine::Allocate(
+				allocator,
+				sizeof(CPUFrameProfilerCaptureEvent) * (thread_event_mask + 1),
+				ECS_CACHE_LINE_SIZE
+			);
+			threads[index].write_index = 0;
+			threads[index].depth = 0;
+		}
+		frame_events = (CPUFrameProfilerCaptureEvent*)ECSEngine::Allocate(
+			allocator,
+			sizeof(CPUFrameProfilerCaptureEvent) * (frame_event_mask + 1),
+			ECS_CACHE_LINE_SIZE
+		);
+		counter_events = (CPUFrameProfilerCaptureEvent*)ECSEngine::Allocate(
+			allocator,
+			sizeof(CPUFrameProfilerCaptureEvent) * (counter_event_mask + 1),
+			ECS_CACHE_LINE_SIZE
+		);
+		frame_write_index.store(0, ECS_RELAXED);
+		counter_write_index.store(0, ECS_RELAXED);
+		names.Initialize(allocator, NAME_TABLE_INITIAL_CAPACITY);
+
+		capturing = false;
+		timer.SetUninitialized();
+		start_cycles = 0;
+		stop_cycles = 0;
+		stop_duration_ns = 0;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::Start()
+	{
+		for (size_t index = 0; index < threads.size; index++) {
+			threads[index].write_index = 0;
+		}
+		frame_write_index.store(0, ECS_RELAXED);
+		counter_write_index.store(0, ECS_RELAXED);
+		timer.SetNewStart();
+		start_cycles = OS::Rdtsc();
+		capturing = true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void CPUFrameProfilerCapture::Stop()
+	{
+		if (capturing) {
+			stop_cycles = OS::Rdtsc();
+			stop_duration_ns = timer.GetDuration(ECS_TIMER_DURATION_NS);
+			capturing = false;
+			CopyEventNames();
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+}
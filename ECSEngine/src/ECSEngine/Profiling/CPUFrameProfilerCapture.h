@@ -0,0 +1,148 @@
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Containers/HashTable.h"
+#include "../Utilities/Timer.h"
+#include "../OS/Misc.h"
+
+namespace ECSEngine {
+
+#define ECS_CPU_FRAME_PROFILER_CAPTURE_THREAD_EVENT_CAPACITY (1 << 16)
+#define ECS_CPU_FRAME_PROFILER_CAPTURE_FRAME_EVENT_CAPACITY (1 << 14)
+#define ECS_CPU_FRAME_PROFILER_CAPTURE_COUNTER_EVENT_CAPACITY (1 << 16)
+#define ECS_CPU_FRAME_PROFILER_CAPTURE_MAX_DEPTH 64
+
+	enum ECS_CPU_FRAME_PROFILER_CAPTURE_EVENT_TYPE : unsigned char {
+		ECS_CPU_FRAME_PROFILER_CAPTURE_SCOPE,
+		ECS_CPU_FRAME_PROFILER_CAPTURE_MARKER,
+		ECS_CPU_FRAME_PROFILER_CAPTURE_COUNTER,
+		ECS_CPU_FRAME_PROFILER_CAPTURE_FRAME
+	};
+
+	struct CPUFrameProfilerCaptureEvent {
+		// Rdtsc values. For markers the end is the same as the start and for counters the end is the counter value
+		size_t start;
+		size_t end;
+		const char* name;
+		unsigned int name_size;
+		ECS_CPU_FRAME_PROFILER_CAPTURE_EVENT_TYPE type;
+		unsigned char tag;
+		// Used only by the frame and counter rings, the per thread events already know their thread
+		unsigned short thread_id;
+	};
+
+	static_assert(sizeof(CPUFrameProfilerCaptureEvent) == 32);
+
+	// Each thread writes only into its own ring, such that recording an event needs no synchronization
+	struct alignas(ECS_CACHE_LINE_SIZE) CPUFrameProfilerCaptureThread {
+		CPUFrameProfilerCaptureEvent* events;
+		// This is incremented for each event, the ring index is obtained by masking it
+		size_t write_index;
+		unsigned int depth;
+		size_t scope_starts[ECS_CPU_FRAME_PROFILER_CAPTURE_MAX_DEPTH];
+	};
+
+	/*
+		A continuous capture that records the CPUFrameProfiler scopes with their timestamps, instead of the per entry
+		statistics, such that the frames can be inspected on a timeline. The events are written into fixed ring buffers,
+		when a ring is full the oldest events are overwritten, and nothing is allocated while capturing. The capture can
+		be exported as a Chrome trace JSON which both chrome://tracing and the Perfetto UI can open.
+		The event names reference the storage of the profilers that produced them - call CopyEventNames before that storage
+		is released (the CPUFrameProfiler does this in its Clear and Stop does it as well).
+	*/
+	struct ECSENGINE_API CPUFrameProfilerCapture {
+		// Must be called before the scope is entered, even when not capturing, such that the nesting is kept in sync
+		ECS_INLINE void BeginScope(unsigned int thread_id) {
+			CPUFrameProfilerCaptureThread* thread = threads.buffer + thread_id;
+			if (thread->depth < ECS_CPU_FRAME_PROFILER_CAPTURE_MAX_DEPTH) {
+				thread->scope_starts[thread->depth] = capturing ? OS::Rdtsc() : 0;
+			}
+			thread->depth++;
+		}
+
+		// The name must remain stable until CopyEventNames is called
+		ECS_INLINE void EndScope(unsigned int thread_id, Stream<char> name, unsigned char tag = 0) {
+			CPUFrameProfilerCaptureThread* thread = threads.buffer + thread_id;
+			if (thread->depth == 0) {
+				return;
+			}
+			thread->depth--;
+			// If the capture was started while inside this scope, the start is 0 and the scope is skipped
+			if (capturing && thread->depth < ECS_CPU_FRAME_PROFILER_CAPTURE_MAX_DEPTH && thread->scope_starts[thread->depth] != 0) {
+				CPUFrameProfilerCaptureEvent* event = thread->events + (thread->write_index & thread_event_mask);
+				event->start = thread->scope_starts[thread->depth];
+				event->end = OS::Rdtsc();
+				event->name = name.buffer;
+				event->name_size = name.size;
+				event->type = ECS_CPU_FRAME_PROFILER_CAPTURE_SCOPE;
+				event->tag = tag;
+				thread->write_index++;
+			}
+		}
+
+		// An instant event on the timeline of that thread. With thread_id -1 it is a global event, which can
+		// Be added from any thread, including the ones that the profiler doesn't know about
+		void AddMarker(unsigned int thread_id, Stream<char> name);
+
+		// Can be called from any thread
+		void AddCounter(Stream<char> name, size_t value);
+
+		// Records a frame span on its own track. Can be called from any thread
+		void AddFrame(size_t start_cycles, size_t end_cycles);
+
+		// Copies the names of the recorded events into the capture's own storage, such that the
+		// Storage that they were referencing can be released. It must not run concurrently with the writers
+		void CopyEventNames();
+
+		void Deallocate();
+
+		// Writes all the events that are still in the rings. The capture must be stopped first, since the writers could
+		// Overwrite the events while they are read. Returns false if the capture is active or the file could not be written
+		bool ExportChromeTrace(Stream<wchar_t> path, CapacityStream<char>* error_message = nullptr);
+
+		// Returns how many events were overwritten because the rings were full
+		size_t GetDroppedEventCount() const;
+
+		// The capacities are rounded up to a power of two
+		void Initialize(
+			AllocatorPolymorphic allocator,
+			unsigned int thread_count,
+			unsigned int thread_event_capacity = ECS_CPU_FRAME_PROFILER_CAPTURE_THREAD_EVENT_CAPACITY,
+			unsigned int frame_event_capacity = ECS_CPU_FRAME_PROFILER_CAPTURE_FRAME_EVENT_CAPACITY,
+			unsigned int counter_event_capacity = ECS_CPU_FRAME_PROFILER_CAPTURE_COUNTER_EVENT_CAPACITY
+		);
+
+		ECS_INLINE bool IsCapturing() const {
+			return capturing;
+		}
+
+		// Discards the previous events and starts recording. Must be called in between frames
+		void Start();
+
+		// Must be called in between frames
+		void Stop();
+
+		AllocatorPolymorphic allocator;
+		Stream<CPUFrameProfilerCaptureThread> threads;
+		// The frames and the global markers, which can come from any thread. They have their own ring, such that
+		// The frame boundaries are not evicted by the counters
+		CPUFrameProfilerCaptureEvent* frame_events;
+		std::atomic<size_t> frame_write_index;
+		// The counters, which can come from any thread
+		CPUFrameProfilerCaptureEvent* counter_events;
+		std::atomic<size_t> counter_write_index;
+		size_t thread_event_mask;
+		size_t frame_event_mask;
+		size_t counter_event_mask;
+		// Owns the names after CopyEventNames
+		HashTableDefault<Stream<char>> names;
+		bool capturing;
+
+		// These are used to convert the Rdtsc values into microseconds
+		Timer timer;
+		size_t start_cycles;
+		size_t stop_cycles;
+		size_t stop_duration_ns;
+	};
+
+}
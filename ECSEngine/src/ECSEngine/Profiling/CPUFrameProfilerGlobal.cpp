@@ -19,4 +19,16 @@ namespace ECSEngine {
 		ECS_CPU_FRAME_PROFILER->Pop(thread_id, value);
 	}
 
+	void CPUFrameProfilerMarker(unsigned int thread_id, Stream<char> name) {
+		if (ECS_CPU_FRAME_PROFILER != nullptr && ECS_CPU_FRAME_PROFILER->capture != nullptr) {
+			ECS_CPU_FRAME_PROFILER->capture->AddMarker(thread_id, name);
+		}
+	}
+
+	void CPUFrameProfilerCounter(Stream<char> name, size_t value) {
+		if (ECS_CPU_FRAME_PROFILER != nullptr && ECS_CPU_FRAME_PROFILER->capture != nullptr) {
+			ECS_CPU_FRAME_PROFILER->capture->AddCounter(name, value);
+		}
+	}
+
 }
\ No newline at end of file
@@ -22,6 +22,13 @@ namespace ECSEngine {
 
 	ECSENGINE_API void CPUFrameProfilerPop(unsigned int thread_id, float value);
 
+	// Adds an instant event to the capture of the global profiler, if it is capturing. With thread_id -1
+	// The marker is global and it can be added from any thread
+	ECSENGINE_API void CPUFrameProfilerMarker(unsigned int thread_id, Stream<char> name);
+
+	// Adds a counter value to the capture of the global profiler, if it is capturing. Can be called from any thread
+	ECSENGINE_API void CPUFrameProfilerCounter(Stream<char> name, size_t value);
+
 	struct CPUFrameProfilingTimer {
 		ECS_INLINE CPUFrameProfilingTimer(unsigned int _thread_id, Stream<char> name, unsigned char tag = 0) : thread_id(_thread_id) {
 			CPUFrameProfilerPush(thread_id, name, tag);
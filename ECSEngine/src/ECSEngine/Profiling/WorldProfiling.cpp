@@ -60,6 +60,9 @@ namespace ECSEngine {
 
 	void WorldProfiling::EndSimulation()
 	{
+		if (HasFlag(options, ECS_WORLD_PROFILING_CPU) && cpu_profiler.capture != nullptr) {
+			cpu_profiler.capture->AddMarker(-1, "Simulation End");
+		}
 		if (HasFlag(options, ECS_WORLD_PROFILING_PHYSICAL_MEMORY)) {
 			physical_memory_profiler.EndSimulation();
 		}
@@ -90,6 +93,9 @@ namespace ECSEngine {
 		if (HasFlag(options, ECS_WORLD_PROFILING_ALLOCATOR)) {
 			AddAllocatorProfilingWorldAllocators(&allocator_profiler, world);
 		}
+		if (HasFlag(options, ECS_WORLD_PROFILING_CPU) && cpu_profiler.capture != nullptr) {
+			cpu_profiler.capture->AddMarker(-1, "Simulation Start");
+		}
 	}
 
 	void WorldProfiling::StartFrame()
@@ -458,4 +458,86 @@ namespace ECSEngine {
 
 	ECS_TEMPLATE_FUNCTION_2_BEFORE(FrustumPoints, GetCameraFrustumPoints, const Camera*, const CameraCached*);
 
+	FrustumPlanes GetFrustumPlanes(Matrix view_projection_matrix) {
+		// The matrices use row vectors, such that the clip coordinates are the dot products between
+		// the position and the columns. The depth is in the [0, w] range
+		float values[4][4];
+		view_projection_matrix.Store(values);
+		float4 columns[4];
+		for (size_t index = 0; index < 4; index++) {
+			columns[index] = { values[0][index], values[1][index], values[2][index], values[3][index] };
+		}
+
+		float4 coefficients[6] = {
+			columns[3] + columns[0],
+			columns[3] - columns[0],
+			columns[3] + columns[1],
+			columns[3] - columns[1],
+			columns[2],
+			columns[3] - columns[2]
+		};
+
+		FrustumPlanes frustum;
+		for (size_t index = 0; index < 6; index++) {
+			// The plane equation is dot(normal, point) + w >= 0, while the planes are stored as dot(normal, point) >= dot
+			float3 normal = coefficients[index].xyz();
+			float inverse_length = 1.0f / Length(normal);
+			frustum.planes[index] = PlaneScalar(normal * float3::Splat(inverse_length), -coefficients[index].w * inverse_length);
+		}
+		return frustum;
+	}
+
+	bool IsAABBInFrustum(const AABBScalar& aabb, const FrustumPlanes& frustum) {
+		float3 center = AABBCenter(aabb);
+		float3 half_extents = AABBHalfExtents(aabb);
+		for (size_t index = 0; index < std::size(frustum.planes); index++) {
+			// Project the extents onto the normal, if even the furthest corner along the normal
+			// is behind the plane then the entire AABB is outside
+			const PlaneScalar& plane = frustum.planes[index];
+			if (Dot(plane.normal, center) + Dot(Abs(plane.normal), half_extents) < plane.dot) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	SIMDVectorMask ECS_VECTORCALL IsAABBInFrustum(AABB aabbs, const FrustumPlanes& frustum) {
+		Vector3 center = AABBCenter(aabbs);
+		Vector3 half_extents = AABBHalfExtents(aabbs);
+		SIMDVectorMask is_inside = true;
+		for (size_t index = 0; index < std::size(frustum.planes); index++) {
+			const PlaneScalar& plane = frustum.planes[index];
+			Vec8f distance = Dot(Vector3().Splat(plane.normal), center) + Dot(Vector3().Splat(Abs(plane.normal)), half_extents);
+			is_inside &= distance >= Vec8f(plane.dot);
+		}
+		return is_inside;
+	}
+
+	size_t FrustumCullAABBs(Stream<AABBScalar> aabbs, const FrustumPlanes& frustum, unsigned int* visible_indices, unsigned int index_offset) {
+		static_assert(sizeof(AABBScalar) == sizeof(float) * 6);
+
+		size_t visible_count = 0;
+		for (size_t index = 0; index < aabbs.size; index += Vec8f::size()) {
+			// Transpose the AABBs into the SoA form with strided gathers
+			size_t count = min(aabbs.size - index, (size_t)Vec8f::size());
+			const AABBScalar* current_aabbs = aabbs.buffer + index;
+			AABB simd_aabbs;
+			simd_aabbs.min.x = GatherStride<6, 0>(current_aabbs, count);
+			simd_aabbs.min.y = GatherStride<6, 1>(current_aabbs, count);
+			simd_aabbs.min.z = GatherStride<6, 2>(current_aabbs, count);
+			simd_aabbs.max.x = GatherStride<6, 3>(current_aabbs, count);
+			simd_aabbs.max.y = GatherStride<6, 4>(current_aabbs, count);
+			simd_aabbs.max.z = GatherStride<6, 5>(current_aabbs, count);
+
+			// The unused lanes repeat the first AABB, they must be masked out
+			unsigned int visible_bits = to_bits(IsAABBInFrustum(simd_aabbs, frustum)) & ((1 << count) - 1);
+			while (visible_bits != 0) {
+				unsigned int lane = FirstLSB(visible_bits);
+				visible_indices[visible_count++] = index_offset + (unsigned int)(index + lane);
+				visible_bits &= visible_bits - 1;
+			}
+		}
+		return visible_count;
+	}
+
 }
\ No newline at end of file
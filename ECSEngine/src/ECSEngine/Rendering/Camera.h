@@ -4,6 +4,7 @@
 #include "../Utilities/Reflection/ReflectionMacros.h"
 #include "../Math/Conversion.h"
 #include "../Math/AABB.h"
+#include "../Math/Plane.h"
 
 namespace ECSEngine {
 
@@ -478,4 +479,24 @@ namespace ECSEngine {
 	template<typename CameraType>
 	ECSENGINE_API FrustumPoints GetCameraFrustumPoints(const CameraType* camera);
 
+	// The planes are oriented towards the inside of the frustum, in the order left, right, bottom, top, near and far
+	struct FrustumPlanes {
+		PlaneScalar planes[6];
+	};
+
+	// Extracts the world space planes from a view projection matrix. For a model view projection matrix,
+	// the planes are in the object space
+	ECSENGINE_API FrustumPlanes GetFrustumPlanes(Matrix view_projection_matrix);
+
+	// Returns true if the AABB is inside or intersects the frustum. The test is conservative, the AABBs
+	// that are outside but near the frustum corners can be reported as visible
+	ECSENGINE_API bool IsAABBInFrustum(const AABBScalar& aabb, const FrustumPlanes& frustum);
+
+	// The same as the scalar version, but for 8 AABBs at a time
+	ECSENGINE_API SIMDVectorMask ECS_VECTORCALL IsAABBInFrustum(AABB aabbs, const FrustumPlanes& frustum);
+
+	// Writes the indices of the AABBs that are inside or intersect the frustum, to which the index offset is added.
+	// The visible indices must have at least aabbs.size entries. Returns the count of visible AABBs
+	ECSENGINE_API size_t FrustumCullAABBs(Stream<AABBScalar> aabbs, const FrustumPlanes& frustum, unsigned int* visible_indices, unsigned int index_offset = 0);
+
 }
\ No newline at end of file
@@ -0,0 +1,959 @@
+#include "ecspch.h"
+#include "BlockCompression.h"
+#include "../../Math/VCLExtensions.h"
+#include "../../Math/MathHelpers.h"
+#include "../../Multithreading/ParallelFor.h"
+#include "../../Allocators/AllocatorPolymorphic.h"
+#include "../../Utilities/PointerUtilities.h"
+
+// The minimum amount of block rows that a thread compresses at once
+#define BLOCK_COMPRESSION_MIN_ROW_BATCH 4
+#define BLOCK_COMPRESSION_MAX_BATCH_COUNT 256
+
+#define BLOCK_PIXEL_COUNT 16
+
+namespace ECSEngine {
+
+	// The channels of a 4x4 block in a SoA layout, as floats in the [0, 255] range
+	struct BlockPixels {
+		alignas(32) float channels[4][BLOCK_PIXEL_COUNT];
+	};
+
+	// The luminance contributions, normalized to green
+	static const float PERCEPTUAL_WEIGHTS[4] = { 0.2125f / 0.7154f, 1.0f, 0.0721f / 0.7154f, 1.0f };
+	static const float UNIFORM_WEIGHTS[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	// The interpolation factor from the first endpoint to the second one for each index
+	static const float BC1_FOUR_COLOR_FACTORS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	static const float BC1_THREE_COLOR_FACTORS[3] = { 0.0f, 1.0f, 0.5f };
+	static const unsigned int BC7_INDEX_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Indexed by the quality
+	static const unsigned int QUALITY_AXIS_ITERATIONS[] = { 3, 6, 8 };
+	static const unsigned int QUALITY_REFINE_ITERATIONS[] = { 0, 1, 3 };
+	static const int QUALITY_BC4_SEARCH_RADIUS[] = { 0, 1, 3 };
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	struct BlockBitWriter {
+		ECS_INLINE void Write(unsigned int value, unsigned int count) {
+			for (unsigned int index = 0; index < count; index++) {
+				bits[offset >> 6] |= (unsigned long long)((value >> index) & 1) << (offset & 63);
+				offset++;
+			}
+		}
+
+		unsigned long long bits[2] = { 0, 0 };
+		unsigned int offset = 0;
+	};
+
+	struct BlockBitReader {
+		ECS_INLINE unsigned int Read(unsigned int count) {
+			unsigned int value = 0;
+			for (unsigned int index = 0; index < count; index++) {
+				value |= (unsigned int)((bits[offset >> 6] >> (offset & 63)) & 1) << index;
+				offset++;
+			}
+			return value;
+		}
+
+		unsigned long long bits[2];
+		unsigned int offset = 0;
+	};
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// The coordinates outside the image are clamped to the last row and column
+	static void LoadBlock(
+		const void* pixels,
+		size_t row_pitch,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		size_t block_x,
+		size_t block_y,
+		BlockPixels* block
+	) {
+		for (size_t y = 0; y < 4; y++) {
+			const unsigned char* row = (const unsigned char*)OffsetPointer(pixels, min(block_y * 4 + y, height - 1) * row_pitch);
+			for (size_t x = 0; x < 4; x++) {
+				const unsigned char* pixel = row + min(block_x * 4 + x, width - 1) * channel_count;
+				size_t pixel_index = y * 4 + x;
+				// Grayscale images replicate the value, such that they can be encoded as color as well
+				unsigned char missing_color = channel_count == 1 ? pixel[0] : 0;
+				block->channels[0][pixel_index] = pixel[0];
+				block->channels[1][pixel_index] = channel_count >= 2 ? pixel[1] : missing_color;
+				block->channels[2][pixel_index] = channel_count >= 3 ? pixel[2] : missing_color;
+				block->channels[3][pixel_index] = channel_count >= 4 ? pixel[3] : 255;
+			}
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Assigns to each pixel the closest palette entry. The palette entries have channel_count consecutive values.
+	// The pixels with a 0 weight do not contribute to the error. Returns the total weighted squared error
+	template<unsigned int channel_count>
+	static float SelectIndices(
+		const BlockPixels& block,
+		unsigned int first_channel,
+		const float* channel_weights,
+		const float* palette,
+		unsigned int palette_size,
+		const float* pixel_weights,
+		unsigned char* indices
+	) {
+		Vec8f total_error = 0.0f;
+		for (unsigned int offset = 0; offset < BLOCK_PIXEL_COUNT; offset += Vec8f::size()) {
+			Vec8f values[channel_count];
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				values[channel].load_a(block.channels[first_channel + channel] + offset);
+			}
+
+			Vec8f best_error = FLT_MAX;
+			Vec8f best_index = 0.0f;
+			for (unsigned int entry = 0; entry < palette_size; entry++) {
+				Vec8f error = 0.0f;
+				for (unsigned int channel = 0; channel < channel_count; channel++) {
+					Vec8f difference = values[channel] - Vec8f(palette[entry * channel_count + channel]);
+					error = mul_add(difference * difference, Vec8f(channel_weights[channel]), error);
+				}
+				Vec8fb is_better = error < best_error;
+				best_error = select(is_better, error, best_error);
+				best_index = select(is_better, Vec8f((float)entry), best_index);
+			}
+
+			if (pixel_weights != nullptr) {
+				best_error *= Vec8f().load(pixel_weights + offset);
+			}
+			total_error += best_error;
+
+			alignas(32) int index_values[Vec8i::size()];
+			truncatei(best_index).store_a(index_values);
+			for (unsigned int index = 0; index < Vec8i::size(); index++) {
+				indices[offset + index] = (unsigned char)index_values[index];
+			}
+		}
+		return horizontal_add(total_error);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// The endpoints are the extremes of the projections of the pixels on the principal axis. The axis is found
+	// with power iterations on the covariance matrix, in the space scaled by the channel weights
+	template<unsigned int channel_count>
+	static void PrincipalAxisEndpoints(
+		const BlockPixels& block,
+		unsigned int first_channel,
+		const float* channel_weights,
+		const float* pixel_weights,
+		unsigned int iterations,
+		float* endpoint0,
+		float* endpoint1
+	) {
+		float scales[channel_count];
+		float mean[channel_count] = {};
+		float weight_sum = 0.0f;
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			scales[channel] = sqrtf(channel_weights[channel]);
+		}
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			float weight = pixel_weights != nullptr ? pixel_weights[pixel] : 1.0f;
+			weight_sum += weight;
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				mean[channel] += block.channels[first_channel + channel][pixel] * weight;
+			}
+		}
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			mean[channel] /= weight_sum;
+		}
+
+		float covariance[channel_count][channel_count] = {};
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			float weight = pixel_weights != nullptr ? pixel_weights[pixel] : 1.0f;
+			float centered[channel_count];
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				centered[channel] = (block.channels[first_channel + channel][pixel] - mean[channel]) * scales[channel];
+			}
+			for (unsigned int row = 0; row < channel_count; row++) {
+				for (unsigned int column = row; column < channel_count; column++) {
+					covariance[row][column] += centered[row] * centered[column] * weight;
+				}
+			}
+		}
+		for (unsigned int row = 0; row < channel_count; row++) {
+			for (unsigned int column = 0; column < row; column++) {
+				covariance[row][column] = covariance[column][row];
+			}
+		}
+
+		// Start from the row with the largest variance, such that the start is not orthogonal to the axis
+		unsigned int largest_row = 0;
+		for (unsigned int row = 1; row < channel_count; row++) {
+			if (covariance[row][row] > covariance[largest_row][largest_row]) {
+				largest_row = row;
+			}
+		}
+		float axis[channel_count];
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			axis[channel] = covariance[largest_row][channel];
+		}
+		for (unsigned int iteration = 0; iteration < iterations; iteration++) {
+			float next_axis[channel_count] = {};
+			float largest_component = 0.0f;
+			for (unsigned int row = 0; row < channel_count; row++) {
+				for (unsigned int column = 0; column < channel_count; column++) {
+					next_axis[row] += covariance[row][column] * axis[column];
+				}
+				largest_component = max(largest_component, fabsf(next_axis[row]));
+			}
+			if (largest_component < 1e-8f) {
+				break;
+			}
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				axis[channel] = next_axis[channel] / largest_component;
+			}
+		}
+
+		float length_squared = 0.0f;
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			length_squared += axis[channel] * axis[channel];
+		}
+		if (length_squared < 1e-8f) {
+			// All the pixels are the same
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				endpoint0[channel] = mean[channel];
+				endpoint1[channel] = mean[channel];
+			}
+			return;
+		}
+		float inverse_length = 1.0f / sqrtf(length_squared);
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			axis[channel] *= inverse_length;
+		}
+
+		float min_projection = FLT_MAX;
+		float max_projection = -FLT_MAX;
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			if (pixel_weights == nullptr || pixel_weights[pixel] > 0.0f) {
+				float projection = 0.0f;
+				for (unsigned int channel = 0; channel < channel_count; channel++) {
+					projection += (block.channels[first_channel + channel][pixel] - mean[channel]) * scales[channel] * axis[channel];
+				}
+				min_projection = min(min_projection, projection);
+				max_projection = max(max_projection, projection);
+			}
+		}
+
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			// The scale is 0 only for channels with a 0 weight, in which case they are irrelevant
+			float unscale = scales[channel] > 0.0f ? axis[channel] / scales[channel] : 0.0f;
+			endpoint0[channel] = Clamp(mean[channel] + unscale * min_projection, 0.0f, 255.0f);
+			endpoint1[channel] = Clamp(mean[channel] + unscale * max_projection, 0.0f, 255.0f);
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Solves for the endpoints that minimize the error for the given indices, where each index interpolates
+	// between the endpoints with its factor. Returns false if the system is singular (all pixels use the same factor)
+	template<unsigned int channel_count>
+	static bool LeastSquaresEndpoints(
+		const BlockPixels& block,
+		unsigned int first_channel,
+		const unsigned char* indices,
+		const float* index_factors,
+		const float* pixel_weights,
+		float* endpoint0,
+		float* endpoint1
+	) {
+		float alpha_alpha = 0.0f;
+		float beta_beta = 0.0f;
+		float alpha_beta = 0.0f;
+		float alpha_x[channel_count] = {};
+		float beta_x[channel_count] = {};
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			float weight = pixel_weights != nullptr ? pixel_weights[pixel] : 1.0f;
+			float beta = index_factors[indices[pixel]];
+			float alpha = 1.0f - beta;
+			alpha_alpha += alpha * alpha * weight;
+			beta_beta += beta * beta * weight;
+			alpha_beta += alpha * beta * weight;
+			for (unsigned int channel = 0; channel < channel_count; channel++) {
+				float value = block.channels[first_channel + channel][pixel] * weight;
+				alpha_x[channel] += alpha * value;
+				beta_x[channel] += beta * value;
+			}
+		}
+
+		float determinant = alpha_alpha * beta_beta - alpha_beta * alpha_beta;
+		if (fabsf(determinant) < 1e-6f) {
+			return false;
+		}
+		float inverse_determinant = 1.0f / determinant;
+		for (unsigned int channel = 0; channel < channel_count; channel++) {
+			endpoint0[channel] = Clamp((alpha_x[channel] * beta_beta - beta_x[channel] * alpha_beta) * inverse_determinant, 0.0f, 255.0f);
+			endpoint1[channel] = Clamp((beta_x[channel] * alpha_alpha - alpha_x[channel] * alpha_beta) * inverse_determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	ECS_INLINE static unsigned short QuantizeRGB565(const float* color) {
+		unsigned int red = (unsigned int)(color[0] * (31.0f / 255.0f) + 0.5f);
+		unsigned int green = (unsigned int)(color[1] * (63.0f / 255.0f) + 0.5f);
+		unsigned int blue = (unsigned int)(color[2] * (31.0f / 255.0f) + 0.5f);
+		return (unsigned short)((red << 11) | (green << 5) | blue);
+	}
+
+	ECS_INLINE static void DecodeRGB565(unsigned short value, float* color) {
+		unsigned int red = (value >> 11) & 31;
+		unsigned int green = (value >> 5) & 63;
+		unsigned int blue = value & 31;
+		color[0] = (float)((red << 3) | (red >> 2));
+		color[1] = (float)((green << 2) | (green >> 4));
+		color[2] = (float)((blue << 3) | (blue >> 2));
+	}
+
+	// Fills in the RGB palette of a BC1 color block. Returns the palette size (3 or 4)
+	static unsigned int BC1Palette(unsigned short color0, unsigned short color1, bool four_color, float* palette) {
+		DecodeRGB565(color0, palette);
+		DecodeRGB565(color1, palette + 3);
+		const float* factors = four_color ? BC1_FOUR_COLOR_FACTORS : BC1_THREE_COLOR_FACTORS;
+		unsigned int palette_size = four_color ? 4 : 3;
+		for (unsigned int entry = 2; entry < palette_size; entry++) {
+			for (unsigned int channel = 0; channel < 3; channel++) {
+				palette[entry * 3 + channel] = palette[channel] + (palette[3 + channel] - palette[channel]) * factors[entry];
+			}
+		}
+		return palette_size;
+	}
+
+	struct BC1Candidate {
+		unsigned short color0;
+		unsigned short color1;
+		bool four_color;
+		float error;
+		unsigned char indices[BLOCK_PIXEL_COUNT];
+	};
+
+	// The BC3 color blocks are always decoded with 4 colors. For BC1, the 3 color mode is used when there are
+	// transparent pixels or when the endpoints quantize to the same value, since the fourth color would be transparent
+	static void EvaluateBC1(
+		const BlockPixels& block,
+		const float* weights,
+		const float* pixel_weights,
+		const float* endpoint0,
+		const float* endpoint1,
+		bool three_color,
+		bool bc3_color,
+		BC1Candidate* best
+	) {
+		unsigned short color0 = QuantizeRGB565(endpoint0);
+		unsigned short color1 = QuantizeRGB565(endpoint1);
+		bool four_color = true;
+		if (!bc3_color) {
+			if (three_color) {
+				if (color0 > color1) {
+					std::swap(color0, color1);
+				}
+				four_color = false;
+			}
+			else {
+				if (color0 < color1) {
+					std::swap(color0, color1);
+				}
+				four_color = color0 != color1;
+			}
+		}
+
+		float palette[4 * 3];
+		unsigned int palette_size = BC1Palette(color0, color1, four_color, palette);
+		unsigned char indices[BLOCK_PIXEL_COUNT];
+		float error = SelectIndices<3>(block, 0, weights, palette, palette_size, pixel_weights, indices);
+		if (error < best->error) {
+			best->color0 = color0;
+			best->color1 = color1;
+			best->four_color = four_color;
+			best->error = error;
+			memcpy(best->indices, indices, sizeof(indices));
+		}
+	}
+
+	static void CompressBC1Color(
+		const BlockPixels& block,
+		const float* weights,
+		ECS_BLOCK_COMPRESSION_QUALITY quality,
+		bool alpha_cutout,
+		bool bc3_color,
+		void* output
+	) {
+		float pixel_weights[BLOCK_PIXEL_COUNT];
+		unsigned int transparent_count = 0;
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			bool is_transparent = alpha_cutout && block.channels[3][pixel] < 128.0f;
+			pixel_weights[pixel] = is_transparent ? 0.0f : 1.0f;
+			transparent_count += is_transparent;
+		}
+		bool three_color = transparent_count > 0;
+
+		BC1Candidate best;
+		if (transparent_count == BLOCK_PIXEL_COUNT) {
+			// The 3 color mode with all the indices set to transparent
+			best.color0 = 0;
+			best.color1 = 0;
+			best.four_color = false;
+		}
+		else {
+			const float* block_pixel_weights = three_color ? pixel_weights : nullptr;
+			float endpoint0[3];
+			float endpoint1[3];
+			PrincipalAxisEndpoints<3>(block, 0, weights, block_pixel_weights, QUALITY_AXIS_ITERATIONS[quality], endpoint0, endpoint1);
+
+			best.error = FLT_MAX;
+			EvaluateBC1(block, weights, block_pixel_weights, endpoint0, endpoint1, three_color, bc3_color, &best);
+			for (unsigned int iteration = 0; iteration < QUALITY_REFINE_ITERATIONS[quality] && best.error > 0.0f; iteration++) {
+				const float* factors = best.four_color ? BC1_FOUR_COLOR_FACTORS : BC1_THREE_COLOR_FACTORS;
+				if (!LeastSquaresEndpoints<3>(block, 0, best.indices, factors, block_pixel_weights, endpoint0, endpoint1)) {
+					break;
+				}
+				float previous_error = best.error;
+				EvaluateBC1(block, weights, block_pixel_weights, endpoint0, endpoint1, three_color, bc3_color, &best);
+				if (best.error >= previous_error) {
+					break;
+				}
+			}
+		}
+
+		unsigned int index_bits = 0;
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			unsigned int index = pixel_weights[pixel] == 0.0f ? 3 : best.indices[pixel];
+			index_bits |= index << (pixel * 2);
+		}
+		memcpy(output, &best.color0, sizeof(best.color0));
+		memcpy(OffsetPointer(output, 2), &best.color1, sizeof(best.color1));
+		memcpy(OffsetPointer(output, 4), &index_bits, sizeof(index_bits));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Fills the 8 entry palette of a BC4 block. When the first endpoint is not larger than the second,
+	// the palette has 6 interpolated values and the explicit 0 and 255
+	static void BC4Palette(unsigned int endpoint0, unsigned int endpoint1, float* palette) {
+		palette[0] = (float)endpoint0;
+		palette[1] = (float)endpoint1;
+		if (endpoint0 > endpoint1) {
+			for (unsigned int entry = 2; entry < 8; entry++) {
+				palette[entry] = (float)((8 - entry) * endpoint0 + (entry - 1) * endpoint1) / 7.0f;
+			}
+		}
+		else {
+			for (unsigned int entry = 2; entry < 6; entry++) {
+				palette[entry] = (float)((6 - entry) * endpoint0 + (entry - 1) * endpoint1) / 5.0f;
+			}
+			palette[6] = 0.0f;
+			palette[7] = 255.0f;
+		}
+	}
+
+	static void CompressBC4Channel(const BlockPixels& block, unsigned int channel, ECS_BLOCK_COMPRESSION_QUALITY quality, void* output) {
+		const float* values = block.channels[channel];
+		Vec8f low = Vec8f().load_a(values);
+		Vec8f high = Vec8f().load_a(values + Vec8f::size());
+		int min_value = (int)HorizontalMin8(min(low, high))[0];
+		int max_value = (int)HorizontalMax8(max(low, high))[0];
+
+		unsigned int best_endpoint0 = max_value;
+		unsigned int best_endpoint1 = min_value;
+		unsigned char best_indices[BLOCK_PIXEL_COUNT] = {};
+		if (min_value != max_value) {
+			float best_error = FLT_MAX;
+			auto evaluate = [&](unsigned int endpoint0, unsigned int endpoint1) {
+				float palette[8];
+				unsigned char indices[BLOCK_PIXEL_COUNT];
+				BC4Palette(endpoint0, endpoint1, palette);
+				float error = SelectIndices<1>(block, channel, UNIFORM_WEIGHTS, palette, 8, nullptr, indices);
+				if (error < best_error) {
+					best_error = error;
+					best_endpoint0 = endpoint0;
+					best_endpoint1 = endpoint1;
+					memcpy(best_indices, indices, sizeof(indices));
+				}
+			};
+
+			// Search around the extremes, since moving the endpoints inwards can reduce the error of the interpolated values
+			int radius = QUALITY_BC4_SEARCH_RADIUS[quality];
+			for (int endpoint0 = max_value; endpoint0 >= max(max_value - radius, 0); endpoint0--) {
+				for (int endpoint1 = min_value; endpoint1 <= min(min_value + radius, 255) && endpoint1 < endpoint0; endpoint1++) {
+					evaluate(endpoint0, endpoint1);
+				}
+			}
+
+			if (quality != ECS_BLOCK_COMPRESSION_QUALITY_FAST && (min_value == 0 || max_value == 255)) {
+				// The 6 value mode, which can represent exactly the extremes while interpolating the other values
+				int inner_min = 255;
+				int inner_max = 0;
+				for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+					int value = (int)values[pixel];
+					if (value != 0 && value != 255) {
+						inner_min = min(inner_min, value);
+						inner_max = max(inner_max, value);
+					}
+				}
+				if (inner_min > inner_max) {
+					inner_min = 0;
+					inner_max = 0;
+				}
+				evaluate(inner_min, inner_max);
+			}
+		}
+
+		unsigned long long index_bits = 0;
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			index_bits |= (unsigned long long)best_indices[pixel] << (pixel * 3);
+		}
+		unsigned char* bytes = (unsigned char*)output;
+		bytes[0] = (unsigned char)best_endpoint0;
+		bytes[1] = (unsigned char)best_endpoint1;
+		memcpy(bytes + 2, &index_bits, 6);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	struct BC7Candidate {
+		unsigned int endpoints[2][4];
+		unsigned int p_bits[2];
+		float error;
+		unsigned char indices[BLOCK_PIXEL_COUNT];
+	};
+
+	// Quantizes an endpoint to 7 bits per channel with the given p-bit. Returns the weighted quantization error
+	static float QuantizeBC7Endpoint(const float* endpoint, unsigned int p_bit, const float* weights, unsigned int* quantized) {
+		float error = 0.0f;
+		for (unsigned int channel = 0; channel < 4; channel++) {
+			int value = (int)((endpoint[channel] - (float)p_bit) * 0.5f + 0.5f);
+			quantized[channel] = (unsigned int)Clamp(value, 0, 127);
+			float difference = (float)((quantized[channel] << 1) | p_bit) - endpoint[channel];
+			error += difference * difference * weights[channel];
+		}
+		return error;
+	}
+
+	static void EvaluateBC7Mode6(
+		const BlockPixels& block,
+		const float* weights,
+		const float* endpoint0,
+		const float* endpoint1,
+		unsigned int p_bit0,
+		unsigned int p_bit1,
+		BC7Candidate* best
+	) {
+		unsigned int endpoints[2][4];
+		QuantizeBC7Endpoint(endpoint0, p_bit0, weights, endpoints[0]);
+		QuantizeBC7Endpoint(endpoint1, p_bit1, weights, endpoints[1]);
+
+		float palette[16 * 4];
+		for (unsigned int channel = 0; channel < 4; channel++) {
+			unsigned int decoded0 = (endpoints[0][channel] << 1) | p_bit0;
+			unsigned int decoded1 = (endpoints[1][channel] << 1) | p_bit1;
+			for (unsigned int entry = 0; entry < 16; entry++) {
+				unsigned int weight = BC7_INDEX_WEIGHTS[entry];
+				palette[entry * 4 + channel] = (float)(((64 - weight) * decoded0 + weight * decoded1 + 32) >> 6);
+			}
+		}
+
+		unsigned char indices[BLOCK_PIXEL_COUNT];
+		float error = SelectIndices<4>(block, 0, weights, palette, 16, nullptr, indices);
+		if (error < best->error) {
+			memcpy(best->endpoints, endpoints, sizeof(endpoints));
+			best->p_bits[0] = p_bit0;
+			best->p_bits[1] = p_bit1;
+			best->error = error;
+			memcpy(best->indices, indices, sizeof(indices));
+		}
+	}
+
+	// Evaluates the p-bits that have the smallest endpoint quantization error or, for the high quality, all of them
+	static void EvaluateBC7Mode6PBits(
+		const BlockPixels& block,
+		const float* weights,
+		const float* endpoint0,
+		const float* endpoint1,
+		ECS_BLOCK_COMPRESSION_QUALITY quality,
+		BC7Candidate* best
+	) {
+		if (quality == ECS_BLOCK_COMPRESSION_QUALITY_HIGH) {
+			for (unsigned int p_bits = 0; p_bits < 4; p_bits++) {
+				EvaluateBC7Mode6(block, weights, endpoint0, endpoint1, p_bits & 1, p_bits >> 1, best);
+			}
+		}
+		else {
+			unsigned int quantized[4];
+			unsigned int p_bit0 = QuantizeBC7Endpoint(endpoint0, 1, weights, quantized) < QuantizeBC7Endpoint(endpoint0, 0, weights, quantized);
+			unsigned int p_bit1 = QuantizeBC7Endpoint(endpoint1, 1, weights, quantized) < QuantizeBC7Endpoint(endpoint1, 0, weights, quantized);
+			EvaluateBC7Mode6(block, weights, endpoint0, endpoint1, p_bit0, p_bit1, best);
+		}
+	}
+
+	static void CompressBC7Mode6(const BlockPixels& block, const float* weights, ECS_BLOCK_COMPRESSION_QUALITY quality, void* output) {
+		float endpoint0[4];
+		float endpoint1[4];
+		PrincipalAxisEndpoints<4>(block, 0, weights, nullptr, QUALITY_AXIS_ITERATIONS[quality], endpoint0, endpoint1);
+
+		BC7Candidate best;
+		best.error = FLT_MAX;
+		EvaluateBC7Mode6PBits(block, weights, endpoint0, endpoint1, quality, &best);
+
+		float index_factors[16];
+		for (unsigned int index = 0; index < 16; index++) {
+			index_factors[index] = (float)BC7_INDEX_WEIGHTS[index] / 64.0f;
+		}
+		for (unsigned int iteration = 0; iteration < QUALITY_REFINE_ITERATIONS[quality] && best.error > 0.0f; iteration++) {
+			if (!LeastSquaresEndpoints<4>(block, 0, best.indices, index_factors, nullptr, endpoint0, endpoint1)) {
+				break;
+			}
+			float previous_error = best.error;
+			EvaluateBC7Mode6PBits(block, weights, endpoint0, endpoint1, quality, &best);
+			if (best.error >= previous_error) {
+				break;
+			}
+		}
+
+		// The most significant bit of the first index is implicitly 0. Swap the endpoints and invert the indices otherwise
+		if (best.indices[0] >= 8) {
+			for (unsigned int channel = 0; channel < 4; channel++) {
+				std::swap(best.endpoints[0][channel], best.endpoints[1][channel]);
+			}
+			std::swap(best.p_bits[0], best.p_bits[1]);
+			for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+				best.indices[pixel] = 15 - best.indices[pixel];
+			}
+		}
+
+		BlockBitWriter writer;
+		// The mode is encoded as 6 zero bits followed by a one
+		writer.Write(1 << 6, 7);
+		for (unsigned int channel = 0; channel < 4; channel++) {
+			writer.Write(best.endpoints[0][channel], 7);
+			writer.Write(best.endpoints[1][channel], 7);
+		}
+		writer.Write(best.p_bits[0], 1);
+		writer.Write(best.p_bits[1], 1);
+		writer.Write(best.indices[0], 3);
+		for (unsigned int pixel = 1; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			writer.Write(best.indices[pixel], 4);
+		}
+		memcpy(output, writer.bits, sizeof(writer.bits));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static void CompressBlock(const BlockPixels& block, ECS_TEXTURE_COMPRESSION compression, void* output, const BlockCompressionOptions& options) {
+		const float* weights = options.perceptual_weighting ? PERCEPTUAL_WEIGHTS : UNIFORM_WEIGHTS;
+		switch (compression) {
+		case ECS_TEXTURE_COMPRESSION_BC1:
+			CompressBC1Color(block, weights, options.quality, options.alpha_cutout, false, output);
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC3:
+			CompressBC4Channel(block, 3, options.quality, output);
+			CompressBC1Color(block, weights, options.quality, false, true, OffsetPointer(output, 8));
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC4:
+			CompressBC4Channel(block, 0, options.quality, output);
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC5:
+			CompressBC4Channel(block, 0, options.quality, output);
+			CompressBC4Channel(block, 1, options.quality, OffsetPointer(output, 8));
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC7:
+			CompressBC7Mode6(block, weights, options.quality, output);
+			break;
+		default:
+			ECS_ASSERT(false, "There is no block compression encoder for the given compression");
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void BlockCompress(const unsigned char* pixels, ECS_TEXTURE_COMPRESSION compression, void* block, const BlockCompressionOptions& options) {
+		BlockPixels block_pixels;
+		LoadBlock(pixels, 4 * 4, 4, 4, 4, 0, 0, &block_pixels);
+		CompressBlock(block_pixels, compression, block, options);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static void DecompressBC1Color(const void* block, bool bc3_color, unsigned char* pixels) {
+		unsigned short color0;
+		unsigned short color1;
+		unsigned int index_bits;
+		memcpy(&color0, block, sizeof(color0));
+		memcpy(&color1, OffsetPointer(block, 2), sizeof(color1));
+		memcpy(&index_bits, OffsetPointer(block, 4), sizeof(index_bits));
+
+		float palette[4 * 3];
+		unsigned int palette_size = BC1Palette(color0, color1, bc3_color || color0 > color1, palette);
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			unsigned int index = (index_bits >> (pixel * 2)) & 3;
+			if (index < palette_size) {
+				for (unsigned int channel = 0; channel < 3; channel++) {
+					pixels[pixel * 4 + channel] = (unsigned char)(palette[index * 3 + channel] + 0.5f);
+				}
+				pixels[pixel * 4 + 3] = 255;
+			}
+			else {
+				// Transparent black
+				memset(pixels + pixel * 4, 0, 4);
+			}
+		}
+	}
+
+	static void DecompressBC4Channel(const void* block, unsigned int channel, unsigned char* pixels) {
+		const unsigned char* bytes = (const unsigned char*)block;
+		unsigned long long index_bits = 0;
+		memcpy(&index_bits, bytes + 2, 6);
+
+		float palette[8];
+		BC4Palette(bytes[0], bytes[1], palette);
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			pixels[pixel * 4 + channel] = (unsigned char)(palette[(index_bits >> (pixel * 3)) & 7] + 0.5f);
+		}
+	}
+
+	static bool DecompressBC7Mode6(const void* block, unsigned char* pixels) {
+		BlockBitReader reader;
+		memcpy(reader.bits, block, sizeof(reader.bits));
+		if (reader.Read(7) != 1 << 6) {
+			return false;
+		}
+
+		unsigned int endpoints[2][4];
+		for (unsigned int channel = 0; channel < 4; channel++) {
+			endpoints[0][channel] = reader.Read(7);
+			endpoints[1][channel] = reader.Read(7);
+		}
+		unsigned int p_bit0 = reader.Read(1);
+		unsigned int p_bit1 = reader.Read(1);
+		for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+			unsigned int weight = BC7_INDEX_WEIGHTS[reader.Read(pixel == 0 ? 3 : 4)];
+			for (unsigned int channel = 0; channel < 4; channel++) {
+				unsigned int decoded0 = (endpoints[0][channel] << 1) | p_bit0;
+				unsigned int decoded1 = (endpoints[1][channel] << 1) | p_bit1;
+				pixels[pixel * 4 + channel] = (unsigned char)(((64 - weight) * decoded0 + weight * decoded1 + 32) >> 6);
+			}
+		}
+		return true;
+	}
+
+	bool BlockDecompress(const void* block, ECS_TEXTURE_COMPRESSION compression, unsigned char* pixels) {
+		switch (compression) {
+		case ECS_TEXTURE_COMPRESSION_BC1:
+			DecompressBC1Color(block, false, pixels);
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC3:
+			DecompressBC1Color(OffsetPointer(block, 8), true, pixels);
+			DecompressBC4Channel(block, 3, pixels);
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC4:
+			DecompressBC4Channel(block, 0, pixels);
+			for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+				pixels[pixel * 4 + 1] = pixels[pixel * 4];
+				pixels[pixel * 4 + 2] = pixels[pixel * 4];
+				pixels[pixel * 4 + 3] = 255;
+			}
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC5:
+			DecompressBC4Channel(block, 0, pixels);
+			DecompressBC4Channel(OffsetPointer(block, 8), 1, pixels);
+			for (unsigned int pixel = 0; pixel < BLOCK_PIXEL_COUNT; pixel++) {
+				pixels[pixel * 4 + 2] = 0;
+				pixels[pixel * 4 + 3] = 255;
+			}
+			break;
+		case ECS_TEXTURE_COMPRESSION_BC7:
+			return DecompressBC7Mode6(block, pixels);
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	struct BlockCompressionImage {
+		const void* pixels;
+		size_t row_pitch;
+		size_t width;
+		size_t height;
+		void* output;
+	};
+
+	static void CompressBlockRow(
+		const BlockCompressionImage& image,
+		unsigned int channel_count,
+		size_t block_row,
+		ECS_TEXTURE_COMPRESSION compression,
+		const BlockCompressionOptions& options
+	) {
+		size_t block_size = GetBlockCompressionBlockByteSize(compression);
+		size_t block_columns = (image.width + 3) / 4;
+		void* row_output = OffsetPointer(image.output, block_row * block_columns * block_size);
+
+		BlockPixels block;
+		for (size_t column = 0; column < block_columns; column++) {
+			LoadBlock(image.pixels, image.row_pitch, channel_count, image.width, image.height, column, block_row, &block);
+			CompressBlock(block, compression, OffsetPointer(row_output, column * block_size), options);
+		}
+	}
+
+	// The block rows of all the images form a single range, such that the small mips are batched together
+	static void CompressBlockImages(
+		Stream<BlockCompressionImage> images,
+		unsigned int channel_count,
+		ECS_TEXTURE_COMPRESSION compression,
+		const BlockCompressionOptions& options
+	) {
+		// The first global row of each image, plus the total row count at the end
+		ECS_STACK_CAPACITY_STREAM(size_t, row_offsets, 64);
+		row_offsets.AssertCapacity(images.size + 1);
+		size_t total_row_count = 0;
+		for (size_t index = 0; index < images.size; index++) {
+			row_offsets[index] = total_row_count;
+			total_row_count += (images[index].height + 3) / 4;
+		}
+		row_offsets[images.size] = total_row_count;
+
+		ParallelForBatches(options.task_manager, total_row_count, BLOCK_COMPRESSION_MIN_ROW_BATCH, BLOCK_COMPRESSION_MAX_BATCH_COUNT,
+			[&](size_t batch_offset, size_t batch_count, size_t batch_index) {
+				size_t image_index = 0;
+				for (size_t row = batch_offset; row < batch_offset + batch_count; row++) {
+					while (row >= row_offsets[image_index + 1]) {
+						image_index++;
+					}
+					CompressBlockRow(images[image_index], channel_count, row - row_offsets[image_index], compression, options);
+				}
+			}
+		);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void BlockCompressImage(
+		const void* pixels,
+		size_t row_pitch,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		ECS_TEXTURE_COMPRESSION compression,
+		void* output,
+		const BlockCompressionOptions& options
+	) {
+		ECS_ASSERT(HasBlockCompressionEncoder(compression), "There is no block compression encoder for the given compression");
+		BlockCompressionImage image = { pixels, row_pitch, width, height, output };
+		CompressBlockImages({ &image, 1 }, channel_count, compression, options);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool BlockCompressMips(
+		Stream<Stream<void>> data,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		ECS_TEXTURE_COMPRESSION compression,
+		Stream<void>* new_data,
+		AllocatorPolymorphic allocator,
+		const BlockCompressionOptions& options
+	) {
+		if (!HasBlockCompressionEncoder(compression) || data.size == 0) {
+			return false;
+		}
+
+		ECS_STACK_CAPACITY_STREAM(BlockCompressionImage, images, 64);
+		images.AssertCapacity(data.size);
+		size_t total_size = 0;
+		for (size_t index = 0; index < data.size; index++) {
+			size_t mip_width = max(width >> index, (size_t)1);
+			size_t mip_height = max(height >> index, (size_t)1);
+			images[index] = { data[index].buffer, data[index].size / mip_height, mip_width, mip_height, nullptr };
+			total_size += GetBlockCompressedByteSize(compression, mip_width, mip_height);
+		}
+		images.size = data.size;
+
+		void* allocation = Allocate(allocator, total_size);
+		size_t offset = 0;
+		for (size_t index = 0; index < data.size; index++) {
+			size_t mip_size = GetBlockCompressedByteSize(compression, images[index].width, images[index].height);
+			images[index].output = OffsetPointer(allocation, offset);
+			new_data[index] = { images[index].output, mip_size };
+			offset += mip_size;
+		}
+
+		CompressBlockImages(images, channel_count, compression, options);
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	float CalculateBlockCompressionPSNR(
+		const void* pixels,
+		size_t row_pitch,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		const void* compressed,
+		ECS_TEXTURE_COMPRESSION compression
+	) {
+		unsigned int compressed_channel_count = 4;
+		if (compression == ECS_TEXTURE_COMPRESSION_BC1) {
+			compressed_channel_count = 3;
+		}
+		else if (compression == ECS_TEXTURE_COMPRESSION_BC4) {
+			compressed_channel_count = 1;
+		}
+		else if (compression == ECS_TEXTURE_COMPRESSION_BC5) {
+			compressed_channel_count = 2;
+		}
+		unsigned int compared_channel_count = min(channel_count, compressed_channel_count);
+
+		size_t block_size = GetBlockCompressionBlockByteSize(compression);
+		size_t block_columns = (width + 3) / 4;
+		size_t block_rows = (height + 3) / 4;
+		double squared_error = 0.0;
+		size_t sample_count = 0;
+		for (size_t block_y = 0; block_y < block_rows; block_y++) {
+			for (size_t block_x = 0; block_x < block_columns; block_x++) {
+				unsigned char decoded[BLOCK_PIXEL_COUNT * 4];
+				bool success = BlockDecompress(OffsetPointer(compressed, (block_y * block_columns + block_x) * block_size), compression, decoded);
+				ECS_ASSERT(success, "Cannot decode the compressed block for the PSNR");
+
+				for (size_t y = 0; y < 4 && block_y * 4 + y < height; y++) {
+					const unsigned char* row = (const unsigned char*)OffsetPointer(pixels, (block_y * 4 + y) * row_pitch);
+					for (size_t x = 0; x < 4 && block_x * 4 + x < width; x++) {
+						const unsigned char* decoded_pixel = decoded + (y * 4 + x) * 4;
+						// The BC1 cutout pixels have no color
+						if (compression == ECS_TEXTURE_COMPRESSION_BC1 && decoded_pixel[3] == 0) {
+							continue;
+						}
+						const unsigned char* pixel = row + (block_x * 4 + x) * channel_count;
+						for (unsigned int channel = 0; channel < compared_channel_count; channel++) {
+							double difference = (double)pixel[channel] - (double)decoded_pixel[channel];
+							squared_error += difference * difference;
+						}
+						sample_count += compared_channel_count;
+					}
+				}
+			}
+		}
+
+		if (squared_error == 0.0) {
+			return FLT_MAX;
+		}
+		double mean_squared_error = squared_error / (double)sample_count;
+		return (float)(10.0 * log10(255.0 * 255.0 / mean_squared_error));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "../../Core.h"
+#include "../../Containers/Stream.h"
+#include "../../Allocators/AllocatorTypes.h"
+#include "TextureCompressionTypes.h"
+
+namespace ECSEngine {
+
+	struct TaskManager;
+
+	// Built in CPU encoder for the BC1, BC3, BC4, BC5 and BC7 formats. It does not depend on the graphics device
+	// or on DirectXTex. BC6 is not supported, it must go through the GPU codec
+
+	enum ECS_BLOCK_COMPRESSION_QUALITY : unsigned char {
+		// The endpoints are the extremes of the principal axis of the block
+		ECS_BLOCK_COMPRESSION_QUALITY_FAST,
+		// Adds a least squares refinement of the endpoints and a small endpoint search for the single channel blocks
+		ECS_BLOCK_COMPRESSION_QUALITY_NORMAL,
+		// More refinement iterations, a wider single channel endpoint search and all the BC7 p-bit combinations
+		ECS_BLOCK_COMPRESSION_QUALITY_HIGH
+	};
+
+	struct BlockCompressionOptions {
+		ECS_BLOCK_COMPRESSION_QUALITY quality = ECS_BLOCK_COMPRESSION_QUALITY_NORMAL;
+		// Weights the color error by the luminance contribution of the channels. Used by BC1, BC3 and BC7
+		bool perceptual_weighting = true;
+		// For BC1, the pixels that have the alpha under half are encoded as transparent, using the 3 color mode
+		bool alpha_cutout = true;
+		// When set, the blocks are compressed in parallel. The calling thread takes part as well
+		TaskManager* task_manager = nullptr;
+	};
+
+	// BC7 is encoded with mode 6 only - a single RGBA subset with 4 bit indices - which is the same mode
+	// that the GPU codec uses in its quick mode
+	ECS_INLINE bool HasBlockCompressionEncoder(ECS_TEXTURE_COMPRESSION compression) {
+		return IsCPUCodec(compression) || compression == ECS_TEXTURE_COMPRESSION_BC7;
+	}
+
+	// The byte size of a 4x4 block
+	ECS_INLINE size_t GetBlockCompressionBlockByteSize(ECS_TEXTURE_COMPRESSION compression) {
+		return compression == ECS_TEXTURE_COMPRESSION_BC1 || compression == ECS_TEXTURE_COMPRESSION_BC4 ? 8 : 16;
+	}
+
+	// The byte size of a row of blocks
+	ECS_INLINE size_t GetBlockCompressedRowPitch(ECS_TEXTURE_COMPRESSION compression, size_t width) {
+		return ((width + 3) / 4) * GetBlockCompressionBlockByteSize(compression);
+	}
+
+	ECS_INLINE size_t GetBlockCompressedByteSize(ECS_TEXTURE_COMPRESSION compression, size_t width, size_t height) {
+		return GetBlockCompressedRowPitch(compression, width) * ((height + 3) / 4);
+	}
+
+	// The pixels are a 4x4 RGBA8 block, in row order. BC4 uses the red channel and BC5 the red and green channels
+	ECSENGINE_API void BlockCompress(const unsigned char* pixels, ECS_TEXTURE_COMPRESSION compression, void* block, const BlockCompressionOptions& options = {});
+
+	// Writes a 4x4 RGBA8 block, in row order. BC4 writes the value in all the color channels, BC5 sets blue to 0.
+	// For BC7 only the mode 6 blocks can be decoded - which are the ones that the encoder produces. Returns false
+	// if the block cannot be decoded
+	ECSENGINE_API bool BlockDecompress(const void* block, ECS_TEXTURE_COMPRESSION compression, unsigned char* pixels);
+
+	// The pixels have channel_count 8 bit channels (1, 2 or 4). The missing color channels are replicated from
+	// the red channel for grayscale images or are 0 otherwise, and the missing alpha is opaque. The dimensions that
+	// are not a multiple of 4 have the last row and column replicated. The output must have
+	// GetBlockCompressedByteSize bytes, the block rows being tightly packed
+	ECSENGINE_API void BlockCompressImage(
+		const void* pixels,
+		size_t row_pitch,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		ECS_TEXTURE_COMPRESSION compression,
+		void* output,
+		const BlockCompressionOptions& options = {}
+	);
+
+	// Data is a stream for each mip level, with the size of the whole mip level. Compresses all the blocks of all the mips
+	// (in parallel when a task manager is given) into a single allocation. To deallocate the data, deallocate the buffer of
+	// the first mip. Returns false if the compression has no encoder
+	ECSENGINE_API bool BlockCompressMips(
+		Stream<Stream<void>> data,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		ECS_TEXTURE_COMPRESSION compression,
+		Stream<void>* new_data,
+		AllocatorPolymorphic allocator,
+		const BlockCompressionOptions& options = {}
+	);
+
+	// Returns the peak signal to noise ratio, in decibels, of the compressed image against the original. Only the
+	// channels that are present in both are compared (BC1 ignores alpha). Returns FLT_MAX for identical images
+	ECSENGINE_API float CalculateBlockCompressionPSNR(
+		const void* pixels,
+		size_t row_pitch,
+		unsigned int channel_count,
+		size_t width,
+		size_t height,
+		const void* compressed,
+		ECS_TEXTURE_COMPRESSION compression
+	);
+
+}
@@ -313,7 +313,7 @@ namespace ECSEngine {
 			: COMPRESSED_FORMATS[compression_type];
 
 		ECS_STACK_CAPACITY_STREAM_DYNAMIC(Stream<void>, new_data, data.size);
-		if (IsCPUCodec(compression_type)) {
+		if (IsCPUCodec(compression_type) || (compression_type == ECS_TEXTURE_COMPRESSION_BC7 && HasFlag(descriptor.flags, ECS_TEXTURE_COMPRESS_CPU_BC7))) {
 			bool success = CompressTexture(data, new_data.buffer, width, height, compression_type, descriptor);
 			if (!success) {
 				return texture_result;
@@ -457,18 +457,9 @@ namespace ECSEngine {
 		const CompressTextureDescriptor& descriptor
 	)
 	{
-		// Get the texture descriptor and fill the DirectX image
-		ECS_GRAPHICS_FORMAT texture_format = ECS_GRAPHICS_FORMAT_RGBA8_UNORM;
-		if (compression_type == ECS_TEXTURE_COMPRESSION_BC3) {
-			texture_format = ECS_GRAPHICS_FORMAT_R8_UNORM;
-		}
-		else if (compression_type == ECS_TEXTURE_COMPRESSION_BC5) {
-			texture_format = ECS_GRAPHICS_FORMAT_RG8_UNORM;
-		}
-
-		// Check if the compression type conforms to the range
-		if ((unsigned int)compression_type > (unsigned int)ECS_TEXTURE_COMPRESSION_BC5) {
-			SetErrorMessageInternal(descriptor.error_message, "Incorrect compression type - out of range.");
+		// Check if the compression type has a CPU encoder
+		if (!HasBlockCompressionEncoder(compression_type)) {
+			SetErrorMessageInternal(descriptor.error_message, "Incorrect compression type - there is no CPU encoder for it.");
 			return false;
 		}
 
@@ -478,62 +469,18 @@ namespace ECSEngine {
 			return false;
 		}
 
-		DirectX::ScratchImage initial_image;
-		SetInternalImageAllocator(&initial_image, descriptor.allocator);
-
-		HRESULT dx_result = initial_image.Initialize2D(GetGraphicsNativeFormat(texture_format), width, height, 1, data.size);
-		if (FAILED(dx_result)) {
-			SetErrorMessageInternal(descriptor.error_message, "Failed to set internal image settings for compression");
+		// The row pitch can have padding, but it is smaller than a pixel per row
+		size_t channel_count = data.size > 0 ? data[0].size / (width * height) : 0;
+		if (channel_count != 1 && channel_count != 2 && channel_count != 4) {
+			SetErrorMessageInternal(descriptor.error_message, "Unsupported pixel format for compression. The pixels must have 1, 2 or 4 8 bit channels.");
 			return false;
 		}
 
-		ECS_GRAPHICS_FORMAT compressed_format = COMPRESSED_FORMATS[(unsigned int)compression_type];
-		DirectX::ScratchImage final_image;
-		SetInternalImageAllocator(&final_image, descriptor.allocator);
-
-		DirectX::TEX_COMPRESS_FLAGS compress_flag = GetCompressionFlag(descriptor.flags);
-
-		for (size_t index = 0; index < data.size; index++) {
-			const DirectX::Image* image = initial_image.GetImage(index, 0, 0);
-			size_t row_pitch = data[index].size / image->height;
-			if (image->rowPitch == row_pitch) {
-				memcpy(image->pixels, data[index].buffer, image->rowPitch * image->height);
-			}
-			else {
-				size_t offset = 0;
-				size_t mapping_offset = 0;
-				for (size_t subindex = 0; subindex < image->height; subindex++) {
-					memcpy(OffsetPointer(image->pixels, offset), OffsetPointer(data[index].buffer, mapping_offset), image->rowPitch);
-					offset += image->rowPitch;
-					mapping_offset += row_pitch;
-				}
-			}
-		}
-
-		HRESULT result = DirectX::Compress(
-			initial_image.GetImages(),
-			initial_image.GetImageCount(),
-			initial_image.GetMetadata(),
-			GetGraphicsNativeFormat(compressed_format),
-			compress_flag,
-			DirectX::TEX_THRESHOLD_DEFAULT,
-			final_image
-		);
-
-		if (FAILED(result)) {
-			SetErrorMessageInternal(descriptor.error_message, "Texture compression failed during codec.");
-			return false;
-		}
-
-		for (size_t index = 0; index < data.size; index++) {
-			const DirectX::Image* image = final_image.GetImage(index, 0, 0);
-			// The row pitch must be divided by 4 because the function returns the byte count of 4 scanlines - not for a single one
-			// Or use the slice pitch
-			new_data[index] = { image->pixels, image->slicePitch };
-		}
-
-		final_image.DetachPixels();
-		return true;
+		BlockCompressionOptions options;
+		options.quality = descriptor.quality;
+		options.perceptual_weighting = !HasFlag(descriptor.flags, ECS_TEXTURE_COMPRESS_DISABLE_PERCEPTUAL_WEIGHTING);
+		options.task_manager = HasFlag(descriptor.flags, ECS_TEXTURE_COMPRESS_DISABLE_MULTICORE) ? nullptr : descriptor.task_manager;
+		return BlockCompressMips(data, (unsigned int)channel_count, width, height, compression_type, new_data, descriptor.allocator, options);
 	}
 
 	// --------------------------------------------------------------------------------------------------------------------------------------
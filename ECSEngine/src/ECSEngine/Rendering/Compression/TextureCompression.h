@@ -3,12 +3,14 @@
 #include "../RenderingStructures.h"
 #include "../../Containers/Stream.h"
 #include "TextureCompressionTypes.h"
+#include "BlockCompression.h"
 #include "../../Allocators/AllocatorTypes.h"
 
 namespace ECSEngine {
 
 	struct Graphics;
 	struct SpinLock;
+	struct TaskManager;
 
 	struct CompressTextureDescriptor {
 		ECS_INLINE void GPULock() const {
@@ -28,6 +30,10 @@ namespace ECSEngine {
 		CapacityStream<char>* error_message = nullptr;
 		// If set, it will acquire lock it to synchronize the access to the immediate context
 		SpinLock* gpu_lock = nullptr;
+		// Used by the CPU codecs, which use the built in block encoder
+		ECS_BLOCK_COMPRESSION_QUALITY quality = ECS_BLOCK_COMPRESSION_QUALITY_NORMAL;
+		// If set, the CPU codecs compress the blocks in parallel, unless the multicore is disabled
+		TaskManager* task_manager = nullptr;
 	};
 
 	// If the texture resides in GPU memory with no CPU access, for CPU compression i.e. BC1, BC3, BC4 
@@ -83,7 +89,9 @@ namespace ECSEngine {
 		DebugInfo debug_info = ECS_DEBUG_INFO
 	);
 
-	// It doesn't relly on the immediate context - if no allocator is specified, it will use Malloc to generate the temporary data
+	// It doesn't relly on the immediate context or on the graphics device - if no allocator is specified, it will use Malloc
+	// to generate the temporary data. It uses the built in block encoder, which supports BC1, BC3, BC4, BC5 and BC7.
+	// The pixels must have 1, 2 or 4 8 bit channels, the count being deduced from the size of the first mip
 	// Data is a stream of data for each of the textures mip levels
 	// It returns a null texture if it fails
 	// In order to deallocate the received data, just deallocate the buffer of the first stream
@@ -35,7 +35,9 @@ namespace ECSEngine {
 		ECS_TEXTURE_COMPRESS_SRGB = 1 << 1,
 		// Adds to the bind flags the render target flag
 		ECS_TEXTURE_COMPRESS_BIND_RENDER_TARGET = 1 << 2,
-		ECS_TEXTURE_COMPRESS_DISABLE_MULTICORE = 1 << 3
+		ECS_TEXTURE_COMPRESS_DISABLE_MULTICORE = 1 << 3,
+		// BC7 uses the built in CPU block encoder instead of the GPU codec, for the data stream overloads
+		ECS_TEXTURE_COMPRESS_CPU_BC7 = 1 << 4
 	};
 
 	ECS_ENUM_BITWISE_OPERATIONS(ECS_TEXTURE_COMPRESS_FLAGS);
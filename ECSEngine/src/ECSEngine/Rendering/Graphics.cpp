@@ -134,6 +134,12 @@ namespace ECSEngine {
 	static_assert(ECS_COUNTOF(ECS_GRAPHICS_RESOURCE_TYPE_STRING) == ECS_GRAPHICS_RESOURCE_TYPE_COUNT);
 
 #define GRAPHICS_INTERNAL_RESOURCE_STARTING_COUNT 1024
+
+// Records the command when a recorder is set and returns early when the recorder skips the execution
+#define GRAPHICS_RECORD_COMMAND(type, argument) if (m_command_recorder != nullptr && m_command_recorder->Record(type, argument)) { return; }
+
+// Records the command without skipping it, for the calls that must always reach the context
+#define GRAPHICS_RECORD_COMMAND_EXECUTE(type, argument) if (m_command_recorder != nullptr) { m_command_recorder->Record(type, argument); }
 	
 	static ECS_GRAPHICS_RESOURCE_TYPE StringToResourceType(Stream<char> string) {
 		ECS_GRAPHICS_RESOURCE_TYPE resource_type = ECS_GRAPHICS_RESOURCE_TYPE_COUNT;
@@ -469,7 +475,7 @@ namespace ECSEngine {
 
 	Graphics::Graphics(const GraphicsDescriptor* descriptor)
 		: m_creation_render_view(nullptr), m_creation_depth_view(nullptr), m_device(nullptr), m_context(nullptr), m_swap_chain(nullptr), m_allocator(descriptor->allocator),
-		m_bound_render_target_count(1)
+		m_bound_render_target_count(1), m_command_recorder(nullptr)
 	{
 		// The internal resources
 		m_internal_resources.Initialize(descriptor->allocator, GRAPHICS_INTERNAL_RESOURCE_STARTING_COUNT);
@@ -626,131 +632,153 @@ namespace ECSEngine {
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexBuffer(VertexBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_VERTEX_BUFFER, 1);
 		ECSEngine::BindVertexBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexBuffers(Stream<VertexBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_VERTEX_BUFFER, buffers.size);
 		ECSEngine::BindVertexBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindIndexBuffer(IndexBuffer index_buffer) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_INDEX_BUFFER, 1);
 		ECSEngine::BindIndexBuffer(index_buffer, m_context);
 	}
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindInputLayout(InputLayout input_layout) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_INPUT_LAYOUT, 1);
 		ECSEngine::BindInputLayout(input_layout, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexShader(VertexShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindVertexShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelShader(PixelShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindPixelShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindDomainShader(DomainShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindDomainShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindHullShader(HullShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindHullShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindGeometryShader(GeometryShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindGeometryShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeShader(ComputeShader shader) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::BindComputeShader(shader, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindPixelConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindPixelConstantBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindVertexConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindVertexConstantBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindDomainConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindDomainConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindDomainConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindDomainConstantBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindHullConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindHullConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindHullConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindHullConstantBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindGeometryConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindGeometryConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindGeometryConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindGeometryConstantBuffers(buffers, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeConstantBuffer(ConstantBuffer buffer, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, 1);
 		ECSEngine::BindComputeConstantBuffer(buffer, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeConstantBuffers(Stream<ConstantBuffer> buffers, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER, buffers.size);
 		ECSEngine::BindComputeConstantBuffers(buffers, m_context, start_slot);
 	}
 
@@ -758,78 +786,91 @@ namespace ECSEngine {
 
 	void Graphics::BindTopology(Topology topology)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_TOPOLOGY, 1);
 		ECSEngine::BindTopology(topology, m_context);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindPixelResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindPixelResourceViews(views, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindVertexResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindVertexResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindVertexResourceViews(views, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindDomainResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindDomainResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindDomainResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindDomainResourceViews(views, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindHullResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindHullResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindHullResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindHullResourceViews(views, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindGeometryResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindGeometryResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindGeometryResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindGeometryResourceViews(views, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeResourceView(ResourceView component, unsigned int slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, 1);
 		ECSEngine::BindComputeResourceView(component, m_context, slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeResourceViews(Stream<ResourceView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW, views.size);
 		ECSEngine::BindComputeResourceViews(views, m_context, start_slot);
 	}
 
@@ -837,6 +878,7 @@ namespace ECSEngine {
 
 	void Graphics::BindSamplerState(SamplerState sampler, unsigned int slot)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SAMPLER_STATE, 1);
 		ECSEngine::BindSamplerState(sampler, m_context, slot);
 	}
 
@@ -844,6 +886,7 @@ namespace ECSEngine {
 
 	void Graphics::BindSamplerStates(Stream<SamplerState> samplers, unsigned int start_slot)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SAMPLER_STATE, samplers.size);
 		ECSEngine::BindSamplerStates(samplers, m_context, start_slot);
 	}
 
@@ -851,6 +894,7 @@ namespace ECSEngine {
 
 	void Graphics::BindPixelUAView(UAView view, unsigned int start_slot)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_UA_VIEW, 1);
 		m_context->OMSetRenderTargetsAndUnorderedAccessViews(
 			D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, 
 			nullptr, 
@@ -866,12 +910,14 @@ namespace ECSEngine {
 
 	void Graphics::BindComputeUAView(UAView view, unsigned int start_slot)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_UA_VIEW, 1);
 		ECSEngine::BindComputeUAView(view, m_context, start_slot);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindPixelUAViews(Stream<UAView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_UA_VIEW, views.size);
 		m_context->OMSetRenderTargetsAndUnorderedAccessViews(
 			D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, 
 			nullptr, 
@@ -886,6 +932,7 @@ namespace ECSEngine {
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindComputeUAViews(Stream<UAView> views, unsigned int start_slot) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_UA_VIEW, views.size);
 		ECSEngine::BindComputeUAViews(views, m_context, start_slot);
 	}
 
@@ -893,6 +940,7 @@ namespace ECSEngine {
 
 	void Graphics::BindRasterizerState(RasterizerState state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::BindRasterizerState(state, m_context);
 	}
 
@@ -900,6 +948,7 @@ namespace ECSEngine {
 
 	void Graphics::BindDepthStencilState(DepthStencilState state, unsigned int stencil_ref)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::BindDepthStencilState(state, m_context, stencil_ref);
 	}
 
@@ -907,6 +956,7 @@ namespace ECSEngine {
 
 	void Graphics::BindBlendState(BlendState state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::BindBlendState(state, m_context);
 	}
 
@@ -938,6 +988,7 @@ namespace ECSEngine {
 
 	void Graphics::BindViewport(float top_left_x, float top_left_y, float width, float height, float min_depth, float max_depth)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_VIEWPORT, 1);
 		ECSEngine::BindViewport(top_left_x, top_left_y, width, height, min_depth, max_depth, m_context);
 	}
 
@@ -964,6 +1015,7 @@ namespace ECSEngine {
 
 	void Graphics::BindMesh(const Mesh& mesh)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_MESH, 1);
 		ECSEngine::BindMesh(mesh, m_context);
 	}
 
@@ -971,12 +1023,14 @@ namespace ECSEngine {
 
 	void Graphics::BindMesh(const Mesh& mesh, Stream<ECS_MESH_INDEX> mapping)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_MESH, 1);
 		ECSEngine::BindMesh(mesh, m_context, mapping);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::BindMaterial(const Material& material) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_MATERIAL, 1);
 		ECSEngine::BindMaterial(material, m_context);
 	}
 
@@ -3067,6 +3121,7 @@ namespace ECSEngine {
 
 	void Graphics::ClearRenderTarget(RenderTargetView target, ColorFloat color)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_CLEAR, 1);
 		ECSEngine::ClearRenderTarget(target, GetContext(), color);
 	}
 
@@ -3074,6 +3129,7 @@ namespace ECSEngine {
 
 	void Graphics::ClearDepth(DepthStencilView depth_stencil, float depth) 
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_CLEAR, 1);
 		ECSEngine::ClearDepth(depth_stencil, GetContext(), depth);
 	}
 
@@ -3081,6 +3137,7 @@ namespace ECSEngine {
 
 	void Graphics::ClearStencil(DepthStencilView depth_stencil, unsigned char stencil) 
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_CLEAR, 1);
 		ECSEngine::ClearStencil(depth_stencil, GetContext(), stencil);
 	}
 
@@ -3088,6 +3145,7 @@ namespace ECSEngine {
 
 	void Graphics::ClearDepthStencil(DepthStencilView depth_stencil, float depth, unsigned char stencil)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_CLEAR, 1);
 		ECSEngine::ClearDepthStencil(depth_stencil, GetContext(), depth, stencil);
 	}
 
@@ -3195,6 +3253,7 @@ namespace ECSEngine {
 
 	void Graphics::Dispatch(uint3 dispatch_size)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DISPATCH, 1);
 		ECSEngine::Dispatch(dispatch_size, GetContext());
 	}
 
@@ -3202,6 +3261,7 @@ namespace ECSEngine {
 
 	void Graphics::Dispatch(Texture2D texture, uint3 compute_shader_threads)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DISPATCH, 1);
 		ECSEngine::Dispatch(texture, compute_shader_threads, GetContext());
 	}
 
@@ -3209,6 +3269,7 @@ namespace ECSEngine {
 
 	void Graphics::DispatchIndirect(IndirectBuffer buffer)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DISPATCH, 1);
 		ECSEngine::DispatchIndirect(buffer, GetContext());
 	}
 
@@ -3216,12 +3277,14 @@ namespace ECSEngine {
 
 	void Graphics::Draw(unsigned int vertex_count, unsigned int vertex_offset)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::Draw(vertex_count, GetContext(), vertex_offset);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::DrawIndexed(unsigned int count, unsigned int start_index, unsigned int base_vertex_location) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::DrawIndexed(count, GetContext(), start_index, base_vertex_location);
 	}
 
@@ -3233,6 +3296,7 @@ namespace ECSEngine {
 		unsigned int vertex_buffer_offset,
 		unsigned int instance_offset
 	) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, instance_count);
 		ECSEngine::DrawInstanced(vertex_count, instance_count, GetContext(), vertex_buffer_offset, instance_offset);
 	}
 
@@ -3245,18 +3309,21 @@ namespace ECSEngine {
 		unsigned int vertex_buffer_offset, 
 		unsigned int instance_offset
 	) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, instance_count);
 		ECSEngine::DrawIndexedInstanced(index_count, instance_count, GetContext(), index_buffer_offset, vertex_buffer_offset, instance_offset);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::DrawIndexedInstancedIndirect(IndirectBuffer buffer) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::DrawIndexedInstancedIndirect(buffer, GetContext());
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::DrawInstancedIndirect(IndirectBuffer buffer) {
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::DrawInstancedIndirect(buffer, GetContext());
 	}
 
@@ -3264,6 +3331,7 @@ namespace ECSEngine {
 
 	void Graphics::DrawMesh(const Mesh& mesh, const Material& material)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::DrawMesh(mesh, material, GetContext());
 	}
 
@@ -3271,6 +3339,7 @@ namespace ECSEngine {
 
 	void Graphics::DrawMesh(const CoalescedMesh& mesh, unsigned int submesh_index, const Material& material)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, 1);
 		ECSEngine::DrawMesh(mesh, submesh_index, material, GetContext());
 	}
 
@@ -3278,6 +3347,7 @@ namespace ECSEngine {
 
 	void Graphics::DrawSubmeshCommand(Submesh submesh, unsigned int count)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, count);
 		ECSEngine::DrawSubmeshCommand(submesh, GetContext(), count);
 	}
 
@@ -3285,6 +3355,7 @@ namespace ECSEngine {
 
 	void Graphics::DrawCoalescedMeshCommand(const CoalescedMesh& mesh, unsigned int count)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_DRAW, count);
 		ECSEngine::DrawCoalescedMeshCommand(mesh, GetContext(), count);
 	}
 
@@ -3396,6 +3467,7 @@ namespace ECSEngine {
 
 	void* Graphics::MapBuffer(ID3D11Buffer* buffer, ECS_GRAPHICS_MAP_TYPE map_type, unsigned int subresource_index, unsigned int map_flags)
 	{
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_MAP, 1);
 		return ECSEngine::MapBuffer(buffer, GetContext(), map_type, subresource_index, map_flags);
 	}
 
@@ -3403,6 +3475,7 @@ namespace ECSEngine {
 
 	MappedTexture Graphics::MapTexture(Texture1D texture, ECS_GRAPHICS_MAP_TYPE map_type, unsigned int subresource_index, unsigned int map_flags)
 	{
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_MAP, 1);
 		return ECSEngine::MapTexture(texture, GetContext(), map_type, subresource_index, map_flags);
 	}
 
@@ -3410,6 +3483,7 @@ namespace ECSEngine {
 
 	MappedTexture Graphics::MapTexture(Texture2D texture, ECS_GRAPHICS_MAP_TYPE map_type, unsigned int subresource_index, unsigned int map_flags)
 	{
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_MAP, 1);
 		return ECSEngine::MapTexture(texture, GetContext(), map_type, subresource_index, map_flags);
 	}
 
@@ -3417,6 +3491,7 @@ namespace ECSEngine {
 
 	MappedTexture Graphics::MapTexture(Texture3D texture, ECS_GRAPHICS_MAP_TYPE map_type, unsigned int subresource_index, unsigned int map_flags)
 	{
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_MAP, 1);
 		return ECSEngine::MapTexture(texture, GetContext(), map_type, subresource_index, map_flags);
 	}
 
@@ -4090,6 +4165,7 @@ namespace ECSEngine {
 
 	void Graphics::RestoreBlendState(GraphicsPipelineBlendState state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::RestoreBlendState(GetContext(), state);
 	}
 
@@ -4097,6 +4173,7 @@ namespace ECSEngine {
 
 	void Graphics::RestoreDepthStencilState(GraphicsPipelineDepthStencilState state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::RestoreDepthStencilState(GetContext(), state);
 	}
 
@@ -4104,6 +4181,7 @@ namespace ECSEngine {
 
 	void Graphics::RestoreRasterizerState(GraphicsPipelineRasterizerState state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::RestoreRasterizerState(GetContext(), state);
 	}
 
@@ -4111,6 +4189,7 @@ namespace ECSEngine {
 
 	void Graphics::RestorePipelineRenderState(const GraphicsPipelineRenderState* state)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE, 1);
 		ECSEngine::RestorePipelineRenderState(GetContext(), state);
 	}
 
@@ -4118,6 +4197,7 @@ namespace ECSEngine {
 
 	void Graphics::RestorePipelineShaders(const GraphicsPipelineShaders* shaders)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_BIND_SHADER, 1);
 		ECSEngine::RestorePipelineShaders(GetContext(), shaders);
 	}
 
@@ -4232,6 +4312,7 @@ namespace ECSEngine {
 
 	void Graphics::UpdateBuffer(ID3D11Buffer* buffer, const void* data, size_t data_size, ECS_GRAPHICS_MAP_TYPE map_type, unsigned int map_flags, unsigned int subresource_index)
 	{
+		GRAPHICS_RECORD_COMMAND(ECS_GRAPHICS_COMMAND_UPDATE_BUFFER, data_size);
 		ECSEngine::UpdateBuffer(buffer, data, data_size, m_context, map_type, map_flags, subresource_index);
 	}
 
@@ -4239,24 +4320,28 @@ namespace ECSEngine {
 
 	void Graphics::UnmapBuffer(ID3D11Buffer* buffer, unsigned int resource_index)
 	{
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_UNMAP, 1);
 		ECSEngine::UnmapBuffer(buffer, m_context, resource_index);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::UnmapTexture(Texture1D texture, unsigned int resource_index) {
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_UNMAP, 1);
 		ECSEngine::UnmapTexture(texture, m_context, resource_index);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::UnmapTexture(Texture2D texture, unsigned int resource_index) {
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_UNMAP, 1);
 		ECSEngine::UnmapTexture(texture, m_context, resource_index);
 	}
 
 	// ------------------------------------------------------------------------------------------------------------------------
 
 	void Graphics::UnmapTexture(Texture3D texture, unsigned int resource_index) {
+		GRAPHICS_RECORD_COMMAND_EXECUTE(ECS_GRAPHICS_COMMAND_UNMAP, 1);
 		ECSEngine::UnmapTexture(texture, m_context, resource_index);
 	}
 
@@ -7,6 +7,7 @@
 #include "../Allocators/MemoryManager.h"
 #include "../Containers/AtomicStream.h"
 #include "../Utilities/ByteUnits.h"
+#include "GraphicsCommandRecorder.h"
 
 #define ECS_PIXEL_SHADER_SOURCE(name) L"C:\\Users\\Andrei\\C++\\ECSEngine\\ECSEngine\\src\\ECSEngine\\Rendering\\Shaders\\Pixel\\" TEXT(STRING(name.hlsl))
 #define ECS_VERTEX_SHADER_SOURCE(name) L"C:\\Users\\Andrei\\C++\\ECSEngine\\ECSEngine\\src\\ECSEngine\\Rendering\\Shaders\\Vertex\\" TEXT(STRING(name.hlsl))
@@ -1204,6 +1205,10 @@ namespace ECSEngine {
 			return m_deferred_context;
 		}
 
+		ECS_INLINE GraphicsCommandRecorder* GetCommandRecorder() {
+			return m_command_recorder;
+		}
+
 		GraphicsPipelineBlendState GetBlendState() const;
 
 		GraphicsPipelineDepthStencilState GetDepthStencilState() const;
@@ -1285,6 +1290,13 @@ namespace ECSEngine {
 
 		void SetNewSize(HWND hWnd, unsigned int width, unsigned int height);
 
+		// The recorder can be nullptr to stop recording. With the skip_execution flag set, the recorded commands
+		// are not submitted to the context, but the resource creation still uses the device and the maps and unmaps still
+		// reach the context, such that a mapped resource is always unmapped
+		ECS_INLINE void SetCommandRecorder(GraphicsCommandRecorder* recorder) {
+			m_command_recorder = recorder;
+		}
+
 		// Transfers a shared GPU texture/buffer from a Graphics instance to another - should only create
 		// another runtime DX11 reference to that texture, there should be no memory blit or copy
 		// It does not affect samplers, input layouts, shaders, other pipeline objects (rasterizer/blend/depth states)
@@ -1368,6 +1380,8 @@ namespace ECSEngine {
 		ShaderReflection* m_shader_reflection;
 		MemoryManager* m_allocator;
 		CapacityStream<GraphicsShaderHelper> m_shader_helpers;
+		// When set, the context commands issued through the member functions are recorded
+		GraphicsCommandRecorder* m_command_recorder;
 		// Keep a track of the created resources, for leaks and for winking out the device
 		// For some reason DX11 does not provide a winking method for the device!!!
 		AtomicStream<GraphicsInternalResource> m_internal_resources;
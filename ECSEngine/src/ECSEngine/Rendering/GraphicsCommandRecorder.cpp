@@ -0,0 +1,48 @@
+#include "ecspch.h"
+#include "GraphicsCommandRecorder.h"
+#include "../Allocators/AllocatorPolymorphic.h"
+
+namespace ECSEngine {
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	void GraphicsCommandRecorder::Initialize(AllocatorPolymorphic _allocator, unsigned int capacity)
+	{
+		allocator = _allocator;
+		commands.Initialize(allocator, 0, capacity);
+		skip_execution = false;
+		Reset();
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	void GraphicsCommandRecorder::Deallocate()
+	{
+		if (commands.capacity > 0 && commands.buffer != nullptr) {
+			ECSEngine::Deallocate(allocator, commands.buffer);
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	void GraphicsCommandRecorder::Reset()
+	{
+		commands.size = 0;
+		dropped_command_count = 0;
+		memset(counts, 0, sizeof(counts));
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	size_t GraphicsCommandRecorder::StateChangeCount() const
+	{
+		size_t count = 0;
+		for (size_t index = 0; index <= ECS_GRAPHICS_COMMAND_BIND_MATERIAL; index++) {
+			count += counts[index];
+		}
+		return count;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+}
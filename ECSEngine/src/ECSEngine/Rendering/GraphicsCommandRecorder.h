@@ -0,0 +1,85 @@
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Allocators/AllocatorTypes.h"
+
+namespace ECSEngine {
+
+	enum ECS_GRAPHICS_COMMAND_TYPE : unsigned char {
+		ECS_GRAPHICS_COMMAND_BIND_SHADER,
+		ECS_GRAPHICS_COMMAND_BIND_INPUT_LAYOUT,
+		ECS_GRAPHICS_COMMAND_BIND_VERTEX_BUFFER,
+		ECS_GRAPHICS_COMMAND_BIND_INDEX_BUFFER,
+		ECS_GRAPHICS_COMMAND_BIND_TOPOLOGY,
+		ECS_GRAPHICS_COMMAND_BIND_CONSTANT_BUFFER,
+		ECS_GRAPHICS_COMMAND_BIND_RESOURCE_VIEW,
+		ECS_GRAPHICS_COMMAND_BIND_UA_VIEW,
+		ECS_GRAPHICS_COMMAND_BIND_SAMPLER_STATE,
+		// Blend, depth stencil and rasterizer states, including the restore calls
+		ECS_GRAPHICS_COMMAND_BIND_PIPELINE_STATE,
+		ECS_GRAPHICS_COMMAND_BIND_VIEWPORT,
+		ECS_GRAPHICS_COMMAND_BIND_MESH,
+		ECS_GRAPHICS_COMMAND_BIND_MATERIAL,
+		ECS_GRAPHICS_COMMAND_CLEAR,
+		ECS_GRAPHICS_COMMAND_DRAW,
+		ECS_GRAPHICS_COMMAND_DISPATCH,
+		ECS_GRAPHICS_COMMAND_UPDATE_BUFFER,
+		// The maps and unmaps are always executed, since the caller writes through the mapped pointer
+		ECS_GRAPHICS_COMMAND_MAP,
+		ECS_GRAPHICS_COMMAND_UNMAP,
+		ECS_GRAPHICS_COMMAND_TYPE_COUNT
+	};
+
+	struct GraphicsCommand {
+		ECS_GRAPHICS_COMMAND_TYPE type;
+		// The count of elements for the calls that bind multiple elements at once, the byte size
+		// for the buffer updates and the instance or submesh count for the draws. Otherwise it is 1
+		unsigned int argument;
+	};
+
+	// When set on a Graphics object, the context commands issued through its member functions are recorded into a
+	// compact command stream and counted. With skip_execution the commands are not submitted to the context at all,
+	// which allows measuring the CPU side cost of the submission in isolation. The resource creation, the maps and the unmaps
+	// are not affected by it.
+	// It must be used only from the thread that uses the immediate context
+	struct ECSENGINE_API GraphicsCommandRecorder {
+		// With a capacity of 0, only the counts are kept
+		void Initialize(AllocatorPolymorphic allocator, unsigned int capacity);
+
+		void Deallocate();
+
+		// Returns true if the command should not be executed
+		ECS_INLINE bool Record(ECS_GRAPHICS_COMMAND_TYPE type, size_t argument = 1) {
+			counts[type]++;
+			if (commands.size < commands.capacity) {
+				commands.Add({ type, (unsigned int)argument });
+			}
+			else {
+				dropped_command_count++;
+			}
+			return skip_execution;
+		}
+
+		// Clears the commands and the counts, it should be called at the start of each frame
+		void Reset();
+
+		// The bind calls, without the draws, dispatches, clears and buffer updates
+		size_t StateChangeCount() const;
+
+		ECS_INLINE size_t DrawCount() const {
+			return counts[ECS_GRAPHICS_COMMAND_DRAW];
+		}
+
+		ECS_INLINE size_t CommandCount() const {
+			return commands.size + dropped_command_count;
+		}
+
+		AllocatorPolymorphic allocator;
+		CapacityStream<GraphicsCommand> commands;
+		// The commands that did not fit in the stream, these are still counted
+		size_t dropped_command_count;
+		size_t counts[ECS_GRAPHICS_COMMAND_TYPE_COUNT];
+		bool skip_execution;
+	};
+
+}
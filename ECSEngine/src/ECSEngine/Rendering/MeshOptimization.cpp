@@ -0,0 +1,791 @@
+#include "ecspch.h"
+#include "MeshOptimization.h"
+#include "RenderingStructures.h"
+#include "../GLTF/GLTFLoader.h"
+#include "../Allocators/AllocatorPolymorphic.h"
+#include "../Containers/Hashing.h"
+#include "../Utilities/Algorithms.h"
+#include "../Math/Vector.h"
+#include "../Utilities/PointerUtilities.h"
+
+// The constants used by Forsyth's vertex cache scoring
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+// Bounds the amount of simplification passes, in case each pass can collapse only a few edges
+#define SIMPLIFICATION_MAX_PASS_COUNT 128
+
+namespace ECSEngine {
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	// Returns a power of two that is at least twice the count, such that the open addressing tables have a low load factor
+	static unsigned int HashTableCapacity(unsigned int count) {
+		unsigned int capacity = 16;
+		while (capacity < count * 2) {
+			capacity <<= 1;
+		}
+		return capacity;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	float CalculateMeshACMR(Stream<unsigned int> indices, unsigned int vertex_count, unsigned int cache_size) {
+		if (indices.size < 3) {
+			return 0.0f;
+		}
+
+		// A vertex is in the cache if fewer than cache_size misses happened since it was last loaded
+		unsigned int* timestamps = (unsigned int*)Allocate(ECS_MALLOC_ALLOCATOR, sizeof(unsigned int) * vertex_count);
+		memset(timestamps, 0, sizeof(unsigned int) * vertex_count);
+
+		unsigned int time = cache_size + 1;
+		unsigned int misses = 0;
+		for (size_t index = 0; index < indices.size; index++) {
+			unsigned int vertex = indices[index];
+			ECS_ASSERT(vertex < vertex_count);
+			if (time - timestamps[vertex] > cache_size) {
+				timestamps[vertex] = time++;
+				misses++;
+			}
+		}
+
+		Deallocate(ECS_MALLOC_ALLOCATOR, timestamps);
+		return (float)misses / (float)(indices.size / 3);
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	static float ForsythVertexScore(int cache_position, unsigned int live_triangles) {
+		if (live_triangles == 0) {
+			// The vertex is no longer used, there is no point in keeping it around
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cache_position >= 0) {
+			if (cache_position < 3) {
+				// The vertices of the last triangle are scored lower, since the triangles that share
+				// an edge with it would produce strips, which are not better for a FIFO cache
+				score = FORSYTH_LAST_TRIANGLE_SCORE;
+			}
+			else {
+				const float scaler = 1.0f / (ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE - 3);
+				score = powf(1.0f - (cache_position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+			}
+		}
+
+		// Boost the vertices that have few triangles remaining, such that they are finished off and
+		// no lone triangles are left behind that would need to reload their vertices later on
+		score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)live_triangles, -FORSYTH_VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	void OptimizeMeshVertexCache(Stream<unsigned int> indices, unsigned int vertex_count, AllocatorPolymorphic temporary_allocator) {
+		ECS_ASSERT(indices.size % 3 == 0);
+		unsigned int triangle_count = (unsigned int)(indices.size / 3);
+		if (triangle_count < 2 || vertex_count == 0) {
+			return;
+		}
+
+		// The adjacency lists are stored contiguously, with the live triangle count of each vertex
+		// being the size of its list. The emitted triangles are swapped to the end of the lists
+		unsigned int* live_triangles = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int* adjacency_offsets = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int* adjacency = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * indices.size);
+		float* vertex_scores = (float*)Allocate(temporary_allocator, sizeof(float) * vertex_count);
+		bool* emitted = (bool*)Allocate(temporary_allocator, sizeof(bool) * triangle_count, alignof(bool));
+		unsigned int* output = (unsigned int*)Allocate(temporary_allocator, indices.MemoryOf(indices.size));
+
+		memset(live_triangles, 0, sizeof(unsigned int) * vertex_count);
+		for (size_t index = 0; index < indices.size; index++) {
+			ECS_ASSERT(indices[index] < vertex_count);
+			live_triangles[indices[index]]++;
+		}
+
+		unsigned int offset = 0;
+		for (unsigned int index = 0; index < vertex_count; index++) {
+			adjacency_offsets[index] = offset;
+			offset += live_triangles[index];
+			live_triangles[index] = 0;
+		}
+
+		for (unsigned int triangle = 0; triangle < triangle_count; triangle++) {
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				unsigned int vertex = indices[triangle * 3 + corner];
+				adjacency[adjacency_offsets[vertex] + live_triangles[vertex]++] = triangle;
+			}
+		}
+
+		for (unsigned int index = 0; index < vertex_count; index++) {
+			vertex_scores[index] = ForsythVertexScore(-1, live_triangles[index]);
+		}
+		memset(emitted, 0, sizeof(bool) * triangle_count);
+
+		// The cache holds 3 more entries than the simulated size, such that the vertices of the
+		// emitted triangle can be inserted before the ones that are pushed out are evicted
+		unsigned int cache[ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE + 3];
+		unsigned int new_cache[ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE + 3];
+		unsigned int cache_count = 0;
+
+		unsigned int best_triangle = -1;
+		unsigned int scan_cursor = 0;
+		for (unsigned int output_triangle = 0; output_triangle < triangle_count; output_triangle++) {
+			if (best_triangle == -1) {
+				// None of the triangles that use the cached vertices remained, continue with the first
+				// triangle that was not emitted. This happens mostly when moving to a disjoint part of the mesh
+				while (emitted[scan_cursor]) {
+					scan_cursor++;
+				}
+				best_triangle = scan_cursor;
+			}
+
+			const unsigned int* triangle_indices = indices.buffer + best_triangle * 3;
+			memcpy(output + output_triangle * 3, triangle_indices, sizeof(unsigned int) * 3);
+			emitted[best_triangle] = true;
+
+			// Remove the triangle from the adjacency lists of its vertices
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				unsigned int vertex = triangle_indices[corner];
+				unsigned int* vertex_adjacency = adjacency + adjacency_offsets[vertex];
+				unsigned int live_count = live_triangles[vertex];
+				for (unsigned int subindex = 0; subindex < live_count; subindex++) {
+					if (vertex_adjacency[subindex] == best_triangle) {
+						vertex_adjacency[subindex] = vertex_adjacency[live_count - 1];
+						vertex_adjacency[live_count - 1] = best_triangle;
+						live_triangles[vertex]--;
+						break;
+					}
+				}
+			}
+
+			// The new cache starts with the vertices of the emitted triangle followed by the old entries
+			unsigned int new_cache_count = 0;
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				new_cache[new_cache_count++] = triangle_indices[corner];
+			}
+			for (unsigned int index = 0; index < cache_count; index++) {
+				unsigned int vertex = cache[index];
+				if (vertex != triangle_indices[0] && vertex != triangle_indices[1] && vertex != triangle_indices[2]) {
+					new_cache[new_cache_count++] = vertex;
+				}
+			}
+
+			// The vertices that are pushed out of the simulated cache lose their cache score
+			for (unsigned int index = ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE; index < new_cache_count; index++) {
+				unsigned int vertex = new_cache[index];
+				vertex_scores[vertex] = ForsythVertexScore(-1, live_triangles[vertex]);
+			}
+			cache_count = std::min(new_cache_count, (unsigned int)ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE);
+			memcpy(cache, new_cache, sizeof(unsigned int) * cache_count);
+
+			for (unsigned int index = 0; index < cache_count; index++) {
+				unsigned int vertex = cache[index];
+				vertex_scores[vertex] = ForsythVertexScore((int)index, live_triangles[vertex]);
+			}
+
+			// Only the triangles that reference the cached vertices changed their score,
+			// the best one among them is emitted next
+			best_triangle = -1;
+			float best_score = -FLT_MAX;
+			for (unsigned int index = 0; index < cache_count; index++) {
+				unsigned int vertex = cache[index];
+				const unsigned int* vertex_adjacency = adjacency + adjacency_offsets[vertex];
+				for (unsigned int subindex = 0; subindex < live_triangles[vertex]; subindex++) {
+					unsigned int triangle = vertex_adjacency[subindex];
+					// Degenerate triangles can appear twice in the same list, only one entry is removed
+					if (emitted[triangle]) {
+						continue;
+					}
+					const unsigned int* current_indices = indices.buffer + triangle * 3;
+					float score = vertex_scores[current_indices[0]] + vertex_scores[current_indices[1]] + vertex_scores[current_indices[2]];
+					if (score > best_score) {
+						best_score = score;
+						best_triangle = triangle;
+					}
+				}
+			}
+		}
+
+		indices.CopyOther(output, indices.size);
+
+		Deallocate(temporary_allocator, output);
+		Deallocate(temporary_allocator, emitted);
+		Deallocate(temporary_allocator, vertex_scores);
+		Deallocate(temporary_allocator, adjacency);
+		Deallocate(temporary_allocator, adjacency_offsets);
+		Deallocate(temporary_allocator, live_triangles);
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	unsigned int OptimizeMeshVertexFetchRemap(Stream<unsigned int> indices, unsigned int vertex_count, unsigned int* remapping) {
+		memset(remapping, 0xFF, sizeof(unsigned int) * vertex_count);
+
+		unsigned int next_vertex = 0;
+		for (size_t index = 0; index < indices.size; index++) {
+			unsigned int vertex = indices[index];
+			ECS_ASSERT(vertex < vertex_count);
+			if (remapping[vertex] == -1) {
+				remapping[vertex] = next_vertex++;
+			}
+			indices[index] = remapping[vertex];
+		}
+		return next_vertex;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	// The symmetric 4x4 matrix of the plane equations that were accumulated into a vertex.
+	// Doubles are used since the products of the plane coefficients lose too much precision otherwise
+	struct Quadric {
+		void AddPlane(float3 normal, float distance, float weight) {
+			double x = normal.x, y = normal.y, z = normal.z, w = distance;
+			a00 += weight * x * x; a01 += weight * x * y; a02 += weight * x * z; a03 += weight * x * w;
+			a11 += weight * y * y; a12 += weight * y * z; a13 += weight * y * w;
+			a22 += weight * z * z; a23 += weight * z * w;
+			a33 += weight * w * w;
+		}
+
+		void Add(const Quadric& other) {
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+			a11 += other.a11; a12 += other.a12; a13 += other.a13;
+			a22 += other.a22; a23 += other.a23;
+			a33 += other.a33;
+		}
+
+		double Error(float3 position) const {
+			double x = position.x, y = position.y, z = position.z;
+			double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+				+ a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+				+ a22 * z * z + 2.0 * a23 * z
+				+ a33;
+			return error > 0.0 ? error : 0.0;
+		}
+
+		double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+	};
+
+	struct SimplifyCollapse {
+		unsigned int cost;
+		unsigned int from;
+		unsigned int to;
+	};
+
+	// Returns the index into the table where the key is located or where it should be inserted
+	static unsigned int SimplifyFindEdge(const size_t* table, unsigned int table_mask, size_t key) {
+		unsigned int slot = (unsigned int)Murmur64({ &key, sizeof(key) }) & table_mask;
+		while (table[slot] != -1 && table[slot] != key) {
+			slot = (slot + 1) & table_mask;
+		}
+		return slot;
+	}
+
+	static size_t SimplifyEdgeKey(unsigned int first, unsigned int second) {
+		return ((size_t)first << 32) | (size_t)second;
+	}
+
+	// Locks the vertices that are on open borders or on attribute seams, collapsing these would open holes
+	// in the mesh or would tear the attributes apart
+	static void SimplifyLockVertices(Stream<unsigned int> indices, Stream<float3> positions, bool* locked, AllocatorPolymorphic temporary_allocator) {
+		unsigned int vertex_count = (unsigned int)positions.size;
+		memset(locked, 0, sizeof(bool) * vertex_count);
+
+		// The vertices which share the position with a different vertex are seams
+		unsigned int position_capacity = HashTableCapacity(vertex_count);
+		unsigned int* position_table = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * position_capacity);
+		memset(position_table, 0xFF, sizeof(unsigned int) * position_capacity);
+		for (unsigned int vertex = 0; vertex < vertex_count; vertex++) {
+			unsigned int slot = (unsigned int)Murmur64({ positions.buffer + vertex, sizeof(float3) }) & (position_capacity - 1);
+			while (position_table[slot] != -1) {
+				unsigned int other = position_table[slot];
+				if (memcmp(positions.buffer + other, positions.buffer + vertex, sizeof(float3)) == 0) {
+					locked[other] = true;
+					locked[vertex] = true;
+					break;
+				}
+				slot = (slot + 1) & (position_capacity - 1);
+			}
+			if (position_table[slot] == -1) {
+				position_table[slot] = vertex;
+			}
+		}
+		Deallocate(temporary_allocator, position_table);
+
+		// The edges that do not have the opposite half edge are on the border
+		unsigned int edge_capacity = HashTableCapacity((unsigned int)indices.size);
+		size_t* edge_table = (size_t*)Allocate(temporary_allocator, sizeof(size_t) * edge_capacity);
+		memset(edge_table, 0xFF, sizeof(size_t) * edge_capacity);
+		for (size_t index = 0; index < indices.size; index += 3) {
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				size_t key = SimplifyEdgeKey(indices[index + corner], indices[index + (corner + 1) % 3]);
+				edge_table[SimplifyFindEdge(edge_table, edge_capacity - 1, key)] = key;
+			}
+		}
+		for (size_t index = 0; index < indices.size; index += 3) {
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				unsigned int first = indices[index + corner];
+				unsigned int second = indices[index + (corner + 1) % 3];
+				size_t opposite_key = SimplifyEdgeKey(second, first);
+				if (edge_table[SimplifyFindEdge(edge_table, edge_capacity - 1, opposite_key)] != opposite_key) {
+					locked[first] = true;
+					locked[second] = true;
+				}
+			}
+		}
+		Deallocate(temporary_allocator, edge_table);
+	}
+
+	// Returns true if moving the vertex from onto the position of the vertex to flips any of the triangles
+	// that reference from and do not get collapsed
+	static bool SimplifyCollapseFlips(
+		Stream<unsigned int> indices,
+		Stream<float3> positions,
+		const unsigned int* adjacency,
+		unsigned int adjacency_count,
+		unsigned int from,
+		unsigned int to
+	) {
+		float3 new_position = positions[to];
+		for (unsigned int index = 0; index < adjacency_count; index++) {
+			const unsigned int* triangle_indices = indices.buffer + adjacency[index] * 3;
+			if (triangle_indices[0] == to || triangle_indices[1] == to || triangle_indices[2] == to) {
+				continue;
+			}
+
+			float3 corners[3];
+			float3 new_corners[3];
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				corners[corner] = positions[triangle_indices[corner]];
+				new_corners[corner] = triangle_indices[corner] == from ? new_position : corners[corner];
+			}
+
+			float3 normal = Cross(corners[1] - corners[0], corners[2] - corners[0]);
+			float3 new_normal = Cross(new_corners[1] - new_corners[0], new_corners[2] - new_corners[0]);
+			if (Dot(normal, new_normal) <= 0.0f) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned int SimplifyMesh(
+		Stream<unsigned int> indices,
+		Stream<float3> positions,
+		unsigned int target_index_count,
+		AllocatorPolymorphic temporary_allocator
+	) {
+		ECS_ASSERT(indices.size % 3 == 0);
+		unsigned int vertex_count = (unsigned int)positions.size;
+		target_index_count -= target_index_count % 3;
+		if (indices.size <= target_index_count || vertex_count == 0) {
+			return (unsigned int)indices.size;
+		}
+
+		Quadric* quadrics = (Quadric*)Allocate(temporary_allocator, sizeof(Quadric) * vertex_count, alignof(Quadric));
+		bool* locked = (bool*)Allocate(temporary_allocator, sizeof(bool) * vertex_count, alignof(bool));
+		bool* touched = (bool*)Allocate(temporary_allocator, sizeof(bool) * vertex_count, alignof(bool));
+		unsigned int* remapping = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int* adjacency_counts = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int* adjacency_offsets = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int* adjacency = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * indices.size);
+		// Each half edge can produce 2 collapses, one in each direction, and the other half is used by the sort
+		SimplifyCollapse* collapses = (SimplifyCollapse*)Allocate(temporary_allocator, sizeof(SimplifyCollapse) * indices.size * 4);
+
+		SimplifyLockVertices(indices, positions, locked, temporary_allocator);
+
+		memset(quadrics, 0, sizeof(Quadric) * vertex_count);
+		for (size_t index = 0; index < indices.size; index += 3) {
+			float3 p0 = positions[indices[index]];
+			float3 p1 = positions[indices[index + 1]];
+			float3 p2 = positions[indices[index + 2]];
+			float3 normal = Cross(p1 - p0, p2 - p0);
+			float double_area = Length(normal);
+			if (double_area > 0.0f) {
+				normal = normal * float3::Splat(1.0f / double_area);
+				float distance = -Dot(normal, p0);
+				// Weight the planes by the area, such that small triangles do not dominate the error
+				for (unsigned int corner = 0; corner < 3; corner++) {
+					quadrics[indices[index + corner]].AddPlane(normal, distance, double_area * 0.5f);
+				}
+			}
+		}
+
+		for (unsigned int index = 0; index < vertex_count; index++) {
+			remapping[index] = index;
+		}
+
+		unsigned int index_count = (unsigned int)indices.size;
+		for (unsigned int pass = 0; pass < SIMPLIFICATION_MAX_PASS_COUNT && index_count > target_index_count; pass++) {
+			Stream<unsigned int> current_indices = { indices.buffer, index_count };
+
+			memset(adjacency_counts, 0, sizeof(unsigned int) * vertex_count);
+			for (unsigned int index = 0; index < index_count; index++) {
+				adjacency_counts[current_indices[index]]++;
+			}
+			unsigned int offset = 0;
+			for (unsigned int index = 0; index < vertex_count; index++) {
+				adjacency_offsets[index] = offset;
+				offset += adjacency_counts[index];
+				adjacency_counts[index] = 0;
+			}
+			for (unsigned int index = 0; index < index_count; index++) {
+				unsigned int vertex = current_indices[index];
+				adjacency[adjacency_offsets[vertex] + adjacency_counts[vertex]++] = index / 3;
+			}
+
+			// The costs are positive floats, such that their bits sort in the same order as the values
+			unsigned int collapse_count = 0;
+			for (unsigned int index = 0; index < index_count; index += 3) {
+				for (unsigned int corner = 0; corner < 3; corner++) {
+					unsigned int first = current_indices[index + corner];
+					unsigned int second = current_indices[index + (corner + 1) % 3];
+					Quadric quadric = quadrics[first];
+					quadric.Add(quadrics[second]);
+					if (!locked[first]) {
+						float cost = (float)quadric.Error(positions[second]);
+						collapses[collapse_count++] = { *(unsigned int*)&cost, first, second };
+					}
+					if (!locked[second]) {
+						float cost = (float)quadric.Error(positions[first]);
+						collapses[collapse_count++] = { *(unsigned int*)&cost, second, first };
+					}
+				}
+			}
+			if (collapse_count == 0) {
+				break;
+			}
+
+			RadixSort64(collapses, collapses + collapse_count, collapse_count, [](const SimplifyCollapse& collapse) {
+				return (size_t)collapse.cost;
+			});
+
+			// Each vertex can take part in a single collapse per pass, such that the error of the
+			// collapses and the flip test remain valid
+			memset(touched, 0, sizeof(bool) * vertex_count);
+			unsigned int triangles_to_remove = (index_count - target_index_count) / 3;
+			unsigned int removed_triangles = 0;
+			unsigned int performed_collapses = 0;
+			for (unsigned int index = 0; index < collapse_count && removed_triangles < triangles_to_remove; index++) {
+				const SimplifyCollapse& collapse = collapses[index];
+				if (touched[collapse.from] || touched[collapse.to]) {
+					continue;
+				}
+
+				const unsigned int* from_adjacency = adjacency + adjacency_offsets[collapse.from];
+				unsigned int from_adjacency_count = adjacency_counts[collapse.from];
+				if (SimplifyCollapseFlips(current_indices, positions, from_adjacency, from_adjacency_count, collapse.from, collapse.to)) {
+					continue;
+				}
+
+				// Mark the one ring of both vertices, since their triangles change
+				for (unsigned int subindex = 0; subindex < from_adjacency_count; subindex++) {
+					const unsigned int* triangle_indices = current_indices.buffer + from_adjacency[subindex] * 3;
+					if (triangle_indices[0] == collapse.to || triangle_indices[1] == collapse.to || triangle_indices[2] == collapse.to) {
+						removed_triangles++;
+					}
+					touched[triangle_indices[0]] = true;
+					touched[triangle_indices[1]] = true;
+					touched[triangle_indices[2]] = true;
+				}
+				const unsigned int* to_adjacency = adjacency + adjacency_offsets[collapse.to];
+				for (unsigned int subindex = 0; subindex < adjacency_counts[collapse.to]; subindex++) {
+					const unsigned int* triangle_indices = current_indices.buffer + to_adjacency[subindex] * 3;
+					touched[triangle_indices[0]] = true;
+					touched[triangle_indices[1]] = true;
+					touched[triangle_indices[2]] = true;
+				}
+
+				remapping[collapse.from] = collapse.to;
+				quadrics[collapse.to].Add(quadrics[collapse.from]);
+				performed_collapses++;
+			}
+
+			if (performed_collapses == 0) {
+				break;
+			}
+
+			// Apply the collapses and remove the triangles that became degenerate
+			unsigned int new_index_count = 0;
+			for (unsigned int index = 0; index < index_count; index += 3) {
+				unsigned int v0 = remapping[current_indices[index]];
+				unsigned int v1 = remapping[current_indices[index + 1]];
+				unsigned int v2 = remapping[current_indices[index + 2]];
+				if (v0 != v1 && v0 != v2 && v1 != v2) {
+					indices[new_index_count++] = v0;
+					indices[new_index_count++] = v1;
+					indices[new_index_count++] = v2;
+				}
+			}
+			index_count = new_index_count;
+		}
+
+		Deallocate(temporary_allocator, collapses);
+		Deallocate(temporary_allocator, adjacency);
+		Deallocate(temporary_allocator, adjacency_offsets);
+		Deallocate(temporary_allocator, adjacency_counts);
+		Deallocate(temporary_allocator, remapping);
+		Deallocate(temporary_allocator, touched);
+		Deallocate(temporary_allocator, locked);
+		Deallocate(temporary_allocator, quadrics);
+
+		return index_count;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	Stream<Stream<unsigned int>> GenerateMeshLODChain(
+		Stream<unsigned int> indices,
+		Stream<float3> positions,
+		unsigned int level_count,
+		float reduction_per_level,
+		AllocatorPolymorphic allocator,
+		AllocatorPolymorphic temporary_allocator
+	) {
+		Stream<Stream<unsigned int>> levels;
+		levels.Initialize(allocator, level_count);
+		levels.size = 0;
+		if (level_count == 0) {
+			return levels;
+		}
+
+		levels[0].InitializeAndCopy(allocator, indices);
+		levels.size = 1;
+		for (unsigned int index = 1; index < level_count; index++) {
+			Stream<unsigned int> previous_level = levels[index - 1];
+			unsigned int target_index_count = (unsigned int)((float)previous_level.size * (1.0f - reduction_per_level));
+
+			Stream<unsigned int> current_level;
+			current_level.InitializeAndCopy(allocator, previous_level);
+			current_level.size = SimplifyMesh(current_level, positions, target_index_count, temporary_allocator);
+			if (current_level.size >= previous_level.size) {
+				// The mesh cannot be simplified anymore, the remaining levels would be identical
+				current_level.Deallocate(allocator);
+				break;
+			}
+			levels[levels.size++] = current_level;
+		}
+		return levels;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	struct MeshVertexAttribute {
+		void* buffer;
+		size_t stride;
+	};
+
+	// Returns the count of attributes that are present in the mesh
+	static unsigned int GetMeshVertexAttributes(GLTFMesh* mesh, MeshVertexAttribute* attributes) {
+		unsigned int count = 0;
+		auto add = [&](auto stream) {
+			if (stream.size > 0) {
+				attributes[count++] = { stream.buffer, sizeof(*stream.buffer) };
+			}
+		};
+		add(mesh->positions);
+		add(mesh->normals);
+		add(mesh->uvs);
+		add(mesh->colors);
+		add(mesh->skin_weights);
+		add(mesh->skin_influences);
+		return count;
+	}
+
+	static void SetMeshVertexAttributesSize(GLTFMesh* mesh, size_t size) {
+		auto set = [size](auto& stream) {
+			if (stream.size > 0) {
+				stream.size = size;
+			}
+		};
+		set(mesh->positions);
+		set(mesh->normals);
+		set(mesh->uvs);
+		set(mesh->colors);
+		set(mesh->skin_weights);
+		set(mesh->skin_influences);
+	}
+
+	// The indices are relative to the vertex offset. Merges the vertices with identical attributes into the
+	// first occurrence and compacts the vertex range in place. Returns the new vertex count
+	static unsigned int DeduplicateMeshVertices(
+		Stream<unsigned int> indices,
+		const MeshVertexAttribute* attributes,
+		unsigned int attribute_count,
+		unsigned int vertex_offset,
+		unsigned int vertex_count,
+		AllocatorPolymorphic temporary_allocator
+	) {
+		auto hash_vertex = [&](unsigned int vertex) {
+			size_t hash = 0;
+			for (unsigned int index = 0; index < attribute_count; index++) {
+				const void* element = OffsetPointer(attributes[index].buffer, attributes[index].stride * (vertex_offset + vertex));
+				hash = Murmur64({ element, attributes[index].stride }, hash);
+			}
+			return hash;
+		};
+		auto vertices_equal = [&](unsigned int first, unsigned int second) {
+			for (unsigned int index = 0; index < attribute_count; index++) {
+				size_t stride = attributes[index].stride;
+				const void* first_element = OffsetPointer(attributes[index].buffer, stride * (vertex_offset + first));
+				const void* second_element = OffsetPointer(attributes[index].buffer, stride * (vertex_offset + second));
+				if (memcmp(first_element, second_element, stride) != 0) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		unsigned int table_capacity = HashTableCapacity(vertex_count);
+		unsigned int* table = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * table_capacity);
+		unsigned int* remapping = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		memset(table, 0xFF, sizeof(unsigned int) * table_capacity);
+
+		unsigned int unique_count = 0;
+		for (unsigned int vertex = 0; vertex < vertex_count; vertex++) {
+			unsigned int slot = (unsigned int)hash_vertex(vertex) & (table_capacity - 1);
+			while (table[slot] != -1 && !vertices_equal(table[slot], vertex)) {
+				slot = (slot + 1) & (table_capacity - 1);
+			}
+
+			if (table[slot] == -1) {
+				table[slot] = vertex;
+				// The unique index is never greater than the vertex index, such that the copy can be done in place
+				remapping[vertex] = unique_count;
+				for (unsigned int index = 0; index < attribute_count; index++) {
+					size_t stride = attributes[index].stride;
+					void* destination = OffsetPointer(attributes[index].buffer, stride * (vertex_offset + unique_count));
+					const void* source = OffsetPointer(attributes[index].buffer, stride * (vertex_offset + vertex));
+					if (destination != source) {
+						memcpy(destination, source, stride);
+					}
+				}
+				unique_count++;
+			}
+			else {
+				remapping[vertex] = remapping[table[slot]];
+			}
+		}
+
+		for (size_t index = 0; index < indices.size; index++) {
+			indices[index] = remapping[indices[index]];
+		}
+
+		Deallocate(temporary_allocator, remapping);
+		Deallocate(temporary_allocator, table);
+		return unique_count;
+	}
+
+	// The indices are relative to the vertex offset. Returns the new vertex count
+	static unsigned int OptimizeMeshVertexFetch(
+		Stream<unsigned int> indices,
+		const MeshVertexAttribute* attributes,
+		unsigned int attribute_count,
+		unsigned int vertex_offset,
+		unsigned int vertex_count,
+		AllocatorPolymorphic temporary_allocator
+	) {
+		unsigned int* remapping = (unsigned int*)Allocate(temporary_allocator, sizeof(unsigned int) * vertex_count);
+		unsigned int new_vertex_count = OptimizeMeshVertexFetchRemap(indices, vertex_count, remapping);
+
+		for (unsigned int index = 0; index < attribute_count; index++) {
+			size_t stride = attributes[index].stride;
+			void* vertices = OffsetPointer(attributes[index].buffer, stride * vertex_offset);
+			void* copy = Allocate(temporary_allocator, stride * vertex_count);
+			memcpy(copy, vertices, stride * vertex_count);
+			for (unsigned int vertex = 0; vertex < vertex_count; vertex++) {
+				if (remapping[vertex] != -1) {
+					memcpy(OffsetPointer(vertices, stride * remapping[vertex]), OffsetPointer(copy, stride * vertex), stride);
+				}
+			}
+			Deallocate(temporary_allocator, copy);
+		}
+
+		Deallocate(temporary_allocator, remapping);
+		return new_vertex_count;
+	}
+
+	void OptimizeCoalescedMesh(
+		GLTFMesh* mesh,
+		Stream<Submesh> submeshes,
+		const MeshOptimizationOptions* options,
+		AllocatorPolymorphic temporary_allocator
+	) {
+		if (!options->IsEnabled()) {
+			return;
+		}
+
+		MeshVertexAttribute attributes[ECS_MESH_BUFFER_COUNT];
+		unsigned int attribute_count = GetMeshVertexAttributes(mesh, attributes);
+
+		// The submeshes are optimized in place and then moved down over the space that the previous submeshes freed
+		unsigned int vertex_write_offset = 0;
+		unsigned int index_write_offset = 0;
+		for (size_t submesh_index = 0; submesh_index < submeshes.size; submesh_index++) {
+			Submesh& submesh = submeshes[submesh_index];
+			ECS_ASSERT(submesh.vertex_buffer_offset >= vertex_write_offset && submesh.index_buffer_offset >= index_write_offset,
+				"The submeshes of a coalesced mesh must be laid out in order for the optimization");
+
+			Stream<unsigned int> submesh_indices = { mesh->indices.buffer + submesh.index_buffer_offset, submesh.index_count };
+			unsigned int vertex_count = submesh.vertex_count;
+			for (size_t index = 0; index < submesh_indices.size; index++) {
+				submesh_indices[index] -= submesh.vertex_buffer_offset;
+			}
+
+			if (vertex_count > 0 && submesh_indices.size >= 3) {
+				if (options->deduplicate_vertices) {
+					vertex_count = DeduplicateMeshVertices(submesh_indices, attributes, attribute_count, submesh.vertex_buffer_offset, vertex_count, temporary_allocator);
+				}
+
+				bool simplified = false;
+				if (options->simplification_ratio > 0.0f) {
+					unsigned int target_index_count = (unsigned int)((float)submesh_indices.size * (1.0f - options->simplification_ratio));
+					Stream<float3> submesh_positions = { mesh->positions.buffer + submesh.vertex_buffer_offset, vertex_count };
+					unsigned int new_index_count = SimplifyMesh(submesh_indices, submesh_positions, target_index_count, temporary_allocator);
+					simplified = new_index_count < submesh_indices.size;
+					submesh_indices.size = new_index_count;
+				}
+
+				if (options->optimize_vertex_cache) {
+					OptimizeMeshVertexCache(submesh_indices, vertex_count, temporary_allocator);
+				}
+
+				// The fetch optimization is needed after a simplification as well to remove the collapsed vertices
+				if (options->optimize_vertex_fetch || simplified) {
+					vertex_count = OptimizeMeshVertexFetch(submesh_indices, attributes, attribute_count, submesh.vertex_buffer_offset, vertex_count, temporary_allocator);
+				}
+			}
+
+			// Move the ranges down and rebase the indices onto the new vertex offset
+			if (vertex_write_offset != submesh.vertex_buffer_offset) {
+				for (unsigned int index = 0; index < attribute_count; index++) {
+					size_t stride = attributes[index].stride;
+					memmove(
+						OffsetPointer(attributes[index].buffer, stride * vertex_write_offset),
+						OffsetPointer(attributes[index].buffer, stride * submesh.vertex_buffer_offset),
+						stride * vertex_count
+					);
+				}
+			}
+			unsigned int* index_destination = mesh->indices.buffer + index_write_offset;
+			for (size_t index = 0; index < submesh_indices.size; index++) {
+				index_destination[index] = submesh_indices[index] + vertex_write_offset;
+			}
+
+			submesh.vertex_buffer_offset = vertex_write_offset;
+			submesh.index_buffer_offset = index_write_offset;
+			submesh.vertex_count = vertex_count;
+			submesh.index_count = (unsigned int)submesh_indices.size;
+			vertex_write_offset += vertex_count;
+			index_write_offset += (unsigned int)submesh_indices.size;
+		}
+
+		SetMeshVertexAttributesSize(mesh, vertex_write_offset);
+		mesh->indices.size = index_write_offset;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Allocators/AllocatorTypes.h"
+#include "../Utilities/BasicTypes.h"
+
+namespace ECSEngine {
+
+	struct GLTFMesh;
+	struct Submesh;
+
+	// The size of the FIFO cache that is simulated by the vertex cache optimization
+	// It matches the post transform cache of most desktop GPUs
+#define ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE 32
+
+	struct MeshOptimizationOptions {
+		ECS_INLINE bool IsEnabled() const {
+			return deduplicate_vertices || optimize_vertex_cache || optimize_vertex_fetch || simplification_ratio > 0.0f;
+		}
+
+		// Merges the vertices that have all their attributes bitwise identical
+		bool deduplicate_vertices = false;
+		// Reorders the triangles such that the post transform vertex cache is reused (Forsyth's algorithm)
+		bool optimize_vertex_cache = false;
+		// Reorders the vertices in the order in which the triangles reference them and removes the
+		// vertices that are not referenced. It is always done after a simplification, to remove the
+		// vertices that were collapsed
+		bool optimize_vertex_fetch = false;
+		// The fraction of triangles that is removed with quadric error edge collapses. 0.0f disables it
+		float simplification_ratio = 0.0f;
+	};
+
+	// Returns the average cache miss ratio - the amount of vertex shader invocations per triangle -
+	// for a FIFO cache of the given size. Lower is better, 0.5f being the ideal for large regular grids
+	ECSENGINE_API float CalculateMeshACMR(Stream<unsigned int> indices, unsigned int vertex_count, unsigned int cache_size = ECS_MESH_OPTIMIZATION_VERTEX_CACHE_SIZE);
+
+	// The indices must be in the range [0, vertex_count). Reorders the triangles in place
+	ECSENGINE_API void OptimizeMeshVertexCache(Stream<unsigned int> indices, unsigned int vertex_count, AllocatorPolymorphic temporary_allocator);
+
+	// Fills in the remapping from the old vertex index to the new vertex index, in the order in which the vertices
+	// are referenced, and rewrites the indices. The vertices that are not referenced are remapped to -1.
+	// The remapping must have vertex_count entries. Returns the number of referenced vertices
+	ECSENGINE_API unsigned int OptimizeMeshVertexFetchRemap(Stream<unsigned int> indices, unsigned int vertex_count, unsigned int* remapping);
+
+	// Collapses edges in the order of their quadric error until the index count is at most the target count or no
+	// more edges can be collapsed. The collapses only move vertices onto other existing vertices, such that the
+	// other attributes remain valid. The border and the attribute seam vertices (different vertices with the same
+	// position) are never moved. The indices are rewritten in place. Returns the new index count
+	ECSENGINE_API unsigned int SimplifyMesh(
+		Stream<unsigned int> indices,
+		Stream<float3> positions,
+		unsigned int target_index_count,
+		AllocatorPolymorphic temporary_allocator
+	);
+
+	// Each level has its triangle count reduced by the given ratio from the previous level. The first level is the
+	// original index buffer copy. The LOD index buffers reference the same vertices as the original mesh.
+	// The levels stop early if the simplification cannot reduce the triangle count anymore. Everything is
+	// allocated from the given allocator
+	ECSENGINE_API Stream<Stream<unsigned int>> GenerateMeshLODChain(
+		Stream<unsigned int> indices,
+		Stream<float3> positions,
+		unsigned int level_count,
+		float reduction_per_level,
+		AllocatorPolymorphic allocator,
+		AllocatorPolymorphic temporary_allocator
+	);
+
+	// The mesh must be coalesced, with the indices of each submesh offset by its vertex buffer offset.
+	// The optimizations are performed per submesh, after which the vertex and index buffers are compacted,
+	// such that the submesh offsets and counts and the sizes of the mesh streams can become smaller.
+	// The buffers themselves are not reallocated. The bounds of the submeshes are not modified
+	ECSENGINE_API void OptimizeCoalescedMesh(
+		GLTFMesh* mesh,
+		Stream<Submesh> submeshes,
+		const MeshOptimizationOptions* options,
+		AllocatorPolymorphic temporary_allocator
+	);
+
+}
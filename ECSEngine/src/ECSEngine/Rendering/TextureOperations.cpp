@@ -5,6 +5,8 @@
 #include "../../Dependencies/DirectXTex/DirectXTex/DirectXTex.h"
 #include "../Utilities/Path.h"
 #include "../Utilities/Crash.h"
+#include "../Multithreading/ParallelFor.h"
+#include "../Allocators/AllocatorPolymorphic.h"
 
 namespace ECSEngine {
 
@@ -68,6 +70,316 @@ namespace ECSEngine {
 
 	// ----------------------------------------------------------------------------------------------------------------------
 
+	// The minimum amount of destination rows that a thread resamples at once
+#define TEXTURE_RESAMPLE_MIN_ROW_BATCH 16
+#define TEXTURE_RESAMPLE_MAX_BATCH_COUNT 64
+
+	// The Kaiser window parameters, which are the defaults of the NVIDIA texture tools
+#define TEXTURE_KAISER_FILTER_WIDTH 3.0f
+#define TEXTURE_KAISER_FILTER_ALPHA 4.0f
+
+	enum TEXTURE_RESAMPLE_FILTER : unsigned char {
+		TEXTURE_RESAMPLE_POINT,
+		TEXTURE_RESAMPLE_BOX,
+		TEXTURE_RESAMPLE_LINEAR,
+		TEXTURE_RESAMPLE_KAISER
+	};
+
+	// The conversion tables between the 8 bit values and the linear values in the [0, 1] range
+	struct TextureColorSpaceTables {
+		TextureColorSpaceTables() {
+			for (size_t index = 0; index < ECS_COUNTOF(unorm_to_linear); index++) {
+				float value = (float)index / 255.0f;
+				unorm_to_linear[index] = value;
+				srgb_to_linear[index] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+			}
+			for (size_t index = 0; index < ECS_COUNTOF(linear_to_srgb); index++) {
+				float value = (float)index / (float)(ECS_COUNTOF(linear_to_srgb) - 1);
+				float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+				linear_to_srgb[index] = (unsigned char)(srgb * 255.0f + 0.5f);
+			}
+		}
+
+		float unorm_to_linear[256];
+		float srgb_to_linear[256];
+		// Indexed with 16 bits of precision, since the curve is steep near black
+		unsigned char linear_to_srgb[1 << 16];
+	};
+
+	static const TextureColorSpaceTables& GetTextureColorSpaceTables() {
+		static TextureColorSpaceTables tables;
+		return tables;
+	}
+
+	static float BesselI0(float value) {
+		float sum = 1.0f;
+		float term = 1.0f;
+		float half_value = value * 0.5f;
+		for (size_t index = 1; term > sum * 1e-7f; index++) {
+			float factor = half_value / (float)index;
+			term *= factor * factor;
+			sum += term;
+		}
+		return sum;
+	}
+
+	static float TextureResampleFilterRadius(TEXTURE_RESAMPLE_FILTER filter) {
+		switch (filter) {
+		case TEXTURE_RESAMPLE_BOX:
+			return 0.5f;
+		case TEXTURE_RESAMPLE_LINEAR:
+			return 1.0f;
+		case TEXTURE_RESAMPLE_KAISER:
+			return TEXTURE_KAISER_FILTER_WIDTH;
+		}
+		return 0.0f;
+	}
+
+	// The distance is in destination pixels
+	static float TextureResampleFilterWeight(TEXTURE_RESAMPLE_FILTER filter, float distance) {
+		distance = fabsf(distance);
+		switch (filter) {
+		case TEXTURE_RESAMPLE_BOX:
+			return distance <= 0.5f ? 1.0f : 0.0f;
+		case TEXTURE_RESAMPLE_LINEAR:
+			return max(1.0f - distance, 0.0f);
+		case TEXTURE_RESAMPLE_KAISER:
+		{
+			if (distance >= TEXTURE_KAISER_FILTER_WIDTH) {
+				return 0.0f;
+			}
+			float sinc = distance < 1e-6f ? 1.0f : sinf(PI * distance) / (PI * distance);
+			float window_position = distance / TEXTURE_KAISER_FILTER_WIDTH;
+			return sinc * BesselI0(TEXTURE_KAISER_FILTER_ALPHA * sqrtf(1.0f - window_position * window_position)) / BesselI0(TEXTURE_KAISER_FILTER_ALPHA);
+		}
+		}
+		return 1.0f;
+	}
+
+	// The source pixels and their weights for each destination pixel of a dimension
+	struct TextureResampleTaps {
+		ECS_INLINE unsigned int* Indices(size_t destination_index) const {
+			return indices + destination_index * tap_count;
+		}
+
+		ECS_INLINE float* Weights(size_t destination_index) const {
+			return weights + destination_index * tap_count;
+		}
+
+		unsigned int* indices;
+		float* weights;
+		size_t tap_count;
+	};
+
+	// When downsampling, the filter is widened by the scale, such that all the source pixels contribute.
+	// The source indices are clamped to the edges. The weights are allocated after the indices, such that
+	// only the indices need to be deallocated
+	static TextureResampleTaps CreateTextureResampleTaps(size_t source_size, size_t destination_size, TEXTURE_RESAMPLE_FILTER filter, AllocatorPolymorphic allocator) {
+		float scale = (float)source_size / (float)destination_size;
+		float filter_scale = max(scale, 1.0f);
+		float support = TextureResampleFilterRadius(filter) * filter_scale;
+
+		TextureResampleTaps taps;
+		taps.tap_count = filter == TEXTURE_RESAMPLE_POINT ? 1 : (size_t)ceilf(support * 2.0f) + 1;
+		size_t count = taps.tap_count * destination_size;
+		taps.indices = (unsigned int*)Allocate(allocator, (sizeof(unsigned int) + sizeof(float)) * count);
+		taps.weights = (float*)(taps.indices + count);
+
+		int last_index = (int)source_size - 1;
+		for (size_t index = 0; index < destination_size; index++) {
+			unsigned int* indices = taps.Indices(index);
+			float* weights = taps.Weights(index);
+			float center = ((float)index + 0.5f) * scale - 0.5f;
+			int nearest = Clamp((int)floorf(center + 0.5f), 0, last_index);
+			if (filter == TEXTURE_RESAMPLE_POINT) {
+				indices[0] = nearest;
+				weights[0] = 1.0f;
+				continue;
+			}
+
+			int first = (int)ceilf(center - support);
+			float weight_sum = 0.0f;
+			for (size_t tap = 0; tap < taps.tap_count; tap++) {
+				int source_index = first + (int)tap;
+				indices[tap] = Clamp(source_index, 0, last_index);
+				weights[tap] = TextureResampleFilterWeight(filter, ((float)source_index - center) / filter_scale);
+				weight_sum += weights[tap];
+			}
+
+			if (weight_sum > 0.0f) {
+				for (size_t tap = 0; tap < taps.tap_count; tap++) {
+					weights[tap] /= weight_sum;
+				}
+			}
+			else {
+				// Fallback to the nearest pixel
+				for (size_t tap = 0; tap < taps.tap_count; tap++) {
+					indices[tap] = nearest;
+					weights[tap] = tap == 0 ? 1.0f : 0.0f;
+				}
+			}
+		}
+		return taps;
+	}
+
+	// Decodes the source row to linear values and filters it horizontally
+	template<size_t channel_count>
+	static void TextureResampleRowHorizontal(
+		const unsigned char* source_row,
+		size_t source_width,
+		const float* const* decode_tables,
+		const TextureResampleTaps& taps,
+		size_t destination_width,
+		float* decoded_row,
+		float* destination_row
+	) {
+		for (size_t index = 0; index < source_width; index++) {
+			for (size_t channel = 0; channel < channel_count; channel++) {
+				decoded_row[index * channel_count + channel] = decode_tables[channel][source_row[index * channel_count + channel]];
+			}
+		}
+
+		for (size_t index = 0; index < destination_width; index++) {
+			const unsigned int* indices = taps.Indices(index);
+			const float* weights = taps.Weights(index);
+			float values[channel_count] = {};
+			for (size_t tap = 0; tap < taps.tap_count; tap++) {
+				const float* pixel = decoded_row + indices[tap] * channel_count;
+				for (size_t channel = 0; channel < channel_count; channel++) {
+					values[channel] += pixel[channel] * weights[tap];
+				}
+			}
+			for (size_t channel = 0; channel < channel_count; channel++) {
+				destination_row[index * channel_count + channel] = values[channel];
+			}
+		}
+	}
+
+	// Each batch of destination rows filters horizontally the source rows that it needs, after which
+	// the rows are filtered vertically 8 values at a time. The 8 bit values are decoded to linear space
+	// and encoded back, such that the sRGB textures are filtered correctly. The alpha is always linear
+	static void TextureResample(
+		const void* source,
+		size_t source_width,
+		size_t source_height,
+		void* destination,
+		size_t destination_width,
+		size_t destination_height,
+		size_t channel_count,
+		bool srgb,
+		TEXTURE_RESAMPLE_FILTER filter,
+		TaskManager* task_manager
+	) {
+		ECS_ASSERT(channel_count >= 1 && channel_count <= 4, "Texture resampling supports only 1 to 4 8 bit channels");
+
+		const TextureColorSpaceTables& tables = GetTextureColorSpaceTables();
+		const float* decode_tables[4];
+		bool encode_srgb[4];
+		for (size_t channel = 0; channel < channel_count; channel++) {
+			encode_srgb[channel] = srgb && channel < 3;
+			decode_tables[channel] = encode_srgb[channel] ? tables.srgb_to_linear : tables.unorm_to_linear;
+		}
+
+		TextureResampleTaps horizontal_taps = CreateTextureResampleTaps(source_width, destination_width, filter, ECS_MALLOC_ALLOCATOR);
+		TextureResampleTaps vertical_taps = CreateTextureResampleTaps(source_height, destination_height, filter, ECS_MALLOC_ALLOCATOR);
+
+		size_t source_row_size = source_width * channel_count;
+		size_t destination_row_size = destination_width * channel_count;
+		// Pad the filtered rows such that the vertical filter does not need a remainder loop
+		size_t filtered_row_size = AlignPointer(destination_row_size, Vec8f::size());
+
+		ParallelForBatches(task_manager, destination_height, TEXTURE_RESAMPLE_MIN_ROW_BATCH, TEXTURE_RESAMPLE_MAX_BATCH_COUNT, 
+			[&](size_t row_offset, size_t row_count, size_t batch_index) {
+				// Determine the source rows that this batch references
+				unsigned int first_source_row = UINT_MAX;
+				unsigned int last_source_row = 0;
+				for (size_t row = row_offset; row < row_offset + row_count; row++) {
+					const unsigned int* indices = vertical_taps.Indices(row);
+					for (size_t tap = 0; tap < vertical_taps.tap_count; tap++) {
+						first_source_row = min(first_source_row, indices[tap]);
+						last_source_row = max(last_source_row, indices[tap]);
+					}
+				}
+				size_t source_row_count = last_source_row - first_source_row + 1;
+
+				size_t allocation_size = sizeof(float) * (AlignPointer(source_row_size, Vec8f::size()) + filtered_row_size * (source_row_count + 1));
+				float* decoded_row = (float*)Malloc(allocation_size, ECS_SIMD_BYTE_SIZE);
+				float* filtered_rows = decoded_row + AlignPointer(source_row_size, Vec8f::size());
+				float* destination_values = filtered_rows + filtered_row_size * source_row_count;
+				memset(filtered_rows, 0, sizeof(float) * filtered_row_size * source_row_count);
+
+				for (size_t row = 0; row < source_row_count; row++) {
+					const unsigned char* source_row = (const unsigned char*)OffsetPointer(source, (first_source_row + row) * source_row_size);
+					float* filtered_row = filtered_rows + row * filtered_row_size;
+					switch (channel_count) {
+					case 1:
+						TextureResampleRowHorizontal<1>(source_row, source_width, decode_tables, horizontal_taps, destination_width, decoded_row, filtered_row);
+						break;
+					case 2:
+						TextureResampleRowHorizontal<2>(source_row, source_width, decode_tables, horizontal_taps, destination_width, decoded_row, filtered_row);
+						break;
+					case 3:
+						TextureResampleRowHorizontal<3>(source_row, source_width, decode_tables, horizontal_taps, destination_width, decoded_row, filtered_row);
+						break;
+					case 4:
+						TextureResampleRowHorizontal<4>(source_row, source_width, decode_tables, horizontal_taps, destination_width, decoded_row, filtered_row);
+						break;
+					}
+				}
+
+				for (size_t row = row_offset; row < row_offset + row_count; row++) {
+					const unsigned int* indices = vertical_taps.Indices(row);
+					const float* weights = vertical_taps.Weights(row);
+					for (size_t index = 0; index < filtered_row_size; index += Vec8f::size()) {
+						Vec8f value = 0.0f;
+						for (size_t tap = 0; tap < vertical_taps.tap_count; tap++) {
+							const float* filtered_row = filtered_rows + (indices[tap] - first_source_row) * filtered_row_size;
+							value = mul_add(Vec8f().load_a(filtered_row + index), Vec8f(weights[tap]), value);
+						}
+						// The Kaiser filter has negative lobes, which can overshoot
+						value = min(max(value, Vec8f(0.0f)), Vec8f(1.0f));
+						value.store_a(destination_values + index);
+					}
+
+					unsigned char* destination_row = (unsigned char*)OffsetPointer(destination, row * destination_row_size);
+					for (size_t index = 0; index < destination_width; index++) {
+						for (size_t channel = 0; channel < channel_count; channel++) {
+							float value = destination_values[index * channel_count + channel];
+							size_t value_index = index * channel_count + channel;
+							if (encode_srgb[channel]) {
+								destination_row[value_index] = tables.linear_to_srgb[(size_t)(value * (float)(ECS_COUNTOF(tables.linear_to_srgb) - 1) + 0.5f)];
+							}
+							else {
+								destination_row[value_index] = (unsigned char)(value * 255.0f + 0.5f);
+							}
+						}
+					}
+				}
+
+				Free(decoded_row);
+			}
+		);
+
+		Deallocate(ECS_MALLOC_ALLOCATOR, horizontal_taps.indices);
+		Deallocate(ECS_MALLOC_ALLOCATOR, vertical_taps.indices);
+	}
+
+	// Returns the channel count for the 8 bit unorm formats, or 0 if the format is not one of them
+	static size_t GetTextureResampleChannelCount(ECS_GRAPHICS_FORMAT format) {
+		switch (format) {
+		case ECS_GRAPHICS_FORMAT_R8_UNORM:
+			return 1;
+		case ECS_GRAPHICS_FORMAT_RG8_UNORM:
+			return 2;
+		case ECS_GRAPHICS_FORMAT_RGBA8_UNORM:
+		case ECS_GRAPHICS_FORMAT_RGBA8_UNORM_SRGB:
+			return 4;
+		}
+		return 0;
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
 	Texture2D ResizeTextureWithStaging(Graphics* graphics, Texture2D texture, size_t new_width, size_t new_height, size_t resize_flag, bool temporary)
 	{
 		Texture2D staging_texture = TextureToStaging(graphics, texture);
@@ -196,6 +508,38 @@ namespace ECSEngine {
 	{
 		Stream<void> data = { nullptr, 0 };
 
+		// The 8 bit formats are resized by the internal resampler, which is vectorized and runs in linear space
+		// for the sRGB formats. The cubic filter and the other formats go through DirectXTex. When no allocator
+		// is given, the DirectXTex allocation is kept such that the data is deallocated in the same way
+		if (allocator.allocator != nullptr && resize_flags != ECS_RESIZE_TEXTURE_FILTER_CUBIC) {
+			size_t channel_count = GetTextureResampleChannelCount(format);
+			if (channel_count > 0) {
+				TEXTURE_RESAMPLE_FILTER filter = TEXTURE_RESAMPLE_LINEAR;
+				if (resize_flags == ECS_RESIZE_TEXTURE_FILTER_POINT) {
+					filter = TEXTURE_RESAMPLE_POINT;
+				}
+				else if (resize_flags == ECS_RESIZE_TEXTURE_FILTER_BOX) {
+					filter = TEXTURE_RESAMPLE_BOX;
+				}
+
+				data.size = new_width * new_height * channel_count;
+				data.buffer = Allocate(allocator, data.size);
+				TextureResample(
+					texture_data,
+					current_width,
+					current_height,
+					data.buffer,
+					new_width,
+					new_height,
+					channel_count,
+					IsGraphicsFormatSRGB(format),
+					filter,
+					nullptr
+				);
+				return data;
+			}
+		}
+
 		DirectX::Image dx_image;
 		dx_image.pixels = (uint8_t*)texture_data;
 		dx_image.format = GetGraphicsNativeFormat(format);
@@ -296,17 +640,21 @@ namespace ECSEngine {
 
 	// ----------------------------------------------------------------------------------------------------------------------
 
-	//ECS_OPTIMIZE_START;
-
-	template<int index>
-	ECS_INLINE Vec32uc ECS_VECTORCALL ConvertSingleChannelTextureToGrayscaleSplat(Vec32uc samples) {
-		return permute32<index, index, index, V_DC, index + 1, index + 1, index + 1, V_DC, index + 2, index + 2, index + 2, V_DC, index + 3, index + 3, index + 3, V_DC,
-			index + 4, index + 4, index + 4, V_DC, index + 5, index + 5, index + 5, V_DC, index + 6, index + 6, index + 6, V_DC, index + 7, index + 7, index + 7, V_DC>(samples);
-	}
-
-	ECS_INLINE Vec32uc ECS_VECTORCALL ConvertSingleChannelTextureToGrayscaleBlend(Vec32uc values, Vec32uc alpha) {
-		return blend32<0, 1, 2, 3 + 32, 4, 5, 6, 7 + 32, 8, 9, 10, 11 + 32, 12, 13, 14, 15 + 32, 
-			16, 17, 18, 19 + 32, 20, 21, 22, 23 + 32, 24, 25, 26, 27 + 32, 28, 29, 30, 31 + 32>(values, alpha);
+	// The pixels are converted in chunks of this many pixels, which is a multiple of the SIMD width of all the kernels
+#define TEXTURE_CONVERT_CHUNK_PIXEL_COUNT 32
+	// The minimum amount of chunks that a thread converts at once
+#define TEXTURE_CONVERT_MIN_CHUNK_BATCH 2048
+#define TEXTURE_CONVERT_MAX_BATCH_COUNT 64
+
+	// Calls the kernel with (size_t pixel_offset, size_t pixel_count) for consecutive ranges of the pixels, in parallel
+	// when a task manager is given. The ranges start at multiples of TEXTURE_CONVERT_CHUNK_PIXEL_COUNT
+	template<typename Kernel>
+	static void ConvertTexturePixels(TaskManager* task_manager, size_t pixel_count, Kernel&& kernel) {
+		size_t chunk_count = SlotsFor(pixel_count, TEXTURE_CONVERT_CHUNK_PIXEL_COUNT);
+		ParallelForBatches(task_manager, chunk_count, TEXTURE_CONVERT_MIN_CHUNK_BATCH, TEXTURE_CONVERT_MAX_BATCH_COUNT, [&](size_t chunk_offset, size_t batch_count, size_t batch_index) {
+			size_t pixel_offset = chunk_offset * TEXTURE_CONVERT_CHUNK_PIXEL_COUNT;
+			kernel(pixel_offset, min(batch_count * TEXTURE_CONVERT_CHUNK_PIXEL_COUNT, pixel_count - pixel_offset));
+		});
 	}
 
 	template<typename SizeFunctor>
@@ -348,11 +696,33 @@ namespace ECSEngine {
 		return { streams, mip_data.size };
 	}
 
+	// Expands each value into an opaque RGBA pixel with the value in all the color channels
+	static void ConvertSingleChannelPixelsToGrayscale(const unsigned char* input, unsigned char* output, size_t pixel_count) {
+		size_t simd_count = GetSimdCount(pixel_count, Vec32uc::size());
+		for (size_t index = 0; index < simd_count; index += Vec32uc::size()) {
+			Vec32uc samples = Vec32uc().load(input + index);
+			Vec16us low_samples = extend_low(samples);
+			Vec16us high_samples = extend_high(samples);
+			Vec8ui values[4] = { extend_low(low_samples), extend_high(low_samples), extend_low(high_samples), extend_high(high_samples) };
+			for (size_t subindex = 0; subindex < ECS_COUNTOF(values); subindex++) {
+				// Replicate the value in the color bytes and set the alpha to 255
+				Vec8ui pixels = values[subindex] * Vec8ui(0x00010101) | Vec8ui(0xFF000000);
+				pixels.store(output + (index + subindex * Vec8ui::size()) * 4);
+			}
+		}
+
+		for (size_t index = simd_count; index < pixel_count; index++) {
+			output[index * 4] = input[index];
+			output[index * 4 + 1] = input[index];
+			output[index * 4 + 2] = input[index];
+			output[index * 4 + 3] = 255;
+		}
+	}
+
 	Stream<Stream<void>> ConvertSingleChannelTextureToGrayscaleImpl(
 		Stream<Stream<void>> mip_data,
-		size_t width,
-		size_t height,
 		AllocatorPolymorphic allocator,
+		TaskManager* task_manager,
 		bool in_place
 	) {
 		ECS_STACK_CAPACITY_STREAM(Stream<void>, output_streams, 512);
@@ -360,51 +730,12 @@ namespace ECSEngine {
 			return mip_size * 4;
 		});
 
-		Vec32uc samples;
-		Vec32uc alpha(255);
-		// Now copy the data - use SIMD instructions
 		for (size_t index = 0; index < mip_data.size; index++) {
-			size_t width_times_height = width * height;
-			size_t steps = width_times_height / samples.size();
-			size_t remainder = width_times_height % samples.size();
-			if (remainder == 0) {
-				for (size_t step = 0; step < steps; step++) {
-					// Load the data into the register
-					samples.load(OffsetPointer(mip_data[index].buffer, samples.size() * step));
-
-					// Splat the values 8 at a time - but set the alpha to 255
-					Vec32uc splat0 = ConvertSingleChannelTextureToGrayscaleSplat<0>(samples);
-					Vec32uc splat1 = ConvertSingleChannelTextureToGrayscaleSplat<8>(samples);
-					Vec32uc splat2 = ConvertSingleChannelTextureToGrayscaleSplat<16>(samples);
-					Vec32uc splat3 = ConvertSingleChannelTextureToGrayscaleSplat<24>(samples);
-
-					// Blend with the alpha
-					Vec32uc values0 = ConvertSingleChannelTextureToGrayscaleBlend(splat0, alpha);
-					Vec32uc values1 = ConvertSingleChannelTextureToGrayscaleBlend(splat1, alpha);
-					Vec32uc values2 = ConvertSingleChannelTextureToGrayscaleBlend(splat2, alpha);
-					Vec32uc values3 = ConvertSingleChannelTextureToGrayscaleBlend(splat3, alpha);
-
-					void* base_pointer = OffsetPointer(streams[index].buffer, samples.size() * step * 4);
-					// Write the values
-					values0.store(base_pointer);
-					values1.store(OffsetPointer(base_pointer, samples.size()));
-					values2.store(OffsetPointer(base_pointer, samples.size() * 2));
-					values3.store(OffsetPointer(base_pointer, samples.size() * 3));
-				}
-			}
-			else {
-				// Scalar version
-				unsigned char* source_data = (unsigned char*)mip_data[index].buffer;
-				unsigned char* destination_data = (unsigned char*)streams[index].buffer;
-				for (size_t subindex = 0; subindex < mip_data[index].size; subindex++) {
-					size_t dest_offset = subindex * 4;
-					destination_data[dest_offset] = source_data[subindex];
-					destination_data[dest_offset + 1] = source_data[subindex];
-					destination_data[dest_offset + 2] = source_data[subindex];
-					// Alpha
-					destination_data[dest_offset + 3] = 255;
-				}
-			}
+			const unsigned char* input = (const unsigned char*)mip_data[index].buffer;
+			unsigned char* output = (unsigned char*)streams[index].buffer;
+			ConvertTexturePixels(task_manager, mip_data[index].size, [&](size_t pixel_offset, size_t pixel_count) {
+				ConvertSingleChannelPixelsToGrayscale(input + pixel_offset, output + pixel_offset * 4, pixel_count);
+			});
 		}
 
 		if (in_place) {
@@ -417,28 +748,61 @@ namespace ECSEngine {
 		Stream<Stream<void>> mip_data,
 		size_t width,
 		size_t height,
-		AllocatorPolymorphic allocator
+		AllocatorPolymorphic allocator,
+		TaskManager* task_manager
 	)
 	{
-		return ConvertSingleChannelTextureToGrayscaleImpl(mip_data, width, height, allocator, false);
+		return ConvertSingleChannelTextureToGrayscaleImpl(mip_data, allocator, task_manager, false);
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------------
 
-	void ConvertSingleChannelTextureToGrayscaleInPlace(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator)
+	void ConvertSingleChannelTextureToGrayscaleInPlace(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator, TaskManager* task_manager)
 	{
-		ConvertSingleChannelTextureToGrayscaleImpl(mip_data, width, height, allocator, true);
+		ConvertSingleChannelTextureToGrayscaleImpl(mip_data, allocator, task_manager, true);
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------------
 
+	// Extracts a channel out of 2 or 4 channel pixels by shifting it to the low byte of each pixel and then narrowing
+	// the pixels to bytes. 3 channel pixels are handled with the scalar loop
+	static void ConvertPixelsToSingleChannel(const unsigned char* input, unsigned char* output, size_t pixel_count, size_t channel_count, size_t channel_to_copy) {
+		size_t simd_count = 0;
+		unsigned int shift = (unsigned int)channel_to_copy * 8;
+		if (channel_count == 4) {
+			simd_count = GetSimdCount(pixel_count, Vec32uc::size());
+			for (size_t index = 0; index < simd_count; index += Vec32uc::size()) {
+				const unsigned char* pixels = input + index * 4;
+				Vec8ui values0 = (Vec8ui().load(pixels) >> shift) & Vec8ui(0xFF);
+				Vec8ui values1 = (Vec8ui().load(pixels + ECS_SIMD_BYTE_SIZE) >> shift) & Vec8ui(0xFF);
+				Vec8ui values2 = (Vec8ui().load(pixels + ECS_SIMD_BYTE_SIZE * 2) >> shift) & Vec8ui(0xFF);
+				Vec8ui values3 = (Vec8ui().load(pixels + ECS_SIMD_BYTE_SIZE * 3) >> shift) & Vec8ui(0xFF);
+				Vec32uc result = compress(compress(values0, values1), compress(values2, values3));
+				result.store(output + index);
+			}
+		}
+		else if (channel_count == 2) {
+			simd_count = GetSimdCount(pixel_count, Vec32uc::size());
+			for (size_t index = 0; index < simd_count; index += Vec32uc::size()) {
+				const unsigned char* pixels = input + index * 2;
+				Vec16us values0 = (Vec16us().load(pixels) >> shift) & Vec16us(0xFF);
+				Vec16us values1 = (Vec16us().load(pixels + ECS_SIMD_BYTE_SIZE) >> shift) & Vec16us(0xFF);
+				Vec32uc result = compress(values0, values1);
+				result.store(output + index);
+			}
+		}
+
+		for (size_t index = simd_count; index < pixel_count; index++) {
+			output[index] = input[index * channel_count + channel_to_copy];
+		}
+	}
+
 	Stream<Stream<void>> ConvertTextureToSingleChannelImpl(
 		Stream<Stream<void>> mip_data,
-		size_t width,
-		size_t height,
 		size_t channel_count,
 		size_t channel_to_copy,
 		AllocatorPolymorphic allocator,
+		TaskManager* task_manager,
 		bool in_place
 	) {
 		ECS_STACK_CAPACITY_STREAM(Stream<void>, output_streams, 512);
@@ -446,13 +810,12 @@ namespace ECSEngine {
 			return mip_size / channel_count;
 		});
 
-		// At the moment use just a scalar version. If needed add a SIMD version
 		for (size_t index = 0; index < mip_data.size; index++) {
-			unsigned char* values = (unsigned char*)streams[index].buffer;
-			unsigned char* copy_values = (unsigned char*)mip_data[index].buffer;
-			for (size_t pixel_index = 0; pixel_index < streams[index].size; pixel_index++) {
-				values[pixel_index] = copy_values[pixel_index * channel_count + channel_to_copy];
-			}
+			const unsigned char* input = (const unsigned char*)mip_data[index].buffer;
+			unsigned char* output = (unsigned char*)streams[index].buffer;
+			ConvertTexturePixels(task_manager, streams[index].size, [&](size_t pixel_offset, size_t pixel_count) {
+				ConvertPixelsToSingleChannel(input + pixel_offset * channel_count, output + pixel_offset, pixel_count, channel_count, channel_to_copy);
+			});
 		}
 
 		if (in_place) {
@@ -467,10 +830,11 @@ namespace ECSEngine {
 		size_t height,
 		size_t channel_count,
 		size_t channel_to_copy,
-		AllocatorPolymorphic allocator
+		AllocatorPolymorphic allocator,
+		TaskManager* task_manager
 	)
 	{
-		return ConvertTextureToSingleChannelImpl(mip_data, width, height, channel_count, channel_to_copy, allocator, false);
+		return ConvertTextureToSingleChannelImpl(mip_data, channel_count, channel_to_copy, allocator, task_manager, false);
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------------
@@ -481,52 +845,56 @@ namespace ECSEngine {
 		size_t height,
 		size_t channel_count,
 		size_t channel_to_copy,
-		AllocatorPolymorphic allocator
+		AllocatorPolymorphic allocator,
+		TaskManager* task_manager
 	)
 	{
-		ConvertTextureToSingleChannelImpl(mip_data, width, height, channel_count, channel_to_copy, allocator, true);
+		ConvertTextureToSingleChannelImpl(mip_data, channel_count, channel_to_copy, allocator, task_manager, true);
 	}
 	
 	// ----------------------------------------------------------------------------------------------------------------------
 
-	Stream<Stream<void>> ConvertRGBTextureToRGBAImpl(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator, bool in_place) {
+	// Widens 8 pixels at a time with a permute and a blend of the alpha. The loads are 32 bytes wide
+	// while only 24 are consumed, so the last pixels of the input are handled with the scalar loop
+	static void ConvertRGBPixelsToRGBA(const unsigned char* input, unsigned char* output, size_t pixel_count, size_t readable_pixel_count) {
+		const size_t step_size = 8;
+		// A load must not go past the last readable byte
+		size_t simd_count = readable_pixel_count >= 11 ? min(GetSimdCount(pixel_count, step_size), GetSimdCount(readable_pixel_count - 3, step_size)) : 0;
+		Vec32uc alpha_value = 255;
+		for (size_t index = 0; index < simd_count; index += step_size) {
+			Vec32uc current_values;
+			current_values.load(input + index * 3);
+
+			current_values = permute32<0, 1, 2, V_DC, 3, 4, 5, V_DC, 6, 7, 8, V_DC, 9, 10, 11, V_DC, 12, 13, 14, V_DC,
+				15, 16, 17, V_DC, 18, 19, 20, V_DC, 21, 22, 23, V_DC>(current_values);
+			current_values = blend32<0, 1, 2, 3 + 32, 4, 5, 6, 7 + 32, 8, 9, 10, 11 + 32, 12, 13, 14, 15 + 32,
+				16, 17, 18, 19 + 32, 20, 21, 22, 23 + 32, 24, 25, 26, 27 + 32, 28, 29, 30, 31 + 32>(current_values, alpha_value);
+			current_values.store(output + index * 4);
+		}
+
+		// The remainder is handled normally
+		for (size_t index = simd_count; index < pixel_count; index++) {
+			output[index * 4] = input[index * 3];
+			output[index * 4 + 1] = input[index * 3 + 1];
+			output[index * 4 + 2] = input[index * 3 + 2];
+			output[index * 4 + 3] = 255;
+		}
+	}
+
+	Stream<Stream<void>> ConvertRGBTextureToRGBAImpl(Stream<Stream<void>> mip_data, AllocatorPolymorphic allocator, TaskManager* task_manager, bool in_place) {
 		ECS_STACK_CAPACITY_STREAM(Stream<void>, output_streams, 512);
 		Stream<Stream<void>> streams = GetConvertStream(mip_data, allocator, in_place, output_streams, [](size_t index, size_t mip_size) {
 			return mip_size / 3 * 4;
 		});
 
-		// Use a SIMD version with load, permute and store
-		Vec32uc alpha_value = 255;
 		for (size_t index = 0; index < mip_data.size; index++) {
-			// Load 8 values at a time
-			const unsigned char* input_values = (const unsigned char*)mip_data[index].buffer;
-			unsigned char* output_values = (unsigned char*)streams[index].buffer;
-			size_t output_value_index = 0;
-
-			const size_t step_size = 24;
-			size_t simd_count = GetSimdCount(mip_data[index].size, step_size);
-			ECS_ASSERT((mip_data[index].size - simd_count) % 3 == 0)
-
-				for (size_t simd_index = 0; simd_index < simd_count; simd_index += step_size) {
-					Vec32uc current_values;
-					current_values.load(input_values + simd_index);
-
-					current_values = permute32<0, 1, 2, V_DC, 3, 4, 5, V_DC, 6, 7, 8, V_DC, 9, 10, 11, V_DC, 12, 13, 14, V_DC,
-						15, 16, 17, V_DC, 18, 19, 20, V_DC, 21, 22, 23, V_DC>(current_values);
-					current_values = blend32<0, 1, 2, 3 + 32, 4, 5, 6, 7 + 32, 8, 9, 10, 11 + 32, 12, 13, 14, 15 + 32,
-						16, 17, 18, 19 + 32, 20, 21, 22, 23 + 32, 24, 25, 26, 27 + 32, 28, 29, 30, 31 + 32>(current_values, alpha_value);
-					current_values.store(output_values + output_value_index);
-					output_value_index += 32;
-				}
-
-			// The remainder is handled normally
-			for (size_t scalar_index = simd_count; scalar_index < mip_data[index].size; scalar_index += 3) {
-				output_values[output_value_index] = input_values[scalar_index];
-				output_values[output_value_index + 1] = input_values[scalar_index + 1];
-				output_values[output_value_index + 2] = input_values[scalar_index + 2];
-				output_values[output_value_index + 3] = 255;
-				output_value_index += 4;
-			}
+			ECS_ASSERT(mip_data[index].size % 3 == 0);
+			const unsigned char* input = (const unsigned char*)mip_data[index].buffer;
+			unsigned char* output = (unsigned char*)streams[index].buffer;
+			size_t mip_pixel_count = mip_data[index].size / 3;
+			ConvertTexturePixels(task_manager, mip_pixel_count, [&](size_t pixel_offset, size_t pixel_count) {
+				ConvertRGBPixelsToRGBA(input + pixel_offset * 3, output + pixel_offset * 4, pixel_count, mip_pixel_count - pixel_offset);
+			});
 		}
 
 		if (in_place) {
@@ -535,16 +903,69 @@ namespace ECSEngine {
 		return streams;
 	}
 
-	Stream<Stream<void>> ConvertRGBTextureToRGBA(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator)
+	Stream<Stream<void>> ConvertRGBTextureToRGBA(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator, TaskManager* task_manager)
 	{
-		return ConvertRGBTextureToRGBAImpl(mip_data, width, height, allocator, false);
+		return ConvertRGBTextureToRGBAImpl(mip_data, allocator, task_manager, false);
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------------
 
-	void ConvertRGBTexturetoRGBAInPlace(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator)
+	void ConvertRGBTexturetoRGBAInPlace(Stream<Stream<void>> mip_data, size_t width, size_t height, AllocatorPolymorphic allocator, TaskManager* task_manager)
 	{
-		ConvertRGBTextureToRGBAImpl(mip_data, width, height, allocator, true);
+		ConvertRGBTextureToRGBAImpl(mip_data, allocator, task_manager, true);
+	}
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
+	Stream<Stream<void>> GenerateTextureMips(
+		Stream<void> data,
+		size_t width,
+		size_t height,
+		size_t channel_count,
+		bool srgb,
+		ECS_TEXTURE_MIP_FILTER filter,
+		AllocatorPolymorphic allocator,
+		TaskManager* task_manager,
+		size_t mip_count
+	) {
+		ECS_ASSERT(channel_count >= 1 && channel_count <= 4, "Mip generation supports only 1 to 4 8 bit channels");
+		// The first mip is copied from the data and the kernels read it as a whole, it must not be smaller than the texture
+		ECS_ASSERT(width > 0 && height > 0 && data.size >= width * height * channel_count, "The data given for the mip generation is smaller than the texture");
+
+		size_t full_mip_count = 1;
+		while ((max(width, height) >> full_mip_count) > 0) {
+			full_mip_count++;
+		}
+		mip_count = mip_count == 0 ? full_mip_count : min(mip_count, full_mip_count);
+
+		size_t total_size = sizeof(Stream<void>) * mip_count;
+		for (size_t index = 0; index < mip_count; index++) {
+			total_size += max(width >> index, (size_t)1) * max(height >> index, (size_t)1) * channel_count;
+		}
+		Stream<void>* mips = (Stream<void>*)Allocate(allocator, total_size);
+		uintptr_t buffer = (uintptr_t)(mips + mip_count);
+		for (size_t index = 0; index < mip_count; index++) {
+			mips[index].InitializeFromBuffer(buffer, max(width >> index, (size_t)1) * max(height >> index, (size_t)1) * channel_count);
+		}
+
+		memcpy(mips[0].buffer, data.buffer, mips[0].size);
+		TEXTURE_RESAMPLE_FILTER resample_filter = filter == ECS_TEXTURE_MIP_FILTER_KAISER ? TEXTURE_RESAMPLE_KAISER : TEXTURE_RESAMPLE_BOX;
+		for (size_t index = 1; index < mip_count; index++) {
+			TextureResample(
+				mips[index - 1].buffer,
+				max(width >> (index - 1), (size_t)1),
+				max(height >> (index - 1), (size_t)1),
+				mips[index].buffer,
+				max(width >> index, (size_t)1),
+				max(height >> index, (size_t)1),
+				channel_count,
+				srgb,
+				resample_filter,
+				task_manager
+			);
+		}
+
+		return { mips, mip_count };
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 namespace ECSEngine {
 
 	struct Graphics;
+	struct TaskManager;
 
 	struct DecodedTexture {
 		Stream<void> data;
@@ -66,6 +67,8 @@ namespace ECSEngine {
 	);
 
 	// Resizing is done on the CPU; an allocation will be made for the newly resized data
+	// The R8, RG8 and RGBA8 formats are resized with the internal vectorized resampler (except for the cubic filter),
+	// the sRGB ones being filtered in linear space. The others go through DirectXTex
 	// If it fails, it will return { nullptr, 0 }
 	ECSENGINE_API Stream<void> ResizeTexture(
 		void* texture_data,
@@ -101,7 +104,8 @@ namespace ECSEngine {
 		Stream<Stream<void>> mip_data,
 		size_t width,
 		size_t height,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
 	);
 
 	// Convert a texture from ECS_GRAPHICS_FORMAT_R8_UNORM to ECS_GRAPHICS_FORMAT_RGBA8_UNORM texture
@@ -111,7 +115,8 @@ namespace ECSEngine {
 		Stream<Stream<void>> mip_data,
 		size_t width,
 		size_t height,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
 	);
 
 	// Convert a texture from 2, 3 or 4 8 bit channels into a single 8 bit channel texture
@@ -125,7 +130,8 @@ namespace ECSEngine {
 		size_t height,
 		size_t channel_count = 4,
 		size_t channel_to_copy = 0,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
 	);
 	
 	// Convert a texture from 2, 3 or 4 8 bit channels into a single 8 bit channel texture
@@ -139,7 +145,8 @@ namespace ECSEngine {
 		size_t height,
 		size_t channel_count = 4,
 		size_t channel_to_copy = 0,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
 	);
 
 	// Converts a texture with 3 8 bit channels into 4 8 bit channels with the alpha set to 255
@@ -149,7 +156,8 @@ namespace ECSEngine {
 		Stream<Stream<void>> mip_data,
 		size_t width,
 		size_t height,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
 	);
 
 	// Converts a texture with 3 8 bit channels into 4 8 bit channels with the alpha set to 255
@@ -159,7 +167,31 @@ namespace ECSEngine {
 		Stream<Stream<void>> mip_data,
 		size_t width,
 		size_t height,
-		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr
+	);
+
+	enum ECS_TEXTURE_MIP_FILTER : unsigned char {
+		// Averages the 2x2 footprint, the fastest filter
+		ECS_TEXTURE_MIP_FILTER_BOX,
+		// A windowed sinc, which keeps the lower mips sharper at the cost of some ringing
+		ECS_TEXTURE_MIP_FILTER_KAISER
+	};
+
+	// Generates the mip chain of a texture with 1 to 4 8 bit channels, each mip being filtered from the previous one.
+	// For sRGB textures the color channels are filtered in linear space, the alpha is always linear. A mip count of 0
+	// generates the full chain. The first mip is a copy of the given data. In order to deallocate the data, just deallocate
+	// the buffer of the return (it uses a coalesced allocation). With a task manager, the rows are filtered in parallel
+	ECSENGINE_API Stream<Stream<void>> GenerateTextureMips(
+		Stream<void> data,
+		size_t width,
+		size_t height,
+		size_t channel_count,
+		bool srgb,
+		ECS_TEXTURE_MIP_FILTER filter = ECS_TEXTURE_MIP_FILTER_BOX,
+		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR,
+		TaskManager* task_manager = nullptr,
+		size_t mip_count = 0
 	);
 
 	// It will use the immediate context if none specified. If a deffered context is specified, the copy calls
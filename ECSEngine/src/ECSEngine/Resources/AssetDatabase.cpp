@@ -54,6 +54,115 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------
 
+	void AssetDatabaseLookup::Deallocate(AllocatorPolymorphic allocator)
+	{
+		for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
+			name_tables[index].Deallocate(allocator);
+			pointer_tables[index].Deallocate(allocator);
+		}
+		Reset();
+	}
+
+	// --------------------------------------------------------------------------------------
+
+	void AssetDatabaseLookup::MarkDirty()
+	{
+		for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
+			name_tables_dirty[index] = true;
+		}
+	}
+
+	// --------------------------------------------------------------------------------------
+
+	void AssetDatabaseLookup::Reset()
+	{
+		for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
+			name_tables[index].Reset();
+			pointer_tables[index].Reset();
+			name_collision_counts[index] = 0;
+			name_tables_dirty[index] = false;
+		}
+		lock.Clear();
+	}
+
+	// --------------------------------------------------------------------------------------
+
+	// For samplers and materials the file must be empty
+	static unsigned int AssetLookupHash(Stream<char> name, Stream<wchar_t> file) {
+		return Cantor(fnv1a(name), fnv1a(file));
+	}
+
+	// Clears the table and makes sure that it can hold the given count without growing
+	template<typename Table>
+	static void PrepareLookupTable(Table& table, unsigned int count, AllocatorPolymorphic allocator) {
+		table.Clear();
+		if (count > 0) {
+			unsigned int capacity = (unsigned int)HashTablePowerOfTwoCapacityForElements(count);
+			if (table.GetCapacity() < capacity) {
+				table.Deallocate(allocator);
+				table.Initialize(allocator, capacity);
+			}
+		}
+	}
+
+	// The lookup lock must be acquired
+	static void InsertNameLookup(const AssetDatabase* database, unsigned int handle, ECS_ASSET_TYPE type) {
+		const void* metadata = database->GetAssetConst(handle, type);
+		unsigned int hash = AssetLookupHash(GetAssetName(metadata, type), GetAssetFile(metadata, type));
+		AssetDatabaseLookup::NameTable& table = database->lookup.name_tables[type];
+		if (table.Find(hash) == -1) {
+			table.InsertDynamic(database->Allocator(), handle, hash);
+		}
+		else {
+			database->lookup.name_collision_counts[type]++;
+		}
+	}
+
+	// The lookup lock must be acquired. The table is stale if it was marked as such or
+	// the sparse set was modified without going through the database
+	static void UpdateNameLookup(const AssetDatabase* database, ECS_ASSET_TYPE type) {
+		AssetDatabaseLookup* lookup = &database->lookup;
+		unsigned int asset_count = database->GetAssetCount(type);
+		if (lookup->name_tables_dirty[type] || lookup->name_tables[type].GetCount() + lookup->name_collision_counts[type] != asset_count) {
+			PrepareLookupTable(lookup->name_tables[type], asset_count, database->Allocator());
+			lookup->name_collision_counts[type] = 0;
+			for (unsigned int index = 0; index < asset_count; index++) {
+				InsertNameLookup(database, database->GetAssetHandleFromIndex(index, type), type);
+			}
+			lookup->name_tables_dirty[type] = false;
+		}
+	}
+
+	// The linear functor is called when the hash lookup misses or the stored handle doesn't match
+	// (colliding hashes or a sparse set modified outside the database) and it must return the handle of the asset
+	template<typename LinearFunctor>
+	static unsigned int FindAssetWithLookup(
+		const AssetDatabase* database, 
+		Stream<char> name, 
+		Stream<wchar_t> file, 
+		ECS_ASSET_TYPE type, 
+		LinearFunctor&& linear_functor
+	) {
+		unsigned int hash = AssetLookupHash(name, file);
+		AssetDatabaseLookup* lookup = &database->lookup;
+
+		unsigned int handle = -1;
+		lookup->lock.Lock();
+		UpdateNameLookup(database, type);
+		lookup->name_tables[type].TryGetValue(hash, handle);
+		lookup->lock.Unlock();
+
+		if (handle != -1 && database->Exists(handle, type)) {
+			const void* metadata = database->GetAssetConst(handle, type);
+			if (GetAssetName(metadata, type) == name && GetAssetFile(metadata, type) == file) {
+				return handle;
+			}
+		}
+		return linear_functor();
+	}
+
+	// --------------------------------------------------------------------------------------
+
 	AssetDatabase::AssetDatabase(AllocatorPolymorphic allocator,  const Reflection::ReflectionManager* _reflection_manager)
 		: reflection_manager(_reflection_manager), metadata_file_location(nullptr, 0)
 	{
@@ -86,7 +195,9 @@ namespace ECSEngine {
 				if (ExistsFileOrFolder(path)) {
 					bool success = database->ReadAssetFile(name, file, &metadata, type);
 					if (success) {
-						return set.Add({ metadata, 1 });
+						handle = set.Add({ metadata, 1 });
+						database->AddAssetToLookup(handle, type);
+						return handle;
 					}
 					else {
 						// Also deallocate the name
@@ -99,12 +210,16 @@ namespace ECSEngine {
 				}
 				else {
 					database->WriteAssetFile(&metadata, type);
-					return set.Add({ metadata, 1 });
+					handle = set.Add({ metadata, 1 });
+					database->AddAssetToLookup(handle, type);
+					return handle;
 				}
 			}
 			else {
 				database->WriteAssetFile(&metadata, type);
-				return set.Add({ metadata, 1 });
+				handle = set.Add({ metadata, 1 });
+				database->AddAssetToLookup(handle, type);
+				return handle;
 			}
 		}
 		else {
@@ -128,7 +243,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddMeshInternal(const MeshMetadata* metadata, unsigned int reference_count)
 	{
-		return mesh_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = mesh_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_MESH);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -142,7 +259,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddTextureInternal(const TextureMetadata* metadata, unsigned int reference_count)
 	{
-		return texture_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = texture_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_TEXTURE);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -156,7 +275,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddGPUSamplerInternal(const GPUSamplerMetadata* metadata, unsigned int reference_count)
 	{
-		return gpu_sampler_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = gpu_sampler_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_GPU_SAMPLER);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -170,7 +291,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddShaderInternal(const ShaderMetadata* metadata, unsigned int reference_count)
 	{
-		return shader_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = shader_metadata.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_SHADER);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -184,7 +307,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddMaterialInternal(const MaterialAsset* metadata, unsigned int reference_count)
 	{
-		return material_asset.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = material_asset.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_MATERIAL);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -198,7 +323,9 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::AddMiscInternal(const MiscAsset* metadata, unsigned int reference_count)
 	{
-		return misc_asset.Add({ metadata->Copy(Allocator()), reference_count });
+		unsigned int handle = misc_asset.Add({ metadata->Copy(Allocator()), reference_count });
+		AddAssetToLookup(handle, ECS_ASSET_MISC);
+		return handle;
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -283,6 +410,15 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------
 
+	void AssetDatabase::AddAssetToLookup(unsigned int handle, ECS_ASSET_TYPE type)
+	{
+		lookup.lock.Lock();
+		InsertNameLookup(this, handle, type);
+		lookup.lock.Unlock();
+	}
+
+	// --------------------------------------------------------------------------------------
+
 	template<typename StreamType>
 	AssetDatabase CopyImpl(const AssetDatabase* database, StreamType* handle_mask, AllocatorPolymorphic allocator) {
 		AssetDatabase result;
@@ -410,6 +546,7 @@ namespace ECSEngine {
 		shader_metadata.FreeBuffer();
 		material_asset.FreeBuffer();
 		misc_asset.FreeBuffer();
+		lookup.Deallocate(Allocator());
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -464,8 +601,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindMesh(Stream<char> name, Stream<wchar_t> file) const
 	{
-		return mesh_metadata.FindFunctor([&](const ReferenceCounted<MeshMetadata>& compare) {
-			return compare.value.name == name && compare.value.file == file;
+		return FindAssetWithLookup(this, name, file, ECS_ASSET_MESH, [&]() {
+			return mesh_metadata.FindFunctor([&](const ReferenceCounted<MeshMetadata>& compare) {
+				return compare.value.name == name && compare.value.file == file;
+			});
 		});
 	}
 
@@ -473,8 +612,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindTexture(Stream<char> name, Stream<wchar_t> file) const
 	{
-		return texture_metadata.FindFunctor([&](const ReferenceCounted<TextureMetadata>& compare) {
-			return compare.value.name == name && compare.value.file == file;
+		return FindAssetWithLookup(this, name, file, ECS_ASSET_TEXTURE, [&]() {
+			return texture_metadata.FindFunctor([&](const ReferenceCounted<TextureMetadata>& compare) {
+				return compare.value.name == name && compare.value.file == file;
+			});
 		});
 	}
 
@@ -482,8 +623,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindGPUSampler(Stream<char> name) const
 	{
-		return gpu_sampler_metadata.FindFunctor([&](const ReferenceCounted<GPUSamplerMetadata>& compare) {
-			return compare.value.name == name;
+		return FindAssetWithLookup(this, name, {}, ECS_ASSET_GPU_SAMPLER, [&]() {
+			return gpu_sampler_metadata.FindFunctor([&](const ReferenceCounted<GPUSamplerMetadata>& compare) {
+				return compare.value.name == name;
+			});
 		});
 	}
 
@@ -491,8 +634,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindShader(Stream<char> name, Stream<wchar_t> file) const
 	{
-		return shader_metadata.FindFunctor([&](const ReferenceCounted<ShaderMetadata>& compare) {
-			return compare.value.name == name && compare.value.file == file;
+		return FindAssetWithLookup(this, name, file, ECS_ASSET_SHADER, [&]() {
+			return shader_metadata.FindFunctor([&](const ReferenceCounted<ShaderMetadata>& compare) {
+				return compare.value.name == name && compare.value.file == file;
+			});
 		});
 	}
 
@@ -500,8 +645,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindMaterial(Stream<char> name) const
 	{
-		return material_asset.FindFunctor([&](const ReferenceCounted<MaterialAsset>& compare) {
-			return compare.value.name == name;
+		return FindAssetWithLookup(this, name, {}, ECS_ASSET_MATERIAL, [&]() {
+			return material_asset.FindFunctor([&](const ReferenceCounted<MaterialAsset>& compare) {
+				return compare.value.name == name;
+			});
 		});
 	}
 
@@ -509,8 +656,10 @@ namespace ECSEngine {
 
 	unsigned int AssetDatabase::FindMisc(Stream<char> name, Stream<wchar_t> file) const
 	{
-		return misc_asset.FindFunctor([&](const ReferenceCounted<MiscAsset>& compare) {
-			return compare.value.name == name && compare.value.file == file;
+		return FindAssetWithLookup(this, name, file, ECS_ASSET_MISC, [&]() {
+			return misc_asset.FindFunctor([&](const ReferenceCounted<MiscAsset>& compare) {
+				return compare.value.name == name && compare.value.file == file;
+			});
 		});
 	}
 
@@ -550,46 +699,79 @@ namespace ECSEngine {
 		return -1;
 	}
 
+	// Uses the pointer lookup of the database. If the pointer is not found in the lookup or the entry is stale,
+	// it will perform the linear search and, if the asset is found by its pointer, then that entry is added
+	// to the lookup such that the following calls don't need to go through the linear search again
+	template<typename SparseSet>
+	unsigned int FindAssetExWithLookup(const AssetDatabase* database, const SparseSet* set, ECS_ASSET_TYPE type, const void* pointer, size_t compare_size) {
+		AssetDatabaseLookup* lookup = &database->lookup;
+		AssetDatabaseLookup::PointerTable& table = lookup->pointer_tables[type];
+
+		unsigned int handle = -1;
+		lookup->lock.Lock();
+		table.TryGetValue(pointer, handle);
+		lookup->lock.Unlock();
+
+		if (handle != -1 && set->Exists(handle) && (*set)[handle].value.Pointer() == pointer) {
+			return handle;
+		}
+
+		handle = FindAssetExImplementation(set, pointer, compare_size);
+		if (handle != -1 && (*set)[handle].value.Pointer() == pointer) {
+			lookup->lock.Lock();
+			// The pointer might already be present with a stale handle, in which case only the value is replaced
+			unsigned int table_index = table.Find(pointer);
+			if (table_index == -1) {
+				table.InsertDynamic(database->Allocator(), handle, pointer);
+			}
+			else {
+				*table.GetValuePtrFromIndex(table_index) = handle;
+			}
+			lookup->lock.Unlock();
+		}
+		return handle;
+	}
+
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindMeshEx(const CoalescedMesh* mesh) const
 	{
-		return FindAssetExImplementation(&mesh_metadata, mesh, sizeof(CoalescedMesh));
+		return FindAssetExWithLookup(this, &mesh_metadata, ECS_ASSET_MESH, mesh, sizeof(CoalescedMesh));
 	}
 
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindTextureEx(ResourceView resource_view) const
 	{
-		return FindAssetExImplementation(&texture_metadata, resource_view.Interface(), 0);
+		return FindAssetExWithLookup(this, &texture_metadata, ECS_ASSET_TEXTURE, resource_view.Interface(), 0);
 	}
 
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindGPUSamplerEx(SamplerState sampler_state) const
 	{
-		return FindAssetExImplementation(&gpu_sampler_metadata, sampler_state.Interface(), 0);
+		return FindAssetExWithLookup(this, &gpu_sampler_metadata, ECS_ASSET_GPU_SAMPLER, sampler_state.Interface(), 0);
 	}
 
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindShaderEx(const void* shader_interface) const
 	{
-		return FindAssetExImplementation(&shader_metadata, shader_interface, 0);
+		return FindAssetExWithLookup(this, &shader_metadata, ECS_ASSET_SHADER, shader_interface, 0);
 	}
 
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindMaterialEx(const Material* material) const
 	{
-		return FindAssetExImplementation(&material_asset, material, sizeof(Material));
+		return FindAssetExWithLookup(this, &material_asset, ECS_ASSET_MATERIAL, material, sizeof(Material));
 	}
 
 	// --------------------------------------------------------------------------------------
 
 	unsigned int AssetDatabase::FindMiscEx(Stream<void> data) const
 	{
-		return FindAssetExImplementation(&misc_asset, data.buffer, 0);
+		return FindAssetExWithLookup(this, &misc_asset, ECS_ASSET_MISC, data.buffer, 0);
 	}
 
 	// --------------------------------------------------------------------------------------
@@ -1524,6 +1706,7 @@ namespace ECSEngine {
 			}
 
 			// Deallocate the memory
+			database->RemoveAssetFromLookup(handle, asset_type);
 			metadata.value.DeallocateMemory(type.allocator);
 			type.RemoveSwapBack(handle);
 			return true;
@@ -1936,6 +2119,7 @@ namespace ECSEngine {
 		if (remove_info != nullptr && remove_info->storage != nullptr) {
 			memcpy(remove_info->storage, metadata, AssetMetadataByteSize(type));
 		}
+		RemoveAssetFromLookup(handle, type);
 
 		switch (type) {
 		case ECS_ASSET_MESH:
@@ -1975,6 +2159,32 @@ namespace ECSEngine {
 
 	// --------------------------------------------------------------------------------------
 
+	void AssetDatabase::RemoveAssetFromLookup(unsigned int handle, ECS_ASSET_TYPE type)
+	{
+		const void* metadata = GetAssetConst(handle, type);
+		unsigned int hash = AssetLookupHash(ECSEngine::GetAssetName(metadata, type), GetAssetFile(metadata, type));
+
+		lookup.lock.Lock();
+		AssetDatabaseLookup::NameTable& table = lookup.name_tables[type];
+		unsigned int table_index = table.Find(hash);
+		if (table_index != -1 && table.GetValueFromIndex(table_index) == handle) {
+			table.EraseFromIndex(table_index);
+			// If another asset has the same hash, it needs to take this entry
+			if (lookup.name_collision_counts[type] > 0) {
+				lookup.name_tables_dirty[type] = true;
+			}
+		}
+		else if (lookup.name_collision_counts[type] > 0) {
+			lookup.name_collision_counts[type]--;
+		}
+		else {
+			lookup.name_tables_dirty[type] = true;
+		}
+		lookup.lock.Unlock();
+	}
+
+	// --------------------------------------------------------------------------------------
+
 	void AssetDatabase::RemoveAssetDependencies(const void* asset, ECS_ASSET_TYPE type)
 	{
 		if (type == ECS_ASSET_MATERIAL) {
@@ -2017,6 +2227,10 @@ namespace ECSEngine {
 
 	void AssetDatabase::SetAllocator(AllocatorPolymorphic allocator)
 	{
+		// The lookup tables were allocated from the previous allocator. When called on a new database
+		// the tables have no buffers and nothing is deallocated
+		lookup.Deallocate(mesh_metadata.allocator);
+
 		mesh_metadata.allocator = allocator;
 		texture_metadata.allocator = allocator;
 		gpu_sampler_metadata.allocator = allocator;
@@ -2158,8 +2372,10 @@ namespace ECSEngine {
 		}
 		
 		T* old = (T*)database->GetAsset(handle, type);
+		database->RemoveAssetFromLookup(handle, type);
 		old->DeallocateMemory(database->Allocator());
 		*old = ((T*)metadata)->Copy(database->Allocator());
+		database->AddAssetToLookup(handle, type);
 
 		if (update_files) {
 			// Get the update name and file
@@ -2755,6 +2971,8 @@ namespace ECSEngine {
 
 		ClearSerializeCustomTypeUserData(Reflection::ECS_REFLECTION_CUSTOM_TYPE_MATERIAL_ASSET);
 		SetSerializeCustomMaterialDoNotIncrementDependencies(false);
+		// The sparse sets were replaced, the lookup must be rebuilt
+		database->lookup.MarkDirty();
 
 		if (options.default_initialize_other_fields) {
 			ECS_ASSET_TYPE current_type = ECS_ASSET_MESH;
@@ -3,6 +3,8 @@
 #include "../Core.h"
 #include "../Containers/Stream.h"
 #include "../Containers/SparseSet.h"
+#include "../Containers/HashTable.h"
+#include "../Multithreading/ConcurrentPrimitives.h"
 #include "AssetMetadata.h"
 #include "../Utilities/Reflection/ReflectionMacros.h"
 #include "../Utilities/Reflection/Reflection.h"
@@ -85,6 +87,31 @@ namespace ECSEngine {
 		CapacityStream<void> storage_dependencies_allocation = { nullptr, 0, 0 };
 	};
 
+	// Per asset type hash indices used to accelerate the AssetDatabase lookups. The name tables map the hash of
+	// the name and file of an asset to its handle and are kept in sync by the database calls. When 2 assets have
+	// the same hash only the first one is stored. Any miss or mismatch in the table falls back to the linear search.
+	// The pointer tables map the asset pointer to the handle. These are only a cache, since the pointers are
+	// changed by the loading code outside the database, and are updated entry by entry when found to be stale
+	struct ECSENGINE_API AssetDatabaseLookup {
+		typedef HashTable<unsigned int, unsigned int, HashFunctionPowerOfTwo> NameTable;
+		typedef HashTable<unsigned int, const void*, HashFunctionPowerOfTwo, PointerHashing> PointerTable;
+
+		void Deallocate(AllocatorPolymorphic allocator);
+
+		// The name tables will be rebuilt before the next lookup
+		void MarkDirty();
+
+		// Sets the tables to empty without deallocating them
+		void Reset();
+
+		NameTable name_tables[ECS_ASSET_TYPE_COUNT];
+		PointerTable pointer_tables[ECS_ASSET_TYPE_COUNT];
+		// The number of assets that are missing from the name table because their hash collided with another entry
+		unsigned int name_collision_counts[ECS_ASSET_TYPE_COUNT] = { 0 };
+		bool name_tables_dirty[ECS_ASSET_TYPE_COUNT] = { false };
+		SpinLock lock;
+	};
+
 	// The last character is a path separator
 	ECSENGINE_API void AssetDatabaseFileDirectory(Stream<wchar_t> file_location, CapacityStream<wchar_t>& path, ECS_ASSET_TYPE type);
 
@@ -152,6 +179,10 @@ namespace ECSEngine {
 		// It increments by one the reference count for that asset. If it doesn't exist, it will load it
 		void AddAsset(unsigned int handle, ECS_ASSET_TYPE type, unsigned int reference_count = 1);
 
+		// Inserts the asset into the name lookup. The database functions that add assets already call this,
+		// it needs to be called manually only when the sparse sets are modified directly
+		void AddAssetToLookup(unsigned int handle, ECS_ASSET_TYPE type);
+
 		// Retrive the allocator for this database
 		ECS_INLINE AllocatorPolymorphic Allocator() const {
 			return mesh_metadata.allocator;
@@ -508,6 +539,10 @@ namespace ECSEngine {
 		// (it will not forcefully remove them)
 		void RemoveAssetForced(unsigned int handle, ECS_ASSET_TYPE type, AssetDatabaseRemoveInfo* remove_info = nullptr);
 
+		// Removes the asset from the name lookup. It must be called while the asset is still in the sparse set.
+		// The database functions that remove assets already call this
+		void RemoveAssetFromLookup(unsigned int handle, ECS_ASSET_TYPE type);
+
 		// If the asset is to be evicted - e.g. it was the last reference, then it will call the functor
 		// before/after the remove is actually done. Can control the before/after with the template boolean argument
 		// The functor receives as arguments (unsigned int handle, ECS_ASSET_TYPE type, AssetType* asset)
@@ -524,6 +559,7 @@ namespace ECSEngine {
 					}
 
 					// Deallocate the memory
+					RemoveAssetFromLookup(handle, type);
 					metadata.value.DeallocateMemory(sparse_set.allocator);
 					sparse_set.RemoveSwapBack(handle);
 
@@ -798,6 +834,8 @@ namespace ECSEngine {
 		// In that directory the metadata folders will be created
 		Stream<wchar_t> metadata_file_location;
 		const Reflection::ReflectionManager* reflection_manager;
+		// Mutable since the const lookups can rebuild the tables
+		mutable AssetDatabaseLookup lookup;
 	};
 
 	// ------------------------------------------------------------------------------------------------------------
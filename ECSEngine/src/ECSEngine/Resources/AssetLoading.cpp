@@ -5,11 +5,13 @@
 #include "../Multithreading/TaskManager.h"
 #include "AssetDatabase.h"
 #include "AssetDatabaseReference.h"
+#include "AssetProcessingCache.h"
 #include "../GLTF/GLTFLoader.h"
 #include "../Allocators/ResizableLinearAllocator.h"
 #include "../Utilities/Path.h"
 #include "../ECS/World.h"
 #include "../OS/FileOS.h"
+#include "../Utilities/Algorithms.h"
 
 namespace ECSEngine {
 
@@ -26,6 +28,12 @@ namespace ECSEngine {
 		Stream<unsigned int> different_handles;
 	};
 
+	// The processed output of a texture handle that was found in the processing cache
+	struct TextureCacheEntry {
+		DecodedTexture texture;
+		Stream<Stream<void>> mips;
+	};
+
 	struct TextureLoadData {
 		ECS_INLINE bool IsValid() const {
 			return time_stamp > 0 || texture.data.size > 0;
@@ -34,6 +42,10 @@ namespace ECSEngine {
 		DecodedTexture texture;
 		size_t time_stamp;
 		Stream<unsigned int> different_handles;
+		// Used only when there is a processing cache. It has an entry for each different handle,
+		// with the mips empty when the processed output for that handle was not found
+		Stream<TextureCacheEntry> cache_entries;
+		size_t content_hash;
 	};
 
 	struct ShaderData {
@@ -78,6 +90,11 @@ namespace ECSEngine {
 			return &global_managers[index];
 		}
 
+		// The I/O stage allocations are deallocated by the processing tasks, on other threads
+		ECS_INLINE AllocatorPolymorphic GetIOAllocator() {
+			return AllocatorPolymorphic(&io_allocator, ECS_ALLOCATION_MULTI);
+		}
+
 		// Sets the success flag to false
 		void Fail(LoadAssetFailure failure) {
 			if (load_info.success != nullptr) {
@@ -118,6 +135,10 @@ namespace ECSEngine {
 		}
 
 		GlobalMemoryManager* global_managers;
+		// The allocator from which the I/O stage makes the file data allocations
+		GlobalMemoryManager io_allocator;
+		// The amount of bytes read by the I/O stage that the processing tasks have not yet consumed
+		std::atomic<size_t> io_bytes_in_flight;
 		// Instead of using the database allocator or the resource manager allocator
 		// That could be used at the same time, create a Malloc based allocator and make
 		// Our allocations from here
@@ -154,6 +175,8 @@ namespace ECSEngine {
 	struct PreloadTaskData {
 		AssetLoadingControlBlock* control_block;
 		unsigned int write_index;
+		// The data read by the I/O stage, if it is used. It is empty if the read failed
+		Stream<void> io_data;
 	};
 
 	struct ProcessTaskData {
@@ -193,6 +216,28 @@ namespace ECSEngine {
 		CallCallback(control_block, control_block->load_info.process_on_success, thread_id, handle, metadata, asset_type);
 	}
 
+	// Marks the data read by the I/O stage for this task as consumed, such that the I/O stage can continue reading.
+	// If the data was handed to another owner, deallocate must be set to false
+	static void ReleaseIOData(PreloadTaskData* data, bool deallocate = true) {
+		if (data->io_data.size > 0) {
+			if (deallocate) {
+				Deallocate(data->control_block->GetIOAllocator(), data->io_data.buffer);
+			}
+			data->control_block->io_bytes_in_flight.fetch_sub(data->io_data.size, ECS_RELAXED);
+			data->io_data = { nullptr, 0 };
+		}
+	}
+
+	// The file data can come either from the I/O stage or from a read made by the preload task itself
+	static void DeallocatePreloadFileData(PreloadTaskData* data, AllocatorPolymorphic thread_allocator, void* buffer) {
+		if (data->io_data.size > 0) {
+			ReleaseIOData(data);
+		}
+		else {
+			Deallocate(thread_allocator, buffer);
+		}
+	}
+
 #pragma region Processing Tasks
 
 	// ------------------------------------------------------------------------------------------------------------
@@ -254,13 +299,43 @@ namespace ECSEngine {
 			data->control_block->database->GetReferenceCountStandalone(handle, ECS_ASSET_TEXTURE)
 		};
 
-		bool success = CreateTextureFromMetadataEx(
-			data->control_block->resource_manager, 
-			metadata, 
-			textures->texture,
-			data->control_block->gpu_lock_ptr,
-			&ex_data
-		);
+		const AssetProcessingCache* processing_cache = data->control_block->load_info.processing_cache;
+		bool success = false;
+		if (textures->cache_entries.size > 0 && textures->cache_entries[data->subhandle_index].mips.size > 0) {
+			const TextureCacheEntry* cache_entry = &textures->cache_entries[data->subhandle_index];
+			success = CreateTextureFromMetadataEx(
+				data->control_block->resource_manager,
+				metadata,
+				cache_entry->texture,
+				data->control_block->gpu_lock_ptr,
+				&ex_data,
+				cache_entry->mips
+			);
+		}
+		else {
+			// Only the compressed textures have a CPU side processing that is worth caching
+			bool write_cache_entry = processing_cache != nullptr && textures->cache_entries.size > 0 && metadata->compression_type != ECS_TEXTURE_COMPRESSION_EX_NONE;
+			Stream<Stream<void>> processed_mips = {};
+			success = CreateTextureFromMetadataEx(
+				data->control_block->resource_manager, 
+				metadata, 
+				textures->texture,
+				data->control_block->gpu_lock_ptr,
+				&ex_data,
+				{},
+				write_cache_entry ? &processed_mips : nullptr
+			);
+			if (processed_mips.size > 0) {
+				WriteAssetProcessingCacheTexture(
+					processing_cache, 
+					AssetProcessingCacheTextureKey(textures->content_hash, metadata), 
+					textures->texture, 
+					processed_mips
+				);
+				// The processed mips are allocated with the default texture descriptor allocator
+				Deallocate(ECS_MALLOC_ALLOCATOR, processed_mips.buffer);
+			}
+		}
 		if (!success) {
 			LoadAssetFailure failure;
 			failure.processing_failure = true;
@@ -366,8 +441,35 @@ namespace ECSEngine {
 		Stream<wchar_t> file_path = MountPathOnlyRel(metadata->file, data->control_block->load_info.mount_point, absolute_path);
 
 		AllocatorPolymorphic allocator = data->control_block->GetThreadAllocator(thread_index);
+
+		auto spawn_processing = [&]() {
+			// Call the callback before that
+			CallOnPreloadCallback(data->control_block, thread_index, mesh_handle, metadata, ECS_ASSET_MESH);
+
+			// Generate the processing tasks
+			SpawnProcessingTasks(data->control_block, world->task_manager, ProcessMesh, mesh_block_pointer->different_handles.size, data->write_index, thread_index);
+		};
+
+		// The processing cache can be used only when the file bytes are available, which happens for the I/O stage.
+		// Only .glb files are considered, since .gltf files can reference external buffers that are not part of the content hash
+		const AssetProcessingCache* processing_cache = data->control_block->load_info.processing_cache;
+		bool use_processing_cache = processing_cache != nullptr && data->io_data.size > 0 && PathExtensionBoth(file_path) == L".glb";
+		AssetProcessingCacheKey cache_key;
+		if (use_processing_cache) {
+			cache_key = AssetProcessingCacheMeshKey(AssetProcessingCacheContentHash(data->io_data), metadata);
+			if (ReadAssetProcessingCacheMesh(processing_cache, cache_key, &mesh_block_pointer->coalesced_mesh, &mesh_block_pointer->submeshes, allocator)) {
+				ReleaseIOData(data);
+				mesh_block_pointer->time_stamp = OS::GetFileLastWrite(file_path);
+				spawn_processing();
+				data->control_block->load_info.finish_semaphore->ExitEx();
+				return;
+			}
+		}
+
 		GLTFData gltf_data = functor(file_path, allocator, data->control_block);
 		if (gltf_data.data == nullptr) {
+			ReleaseIOData(data);
+
 			LoadAssetFailure failure;
 			failure.asset_type = ECS_ASSET_MESH;
 			failure.dependency_failure = false;
@@ -388,16 +490,23 @@ namespace ECSEngine {
 		LoadCoalescedMeshFromGLTFOptions load_options;
 		load_options.allocate_submesh_name = true;
 		load_options.temporary_buffer_allocator = allocator;
+		// Large meshes have many primitives, let the other threads help with them
+		load_options.task_manager = world->task_manager;
+		MeshOptimizationOptions optimization_options = MeshMetadataOptimizationOptions(metadata);
+		if (optimization_options.IsEnabled()) {
+			load_options.optimization = &optimization_options;
+		}
 		bool success = LoadCoalescedMeshFromGLTF(gltf_data, &mesh_block_pointer->coalesced_mesh, submeshes, metadata->invert_z_axis, &load_options);
 		FreeGLTFFile(gltf_data);
+		// The binary chunk of .glb files references the file data, it can be released only now
+		ReleaseIOData(data);
 		if (success) {
 			mesh_block_pointer->submeshes = { submeshes, gltf_data.mesh_count };
-
-			// Call the callback before that
-			CallOnPreloadCallback(data->control_block, thread_index, mesh_handle, metadata, ECS_ASSET_MESH);
-
-			// Generate the processing tasks
-			SpawnProcessingTasks(data->control_block, world->task_manager, ProcessMesh, mesh_block_pointer->different_handles.size, data->write_index, thread_index);
+			if (use_processing_cache) {
+				// It must be written before the processing tasks are spawned, since these can modify the mesh in place
+				WriteAssetProcessingCacheMesh(processing_cache, cache_key, &mesh_block_pointer->coalesced_mesh, mesh_block_pointer->submeshes);
+			}
+			spawn_processing();
 		}
 		else {
 			Deallocate(allocator, submeshes);
@@ -444,11 +553,36 @@ namespace ECSEngine {
 			return;
 		}
 
-		size_t decode_flags = metadata->sRGB ? ECS_DECODE_TEXTURE_FORCE_SRGB : ECS_DECODE_TEXTURE_NO_SRGB;
-		DecodedTexture decoded_texture = DecodeTexture(file_data, file_path, allocator, decode_flags);
-		Deallocate(allocator, file_data.buffer);
+		// The cache entries are read here, while the file data is still available for the content hash.
+		// When all the handles have their processed output cached, the decoding can be skipped entirely
+		const AssetProcessingCache* processing_cache = data->control_block->load_info.processing_cache;
+		bool skip_decode = false;
+		texture_block_pointer->cache_entries = { nullptr, 0 };
+		if (processing_cache != nullptr) {
+			texture_block_pointer->content_hash = AssetProcessingCacheContentHash(file_data);
+			texture_block_pointer->cache_entries.Initialize(allocator, texture_block_pointer->different_handles.size);
+			size_t hit_count = 0;
+			for (size_t index = 0; index < texture_block_pointer->different_handles.size; index++) {
+				TextureCacheEntry* cache_entry = &texture_block_pointer->cache_entries[index];
+				cache_entry->mips = { nullptr, 0 };
+
+				const TextureMetadata* handle_metadata = data->control_block->database->GetTexture(texture_block_pointer->different_handles[index]);
+				if (handle_metadata->compression_type != ECS_TEXTURE_COMPRESSION_EX_NONE) {
+					AssetProcessingCacheKey cache_key = AssetProcessingCacheTextureKey(texture_block_pointer->content_hash, handle_metadata);
+					hit_count += ReadAssetProcessingCacheTexture(processing_cache, cache_key, &cache_entry->texture, &cache_entry->mips, allocator);
+				}
+			}
+			skip_decode = hit_count == texture_block_pointer->different_handles.size;
+		}
 
-		if (decoded_texture.data.size == 0) {
+		DecodedTexture decoded_texture = { { nullptr, 0 }, 0, 0, ECS_GRAPHICS_FORMAT_UNKNOWN };
+		if (!skip_decode) {
+			size_t decode_flags = metadata->sRGB ? ECS_DECODE_TEXTURE_FORCE_SRGB : ECS_DECODE_TEXTURE_NO_SRGB;
+			decoded_texture = DecodeTexture(file_data, file_path, allocator, decode_flags);
+		}
+		DeallocatePreloadFileData(data, allocator, file_data.buffer);
+
+		if (!skip_decode && decoded_texture.data.size == 0) {
 			LoadAssetFailure failure;
 			failure.asset_type = ECS_ASSET_TEXTURE;
 			failure.dependency_failure = false;
@@ -506,6 +640,8 @@ namespace ECSEngine {
 
 		shader_block_pointer->source_code = file_data;
 		shader_block_pointer->time_stamp = OS::GetFileLastWrite(file_path);
+		// The source code is kept alive until the final task frees the I/O allocator
+		ReleaseIOData(data, false);
 
 		// Call the callback
 		CallOnPreloadCallback(data->control_block, thread_index, shader_handle, metadata, ECS_ASSET_SHADER);
@@ -547,6 +683,8 @@ namespace ECSEngine {
 
 		misc_block_pointer->data = file_data;
 		misc_block_pointer->time_stamp = OS::GetFileLastWrite(file_path);
+		// The ownership of the data is passed to the resource manager
+		ReleaseIOData(data, false);
 
 		ResizableStream<void> misc_data_resizable;
 		misc_data_resizable.allocator = ECS_MALLOC_ALLOCATOR;
@@ -708,6 +846,55 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------------
 
+#pragma endregion
+
+#pragma region IO Stage Preload
+
+	// These tasks receive the file data from the I/O stage, it doesn't matter if it comes from a loose or a packed file
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static ECS_THREAD_TASK(PreloadIOMeshTask) {
+		PreloadMeshHelper(world, _data, thread_id, [_data](Stream<wchar_t> file_path, AllocatorPolymorphic allocator, const auto* control_block) {
+			Stream<void> io_data = ((PreloadTaskData*)_data)->io_data;
+			if (io_data.size == 0) {
+				GLTFData gltf_data;
+				gltf_data.data = nullptr;
+				gltf_data.mesh_count = 0;
+				return gltf_data;
+			}
+			// The path is needed to resolve the external buffers that .gltf files can reference
+			return LoadGLTFFileFromMemory(io_data, file_path, allocator);
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static ECS_THREAD_TASK(PreloadIOTextureTask) {
+		PreloadTextureHelper(world, _data, thread_id, [_data](Stream<wchar_t> file_path, AllocatorPolymorphic allocator, const auto* control_block) {
+			return ((PreloadTaskData*)_data)->io_data;
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static ECS_THREAD_TASK(PreloadIOShaderTask) {
+		PreloadShaderHelper(world, _data, thread_id, [_data](Stream<wchar_t> file_path, AllocatorPolymorphic allocator, const auto* control_block) {
+			Stream<void> io_data = ((PreloadTaskData*)_data)->io_data;
+			return Stream<char>(io_data.buffer, io_data.size);
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static ECS_THREAD_TASK(PreloadIOMiscTask) {
+		PreloadMiscHelper(world, _data, thread_id, [_data](Stream<wchar_t> file_path, const auto* control_block) {
+			return ((PreloadTaskData*)_data)->io_data;
+		});
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
 #pragma endregion
 
 	// ------------------------------------------------------------------------------------------------------------
@@ -815,6 +1002,9 @@ namespace ECSEngine {
 		for (unsigned int index = 0; index < thread_count; index++) {
 			data->global_managers[index].Free();
 		}
+		if (data->load_info.use_io_stage) {
+			data->io_allocator.Free();
+		}
 
 		// We need to take these out from the data, since the data was allocated from
 		// The persistent allocator with Malloc, it will result in a crash since it
@@ -1034,6 +1224,11 @@ namespace ECSEngine {
 			CreateGlobalMemoryManager(&control_block->global_managers[index], ALLOCATOR_SIZE, ECS_KB * 8, ALLOCATOR_BACKUP);
 		}
 
+		if (load_info->use_io_stage) {
+			CreateGlobalMemoryManager(&control_block->io_allocator, ALLOCATOR_SIZE, ECS_KB * 8, ALLOCATOR_BACKUP);
+		}
+		control_block->io_bytes_in_flight.store(0, ECS_RELAXED);
+
 		return control_block;
 	}
 
@@ -1052,7 +1247,338 @@ namespace ECSEngine {
 		PreloadTaskFunctions functions;
 	};
 
+#pragma region IO Stage
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	struct IORequest {
+		// The priority is in the upper byte, followed by the packed file index and the offset inside it
+		size_t sort_key;
+		ECS_ASSET_TYPE type;
+		unsigned int write_index;
+		// For packed files, these describe the range inside the packed file
+		unsigned int packed_index;
+		unsigned int offset;
+		unsigned int size;
+	};
+
+	// The order in which the reads are issued. The shaders come first such that the final task
+	// most likely finds them loaded when it creates the materials
+	static ECS_ASSET_TYPE IO_STAGE_PRIORITY[] = {
+		ECS_ASSET_SHADER,
+		ECS_ASSET_TEXTURE,
+		ECS_ASSET_MESH,
+		ECS_ASSET_MISC
+	};
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static unsigned int IOStagePreloadCount(const AssetLoadingControlBlock* control_block, ECS_ASSET_TYPE type) {
+		switch (type) {
+		case ECS_ASSET_MESH:
+			return control_block->meshes.size;
+		case ECS_ASSET_TEXTURE:
+			return control_block->textures.size;
+		case ECS_ASSET_SHADER:
+			return control_block->shaders.size;
+		case ECS_ASSET_MISC:
+			return control_block->miscs.size;
+		default:
+			ECS_ASSERT(false, "Invalid asset type for the asset loading I/O stage");
+		}
+		return 0;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static Stream<wchar_t> IOStagePreloadFile(
+		const AssetLoadingControlBlock* control_block, 
+		ECS_ASSET_TYPE type, 
+		unsigned int write_index, 
+		CapacityStream<wchar_t> storage
+	) {
+		unsigned int handle = -1;
+		switch (type) {
+		case ECS_ASSET_MESH:
+			handle = control_block->meshes[write_index].different_handles[0];
+			break;
+		case ECS_ASSET_TEXTURE:
+			handle = control_block->textures[write_index].different_handles[0];
+			break;
+		case ECS_ASSET_SHADER:
+			handle = control_block->shaders[write_index].different_handles[0];
+			break;
+		case ECS_ASSET_MISC:
+			handle = control_block->miscs[write_index].different_handles[0];
+			break;
+		default:
+			ECS_ASSERT(false, "Invalid asset type for the asset loading I/O stage");
+		}
+
+		Stream<wchar_t> file = GetAssetFile(control_block->database->GetAssetConst(handle, type), type);
+		return MountPathOnlyRel(file, control_block->load_info.mount_point, storage);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// The misc data is handed to the resource manager, which expects it to be allocated with Malloc
+	static AllocatorPolymorphic IOStageRequestAllocator(AssetLoadingControlBlock* control_block, ECS_ASSET_TYPE type) {
+		return type == ECS_ASSET_MISC ? ECS_MALLOC_ALLOCATOR : control_block->GetIOAllocator();
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	static void IOStageSpawnPreload(
+		AssetLoadingControlBlock* control_block, 
+		TaskManager* task_manager, 
+		ECS_ASSET_TYPE type, 
+		unsigned int write_index, 
+		Stream<void> io_data
+	) {
+		ThreadFunction thread_function = nullptr;
+		switch (type) {
+		case ECS_ASSET_MESH:
+			thread_function = PreloadIOMeshTask;
+			break;
+		case ECS_ASSET_TEXTURE:
+			thread_function = PreloadIOTextureTask;
+			break;
+		case ECS_ASSET_SHADER:
+			thread_function = PreloadIOShaderTask;
+			break;
+		case ECS_ASSET_MISC:
+			thread_function = PreloadIOMiscTask;
+			break;
+		default:
+			ECS_ASSERT(false, "Invalid asset type for the asset loading I/O stage");
+		}
+
+		PreloadTaskData preload_data;
+		preload_data.control_block = control_block;
+		preload_data.write_index = write_index;
+		preload_data.io_data = io_data;
+		// This must be incremented before the task is visible, since the task decrements it
+		if (io_data.size > 0) {
+			control_block->io_bytes_in_flight.fetch_add(io_data.size, ECS_RELAXED);
+		}
+		task_manager->AddDynamicTaskAndWake({ thread_function, &preload_data, sizeof(preload_data) });
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// While the data that was not yet consumed is over the limit, help with the tasks from this thread's queue
+	static void IOStageWaitForBudget(AssetLoadingControlBlock* control_block, TaskManager* task_manager, unsigned int thread_id) {
+		ThreadQueue* thread_queue = task_manager->GetThreadQueue(thread_id);
+		while (control_block->io_bytes_in_flight.load(ECS_RELAXED) > control_block->load_info.io_max_bytes_in_flight) {
+			DynamicThreadTask thread_queue_task;
+			if (thread_queue->Pop(thread_queue_task)) {
+				task_manager->ExecuteDynamicTask(thread_queue_task.task, thread_id, thread_id);
+			}
+			else {
+				GiveSliceToProcessorThread();
+			}
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// Returns the range from the packed file in the x and y components and the packed file index in the z component.
+	// Returns false if the file is not found inside the packed files or if the range is corrupted
+	static bool IOStagePackedRange(
+		const AssetLoadingControlBlock* control_block, 
+		Stream<wchar_t> file_path, 
+		Stream<size_t> packed_file_sizes, 
+		uint3& range
+	) {
+		unsigned int packed_index = 0;
+		const PackedFile* packed_file = control_block->extra.packed_file;
+		if (control_block->extra.dimension == CONTROL_BLOCK_MULTI_PACKED) {
+			if (!control_block->extra.multi_packed_file->lookup_table.TryGetValue(file_path, packed_index) 
+				|| packed_index >= control_block->extra.multi_packed_inputs.size) {
+				return false;
+			}
+			packed_file = &control_block->extra.multi_packed_inputs[packed_index];
+		}
+
+		uint2 file_offsets;
+		if (!packed_file->lookup_table.TryGetValue(file_path, file_offsets)) {
+			return false;
+		}
+		// Use the same validation as UnpackFile
+		if ((size_t)file_offsets.x + (size_t)file_offsets.y >= packed_file_sizes[packed_index]) {
+			return false;
+		}
+
+		range = { file_offsets.x, file_offsets.y, packed_index };
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	// A single task that performs all the reads from disk for a load. The reads are issued in priority order,
+	// for packed files the ranges are sorted by offset and adjacent ranges are read together, such that the disk
+	// is accessed sequentially. The preload tasks, which do the CPU processing, are spawned as soon as their data is read.
+	// Since a single task reads, the shared packed file handles are not used concurrently.
+	static ECS_THREAD_TASK(IOStageTask) {
+		AssetLoadingControlBlock* control_block = (AssetLoadingControlBlock*)_data;
+		TaskManager* task_manager = world->task_manager;
+
+		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 64, ECS_MB * 16);
+		AllocatorPolymorphic stack_allocator_polymorphic = &stack_allocator;
+
+		size_t total_count = 0;
+		for (size_t index = 0; index < ECS_COUNTOF(IO_STAGE_PRIORITY); index++) {
+			total_count += IOStagePreloadCount(control_block, IO_STAGE_PRIORITY[index]);
+		}
+
+		bool is_packed = control_block->extra.dimension != CONTROL_BLOCK_NONE;
+		Stream<size_t> packed_file_sizes;
+		if (control_block->extra.dimension == CONTROL_BLOCK_PACKED) {
+			packed_file_sizes.Initialize(stack_allocator_polymorphic, 1);
+			packed_file_sizes[0] = GetFileByteSize(control_block->extra.packed_file->file_handle);
+		}
+		else if (control_block->extra.dimension == CONTROL_BLOCK_MULTI_PACKED) {
+			packed_file_sizes.Initialize(stack_allocator_polymorphic, control_block->extra.multi_packed_inputs.size);
+			for (size_t index = 0; index < packed_file_sizes.size; index++) {
+				packed_file_sizes[index] = GetFileByteSize(control_block->extra.multi_packed_inputs[index].file_handle);
+			}
+		}
+
+		// The second half is used as the temporary for the sort
+		IORequest* requests = (IORequest*)Allocate(stack_allocator_polymorphic, sizeof(IORequest) * total_count * 2);
+		size_t request_count = 0;
+		for (size_t priority = 0; priority < ECS_COUNTOF(IO_STAGE_PRIORITY); priority++) {
+			ECS_ASSET_TYPE type = IO_STAGE_PRIORITY[priority];
+			unsigned int type_count = IOStagePreloadCount(control_block, type);
+			for (unsigned int index = 0; index < type_count; index++) {
+				IORequest request;
+				request.type = type;
+				request.write_index = index;
+				request.packed_index = -1;
+				request.offset = 0;
+				request.size = 0;
+				request.sort_key = (priority << 56) | request_count;
+
+				if (is_packed) {
+					ECS_STACK_CAPACITY_STREAM(wchar_t, absolute_path, 512);
+					Stream<wchar_t> file_path = IOStagePreloadFile(control_block, type, index, absolute_path);
+					uint3 range;
+					if (!IOStagePackedRange(control_block, file_path, packed_file_sizes, range)) {
+						// Let the preload task report the failure
+						IOStageSpawnPreload(control_block, task_manager, type, index, { nullptr, 0 });
+						continue;
+					}
+
+					request.offset = range.x;
+					request.size = range.y;
+					request.packed_index = range.z;
+					request.sort_key = (priority << 56) | ((size_t)range.z << 32) | (size_t)range.x;
+				}
+				requests[request_count++] = request;
+			}
+		}
+
+		if (is_packed) {
+			RadixSort64(requests, requests + request_count, request_count, [](const IORequest& request) {
+				return request.sort_key;
+			});
+		}
+
+		size_t coalesce_size = control_block->load_info.io_coalesce_size;
+		void* coalesce_buffer = nullptr;
+
+		size_t request_index = 0;
+		while (request_index < request_count) {
+			IOStageWaitForBudget(control_block, task_manager, thread_id);
+
+			const IORequest* request = &requests[request_index];
+			AllocatorPolymorphic request_allocator = IOStageRequestAllocator(control_block, request->type);
+			if (!is_packed) {
+				ECS_STACK_CAPACITY_STREAM(wchar_t, absolute_path, 512);
+				Stream<wchar_t> file_path = IOStagePreloadFile(control_block, request->type, request->write_index, absolute_path);
+				// The shaders were read in text mode before, keep that behaviour
+				Stream<void> file_data = request->type == ECS_ASSET_SHADER ? ReadWholeFileText(file_path, request_allocator)
+					: ReadWholeFileBinary(file_path, request_allocator);
+				IOStageSpawnPreload(control_block, task_manager, request->type, request->write_index, file_data);
+				request_index++;
+				continue;
+			}
+
+			// Determine the run of adjacent ranges from the same packed file
+			size_t run_end = request_index + 1;
+			size_t run_size = request->size;
+			while (run_end < request_count && requests[run_end].packed_index == request->packed_index
+				&& requests[run_end].offset == requests[run_end - 1].offset + requests[run_end - 1].size
+				&& run_size + requests[run_end].size <= coalesce_size) {
+				run_size += requests[run_end].size;
+				run_end++;
+			}
+
+			ECS_FILE_HANDLE file_handle = control_block->extra.dimension == CONTROL_BLOCK_PACKED ? control_block->extra.packed_file->file_handle
+				: control_block->extra.multi_packed_inputs[request->packed_index].file_handle;
+			bool cursor_success = SetFileCursorBool(file_handle, request->offset, ECS_FILE_SEEK_BEG);
+
+			if (run_end - request_index == 1) {
+				// A single range, read it directly into its final allocation
+				Stream<void> file_data = { nullptr, 0 };
+				if (cursor_success) {
+					file_data.buffer = Allocate(request_allocator, request->size);
+					file_data.size = request->size;
+					if (!ReadFileExact(file_handle, file_data)) {
+						Deallocate(request_allocator, file_data.buffer);
+						file_data = { nullptr, 0 };
+					}
+				}
+				IOStageSpawnPreload(control_block, task_manager, request->type, request->write_index, file_data);
+			}
+			else {
+				if (coalesce_buffer == nullptr) {
+					coalesce_buffer = Malloc(coalesce_size);
+				}
+
+				bool read_success = cursor_success && ReadFileExact(file_handle, { coalesce_buffer, run_size });
+				size_t run_offset = 0;
+				for (size_t index = request_index; index < run_end; index++) {
+					Stream<void> file_data = { nullptr, 0 };
+					if (read_success) {
+						AllocatorPolymorphic current_allocator = IOStageRequestAllocator(control_block, requests[index].type);
+						file_data.buffer = Allocate(current_allocator, requests[index].size);
+						file_data.size = requests[index].size;
+						memcpy(file_data.buffer, OffsetPointer(coalesce_buffer, run_offset), file_data.size);
+					}
+					run_offset += requests[index].size;
+					IOStageSpawnPreload(control_block, task_manager, requests[index].type, requests[index].write_index, file_data);
+				}
+			}
+
+			request_index = run_end;
+		}
+
+		if (coalesce_buffer != nullptr) {
+			Free(coalesce_buffer);
+		}
+
+		// All the preload tasks were distributed, the final task can be launched now such that it doesn't 
+		// drain its thread queue and start waiting before all the tasks have been added
+		task_manager->AddDynamicTaskAndWake({ ProcessFinalTask, control_block, 0 });
+		control_block->load_info.finish_semaphore->ExitEx();
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+#pragma endregion
+
 	static void LaunchPreloadTasks(LaunchPreloadTasksData* task_data) {
+		AssetLoadingControlBlock* control_block = task_data->control_block;
+		if (control_block->load_info.use_io_stage) {
+			// Enter for all the preload tasks that the I/O stage spawns, for the I/O task itself and for the final task,
+			// which is launched by the I/O task after all reads were issued
+			unsigned int preload_count = control_block->shaders.size + control_block->meshes.size + control_block->textures.size + control_block->miscs.size;
+			control_block->load_info.finish_semaphore->Enter(preload_count + 2);
+			task_data->task_manager->AddDynamicTaskAndWake({ IOStageTask, control_block, 0 });
+			return;
+		}
+
 		// It doesn't matter the order of the preloads - except for the shaders
 		// They must be loaded first such that when the process material thread task is executed
 		// the most amount (likely all) shaders are already loaded
@@ -1061,6 +1587,7 @@ namespace ECSEngine {
 				PreloadTaskData data;
 				data.control_block = task_data->control_block;
 				data.write_index = index;
+				data.io_data = { nullptr, 0 };
 
 				task_data->task_manager->AddDynamicTaskAndWake({ thread_function, &data, sizeof(data) });
 			}
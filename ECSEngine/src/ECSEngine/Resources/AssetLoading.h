@@ -20,6 +20,7 @@ namespace ECSEngine {
 	struct AssetDatabase;
 	struct AssetDatabaseReference;
 	struct TaskManager;
+	struct AssetProcessingCache;
 
 	// This is used to report the exact failure for the load
 	// If processing_failure is set to true then the data from disk was read but the processing failed
@@ -54,6 +55,23 @@ namespace ECSEngine {
 
 		SpinLock* gpu_lock = nullptr;
 
+		// When enabled, the reads from disk are made by a dedicated I/O task instead of each preload
+		// task reading its own file while the CPU waits. The reads are issued in priority order (shaders,
+		// textures, meshes and then miscs) and for packed files they are sorted by offset, with adjacent
+		// ranges merged into a single read. The processing tasks are spawned as soon as their data arrives
+		bool use_io_stage = true;
+		// The maximum size of a merged read from a packed file
+		size_t io_coalesce_size = ECS_MB * 8;
+		// The maximum amount of bytes that were read but not yet consumed by the processing tasks.
+		// When this limit is reached, the I/O task helps with the processing until the data is consumed
+		size_t io_max_bytes_in_flight = ECS_MB * 512;
+
+		// When set, the CPU side processing outputs are looked up in this cache, keyed by the content of the
+		// source file and the metadata settings, and stored into it when they are computed. The decoded vertex
+		// streams of .glb meshes are cached (only when the I/O stage is used, since the file bytes are needed
+		// for the key), as well as the generated and compressed mips of the compressed textures
+		const AssetProcessingCache* processing_cache = nullptr;
+
 		// With this mask can specify which actual handles should be loaded
 		// There must be ECS_ASSET_TYPE_COUNT streams
 		//Stream<Stream<unsigned int>> include_assets = { nullptr, 0 };
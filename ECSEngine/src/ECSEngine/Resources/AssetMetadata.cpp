@@ -1492,7 +1492,7 @@ namespace ECSEngine {
 	bool MeshMetadata::CompareOptions(const MeshMetadata* other) const
 	{
 		return scale_factor == other->scale_factor && invert_z_axis == other->invert_z_axis && optimize_level == other->optimize_level
-			&& origin_to_object_center == other->origin_to_object_center;
+			&& origin_to_object_center == other->origin_to_object_center && simplification_ratio == other->simplification_ratio;
 	}
 
 	// ------------------------------------------------------------------------------------------------------
@@ -1503,6 +1503,7 @@ namespace ECSEngine {
 		invert_z_axis = other->invert_z_axis;
 		optimize_level = other->optimize_level;
 		origin_to_object_center = other->origin_to_object_center;
+		simplification_ratio = other->simplification_ratio;
 	}
 
 	// ------------------------------------------------------------------------------------------------------
@@ -1526,6 +1527,7 @@ namespace ECSEngine {
 		file = _file;
 		optimize_level = ECS_ASSET_MESH_OPTIMIZE_NONE;
 		origin_to_object_center = true;
+		simplification_ratio = 0.0f;
 
 		mesh_pointer = nullptr;
 	}
@@ -1551,7 +1553,7 @@ namespace ECSEngine {
 	bool MeshMetadata::SameTarget(const MeshMetadata* other) const
 	{
 		return file == other->file && scale_factor == other->scale_factor && invert_z_axis == other->invert_z_axis
-			&& optimize_level == other->optimize_level;
+			&& optimize_level == other->optimize_level && simplification_ratio == other->simplification_ratio;
 	}
 
 	// ------------------------------------------------------------------------------------------------------
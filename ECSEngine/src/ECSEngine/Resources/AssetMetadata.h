@@ -203,6 +203,8 @@ namespace ECSEngine {
 		bool invert_z_axis;
 		bool origin_to_object_center;
 		ECS_ASSET_MESH_OPTIMIZE_LEVEL optimize_level;
+		// The fraction of triangles removed from each submesh when importing. 0.0f keeps the full detail
+		float simplification_ratio;
 
 		[[ECS_POINTER_AS_ADDRESS]]
 		CoalescedMesh* mesh_pointer;
@@ -19,6 +19,7 @@ namespace ECSEngine {
 		identifier.Add(&metadata->invert_z_axis);
 		identifier.Add(&metadata->optimize_level);
 		identifier.Add(&metadata->origin_to_object_center);
+		identifier.Add(&metadata->simplification_ratio);
 
 		// Add the name as well in order to differentiate between distinct settings with the same options
 		identifier.Add(metadata->name);
@@ -26,6 +27,22 @@ namespace ECSEngine {
 
 	// ------------------------------------------------------------------------------------------------------
 
+	MeshOptimizationOptions MeshMetadataOptimizationOptions(const MeshMetadata* metadata)
+	{
+		MeshOptimizationOptions options;
+		if (metadata->optimize_level >= ECS_ASSET_MESH_OPTIMIZE_BASIC) {
+			options.deduplicate_vertices = true;
+			options.optimize_vertex_cache = true;
+		}
+		if (metadata->optimize_level >= ECS_ASSET_MESH_OPTIMIZE_ADVANCED) {
+			options.optimize_vertex_fetch = true;
+		}
+		options.simplification_ratio = metadata->simplification_ratio;
+		return options;
+	}
+
+	// ------------------------------------------------------------------------------------------------------
+
 	void TextureMetadataIdentifier(const TextureMetadata* metadata, CapacityStream<void>& identifier)
 	{
 		identifier.Add(&metadata->sRGB);
@@ -59,6 +76,10 @@ namespace ECSEngine {
 		if (metadata->origin_to_object_center) {
 			load_descriptor.load_flags |= ECS_RESOURCE_MANAGER_COALESCED_MESH_ORIGIN_TO_CENTER;
 		}
+		MeshOptimizationOptions optimization_options = MeshMetadataOptimizationOptions(metadata);
+		if (optimization_options.IsEnabled()) {
+			load_descriptor.mesh_optimization = &optimization_options;
+		}
 
 		ECS_STACK_VOID_STREAM(suffix, 512);
 		MeshMetadataIdentifier(metadata, suffix);
@@ -160,19 +181,25 @@ namespace ECSEngine {
 		TextureMetadata* metadata,
 		DecodedTexture texture,
 		SpinLock* gpu_lock,
-		CreateAssetFromMetadataExData* ex_data
+		CreateAssetFromMetadataExData* ex_data,
+		Stream<Stream<void>> processed_mips,
+		Stream<Stream<void>>* processed_mips_output
 	)
 	{
 		return CreateTextureHelper(resource_manager, metadata, ex_data->mount_point, [&](Stream<wchar_t> file_path, const ResourceManagerTextureDesc* texture_descriptor, ResourceManagerLoadDesc& load_desc) {
 			size_t time_stamp = GetTimeStamp(ex_data->time_stamp, file_path);
 			load_desc.gpu_lock = gpu_lock;
 
+			ResourceManagerTextureDesc processed_descriptor = *texture_descriptor;
+			processed_descriptor.processed_mips = processed_mips;
+			processed_descriptor.processed_mips_output = processed_mips_output;
+
 			ResourceManagerExDesc ex_desc;
 			ex_desc.filename = file_path;
 			ex_desc.time_stamp = time_stamp;
 			ex_desc.multithreaded = ex_data->multithreaded;
 			ex_desc.reference_count = ex_data->reference_count;
-			return resource_manager->LoadTextureImplementationEx(texture, texture_descriptor, load_desc, &ex_desc);
+			return resource_manager->LoadTextureImplementationEx(texture, &processed_descriptor, load_desc, &ex_desc);
 		});
 	}
 
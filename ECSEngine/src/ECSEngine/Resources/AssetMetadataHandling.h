@@ -1,6 +1,7 @@
 #pragma once
 #include "AssetMetadata.h"
 #include "../Rendering/TextureOperations.h"
+#include "../Rendering/MeshOptimization.h"
 #include "../Utilities/StackScope.h"
 
 namespace ECSEngine {
@@ -56,6 +57,10 @@ namespace ECSEngine {
 	// The combination of settings that form an identifier
 	ECSENGINE_API void MeshMetadataIdentifier(const MeshMetadata* metadata, CapacityStream<void>& identifier);
 
+	// The basic level deduplicates the vertices and reorders the triangles for the vertex cache,
+	// the advanced level reorders the vertices for the fetch as well
+	ECSENGINE_API MeshOptimizationOptions MeshMetadataOptimizationOptions(const MeshMetadata* metadata);
+
 	// SINGLE THREADED
 	// Returns true if it managed to create the asset according to the metadata, else false
 	// It does not modify the underlying ResourceView if it fails
@@ -68,12 +73,16 @@ namespace ECSEngine {
 	// A more detailed version. Useful for multithreaded loading
 	// If the time stamp is 0, then it will get it from the OS
 	// It does not modify the underlying ResourceView if it fails
+	// The processed mips and the processed mips output are forwarded to the ResourceManagerTextureDesc,
+	// they can be used to skip or to retrieve the CPU side processing of compressed textures
 	ECSENGINE_API bool CreateTextureFromMetadataEx(
 		ResourceManager* resource_manager,
 		TextureMetadata* metadata,
 		DecodedTexture texture,
 		SpinLock* gpu_lock = nullptr,
-		CreateAssetFromMetadataExData* ex_data = {}
+		CreateAssetFromMetadataExData* ex_data = {},
+		Stream<Stream<void>> processed_mips = {},
+		Stream<Stream<void>>* processed_mips_output = nullptr
 	);
 	
 	ECSENGINE_API void TextureMetadataIdentifier(const TextureMetadata* metadata, CapacityStream<void>& identifier);
@@ -0,0 +1,442 @@
+#include "ecspch.h"
+#include "AssetProcessingCache.h"
+#include "../Containers/Hashing.h"
+#include "../GLTF/GLTFLoader.h"
+#include "../Rendering/RenderingStructures.h"
+#include "../Allocators/ResizableLinearAllocator.h"
+#include "../Utilities/File.h"
+#include "../Utilities/StringUtilities.h"
+#include "../OS/Thread.h"
+
+#define ENTRY_MAGIC 0x45435041
+#define ENTRY_EXTENSION L".cache"
+#define TEMPORARY_EXTENSION L".tmp"
+
+namespace ECSEngine {
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	struct EntryHeader {
+		unsigned int magic;
+		unsigned int version;
+		ECS_ASSET_TYPE type;
+		size_t content_hash;
+		size_t settings_hash;
+		size_t payload_size;
+	};
+
+	// The vertex buffers and the indices are written first, since they all have a size multiple of 4,
+	// and the names are written at the end such that the buffers are aligned when read back
+	enum MESH_ENTRY_BUFFER : unsigned char {
+		MESH_ENTRY_POSITIONS,
+		MESH_ENTRY_NORMALS,
+		MESH_ENTRY_UVS,
+		MESH_ENTRY_COLORS,
+		MESH_ENTRY_SKIN_WEIGHTS,
+		MESH_ENTRY_SKIN_INFLUENCES,
+		MESH_ENTRY_INDICES,
+		MESH_ENTRY_BUFFER_COUNT
+	};
+
+	struct MeshEntryHeader {
+		unsigned int buffer_counts[MESH_ENTRY_BUFFER_COUNT];
+		unsigned int submesh_count;
+		unsigned int name_size;
+	};
+
+	struct MeshEntrySubmesh {
+		unsigned int index_buffer_offset;
+		unsigned int vertex_buffer_offset;
+		unsigned int index_count;
+		unsigned int vertex_count;
+		AABBScalar bounds;
+		unsigned int name_size;
+	};
+
+	struct TextureEntryHeader {
+		ECS_GRAPHICS_FORMAT format;
+		unsigned int width;
+		unsigned int height;
+		unsigned int mip_count;
+	};
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	size_t AssetProcessingCacheContentHash(Stream<void> file_data)
+	{
+		return Murmur64(file_data);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	AssetProcessingCacheKey AssetProcessingCacheMeshKey(size_t content_hash, const MeshMetadata* metadata)
+	{
+		// The optimization is done in the preload stage as well, it changes the cached streams
+		unsigned char settings[2 + sizeof(float)] = { (unsigned char)metadata->invert_z_axis, (unsigned char)metadata->optimize_level };
+		memcpy(settings + 2, &metadata->simplification_ratio, sizeof(float));
+
+		AssetProcessingCacheKey key;
+		key.content_hash = content_hash;
+		key.settings_hash = Murmur64({ settings, sizeof(settings) });
+		key.type = ECS_ASSET_MESH;
+		return key;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	AssetProcessingCacheKey AssetProcessingCacheTextureKey(size_t content_hash, const TextureMetadata* metadata)
+	{
+		unsigned char settings[] = { (unsigned char)metadata->sRGB, (unsigned char)metadata->generate_mip_maps, (unsigned char)metadata->compression_type };
+
+		AssetProcessingCacheKey key;
+		key.content_hash = content_hash;
+		key.settings_hash = Murmur64({ settings, sizeof(settings) });
+		key.type = ECS_ASSET_TEXTURE;
+		return key;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool AssetProcessingCache::Initialize(AllocatorPolymorphic _allocator, Stream<wchar_t> _directory)
+	{
+		allocator = _allocator;
+		directory = StringCopy(allocator, _directory);
+		if (!ExistsFileOrFolder(directory)) {
+			if (!CreateFolder(directory)) {
+				Deallocate();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void AssetProcessingCache::Deallocate()
+	{
+		directory.Deallocate(allocator);
+		directory = { nullptr, 0 };
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool AssetProcessingCache::Clear() const
+	{
+		return DeleteFolderContents(directory);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	void AssetProcessingCache::GetEntryPath(AssetProcessingCacheKey key, CapacityStream<wchar_t>& path) const
+	{
+		path.CopyOther(directory);
+		path.AddAssert(ECS_OS_PATH_SEPARATOR);
+		ConvertIntToChars(path, (int64_t)key.type);
+		path.AddAssert(L'_');
+		ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(path, key.content_hash);
+		path.AddAssert(L'_');
+		ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(path, key.settings_hash);
+		path.AddStreamAssert(ENTRY_EXTENSION);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	Stream<void> AssetProcessingCache::Read(AssetProcessingCacheKey key, AllocatorPolymorphic payload_allocator) const
+	{
+		ECS_STACK_CAPACITY_STREAM(wchar_t, entry_path, 512);
+		GetEntryPath(key, entry_path);
+
+		ECS_FILE_HANDLE file_handle = 0;
+		if (OpenFile(entry_path, &file_handle, ECS_FILE_ACCESS_READ_BINARY_SEQUENTIAL) != ECS_FILE_STATUS_OK) {
+			return {};
+		}
+		ScopedFile scoped_file({ file_handle });
+
+		EntryHeader header;
+		if (!ReadFileExact(file_handle, { &header, sizeof(header) })) {
+			return {};
+		}
+
+		bool is_valid = header.magic == ENTRY_MAGIC && header.version == ECS_ASSET_PROCESSING_CACHE_VERSION && header.type == key.type
+			&& header.content_hash == key.content_hash && header.settings_hash == key.settings_hash && header.payload_size > 0;
+		// A truncated entry can appear if the process was killed while writing, before the rename
+		if (!is_valid || GetFileByteSize(file_handle) != sizeof(header) + header.payload_size) {
+			return {};
+		}
+
+		void* payload = Allocate(payload_allocator, header.payload_size);
+		if (!ReadFileExact(file_handle, { payload, header.payload_size })) {
+			ECSEngine::Deallocate(payload_allocator, payload);
+			return {};
+		}
+		return { payload, header.payload_size };
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool AssetProcessingCache::Write(AssetProcessingCacheKey key, Stream<Stream<void>> payload_chunks) const
+	{
+		ECS_STACK_CAPACITY_STREAM(wchar_t, entry_path, 512);
+		GetEntryPath(key, entry_path);
+
+		// Each thread writes to its own temporary file, the thread IDs are unique across processes as well
+		ECS_STACK_CAPACITY_STREAM(wchar_t, temporary_path, 512);
+		temporary_path.CopyOther(entry_path);
+		temporary_path.AddAssert(L'.');
+		ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(temporary_path, OS::GetCurrentThreadID());
+		temporary_path.AddStreamAssert(TEMPORARY_EXTENSION);
+
+		EntryHeader header;
+		header.magic = ENTRY_MAGIC;
+		header.version = ECS_ASSET_PROCESSING_CACHE_VERSION;
+		header.type = key.type;
+		header.content_hash = key.content_hash;
+		header.settings_hash = key.settings_hash;
+		header.payload_size = 0;
+		for (size_t index = 0; index < payload_chunks.size; index++) {
+			header.payload_size += payload_chunks[index].size;
+		}
+
+		ECS_FILE_HANDLE file_handle = 0;
+		if (FileCreate(temporary_path, &file_handle, ECS_FILE_ACCESS_WRITE_BINARY_TRUNCATE) != ECS_FILE_STATUS_OK) {
+			return false;
+		}
+
+		bool success = WriteFile(file_handle, { &header, sizeof(header) });
+		for (size_t index = 0; index < payload_chunks.size && success; index++) {
+			if (payload_chunks[index].size > 0) {
+				success = WriteFile(file_handle, payload_chunks[index]);
+			}
+		}
+		success &= CloseFile(file_handle);
+
+		if (success) {
+			success = RenameFileAbsolute(temporary_path, entry_path);
+			if (!success) {
+				// Another writer could have published the same entry in the meantime, in which case it's fine
+				RemoveFile(temporary_path);
+				success = ExistsFileOrFolder(entry_path);
+			}
+		}
+		else {
+			RemoveFile(temporary_path);
+		}
+		return success;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool WriteAssetProcessingCacheMesh(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		const GLTFMesh* mesh,
+		Stream<Submesh> submeshes
+	)
+	{
+		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 32, ECS_MB * 8);
+
+		Stream<void> buffers[MESH_ENTRY_BUFFER_COUNT] = {
+			mesh->positions,
+			mesh->normals,
+			mesh->uvs,
+			mesh->colors,
+			mesh->skin_weights,
+			mesh->skin_influences,
+			mesh->indices
+		};
+
+		MeshEntryHeader header;
+		header.buffer_counts[MESH_ENTRY_POSITIONS] = (unsigned int)mesh->positions.size;
+		header.buffer_counts[MESH_ENTRY_NORMALS] = (unsigned int)mesh->normals.size;
+		header.buffer_counts[MESH_ENTRY_UVS] = (unsigned int)mesh->uvs.size;
+		header.buffer_counts[MESH_ENTRY_COLORS] = (unsigned int)mesh->colors.size;
+		header.buffer_counts[MESH_ENTRY_SKIN_WEIGHTS] = (unsigned int)mesh->skin_weights.size;
+		header.buffer_counts[MESH_ENTRY_SKIN_INFLUENCES] = (unsigned int)mesh->skin_influences.size;
+		header.buffer_counts[MESH_ENTRY_INDICES] = (unsigned int)mesh->indices.size;
+		header.submesh_count = (unsigned int)submeshes.size;
+		header.name_size = (unsigned int)mesh->name.size;
+
+		Stream<MeshEntrySubmesh> entry_submeshes;
+		entry_submeshes.Initialize(&stack_allocator, submeshes.size);
+		for (size_t index = 0; index < submeshes.size; index++) {
+			entry_submeshes[index].index_buffer_offset = submeshes[index].index_buffer_offset;
+			entry_submeshes[index].vertex_buffer_offset = submeshes[index].vertex_buffer_offset;
+			entry_submeshes[index].index_count = submeshes[index].index_count;
+			entry_submeshes[index].vertex_count = submeshes[index].vertex_count;
+			entry_submeshes[index].bounds = submeshes[index].bounds;
+			entry_submeshes[index].name_size = (unsigned int)submeshes[index].name.size;
+		}
+
+		ResizableStream<Stream<void>> chunks(&stack_allocator, MESH_ENTRY_BUFFER_COUNT + submeshes.size + 3);
+		chunks.Add({ &header, sizeof(header) });
+		chunks.Add(entry_submeshes);
+		for (size_t index = 0; index < MESH_ENTRY_BUFFER_COUNT; index++) {
+			chunks.Add(buffers[index]);
+		}
+		chunks.Add(mesh->name);
+		for (size_t index = 0; index < submeshes.size; index++) {
+			chunks.Add(submeshes[index].name);
+		}
+
+		return cache->Write(key, chunks.ToStream());
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool ReadAssetProcessingCacheMesh(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		GLTFMesh* mesh,
+		Stream<Submesh>* submeshes,
+		AllocatorPolymorphic allocator
+	)
+	{
+		Stream<void> payload = cache->Read(key, allocator);
+		if (payload.size == 0) {
+			return false;
+		}
+
+		// Validate all the sizes before referencing any of the data
+		auto fail = [&]() {
+			Deallocate(allocator, payload.buffer);
+			return false;
+		};
+
+		if (payload.size < sizeof(MeshEntryHeader)) {
+			return fail();
+		}
+		const MeshEntryHeader* header = (const MeshEntryHeader*)payload.buffer;
+		size_t buffer_element_sizes[MESH_ENTRY_BUFFER_COUNT] = {
+			sizeof(float3),
+			sizeof(float3),
+			sizeof(float2),
+			sizeof(Color),
+			sizeof(float4),
+			sizeof(uint4),
+			sizeof(unsigned int)
+		};
+
+		size_t expected_size = sizeof(MeshEntryHeader) + sizeof(MeshEntrySubmesh) * (size_t)header->submesh_count + header->name_size;
+		if (expected_size > payload.size) {
+			return fail();
+		}
+		const MeshEntrySubmesh* entry_submeshes = (const MeshEntrySubmesh*)OffsetPointer(payload.buffer, sizeof(MeshEntryHeader));
+		for (size_t index = 0; index < MESH_ENTRY_BUFFER_COUNT; index++) {
+			expected_size += buffer_element_sizes[index] * (size_t)header->buffer_counts[index];
+		}
+		for (unsigned int index = 0; index < header->submesh_count; index++) {
+			expected_size += entry_submeshes[index].name_size;
+		}
+		if (expected_size != payload.size) {
+			return fail();
+		}
+
+		uintptr_t ptr = (uintptr_t)(entry_submeshes + header->submesh_count);
+		auto get_buffer = [&](MESH_ENTRY_BUFFER buffer) {
+			void* buffer_pointer = (void*)ptr;
+			ptr += buffer_element_sizes[buffer] * (size_t)header->buffer_counts[buffer];
+			return buffer_pointer;
+		};
+
+		mesh->positions = { get_buffer(MESH_ENTRY_POSITIONS), header->buffer_counts[MESH_ENTRY_POSITIONS] };
+		mesh->normals = { get_buffer(MESH_ENTRY_NORMALS), header->buffer_counts[MESH_ENTRY_NORMALS] };
+		mesh->uvs = { get_buffer(MESH_ENTRY_UVS), header->buffer_counts[MESH_ENTRY_UVS] };
+		mesh->colors = { get_buffer(MESH_ENTRY_COLORS), header->buffer_counts[MESH_ENTRY_COLORS] };
+		mesh->skin_weights = { get_buffer(MESH_ENTRY_SKIN_WEIGHTS), header->buffer_counts[MESH_ENTRY_SKIN_WEIGHTS] };
+		mesh->skin_influences = { get_buffer(MESH_ENTRY_SKIN_INFLUENCES), header->buffer_counts[MESH_ENTRY_SKIN_INFLUENCES] };
+		mesh->indices = { get_buffer(MESH_ENTRY_INDICES), header->buffer_counts[MESH_ENTRY_INDICES] };
+		mesh->name = { (char*)ptr, header->name_size };
+		ptr += header->name_size;
+
+		submeshes->Initialize(allocator, header->submesh_count);
+		for (unsigned int index = 0; index < header->submesh_count; index++) {
+			Submesh* submesh = &submeshes->buffer[index];
+			submesh->index_buffer_offset = entry_submeshes[index].index_buffer_offset;
+			submesh->vertex_buffer_offset = entry_submeshes[index].vertex_buffer_offset;
+			submesh->index_count = entry_submeshes[index].index_count;
+			submesh->vertex_count = entry_submeshes[index].vertex_count;
+			submesh->bounds = entry_submeshes[index].bounds;
+			submesh->name = { (char*)ptr, entry_submeshes[index].name_size };
+			ptr += entry_submeshes[index].name_size;
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool WriteAssetProcessingCacheTexture(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		DecodedTexture texture,
+		Stream<Stream<void>> mips
+	)
+	{
+		ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 4, ECS_MB);
+
+		TextureEntryHeader header;
+		header.format = texture.format;
+		header.width = texture.width;
+		header.height = texture.height;
+		header.mip_count = (unsigned int)mips.size;
+
+		Stream<size_t> mip_sizes;
+		mip_sizes.Initialize(&stack_allocator, mips.size);
+		for (size_t index = 0; index < mips.size; index++) {
+			mip_sizes[index] = mips[index].size;
+		}
+
+		ResizableStream<Stream<void>> chunks(&stack_allocator, mips.size + 2);
+		chunks.Add({ &header, sizeof(header) });
+		chunks.Add(mip_sizes);
+		chunks.AddStream(mips);
+		return cache->Write(key, chunks.ToStream());
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+	bool ReadAssetProcessingCacheTexture(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		DecodedTexture* texture,
+		Stream<Stream<void>>* mips,
+		AllocatorPolymorphic allocator
+	)
+	{
+		Stream<void> payload = cache->Read(key, allocator);
+		if (payload.size == 0) {
+			return false;
+		}
+
+		const TextureEntryHeader* header = (const TextureEntryHeader*)payload.buffer;
+		size_t expected_size = sizeof(TextureEntryHeader);
+		if (payload.size >= expected_size) {
+			expected_size += sizeof(size_t) * (size_t)header->mip_count;
+		}
+		const size_t* mip_sizes = (const size_t*)OffsetPointer(payload.buffer, sizeof(TextureEntryHeader));
+		if (payload.size >= expected_size) {
+			for (unsigned int index = 0; index < header->mip_count; index++) {
+				expected_size += mip_sizes[index];
+			}
+		}
+		if (payload.size != expected_size || header->mip_count == 0) {
+			Deallocate(allocator, payload.buffer);
+			return false;
+		}
+
+		texture->data = payload;
+		texture->format = header->format;
+		texture->width = header->width;
+		texture->height = header->height;
+
+		mips->Initialize(allocator, header->mip_count);
+		uintptr_t ptr = (uintptr_t)(mip_sizes + header->mip_count);
+		for (unsigned int index = 0; index < header->mip_count; index++) {
+			mips->buffer[index] = { (void*)ptr, mip_sizes[index] };
+			ptr += mip_sizes[index];
+		}
+		return true;
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+
+}
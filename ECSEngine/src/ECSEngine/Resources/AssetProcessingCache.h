@@ -0,0 +1,109 @@
+#pragma once
+#include "../Core.h"
+#include "../Containers/Stream.h"
+#include "../Allocators/AllocatorTypes.h"
+#include "../Rendering/TextureOperations.h"
+#include "AssetMetadata.h"
+
+namespace ECSEngine {
+
+	struct GLTFMesh;
+	struct Submesh;
+
+	// Increment this when the layout of the entries or the processing itself changes,
+	// such that the entries written by older versions are ignored
+#define ECS_ASSET_PROCESSING_CACHE_VERSION 0
+
+	// Identifies a processed output. The content hash is made over the bytes of the source file
+	// (not over its path), such that renamed or duplicated files and files shared between projects or
+	// branches map to the same entry. The settings hash contains only the metadata options that influence
+	// the processing that is cached
+	struct AssetProcessingCacheKey {
+		ECS_INLINE bool operator == (const AssetProcessingCacheKey& other) const {
+			return content_hash == other.content_hash && settings_hash == other.settings_hash && type == other.type;
+		}
+
+		size_t content_hash;
+		size_t settings_hash;
+		ECS_ASSET_TYPE type;
+	};
+
+	ECSENGINE_API size_t AssetProcessingCacheContentHash(Stream<void> file_data);
+
+	// Only the options that the preload stage uses are considered, since the rest are applied when the
+	// GPU resources are created
+	ECSENGINE_API AssetProcessingCacheKey AssetProcessingCacheMeshKey(size_t content_hash, const MeshMetadata* metadata);
+
+	// All the options are considered, since the mip generation and the compression are cached
+	ECSENGINE_API AssetProcessingCacheKey AssetProcessingCacheTextureKey(size_t content_hash, const TextureMetadata* metadata);
+
+	// A persistent on disk cache for the CPU side outputs of the asset processing. Each entry is a separate file
+	// inside the directory, named after its key, such that the same directory can be shared between multiple
+	// projects and branches. The entries are written into a temporary file that is renamed at the end, such that
+	// readers from this or other processes never see a partially written entry. All functions can be called
+	// from multiple threads at the same time
+	struct ECSENGINE_API AssetProcessingCache {
+		// The directory is copied and created if it doesn't exist. Returns false if the directory could not be created
+		bool Initialize(AllocatorPolymorphic allocator, Stream<wchar_t> directory);
+
+		void Deallocate();
+
+		// Removes all entries from the directory
+		bool Clear() const;
+
+		void GetEntryPath(AssetProcessingCacheKey key, CapacityStream<wchar_t>& path) const;
+
+		ECS_INLINE bool IsEnabled() const {
+			return directory.size > 0;
+		}
+
+		// Returns the payload of the entry allocated from the given allocator, or { nullptr, 0 } if there is no entry
+		// for this key or if the entry is not valid (it is truncated or it was written by a different version)
+		Stream<void> Read(AssetProcessingCacheKey key, AllocatorPolymorphic allocator) const;
+
+		// The chunks are written one after the other and form the payload. Returns true if it succeeded.
+		// If another thread or process writes the same entry at the same time, only one of them is kept
+		bool Write(AssetProcessingCacheKey key, Stream<Stream<void>> payload_chunks) const;
+
+		AllocatorPolymorphic allocator;
+		Stream<wchar_t> directory;
+	};
+
+	// Writes the decoded vertex streams, the indices and the submeshes of a coalesced mesh
+	ECSENGINE_API bool WriteAssetProcessingCacheMesh(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		const GLTFMesh* mesh,
+		Stream<Submesh> submeshes
+	);
+
+	// Fills in the coalesced mesh and the submeshes. The mesh buffers and the names reference a single allocation
+	// made from the allocator, while the submeshes are a separate allocation. Returns false if there is no valid entry
+	ECSENGINE_API bool ReadAssetProcessingCacheMesh(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		GLTFMesh* mesh,
+		Stream<Submesh>* submeshes,
+		AllocatorPolymorphic allocator
+	);
+
+	// The format, width and height are taken from the texture (the data is ignored) and describe the first mip level
+	ECSENGINE_API bool WriteAssetProcessingCacheTexture(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		DecodedTexture texture,
+		Stream<Stream<void>> mips
+	);
+
+	// Fills in the format, width and height of the first mip level and the mips. The texture data references
+	// the entire payload, while the mips are allocated as a single block, deallocate only mips->buffer and the
+	// texture data buffer. Returns false if there is no valid entry
+	ECSENGINE_API bool ReadAssetProcessingCacheTexture(
+		const AssetProcessingCache* cache,
+		AssetProcessingCacheKey key,
+		DecodedTexture* texture,
+		Stream<Stream<void>>* mips,
+		AllocatorPolymorphic allocator
+	);
+
+}
@@ -1092,47 +1092,92 @@ namespace ECSEngine {
 		bool temporary = HasFlag(load_descriptor.load_flags, ECS_RESOURCE_MANAGER_TEMPORARY);
 
 		if (is_compression) {
-			DirectX::ScratchImage image;
-
-			DirectX::Image new_image;
-			new_image.pixels = (uint8_t*)decoded_texture.data.buffer;
-			new_image.width = decoded_texture.width;
-			new_image.height = decoded_texture.height;
-			new_image.format = GetGraphicsNativeFormat(decoded_texture.format);
-			ECS_ASSERT(!FAILED(DirectX::ComputePitch(new_image.format, new_image.width, new_image.height, new_image.rowPitch, new_image.slicePitch)));
-
-			if (HasFlag(descriptor->misc_flags, ECS_GRAPHICS_MISC_GENERATE_MIPS) || descriptor->context != nullptr) {
-				void* new_allocation = Malloc(new_image.slicePitch);
-				HRESULT result = S_OK;
-				__try {
-					memcpy(new_allocation, new_image.pixels, new_image.slicePitch);
-					new_image.pixels = (uint8_t*)new_allocation;
-					result = DirectX::GenerateMipMaps(new_image, DirectX::TEX_FILTER_LINEAR, 0, image);
-				}
-				__finally {
-					// Always deallocate this allocation, such that we don't leak it in case of a crash, since this can be quite large
-					Free(new_allocation);
-				}
+			CompressTextureDescriptor compress_descriptor;
+			compress_descriptor.gpu_lock = load_descriptor.gpu_lock;
+			if (descriptor->srgb) {
+				compress_descriptor.flags |= ECS_TEXTURE_COMPRESS_SRGB;
+			}
+			bool is_cpu_codec = IsCPUCodec(TextureCompressionFromEx(descriptor->compression));
 
-				if (FAILED(result)) {
-					return nullptr;
+			// Creates the texture directly from already compressed mip levels
+			auto create_from_compressed_mips = [&](Stream<Stream<void>> compressed_mips) {
+				Texture2DDescriptor graphics_descriptor;
+				graphics_descriptor.bind_flag = ECS_GRAPHICS_BIND_SHADER_RESOURCE;
+				graphics_descriptor.format = GetCompressedRenderFormat(descriptor->compression, descriptor->srgb);
+				graphics_descriptor.usage = ECS_GRAPHICS_USAGE_DEFAULT;
+				graphics_descriptor.size = { decoded_texture.width, decoded_texture.height };
+				graphics_descriptor.mip_levels = compressed_mips.size;
+				graphics_descriptor.mip_data = compressed_mips;
+				return m_graphics->CreateTexture(&graphics_descriptor, temporary);
+			};
+
+			Texture2D texture;
+			if (descriptor->processed_mips.size > 0) {
+				if (is_cpu_codec) {
+					texture = create_from_compressed_mips(descriptor->processed_mips);
+				}
+				else {
+					texture = CompressTexture(m_graphics, descriptor->processed_mips, decoded_texture.width, decoded_texture.height, descriptor->compression, temporary, compress_descriptor);
 				}
 			}
+			else {
+				DirectX::ScratchImage image;
+
+				DirectX::Image new_image;
+				new_image.pixels = (uint8_t*)decoded_texture.data.buffer;
+				new_image.width = decoded_texture.width;
+				new_image.height = decoded_texture.height;
+				new_image.format = GetGraphicsNativeFormat(decoded_texture.format);
+				ECS_ASSERT(!FAILED(DirectX::ComputePitch(new_image.format, new_image.width, new_image.height, new_image.rowPitch, new_image.slicePitch)));
+
+				if (HasFlag(descriptor->misc_flags, ECS_GRAPHICS_MISC_GENERATE_MIPS) || descriptor->context != nullptr) {
+					void* new_allocation = Malloc(new_image.slicePitch);
+					HRESULT result = S_OK;
+					__try {
+						memcpy(new_allocation, new_image.pixels, new_image.slicePitch);
+						new_image.pixels = (uint8_t*)new_allocation;
+						result = DirectX::GenerateMipMaps(new_image, DirectX::TEX_FILTER_LINEAR, 0, image);
+					}
+					__finally {
+						// Always deallocate this allocation, such that we don't leak it in case of a crash, since this can be quite large
+						Free(new_allocation);
+					}
 
-			ECS_STACK_CAPACITY_STREAM(Stream<void>, data, 64);
-			data.AssertCapacity(image.GetImageCount());
-			const auto* images = image.GetImages();
-			for (size_t index = 0; index < image.GetImageCount(); index++) {
-				data[index] = { images[index].pixels, images[index].slicePitch };
-			}
-			data.size = image.GetImageCount();
+					if (FAILED(result)) {
+						return nullptr;
+					}
+				}
 
-			CompressTextureDescriptor compress_descriptor;
-			compress_descriptor.gpu_lock = load_descriptor.gpu_lock;
-			if (descriptor->srgb) {
-				compress_descriptor.flags |= ECS_TEXTURE_COMPRESS_SRGB;
+				ECS_STACK_CAPACITY_STREAM(Stream<void>, data, 64);
+				data.AssertCapacity(image.GetImageCount());
+				const auto* images = image.GetImages();
+				for (size_t index = 0; index < image.GetImageCount(); index++) {
+					data[index] = { images[index].pixels, images[index].slicePitch };
+				}
+				data.size = image.GetImageCount();
+
+				if (descriptor->processed_mips_output != nullptr) {
+					if (is_cpu_codec) {
+						// Perform the CPU compression here, such that the compressed blocks can be handed to the caller
+						ECS_STACK_CAPACITY_STREAM_DYNAMIC(Stream<void>, compressed_data, data.size);
+						compress_descriptor.allocator = descriptor->allocator;
+						if (!CompressTexture(data, compressed_data.buffer, images[0].width, images[0].height, descriptor->compression, compress_descriptor)) {
+							return nullptr;
+						}
+						compressed_data.size = data.size;
+						*descriptor->processed_mips_output = StreamCoalescedDeepCopy(compressed_data.ToStream(), descriptor->allocator);
+						Deallocate(descriptor->allocator, compressed_data[0].buffer);
+						texture = create_from_compressed_mips(*descriptor->processed_mips_output);
+					}
+					else {
+						*descriptor->processed_mips_output = StreamCoalescedDeepCopy(data.ToStream(), descriptor->allocator);
+						texture = CompressTexture(m_graphics, data, images[0].width, images[0].height, descriptor->compression, temporary, compress_descriptor);
+					}
+				}
+				else {
+					texture = CompressTexture(m_graphics, data, images[0].width, images[0].height, descriptor->compression, temporary, compress_descriptor);
+				}
 			}
-			Texture2D texture = CompressTexture(m_graphics, data, images[0].width, images[0].height, descriptor->compression, temporary, compress_descriptor);
 			if (texture.Interface() == nullptr) {
 				return nullptr;
 			}
@@ -1334,6 +1379,7 @@ namespace ECSEngine {
 		options.permanent_allocator = allocator;
 		options.scale_factor = scale_factor;
 		options.center_object_midpoint = has_origin_to_center;
+		options.optimization = load_descriptor.mesh_optimization;
 		bool success = LoadCoalescedMeshFromGLTFToGPU(m_graphics, *data, mesh, has_invert, &options);
 		if (!success) {
 			Deallocate(allocator, allocation);
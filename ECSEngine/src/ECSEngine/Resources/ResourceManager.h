@@ -40,6 +40,14 @@ namespace ECSEngine {
 		ECS_TEXTURE_COMPRESSION_EX compression = ECS_TEXTURE_COMPRESSION_EX_NONE;
 		bool srgb = false;
 		AllocatorPolymorphic allocator = ECS_MALLOC_ALLOCATOR;
+		// Used only when a compression is specified. If set, these are the mip levels that a previous load produced
+		// on the CPU side with the same settings (see processed_mips_output) and the mip generation and the CPU
+		// compression are skipped. The decoded texture must describe the first level before the compression
+		Stream<Stream<void>> processed_mips = {};
+		// Used only when a compression is specified. If set, it receives the mip levels produced on the CPU side -
+		// the compressed blocks for the CPU codecs or the generated mips for the GPU codecs - such that they can be
+		// cached by the caller. They are allocated as a single block from the allocator, deallocate only the buffer
+		Stream<Stream<void>>* processed_mips_output = nullptr;
 	};
 
 	// Initializes the first parameter with memory from the second parameter
@@ -49,6 +57,7 @@ namespace ECSEngine {
 
 	struct GLTFData;
 	struct GLTFMesh;
+	struct MeshOptimizationOptions;
 	struct ResourceManager;
 	struct ResourceManagerExDesc;
 
@@ -124,6 +133,9 @@ namespace ECSEngine {
 		// Only for graphics resources. If they need access to the immediate context then they will acquire the
 		// Graphics object lock before proceeding to use the immediate context
 		SpinLock* gpu_lock = nullptr;
+		// Only for coalesced meshes loaded from GLTF files. If set, the submeshes are optimized before
+		// being uploaded to the GPU. It is not considered for the identifier, use the suffix for that
+		const MeshOptimizationOptions* mesh_optimization = nullptr;
 	};
 
 	struct ECSENGINE_API ResourceManagerUserMaterialExtraInfo {
@@ -171,8 +171,9 @@ namespace ECSEngine {
 		// Use malloc for now for the change set allocator
 		delta_state->change_set_allocator = ResizableLinearAllocator(CHANGE_SET_ALLOCATOR_CAPACITY, CHANGE_SET_ALLOCATOR_BACKUP_CAPACITY, ECS_MALLOC_ALLOCATOR);
 
-		// Copy the current contents
-		delta_state->previous_entity_manager.CopyOther(delta_state->current_entity_manager);
+		// Copy the current contents. Use a copy on write, the snapshot is only read and most of the archetypes
+		// Are not written every frame
+		delta_state->previous_entity_manager.CopyOther(delta_state->current_entity_manager, true);
 
 		for (size_t index = 0; index < ECS_COUNTOF(delta_state->previous_asset_database_snapshot_allocators); index++) {
 			delta_state->previous_asset_database_snapshot_allocators[index] = ResizableLinearAllocator(ASSET_DATABASE_SNAPSHOT_ALLOCATOR_CAPACITY, ASSET_DATABASE_SNAPSHOT_ALLOCATOR_CAPACITY, ECS_MALLOC_ALLOCATOR);
@@ -227,6 +228,8 @@ namespace ECSEngine {
 
 	static void WriterDeallocate(void* user_data, AllocatorPolymorphic allocator) {
 		WriterData* delta_state = (WriterData*)user_data;
+		// The snapshot can reference the storage of the current entity manager
+		delta_state->previous_entity_manager.DetachCopyOnWrite(false);
 		delta_state->previous_state_allocator.Free();
 		delta_state->change_set_allocator.Free();
 		for (size_t index = 0; index < ECS_COUNTOF(delta_state->previous_asset_database_snapshot_allocators); index++) {
@@ -606,7 +609,9 @@ namespace ECSEngine {
 		// Don't forget to deallocate the allocator, since all previous data can be winked
 		// Don't maintain the components, they will be reconstructed by the copy of the entity manager
 		data->previous_entity_manager.ClearAll();
-		data->previous_entity_manager.CopyOther(data->current_entity_manager);
+		// The archetype storage is shared with the current entity manager, only the bases that are written
+		// Afterwards are cloned
+		data->previous_entity_manager.CopyOther(data->current_entity_manager, true);
 	}
 
 	static bool WriterDeltaFunction(DeltaStateWriterDeltaFunctionData* function_data) {
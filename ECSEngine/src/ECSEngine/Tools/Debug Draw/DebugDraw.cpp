@@ -7,6 +7,7 @@
 #include "../../Rendering/RenderingEffects.h"
 #include "../../Utilities/FilePreprocessor.h"
 #include "../../Rendering/Camera.h"
+#include "../../Multithreading/ParallelFor.h"
 
 #define SMALL_VERTEX_BUFFER_CAPACITY 8
 #define PER_THREAD_RESOURCES 32
@@ -14,6 +15,12 @@
 
 #define LARGE_BUFFER_CAPACITY 100 * ECS_KB
 
+// Set by the deck draws, whose element functor can be called concurrently and returns stable pointers.
+// The GPU buffers are then filled in parallel, and the transform elements are expanded 8 at a time
+#define DRAW_PARALLEL_FILL (1 << 1)
+#define PARALLEL_FILL_MIN_BATCH 512
+#define PARALLEL_FILL_MAX_BATCH_COUNT 64
+
 #define POINT_SIZE 0.0175f
 #define CIRCLE_TESSELATION 32
 #define ARROW_HEAD_DARKEN_COLOR 1.0f
@@ -504,6 +511,15 @@ namespace ECSEngine {
 							exit_dynamic_loop = true;
 						}
 					}
+					else if constexpr ((flags & DRAW_PARALLEL_FILL) != 0) {
+						// The batches write disjoint ranges of the buffers
+						ParallelForBatches(drawer->task_manager, current_count, PARALLEL_FILL_MIN_BATCH, PARALLEL_FILL_MAX_BATCH_COUNT,
+							[&](size_t batch_offset, size_t batch_count, size_t batch_index) {
+								for (size_t index = batch_offset; index < batch_offset + batch_count; index++) {
+									iteration((unsigned int)index);
+								}
+							});
+					}
 					else {
 						// Fill the buffers
 						for (unsigned int index = 0; index < current_count; index++) {
@@ -587,7 +603,7 @@ namespace ECSEngine {
 			unsigned int instance_count = GetMaximumCount(counts);
 
 			if (instance_count > 0) {
-				DrawStructuredDeckCore<false, flags>(drawer, instance_count, vertex_count, counts, shader_output, 
+				DrawStructuredDeckCore<false, flags | DRAW_PARALLEL_FILL>(drawer, instance_count, vertex_count, counts, shader_output, 
 					[deck, indices](unsigned int index, ElementType element_type, bool* should_stop) {
 					return &deck->buffers[indices[element_type][index].x][indices[element_type][index].y];
 				});
@@ -600,6 +616,113 @@ namespace ECSEngine {
 		}
 	}
 
+	// The transforms of Vec8f::size() elements, in SoA form. The rotation is a quaternion such that
+	// the AABBs and the spheres can use the identity
+	struct DebugTransformLanes {
+		alignas(ECS_SIMD_BYTE_SIZE) float translation[3][Vec8f::size()];
+		alignas(ECS_SIMD_BYTE_SIZE) float rotation[4][Vec8f::size()];
+		alignas(ECS_SIMD_BYTE_SIZE) float scale[3][Vec8f::size()];
+	};
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, float3 translation, QuaternionScalar rotation, float3 scale) {
+		for (size_t index = 0; index < 3; index++) {
+			lanes->translation[index][lane] = translation[index];
+			lanes->scale[index][lane] = scale[index];
+		}
+		lanes->rotation[0][lane] = rotation.x;
+		lanes->rotation[1][lane] = rotation.y;
+		lanes->rotation[2][lane] = rotation.z;
+		lanes->rotation[3][lane] = rotation.w;
+	}
+
+	// These must match the GetMatrix functions of the types
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugSphere* sphere) {
+		SetDebugTransformLane(lanes, lane, sphere->position, QuaternionIdentityScalar(), float3::Splat(sphere->radius));
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugPoint* point) {
+		SetDebugTransformLane(lanes, lane, point->position, QuaternionIdentityScalar(), float3::Splat(POINT_SIZE));
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugCross* cross) {
+		SetDebugTransformLane(lanes, lane, cross->position, cross->rotation, float3::Splat(cross->size));
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugCircle* circle) {
+		SetDebugTransformLane(lanes, lane, circle->position, circle->rotation, float3::Splat(circle->radius));
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugArrow* arrow) {
+		SetDebugTransformLane(lanes, lane, arrow->translation, arrow->rotation, float3(arrow->length, arrow->size, arrow->size));
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugAABB* aabb) {
+		SetDebugTransformLane(lanes, lane, aabb->translation, QuaternionIdentityScalar(), aabb->scale);
+	}
+
+	static void SetDebugTransformLane(DebugTransformLanes* lanes, size_t lane, const DebugOOBB* oobb) {
+		SetDebugTransformLane(lanes, lane, oobb->translation, oobb->rotation, oobb->scale);
+	}
+
+	// Computes the GPU matrices (the transposed object * camera matrices) of all the lanes, which are written
+	// in the GPU layout, such that values[row * 4 + column] is a Vec8f::size() wide value. It is the same as
+	// MatrixMVPToGPU(MatrixTRS(translation, QuaternionToMatrix(rotation), scale), camera_matrix) for each lane
+	static void ECS_VECTORCALL DebugTransformLanesToGPU(const DebugTransformLanes* lanes, Matrix camera_matrix, float values[16][Vec8f::size()]) {
+		alignas(ECS_SIMD_BYTE_SIZE) float camera[16];
+		camera_matrix.StoreAligned(camera);
+
+		Vec8f x = Vec8f().load_a(lanes->rotation[0]);
+		Vec8f y = Vec8f().load_a(lanes->rotation[1]);
+		Vec8f z = Vec8f().load_a(lanes->rotation[2]);
+		Vec8f w = Vec8f().load_a(lanes->rotation[3]);
+
+		// The same formula as the scalar quaternion conversion, the rows being scaled afterwards
+		Vec8f two = 2.0f;
+		Vec8f x_squared = x * x;
+		Vec8f y_squared = y * y;
+		Vec8f z_squared = z * z;
+		Vec8f w_squared = w * w;
+		Vec8f two_wz = two * w * z;
+		Vec8f two_xy = two * x * y;
+		Vec8f two_xz = two * x * z;
+		Vec8f two_yw = two * y * w;
+		Vec8f two_xw = two * x * w;
+		Vec8f two_yz = two * y * z;
+
+		Vec8f object[4][3] = {
+			{ w_squared + x_squared - y_squared - z_squared, two_wz + two_xy, two_xz - two_yw },
+			{ two_xy - two_wz, w_squared + y_squared - x_squared - z_squared, two_xw + two_yz },
+			{ two_yw + two_xz, two_yz - two_xw, w_squared + z_squared - x_squared - y_squared },
+			{ Vec8f().load_a(lanes->translation[0]), Vec8f().load_a(lanes->translation[1]), Vec8f().load_a(lanes->translation[2]) }
+		};
+		for (size_t row = 0; row < 3; row++) {
+			Vec8f scale = Vec8f().load_a(lanes->scale[row]);
+			for (size_t column = 0; column < 3; column++) {
+				object[row][column] *= scale;
+			}
+		}
+
+		// The object matrix has the last column (0, 0, 0, 1), such that only the translation row adds the last camera row
+		for (size_t row = 0; row < 4; row++) {
+			for (size_t column = 0; column < 4; column++) {
+				Vec8f value = row == 3 ? Vec8f(camera[12 + column]) : Vec8f(0.0f);
+				value = mul_add(object[row][0], Vec8f(camera[column]), value);
+				value = mul_add(object[row][1], Vec8f(camera[4 + column]), value);
+				value = mul_add(object[row][2], Vec8f(camera[8 + column]), value);
+				// Transposed for the GPU
+				value.store_a(values[column * 4 + row]);
+			}
+		}
+	}
+
+	template<typename Element, typename = void>
+	struct HasDebugTransformLane : std::false_type {};
+
+	template<typename Element>
+	struct HasDebugTransformLane<Element, std::void_t<decltype(SetDebugTransformLane((DebugTransformLanes*)nullptr, 0, (const Element*)nullptr))>> : std::true_type {};
+
+	// ----------------------------------------------------------------------------------------------------------------------
+
 	// If the dynamic counts is set to true, it will keep retrieving items and filling
 	// The GPU buffers directly without the need for allocations. This works only for a single
 	// Type of draw - the options cannot be intermingled. It will also increment
@@ -616,6 +739,8 @@ namespace ECSEngine {
 		GetElementFunctor&& get_element_functor,
 		ElementType dynamic_options_type = ELEMENT_COUNT
 	) {
+		typedef std::remove_const_t<std::remove_pointer_t<decltype(get_element_functor(0u, WIREFRAME_DEPTH, (bool*)nullptr))>> Element;
+
 		if constexpr (dynamic_counts) {
 			instance_count = 1;
 		}
@@ -717,6 +842,45 @@ namespace ECSEngine {
 							exit_dynamic_loop = true;
 						}
 					}
+					else if constexpr ((flags & DRAW_PARALLEL_FILL) != 0) {
+						// The batches write disjoint ranges of the buffers. The types that have a transform lane
+						// have their matrices computed Vec8f::size() at a time
+						ParallelForBatches(drawer->task_manager, current_count, PARALLEL_FILL_MIN_BATCH, PARALLEL_FILL_MAX_BATCH_COUNT,
+							[&](size_t batch_offset, size_t batch_count, size_t batch_index) {
+								size_t index = batch_offset;
+								size_t batch_end = batch_offset + batch_count;
+								if constexpr (HasDebugTransformLane<Element>::value) {
+									DebugTransformLanes lanes;
+									alignas(ECS_SIMD_BYTE_SIZE) float gpu_values[16][Vec8f::size()];
+									const Element* elements[Vec8f::size()];
+									for (; index + Vec8f::size() <= batch_end; index += Vec8f::size()) {
+										for (size_t lane = 0; lane < Vec8f::size(); lane++) {
+											bool should_stop = false;
+											elements[lane] = get_element_functor((unsigned int)(index + lane), element_type, &should_stop);
+											SetDebugTransformLane(&lanes, lane, elements[lane]);
+										}
+										DebugTransformLanesToGPU(&lanes, drawer->camera_matrix, gpu_values);
+
+										for (size_t lane = 0; lane < Vec8f::size(); lane++) {
+											float* matrix_values = shader_output == ECS_DEBUG_SHADER_OUTPUT_COLOR ? 
+												(float*)((InstancedTransformData*)instanced_data + index + lane) : (float*)(matrix_data + index + lane);
+											for (size_t value_index = 0; value_index < 16; value_index++) {
+												matrix_values[value_index] = gpu_values[value_index][lane];
+											}
+											if (shader_output == ECS_DEBUG_SHADER_OUTPUT_COLOR) {
+												SetInstancedColor(instanced_data, index + lane, GetTypeColor(elements[lane]));
+											}
+											else {
+												instance_id_data[index + lane] = GetTypeInstanceThickness(elements[lane]);
+											}
+										}
+									}
+								}
+								for (; index < batch_end; index++) {
+									iteration((unsigned int)index);
+								}
+							});
+					}
 					else {
 						// Fill the buffers
 						for (unsigned int index = 0; index < current_count; index++) {
@@ -796,7 +960,7 @@ namespace ECSEngine {
 
 			if (instance_count > 0) {
 				// Bind the vertex buffers now
-				DrawTransformCallCore<false, flags>(drawer, instance_count, counts, shader_output, debug_vertex_buffer, 
+				DrawTransformCallCore<false, flags | DRAW_PARALLEL_FILL>(drawer, instance_count, counts, shader_output, debug_vertex_buffer, 
 					[deck, indices](unsigned int index, ElementType element_type, bool* should_stop) {
 					return &deck->buffers[indices[element_type][index].x][indices[element_type][index].y];
 					});
@@ -3628,6 +3792,7 @@ namespace ECSEngine {
 		allocator = _allocator;
 		graphics = resource_manager->m_graphics;
 		thread_count = _thread_count;
+		task_manager = nullptr;
 
 		// Initialize the small vertex buffers
 		positions_small_vertex_buffer = graphics->CreateVertexBuffer(sizeof(InstancedVertex), SMALL_VERTEX_BUFFER_CAPACITY);
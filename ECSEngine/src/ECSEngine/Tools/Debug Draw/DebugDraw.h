@@ -14,6 +14,7 @@ namespace ECSEngine {
 #define ECS_DEBUG_DRAWER_STRUCTURED_OUTPUT_ID_THICKNESS 3
 
 	struct ResourceManager;
+	struct TaskManager;
 
 	typedef float3 DebugVertex;
 
@@ -1043,6 +1044,12 @@ namespace ECSEngine {
 			dispatch_call_type = call_type;
 		}
 
+		// When set, the deck draws fill the GPU buffers in parallel. The draw calls themselves are still
+		// issued from the calling thread
+		ECS_INLINE void SetTaskManager(TaskManager* _task_manager) {
+			task_manager = _task_manager;
+		}
+
 		// Initializes the first parameter with memory from the second parameter
 		ECS_INLINE static void DefaultAllocator(MemoryManager* allocator, GlobalMemoryManager* global_memory) {
 			new (allocator) MemoryManager(DefaultAllocatorSize(), ECS_KB * 16, DefaultAllocatorSize(), global_memory);
@@ -1111,6 +1118,7 @@ namespace ECSEngine {
 		InputLayout layout_shaders[ECS_DEBUG_SHADER_COUNT][ECS_DEBUG_SHADER_OUTPUT_COUNT];
 		Matrix camera_matrix;
 		float2* string_character_bounds;
+		TaskManager* task_manager;
 
 		// Can be set by an external source such that functions
 		// That are being called can use the debug drawer without
@@ -527,7 +527,7 @@ namespace ECSEngine {
 		}
 
 		ECS_INLINE void SetCompareEntryTo(SharedComponentCompareEntry* entry) const {
-			*entry = { compare_function, compare_data, compare_use_copy_deallocate_data };
+			*entry = { compare_function, compare_data, compare_use_copy_deallocate_data, compare_hash_function };
 		}
 
 		ModuleComponentBuildEntry build_entry = { nullptr, {} };
@@ -540,6 +540,9 @@ namespace ECSEngine {
 		SharedComponentCompareFunction compare_function = nullptr;
 		Copyable* compare_data = nullptr;
 		bool compare_use_copy_deallocate_data = false;
+		// Optional, it must be consistent with the compare function. It is needed
+		// For the instances to be looked up by hash when a compare function is given
+		SharedComponentHashFunction compare_hash_function = nullptr;
 
 		ModuleDebugDrawElement debug_draw;
 	};
@@ -421,6 +421,57 @@ namespace ECSEngine {
 		return flag;
 	}
 
+	// Sorts the elements ascending by the 64 bit key that the extract functor returns, using a LSD radix sort
+	// with byte digits. The temporary buffer must have at least size elements. The digits for which all the keys
+	// have the same value are skipped, such that keys which use only the lower bytes need fewer passes
+	template<typename T, typename ExtractKey>
+	void RadixSort64(T* buffer, T* temporary, size_t size, ExtractKey&& extract_key) {
+		if (size < 2) {
+			return;
+		}
+
+		// Build all the digit histograms in a single pass
+		unsigned int counts[sizeof(size_t)][256];
+		memset(counts, 0, sizeof(counts));
+		for (size_t index = 0; index < size; index++) {
+			size_t key = extract_key(buffer[index]);
+			for (size_t digit = 0; digit < sizeof(size_t); digit++) {
+				counts[digit][(key >> (digit * 8)) & 0xFF]++;
+			}
+		}
+
+		T* source = buffer;
+		T* destination = temporary;
+		for (size_t digit = 0; digit < sizeof(size_t); digit++) {
+			unsigned int* digit_counts = counts[digit];
+			size_t shift = digit * 8;
+			// If all the keys fall into the same bucket, the pass would not change the order
+			if (digit_counts[(extract_key(source[0]) >> shift) & 0xFF] == size) {
+				continue;
+			}
+
+			unsigned int offset = 0;
+			for (size_t bucket = 0; bucket < 256; bucket++) {
+				unsigned int count = digit_counts[bucket];
+				digit_counts[bucket] = offset;
+				offset += count;
+			}
+
+			for (size_t index = 0; index < size; index++) {
+				size_t key = extract_key(source[index]);
+				destination[digit_counts[(key >> shift) & 0xFF]++] = source[index];
+			}
+
+			T* temp = source;
+			source = destination;
+			destination = temp;
+		}
+
+		if (source != buffer) {
+			memcpy(buffer, source, sizeof(T) * size);
+		}
+	}
+
 	//// 2 bytes at a time
 	//static int RadixSortUnsignedInt(unsigned int* buffer, unsigned int* intermediate, size_t size,
 	//	unsigned int maximum_element, unsigned int minimum_element, unsigned int* counts)
@@ -13,6 +13,9 @@
 #include "ReflectionCustomTypes.h"
 #include "ReflectionAllocatorHandling.h"
 #include "../Tokenize.h"
+#include "../InMemoryReaderWriter.h"
+#include "../SizeDeterminationReaderWriter.h"
+#include "../../OS/FileOS.h"
 // Added for the Entity, EntiyInfo and EntityPair blittable exceptions
 #include "../../ECS/InternalStructures.h"
 // Added for the Color and ColorFloat blittable exceptions
@@ -60,6 +63,29 @@ namespace ECSEngine {
 			Stream<char> inherit_type;
 		};
 
+		// The sizes of the parsed outputs at a certain moment, which are used to identify the results of each file
+		struct ReflectionParseFileRange {
+			unsigned int type_count;
+			unsigned int enum_count;
+			unsigned int constant_count;
+			unsigned int embedded_array_size_count;
+			unsigned int typedef_count;
+			unsigned int type_template_count;
+			unsigned int valid_dependency_count;
+			size_t total_memory;
+		};
+
+		// Identifies the contents that the parse task read for a file, such that the parse cache describes exactly what was parsed
+		struct ReflectionParseFileStamp {
+			// Taken before the file is read, such that a write during the parse invalidates the cache entry
+			size_t last_write;
+			size_t byte_size;
+			// The hash of the buffer that was read, before the comments are removed
+			size_t content_hash;
+			// It is false when the file was not read entirely, in which case it is not cached
+			bool is_valid;
+		};
+
 		struct ReflectionManagerParseStructuresThreadTaskData {
 			// This is the allocator from which the resizable streams are allocated from.
 			// The allocator is local to this thread, it is not shared
@@ -73,6 +99,10 @@ namespace ECSEngine {
 			ResizableStream<ReflectionTypeTemplate> type_templates;
 			ResizableStream<ReflectionParsedValidDependency> valid_dependencies;
 			HashTableDefault<Stream<ReflectionExpression>> expressions;
+			// The ranges at the start of each path, with an additional entry for the end of the last path
+			ResizableStream<ReflectionParseFileRange> file_ranges;
+			// A stamp for each path, filled in by the parse task
+			ResizableStream<ReflectionParseFileStamp> file_stamps;
 			const ReflectionFieldTable* field_table;
 			CapacityStream<char>* error_message;
 			SpinLock error_message_lock;
@@ -94,6 +124,31 @@ namespace ECSEngine {
 			Semaphore* semaphore;
 		};
 
+		static ReflectionParseFileRange GetReflectionParseFileRange(const ReflectionManagerParseStructuresThreadTaskData* data) {
+			ReflectionParseFileRange range;
+			range.type_count = data->types.size;
+			range.enum_count = data->enums.size;
+			range.constant_count = data->constants.size;
+			range.embedded_array_size_count = data->embedded_array_size.size;
+			range.typedef_count = data->typedefs.size;
+			range.type_template_count = data->type_templates.size;
+			range.valid_dependency_count = data->valid_dependencies.size;
+			range.total_memory = data->total_memory;
+			return range;
+		}
+
+		// Discards everything that was added after the range was retrieved, except for the expressions
+		static void SetReflectionParseFileRange(ReflectionManagerParseStructuresThreadTaskData* data, const ReflectionParseFileRange& range) {
+			data->types.size = range.type_count;
+			data->enums.size = range.enum_count;
+			data->constants.size = range.constant_count;
+			data->embedded_array_size.size = range.embedded_array_size_count;
+			data->typedefs.size = range.typedef_count;
+			data->type_templates.size = range.type_template_count;
+			data->valid_dependencies.size = range.valid_dependency_count;
+			data->total_memory = range.total_memory;
+		}
+
 #pragma region Reflection Type Tag Processing (For certain tags the source code to be parsed is modified such that certain effects can be made possible)
 
 		static Stream<char> ECS_REFLECTION_RUNTIME_COMPONENT_KNOWN_FUNCTIONS[] = {
@@ -1661,6 +1716,7 @@ namespace ECSEngine {
 			action.callback_data = {};
 			action.rule = enum_rule;
 			matcher->AddPreExcludeAction(action, false);
+			matcher->Compile();
 		}
 
 		static void CreateTokenizeStructFieldAction(TokenizeRuleMatcher* struct_matcher, AllocatorPolymorphic temporary_allocator) {
@@ -1759,6 +1815,7 @@ namespace ECSEngine {
 			CreateTokenizeStructFieldAction(matcher, temporary_allocator);
 			CreateTokenizeStructTypedefAction(matcher, temporary_allocator);
 			CreateTokenizeStructInternalStructAction(matcher, temporary_allocator);
+			matcher->Compile();
 		}
 
 		static void InitializeRuleMatchers() {
@@ -3904,6 +3961,10 @@ namespace ECSEngine {
 				Deallocate(Allocator(), blittable_types[index].default_data);
 			}
 			blittable_types.FreeBuffer();
+			if (parse_cache_directory.size > 0) {
+				Deallocate(folders.allocator, parse_cache_directory.buffer);
+				parse_cache_directory = {};
+			}
 		}
 
 		// ----------------------------------------------------------------------------------------------------------------------------
@@ -4275,6 +4336,8 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 			data.typedefs.Initialize(&data.allocator, 16);
 			data.type_templates.Initialize(&data.allocator, 16);
 			data.valid_dependencies.Initialize(&data.allocator, 8);
+			data.file_ranges.Initialize(&data.allocator, path_count + 1);
+			data.file_stamps.Initialize(&data.allocator, path_count);
 
 			data.field_table = &field_table;
 			data.success = true;
@@ -4308,9 +4371,634 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 
 		// ----------------------------------------------------------------------------------------------------------------------------
 
+#pragma region Parse Cache
+
+		// Must be incremented when the parsing changes in a way that produces different results for the same source file
+#define ECS_REFLECTION_PARSE_CACHE_VERSION 1
+#define ECS_REFLECTION_PARSE_CACHE_EXTENSION L".ecsreflectioncache"
+		// Upper bounds for the counts and the string sizes, such that a corrupted cache cannot request huge allocations
+#define ECS_REFLECTION_PARSE_CACHE_MAX_COUNT (ECS_KB * 64)
+#define ECS_REFLECTION_PARSE_CACHE_MAX_STRING_SIZE ECS_MB
+
+		struct ReflectionParseCacheEntry {
+			Stream<wchar_t> path;
+			size_t last_write;
+			size_t byte_size;
+			size_t content_hash;
+			// The serialized parse results of the file
+			Stream<void> data;
+		};
+
+		// Everything is allocated from a temporary allocator, the cache lives only while a folder hierarchy is processed
+		struct ReflectionParseCache {
+			AllocatorPolymorphic allocator;
+			Stream<wchar_t> file;
+			Stream<ReflectionParseCacheEntry> entries;
+			// Maps the path of a file to its index inside the entries
+			HashTableDefault<unsigned int> table;
+			// The entries that are written back. The files that are no longer part of the hierarchy are dropped this way
+			ResizableStream<ReflectionParseCacheEntry> next_entries;
+		};
+
+		// The structures are written as they are, followed by the buffers that they reference, such that a change of the
+		// Layout invalidates the cache. The tag handlers change the parsed results as well. The reflection macros themselves
+		// Are matched by name, their definitions don't influence the parsing
+		static size_t GetReflectionParseCacheKey() {
+			size_t structure_sizes[] = {
+				ECS_REFLECTION_PARSE_CACHE_VERSION,
+				sizeof(ReflectionType),
+				sizeof(ReflectionField),
+				sizeof(ReflectionEvaluation),
+				sizeof(ReflectionTypeMiscInfo),
+				sizeof(ReflectionEnum),
+				sizeof(ReflectionConstant),
+				sizeof(ReflectionTypedef),
+				sizeof(ReflectionTypeTemplate),
+				sizeof(ReflectionTypeTemplate::Argument)
+			};
+			size_t key = Murmur64({ structure_sizes, sizeof(structure_sizes) });
+			for (size_t index = 0; index < ECS_COUNTOF(ECS_REFLECTION_TYPE_TAG_HANDLER); index++) {
+				key = Murmur64(ECS_REFLECTION_TYPE_TAG_HANDLER[index].tag, key);
+			}
+			return key;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool WriteReflectionParseCacheString(WriteInstrument* write, Stream<char> string) {
+			return write->WriteWithSize<unsigned int>(string);
+		}
+
+		static bool ReadReflectionParseCacheString(ReadInstrument* read, AllocatorPolymorphic allocator, Stream<char>& string) {
+			Stream<void> data;
+			if (!read->ReadWithSize<unsigned int>(data, allocator, ECS_REFLECTION_PARSE_CACHE_MAX_STRING_SIZE)) {
+				return false;
+			}
+			string.buffer = (char*)data.buffer;
+			string.size = data.size;
+			return true;
+		}
+
+		static bool WriteReflectionParseCacheStrings(WriteInstrument* write, Stream<Stream<char>> strings) {
+			unsigned int count = (unsigned int)strings.size;
+			if (!write->Write(&count)) {
+				return false;
+			}
+			for (size_t index = 0; index < strings.size; index++) {
+				if (!WriteReflectionParseCacheString(write, strings[index])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static bool ReadReflectionParseCacheStrings(ReadInstrument* read, AllocatorPolymorphic allocator, Stream<Stream<char>>& strings) {
+			unsigned int count = 0;
+			if (!read->Read(&count) || count > ECS_REFLECTION_PARSE_CACHE_MAX_COUNT) {
+				return false;
+			}
+			strings.Initialize(allocator, count);
+			for (unsigned int index = 0; index < count; index++) {
+				if (!ReadReflectionParseCacheString(read, allocator, strings[index])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// The elements are written as they are, the buffers that they reference must be written separately
+		template<typename T>
+		static bool WriteReflectionParseCacheArray(WriteInstrument* write, Stream<T> elements) {
+			unsigned int count = (unsigned int)elements.size;
+			return write->Write(&count) && write->Write(elements.buffer, sizeof(T) * elements.size);
+		}
+
+		// The buffers that the elements reference must be read separately
+		template<typename T>
+		static bool ReadReflectionParseCacheArray(ReadInstrument* read, AllocatorPolymorphic allocator, Stream<T>& elements) {
+			unsigned int count = 0;
+			if (!read->Read(&count) || count > ECS_REFLECTION_PARSE_CACHE_MAX_COUNT) {
+				return false;
+			}
+			elements.buffer = count == 0 ? nullptr : (T*)Allocate(allocator, sizeof(T) * count, alignof(T));
+			elements.size = count;
+			return read->Read(elements.buffer, sizeof(T) * count);
+		}
+
+		// Writes the count of the range followed by each element, using the functor
+		template<typename T, typename Functor>
+		static bool WriteReflectionParseCacheRange(WriteInstrument* write, const ResizableStream<T>& elements, unsigned int start, unsigned int end, Functor&& functor) {
+			unsigned int count = end - start;
+			if (!write->Write(&count)) {
+				return false;
+			}
+			for (unsigned int index = start; index < end; index++) {
+				if (!functor(elements[index])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Reads the elements written by WriteReflectionParseCacheRange and adds them to the given stream
+		template<typename T, typename Functor>
+		static bool ReadReflectionParseCacheRange(ReadInstrument* read, ResizableStream<T>& elements, Functor&& functor) {
+			unsigned int count = 0;
+			if (!read->Read(&count) || count > ECS_REFLECTION_PARSE_CACHE_MAX_COUNT) {
+				return false;
+			}
+			for (unsigned int index = 0; index < count; index++) {
+				T element;
+				if (!functor(element)) {
+					return false;
+				}
+				elements.Add(&element);
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool WriteReflectionParseCacheType(WriteInstrument* write, const ReflectionType* type) {
+			if (!write->Write(type) || !WriteReflectionParseCacheString(write, type->name) || !WriteReflectionParseCacheString(write, type->tag)) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheArray(write, type->fields)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->fields.size; index++) {
+				const ReflectionField& field = type->fields[index];
+				if (!WriteReflectionParseCacheString(write, field.name) || !WriteReflectionParseCacheString(write, field.definition) 
+					|| !WriteReflectionParseCacheString(write, field.tag)) {
+					return false;
+				}
+			}
+
+			if (!WriteReflectionParseCacheArray(write, type->evaluations)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->evaluations.size; index++) {
+				if (!WriteReflectionParseCacheString(write, type->evaluations[index].name)) {
+					return false;
+				}
+			}
+
+			if (!WriteReflectionParseCacheArray(write, type->misc_info)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->misc_info.size; index++) {
+				const ReflectionTypeMiscInfo& misc_info = type->misc_info[index];
+				if (misc_info.type == ECS_REFLECTION_TYPE_MISC_INFO_SOA) {
+					if (!WriteReflectionParseCacheString(write, misc_info.soa.name)) {
+						return false;
+					}
+				}
+				else if (misc_info.type == ECS_REFLECTION_TYPE_MISC_INFO_ALLOCATOR) {
+					if (!WriteReflectionParseCacheString(write, misc_info.allocator_info.main_allocator_definition)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		static bool ReadReflectionParseCacheType(ReadInstrument* read, AllocatorPolymorphic allocator, ReflectionType* type) {
+			if (!read->Read(type) || !ReadReflectionParseCacheString(read, allocator, type->name) || !ReadReflectionParseCacheString(read, allocator, type->tag)) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheArray(read, allocator, type->fields)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->fields.size; index++) {
+				ReflectionField& field = type->fields[index];
+				if (!ReadReflectionParseCacheString(read, allocator, field.name) || !ReadReflectionParseCacheString(read, allocator, field.definition)
+					|| !ReadReflectionParseCacheString(read, allocator, field.tag)) {
+					return false;
+				}
+			}
+
+			if (!ReadReflectionParseCacheArray(read, allocator, type->evaluations)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->evaluations.size; index++) {
+				if (!ReadReflectionParseCacheString(read, allocator, type->evaluations[index].name)) {
+					return false;
+				}
+			}
+
+			if (!ReadReflectionParseCacheArray(read, allocator, type->misc_info)) {
+				return false;
+			}
+			for (size_t index = 0; index < type->misc_info.size; index++) {
+				ReflectionTypeMiscInfo& misc_info = type->misc_info[index];
+				if (misc_info.type == ECS_REFLECTION_TYPE_MISC_INFO_SOA) {
+					if (!ReadReflectionParseCacheString(read, allocator, misc_info.soa.name)) {
+						return false;
+					}
+				}
+				else if (misc_info.type == ECS_REFLECTION_TYPE_MISC_INFO_ALLOCATOR) {
+					if (!ReadReflectionParseCacheString(read, allocator, misc_info.allocator_info.main_allocator_definition)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		static bool WriteReflectionParseCacheExpressions(WriteInstrument* write, Stream<char> type_name, Stream<ReflectionExpression> expressions) {
+			unsigned int count = (unsigned int)expressions.size;
+			if (!WriteReflectionParseCacheString(write, type_name) || !write->Write(&count)) {
+				return false;
+			}
+			for (size_t index = 0; index < expressions.size; index++) {
+				if (!WriteReflectionParseCacheString(write, expressions[index].name) || !WriteReflectionParseCacheString(write, expressions[index].body)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Writes the results that were parsed for a single file, which are those in between the two ranges
+		static bool WriteReflectionParseCacheFile(
+			WriteInstrument* write,
+			const ReflectionManagerParseStructuresThreadTaskData* data,
+			const ReflectionParseFileRange& start,
+			const ReflectionParseFileRange& end
+		) {
+			size_t total_memory = end.total_memory - start.total_memory;
+			if (!write->Write(&total_memory)) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->types, start.type_count, end.type_count, [write](const ReflectionParsedType& type) {
+				return WriteReflectionParseCacheType(write, &type) && WriteReflectionParseCacheString(write, type.inherit_type);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->enums, start.enum_count, end.enum_count, [write](const ReflectionEnum& enum_) {
+				return write->Write(&enum_) && WriteReflectionParseCacheString(write, enum_.name) && WriteReflectionParseCacheStrings(write, enum_.original_fields)
+					&& WriteReflectionParseCacheStrings(write, enum_.fields);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->constants, start.constant_count, end.constant_count, [write](const ReflectionConstant& constant) {
+				return write->Write(&constant) && WriteReflectionParseCacheString(write, constant.name);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->embedded_array_size, start.embedded_array_size_count, end.embedded_array_size_count, 
+				[write](const ReflectionEmbeddedArraySize& embedded_size) {
+				return WriteReflectionParseCacheString(write, embedded_size.reflection_type) && WriteReflectionParseCacheString(write, embedded_size.field_name)
+					&& WriteReflectionParseCacheString(write, embedded_size.body);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->typedefs, start.typedef_count, end.typedef_count, [write](const ReflectionParsedTypedef& typedef_) {
+				return WriteReflectionParseCacheString(write, typedef_.name) && write->Write(&typedef_.entry) && WriteReflectionParseCacheString(write, typedef_.entry.definition);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->type_templates, start.type_template_count, end.type_template_count, [write](const ReflectionTypeTemplate& type_template) {
+				if (!write->Write(&type_template) || !WriteReflectionParseCacheType(write, &type_template.base_type) || !WriteReflectionParseCacheArray(write, type_template.arguments)) {
+					return false;
+				}
+				for (size_t index = 0; index < type_template.arguments.size; index++) {
+					const ReflectionTypeTemplate::Argument& argument = type_template.arguments[index];
+					if (!WriteReflectionParseCacheString(write, argument.type_name)) {
+						return false;
+					}
+					if (argument.type == ReflectionTypeTemplate::ArgumentType::Type && argument.has_default_value) {
+						if (!WriteReflectionParseCacheString(write, argument.default_type_name)) {
+							return false;
+						}
+					}
+				}
+				return WriteReflectionParseCacheArray(write, type_template.embedded_array_sizes);
+			})) {
+				return false;
+			}
+
+			if (!WriteReflectionParseCacheRange(write, data->valid_dependencies, start.valid_dependency_count, end.valid_dependency_count, 
+				[write](const ReflectionParsedValidDependency& valid_dependency) {
+				return WriteReflectionParseCacheString(write, valid_dependency.name);
+			})) {
+				return false;
+			}
+
+			// The pending expressions are keyed by the name of the type, which can be a normal type or a template
+			unsigned int expression_type_count = 0;
+			for (unsigned int index = start.type_count; index < end.type_count; index++) {
+				expression_type_count += data->expressions.Find(data->types[index].name) != -1;
+			}
+			for (unsigned int index = start.type_template_count; index < end.type_template_count; index++) {
+				expression_type_count += data->expressions.Find(data->type_templates[index].base_type.name) != -1;
+			}
+			if (!write->Write(&expression_type_count)) {
+				return false;
+			}
+			for (unsigned int index = start.type_count; index < end.type_count; index++) {
+				unsigned int expression_index = data->expressions.Find(data->types[index].name);
+				if (expression_index != -1) {
+					if (!WriteReflectionParseCacheExpressions(write, data->types[index].name, data->expressions.GetValueFromIndex(expression_index))) {
+						return false;
+					}
+				}
+			}
+			for (unsigned int index = start.type_template_count; index < end.type_template_count; index++) {
+				Stream<char> type_name = data->type_templates[index].base_type.name;
+				unsigned int expression_index = data->expressions.Find(type_name);
+				if (expression_index != -1) {
+					if (!WriteReflectionParseCacheExpressions(write, type_name, data->expressions.GetValueFromIndex(expression_index))) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		static bool ReadReflectionParseCacheFileImplementation(ReadInstrument* read, ReflectionManagerParseStructuresThreadTaskData* data) {
+			AllocatorPolymorphic allocator = &data->allocator;
+
+			size_t total_memory = 0;
+			if (!read->Read(&total_memory)) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->types, [&](ReflectionParsedType& type) {
+				return ReadReflectionParseCacheType(read, allocator, &type) && ReadReflectionParseCacheString(read, allocator, type.inherit_type);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->enums, [&](ReflectionEnum& enum_) {
+				return read->Read(&enum_) && ReadReflectionParseCacheString(read, allocator, enum_.name) && ReadReflectionParseCacheStrings(read, allocator, enum_.original_fields)
+					&& ReadReflectionParseCacheStrings(read, allocator, enum_.fields);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->constants, [&](ReflectionConstant& constant) {
+				return read->Read(&constant) && ReadReflectionParseCacheString(read, allocator, constant.name);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->embedded_array_size, [&](ReflectionEmbeddedArraySize& embedded_size) {
+				return ReadReflectionParseCacheString(read, allocator, embedded_size.reflection_type) && ReadReflectionParseCacheString(read, allocator, embedded_size.field_name)
+					&& ReadReflectionParseCacheString(read, allocator, embedded_size.body);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->typedefs, [&](ReflectionParsedTypedef& typedef_) {
+				return ReadReflectionParseCacheString(read, allocator, typedef_.name) && read->Read(&typedef_.entry) 
+					&& ReadReflectionParseCacheString(read, allocator, typedef_.entry.definition);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->type_templates, [&](ReflectionTypeTemplate& type_template) {
+				if (!read->Read(&type_template) || !ReadReflectionParseCacheType(read, allocator, &type_template.base_type) 
+					|| !ReadReflectionParseCacheArray(read, allocator, type_template.arguments)) {
+					return false;
+				}
+				for (size_t index = 0; index < type_template.arguments.size; index++) {
+					ReflectionTypeTemplate::Argument& argument = type_template.arguments[index];
+					if (!ReadReflectionParseCacheString(read, allocator, argument.type_name)) {
+						return false;
+					}
+					if (argument.type == ReflectionTypeTemplate::ArgumentType::Type && argument.has_default_value) {
+						if (!ReadReflectionParseCacheString(read, allocator, argument.default_type_name)) {
+							return false;
+						}
+					}
+				}
+				return ReadReflectionParseCacheArray(read, allocator, type_template.embedded_array_sizes);
+			})) {
+				return false;
+			}
+
+			if (!ReadReflectionParseCacheRange(read, data->valid_dependencies, [&](ReflectionParsedValidDependency& valid_dependency) {
+				return ReadReflectionParseCacheString(read, allocator, valid_dependency.name);
+			})) {
+				return false;
+			}
+
+			// The expressions are inserted only after all of them were read, such that a failure leaves the table untouched
+			unsigned int expression_type_count = 0;
+			if (!read->Read(&expression_type_count) || expression_type_count > ECS_REFLECTION_PARSE_CACHE_MAX_COUNT) {
+				return false;
+			}
+			Stream<Stream<char>> expression_type_names;
+			Stream<Stream<ReflectionExpression>> expression_types;
+			expression_type_names.Initialize(allocator, expression_type_count);
+			expression_types.Initialize(allocator, expression_type_count);
+			for (unsigned int index = 0; index < expression_type_count; index++) {
+				unsigned int expression_count = 0;
+				if (!ReadReflectionParseCacheString(read, allocator, expression_type_names[index]) || !read->Read(&expression_count) 
+					|| expression_count > ECS_REFLECTION_PARSE_CACHE_MAX_COUNT) {
+					return false;
+				}
+				expression_types[index].Initialize(allocator, expression_count);
+				for (unsigned int expression_index = 0; expression_index < expression_count; expression_index++) {
+					ReflectionExpression& expression = expression_types[index][expression_index];
+					if (!ReadReflectionParseCacheString(read, allocator, expression.name) || !ReadReflectionParseCacheString(read, allocator, expression.body)) {
+						return false;
+					}
+				}
+			}
+			for (unsigned int index = 0; index < expression_type_count; index++) {
+				data->expressions.InsertDynamic(allocator, expression_types[index], expression_type_names[index]);
+			}
+
+			data->total_memory += total_memory;
+			return true;
+		}
+
+		// Adds the cached results of a file to the thread data. In case it fails, the thread data is left as it was
+		static bool ReadReflectionParseCacheFile(Stream<void> file_data, ReflectionManagerParseStructuresThreadTaskData* data) {
+			ReflectionParseFileRange initial_range = GetReflectionParseFileRange(data);
+			InMemoryReadInstrument read_instrument(file_data);
+			if (!ReadReflectionParseCacheFileImplementation(&read_instrument, data)) {
+				SetReflectionParseFileRange(data, initial_range);
+				return false;
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		// Returns false if the parse cache is disabled, else it loads the cache file of the folder hierarchy, if there is one
+		static bool BeginReflectionParseCache(const ReflectionManager* manager, unsigned int folder_index, AllocatorPolymorphic allocator, ReflectionParseCache& cache) {
+			if (manager->parse_cache_directory.size == 0) {
+				return false;
+			}
+
+			// The cache file name is derived from the root, such that multiple hierarchies can share the same directory
+			ECS_STACK_CAPACITY_STREAM(wchar_t, cache_file, 512);
+			cache_file.CopyOther(manager->parse_cache_directory);
+			cache_file.Add(ECS_OS_PATH_SEPARATOR);
+			ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(cache_file, Murmur64(manager->folders[folder_index].root));
+			cache_file.AddStreamAssert(ECS_REFLECTION_PARSE_CACHE_EXTENSION);
+
+			cache.allocator = allocator;
+			cache.file = cache_file.Copy(allocator);
+			cache.entries = {};
+			cache.next_entries.Initialize(allocator, 0);
+
+			ResizableStream<ReflectionParseCacheEntry> entries(allocator, 0);
+			FileReadInstrumentTarget read_target(cache.file, true);
+			bool success = read_target.Read(nullptr, [&](ReadInstrument* read) -> bool {
+				size_t key = 0;
+				unsigned int entry_count = 0;
+				if (!read->Read(&key) || key != GetReflectionParseCacheKey() || !read->Read(&entry_count)) {
+					return false;
+				}
+
+				for (unsigned int index = 0; index < entry_count; index++) {
+					ReflectionParseCacheEntry entry;
+					Stream<void> path;
+					if (!read->ReadWithSize<unsigned short>(path, allocator)) {
+						return false;
+					}
+					entry.path = { path.buffer, path.size / sizeof(wchar_t) };
+					if (!read->Read(&entry.last_write) || !read->Read(&entry.byte_size) || !read->Read(&entry.content_hash)) {
+						return false;
+					}
+					if (!read->ReadWithSize<unsigned int>(entry.data, allocator)) {
+						return false;
+					}
+					entries.Add(&entry);
+				}
+				return true;
+			});
+
+			// A missing or an outdated cache simply means that all the files are parsed
+			if (success) {
+				cache.entries = entries.ToStream();
+			}
+			cache.table.Initialize(allocator, HashTablePowerOfTwoCapacityForElements(cache.entries.size));
+			for (size_t index = 0; index < cache.entries.size; index++) {
+				cache.table.Insert((unsigned int)index, cache.entries[index].path);
+			}
+			return true;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		// Adds the results of the files whose cache entry is still valid to the cached data, and keeps in the path indices
+		// Only the files that must be parsed. The valid entries are carried over to the next cache
+		static void SplitReflectionParseCacheFiles(
+			ReflectionParseCache& cache,
+			Stream<Stream<wchar_t>> files,
+			unsigned int* path_indices,
+			unsigned int& path_count,
+			ReflectionManagerParseStructuresThreadTaskData* cached_data
+		) {
+			unsigned int parse_count = 0;
+			for (unsigned int index = 0; index < path_count; index++) {
+				Stream<wchar_t> path = files[path_indices[index]];
+				bool is_cached = false;
+
+				unsigned int table_index = cache.table.Find(path);
+				size_t last_write = 0;
+				if (table_index != -1 && OS::GetFileTimes(path, nullptr, nullptr, &last_write)) {
+					ReflectionParseCacheEntry entry = cache.entries[cache.table.GetValueFromIndex(table_index)];
+					size_t byte_size = GetFileByteSize(path);
+					bool is_unchanged = byte_size == entry.byte_size && last_write == entry.last_write;
+					if (!is_unchanged && byte_size == entry.byte_size) {
+						// The file was written, but its contents can still be the same (for example, after a checkout).
+						// It is read in the same way as the parse task reads it, such that the hashes can be compared
+						Stream<char> contents = ReadWholeFileText(path);
+						if (contents.buffer != nullptr) {
+							is_unchanged = Murmur64(contents) == entry.content_hash;
+							Free(contents.buffer);
+						}
+					}
+
+					if (is_unchanged && ReadReflectionParseCacheFile(entry.data, cached_data)) {
+						entry.last_write = last_write;
+						cache.next_entries.Add(&entry);
+						is_cached = true;
+					}
+				}
+
+				if (!is_cached) {
+					path_indices[parse_count++] = path_indices[index];
+				}
+			}
+			path_count = parse_count;
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
+		// Adds the entries of the files that were parsed and writes the cache file. It must be called only when the
+		// Folder hierarchy was processed successfully. Failing to write the cache is not an error, the files are parsed next time
+		static void EndReflectionParseCache(ReflectionParseCache& cache, const ReflectionManagerParseStructuresThreadTaskData* parse_data, unsigned int parse_data_count) {
+			for (unsigned int data_index = 0; data_index < parse_data_count; data_index++) {
+				const ReflectionManagerParseStructuresThreadTaskData* data = parse_data + data_index;
+				for (size_t path_index = 0; path_index < data->paths.size; path_index++) {
+					// Use the stamp of what the parse task read, the file can be changed in the meantime
+					const ReflectionParseFileStamp& file_stamp = data->file_stamps[path_index];
+					if (!file_stamp.is_valid) {
+						continue;
+					}
+
+					ReflectionParseCacheEntry entry;
+					entry.path = data->paths[path_index];
+					entry.last_write = file_stamp.last_write;
+					entry.byte_size = file_stamp.byte_size;
+					entry.content_hash = file_stamp.content_hash;
+
+					const ReflectionParseFileRange& start_range = data->file_ranges[path_index];
+					const ReflectionParseFileRange& end_range = data->file_ranges[path_index + 1];
+					SizeDeterminationWriteInstrument size_instrument;
+					WriteReflectionParseCacheFile(&size_instrument, data, start_range, end_range);
+					entry.data.size = size_instrument.write_size;
+					entry.data.buffer = Allocate(cache.allocator, entry.data.size);
+					InMemoryWriteInstrument write_instrument((uintptr_t)entry.data.buffer, entry.data.size);
+					if (WriteReflectionParseCacheFile(&write_instrument, data, start_range, end_range)) {
+						cache.next_entries.Add(&entry);
+					}
+				}
+			}
+
+			FileWriteInstrumentTarget write_target(cache.file, true);
+			write_target.Write(nullptr, [&](WriteInstrument* write) -> bool {
+				size_t key = GetReflectionParseCacheKey();
+				unsigned int entry_count = cache.next_entries.size;
+				if (!write->Write(&key) || !write->Write(&entry_count)) {
+					return false;
+				}
+
+				for (unsigned int index = 0; index < cache.next_entries.size; index++) {
+					const ReflectionParseCacheEntry& entry = cache.next_entries[index];
+					if (!write->WriteWithSize<unsigned short>(entry.path) || !write->Write(&entry.last_write) || !write->Write(&entry.byte_size)
+						|| !write->Write(&entry.content_hash) || !write->WriteWithSize<unsigned int>(entry.data)) {
+						return false;
+					}
+				}
+				return true;
+			});
+		}
+
+#pragma endregion
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
 		// It will deallocate the files
 		bool ProcessFolderHierarchyImplementation(ReflectionManager* manager, unsigned int folder_index, CapacityStream<Stream<wchar_t>> files, CapacityStream<char>* error_message) {			
-			ReflectionManagerParseStructuresThreadTaskData thread_data;
+			// When the parse cache is used, the first entry receives the cached results
+			ReflectionManagerParseStructuresThreadTaskData thread_data[2];
 
 			InitializeRuleMatchers();
 			constexpr size_t thread_memory = 5'000'000;
@@ -4319,22 +5007,50 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 			if (error_message == nullptr) {
 				error_message = &temp_error_message;
 			}
-			manager->InitializeParseThreadTaskData(thread_memory, files.size, thread_data, error_message);
 
+			ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(cache_allocator, ECS_KB * 64, ECS_MB * 16);
+			ReflectionParseCache parse_cache;
+			bool use_parse_cache = BeginReflectionParseCache(manager, folder_index, &cache_allocator, parse_cache);
+			ReflectionManagerParseStructuresThreadTaskData* parse_data = thread_data + use_parse_cache;
 			ConditionVariable condition_variable;
-			thread_data.condition_variable = &condition_variable;
+
+			unsigned int* path_indices = (unsigned int*)cache_allocator.Allocate(sizeof(unsigned int) * files.size);
+			unsigned int path_count = files.size;
+			for (unsigned int index = 0; index < files.size; index++) {
+				path_indices[index] = index;
+			}
+			if (use_parse_cache) {
+				manager->InitializeParseThreadTaskData(0, 0, thread_data[0], error_message);
+				thread_data[0].condition_variable = &condition_variable;
+				// Only the files that have something to reflect are cached
+				path_count = 0;
+				for (unsigned int index = 0; index < files.size; index++) {
+					if (HasReflectStructures(files[index])) {
+						path_indices[path_count++] = index;
+					}
+				}
+				SplitReflectionParseCacheFiles(parse_cache, files, path_indices, path_count, thread_data);
+			}
+
+			manager->InitializeParseThreadTaskData(thread_memory, path_count, *parse_data, error_message);
+			parse_data->condition_variable = &condition_variable;
 			// Assigning paths
-			for (size_t path_index = 0; path_index < files.size; path_index++) {
-				thread_data.paths[path_index] = files[path_index];
+			for (unsigned int path_index = 0; path_index < path_count; path_index++) {
+				parse_data->paths[path_index] = files[path_indices[path_index]];
 			}
 
-			ReflectionManagerParseThreadTask(0, nullptr, &thread_data);
-			bool success = thread_data.success;
-			if (thread_data.success == true) {
-				success = manager->BindApprovedData(&thread_data, 1, folder_index);
+			ReflectionManagerParseThreadTask(0, nullptr, parse_data);
+			bool success = parse_data->success;
+			if (success) {
+				success = manager->BindApprovedData(thread_data, 1 + use_parse_cache, folder_index);
+				if (success && use_parse_cache) {
+					EndReflectionParseCache(parse_cache, parse_data, 1);
+				}
 			}
 
-			manager->DeallocateThreadTaskData(thread_data);
+			for (unsigned int index = 0; index < 1 + use_parse_cache; index++) {
+				manager->DeallocateThreadTaskData(thread_data[index]);
+			}
 			for (size_t index = 0; index < files.size; index++) {
 				Deallocate(manager->folders.allocator, files[index].buffer);
 			}
@@ -4425,9 +5141,6 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 
 			reflect_semaphore.SpinWait();
 
-			unsigned int parse_per_thread_paths = path_indices.size / thread_count;
-			unsigned int parse_thread_paths_remainder = path_indices.size % thread_count;
-
 			constexpr size_t THREAD_MEMORY = 10'000'000;
 			ConditionVariable condition_variable;
 
@@ -4436,10 +5149,27 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 				error_message = &temp_error_message;
 			}
 
-			unsigned int parse_thread_count = parse_per_thread_paths == 0 ? parse_thread_paths_remainder : thread_count;
-			ReflectionManagerParseStructuresThreadTaskData* parse_thread_data = (ReflectionManagerParseStructuresThreadTaskData*)stack_allocator.Allocate(
-				sizeof(ReflectionManagerParseStructuresThreadTaskData) * thread_count
+			ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(cache_allocator, ECS_KB * 64, ECS_MB * 16);
+			ReflectionParseCache parse_cache;
+			bool use_parse_cache = BeginReflectionParseCache(this, folder_index, &cache_allocator, parse_cache);
+
+			// When the parse cache is used, the first entry receives the cached results, such that all entries can be bound at once
+			ReflectionManagerParseStructuresThreadTaskData* thread_data = (ReflectionManagerParseStructuresThreadTaskData*)stack_allocator.Allocate(
+				sizeof(ReflectionManagerParseStructuresThreadTaskData) * (thread_count + 1)
 			);
+			ReflectionManagerParseStructuresThreadTaskData* parse_thread_data = thread_data + use_parse_cache;
+			if (use_parse_cache) {
+				InitializeParseThreadTaskData(0, 0, thread_data[0], error_message);
+				thread_data[0].condition_variable = &condition_variable;
+				// Only the files that changed remain to be parsed
+				unsigned int path_count = path_indices.size;
+				SplitReflectionParseCacheFiles(parse_cache, *files.capacity_stream, path_indices.buffer, path_count, thread_data);
+				path_indices.size = path_count;
+			}
+
+			unsigned int parse_per_thread_paths = path_indices.size / thread_count;
+			unsigned int parse_thread_paths_remainder = path_indices.size % thread_count;
+			unsigned int parse_thread_count = parse_per_thread_paths == 0 ? parse_thread_paths_remainder : thread_count;
 
 			unsigned int parse_thread_start = 0;
 			for (size_t thread_index = 0; thread_index < parse_thread_count; thread_index++) {
@@ -4466,7 +5196,9 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 			}
 
 			// Wait until the threads are done
-			condition_variable.Wait(parse_thread_count);
+			if (parse_thread_count > 0) {
+				condition_variable.Wait(parse_thread_count);
+			}
 
 			bool success = true;
 			
@@ -4481,12 +5213,15 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 			}
 
 			if (success) {
-				success = BindApprovedData(parse_thread_data, parse_thread_count, folder_index);
+				success = BindApprovedData(thread_data, parse_thread_count + use_parse_cache, folder_index);
+				if (success && use_parse_cache) {
+					EndReflectionParseCache(parse_cache, parse_thread_data, parse_thread_count);
+				}
 			}
 
 			// Free the previously allocated memory
-			for (size_t thread_index = 0; thread_index < parse_thread_count; thread_index++) {
-				DeallocateThreadTaskData(parse_thread_data[thread_index]);
+			for (size_t thread_index = 0; thread_index < parse_thread_count + use_parse_cache; thread_index++) {
+				DeallocateThreadTaskData(thread_data[thread_index]);
 			}
 			Deallocate(folders.allocator, path_indices_buffer);
 			for (size_t index = 0; index < files.Size(); index++) {
@@ -4698,6 +5433,22 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 
 		// ----------------------------------------------------------------------------------------------------------------------------
 
+		void ReflectionManager::SetParseCacheDirectory(Stream<wchar_t> directory)
+		{
+			if (parse_cache_directory.size > 0) {
+				Deallocate(folders.allocator, parse_cache_directory.buffer);
+			}
+			parse_cache_directory = {};
+			if (directory.size > 0) {
+				parse_cache_directory = directory.Copy(folders.allocator);
+				if (!ExistsFileOrFolder(directory)) {
+					CreateFolder(directory);
+				}
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------------------------------------------
+
 		void ReflectionManager::SetTypeByteSize(ReflectionType* type, size_t byte_size)
 		{
 			type->byte_size = byte_size;
@@ -4763,6 +5514,10 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 
 			// search every path
 			for (size_t index = 0; index < data->paths.size; index++) {
+				data->file_ranges.Add(GetReflectionParseFileRange(data));
+				data->file_stamps.Add(ReflectionParseFileStamp{});
+				size_t last_write = 0;
+				bool has_last_write = OS::GetFileTimes(data->paths[index], nullptr, nullptr, &last_write);
 				ECS_FILE_HANDLE file = 0;
 				// open the file from the beginning
 				ECS_FILE_STATUS_FLAGS status = OpenFile(data->paths[index], &file, ECS_FILE_ACCESS_TEXT | ECS_FILE_ACCESS_READ_ONLY);
@@ -4803,6 +5558,14 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 						unsigned int bytes_read = ReadFromFile(file, { file_contents, file_size });
 						Stream<char> content = { file_contents, bytes_read };
 
+						if (has_last_write && bytes_read != -1) {
+							ReflectionParseFileStamp* file_stamp = &data->file_stamps[index];
+							file_stamp->last_write = last_write;
+							file_stamp->byte_size = file_size;
+							file_stamp->content_hash = Murmur64(content);
+							file_stamp->is_valid = true;
+						}
+
 						// Eliminate all comments
 						content = RemoveSingleLineComment(content, ECS_C_FILE_SINGLE_LINE_COMMENT_TOKEN);
 						content = RemoveMultiLineComments(content, ECS_C_FILE_MULTI_LINE_COMMENT_OPENED_TOKEN, ECS_C_FILE_MULTI_LINE_COMMENT_CLOSED_TOKEN);
@@ -5282,8 +6045,26 @@ COMPLEX_TYPE(u##base##4, ReflectionBasicFieldType::U##basic_reflect##4, Reflecti
 							}
 						}
 					}
+					else if (has_last_write) {
+						// Nothing to reflect, but the file is still stamped such that the cache can skip it the next time.
+						// The file is read again in the same mode, such that the hash matches the one of the cache check
+						size_t file_size = GetFileByteSize(file);
+						SetFileCursor(file, 0, ECS_FILE_SEEK_BEG);
+						Stream<char> file_contents = { (char*)Malloc(file_size + 1), 0 };
+						size_t bytes_read = ReadFromFile(file, { file_contents.buffer, file_size });
+						if (bytes_read != -1) {
+							file_contents.size = bytes_read;
+							ReflectionParseFileStamp* file_stamp = &data->file_stamps[index];
+							file_stamp->last_write = last_write;
+							file_stamp->byte_size = file_size;
+							file_stamp->content_hash = Murmur64(file_contents);
+							file_stamp->is_valid = true;
+						}
+						Free(file_contents.buffer);
+					}
 				}
 			}
+			data->file_ranges.Add(GetReflectionParseFileRange(data));
 
 			data->condition_variable->Notify();
 		}
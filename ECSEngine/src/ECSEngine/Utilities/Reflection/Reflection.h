@@ -305,6 +305,11 @@ namespace ECSEngine {
 			// It will set the fields of the data according to the defaults
 			void SetInstanceFieldDefaultData(const ReflectionField* field, void* data, bool offset_data = true) const;
 
+			// The parse results of each source file are cached in this directory, one file per folder hierarchy, such that
+			// Processing or updating a hierarchy parses again only the files whose contents changed. The directory is created
+			// If it doesn't exist. An empty directory disables the cache, which is the default
+			void SetParseCacheDirectory(Stream<wchar_t> directory);
+
 			// If ignoring some fields, you can set this value manually in order
 			// to correctly have the byte size
 			void SetTypeByteSize(ReflectionType* type, size_t byte_size);
@@ -325,6 +330,8 @@ namespace ECSEngine {
 			ResizableStream<FolderHierarchy> folders;
 			ResizableStream<ReflectionConstant> constants;
 			ResizableStream<BlittableType> blittable_types;
+			// Allocated from the folders allocator. Empty when the parse cache is disabled
+			Stream<wchar_t> parse_cache_directory = {};
 		};
 
 		// This structure contains information that upper level types
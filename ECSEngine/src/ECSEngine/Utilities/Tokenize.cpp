@@ -2114,6 +2114,7 @@ namespace ECSEngine {
 	}
 
 	void TokenizeRuleMatcher::AddExcludeRule(const TokenizeRule& rule, bool deep_copy) {
+		is_compiled = false;
 		if (deep_copy) {
 			exclude_rules.Add(rule.Copy(Allocator()));
 		}
@@ -2123,6 +2124,7 @@ namespace ECSEngine {
 	}
 
 	void TokenizeRuleMatcher::AddPreExcludeAction(const TokenizeRuleAction& action, bool deep_copy) {
+		is_compiled = false;
 		TokenizeRuleAction copy;
 		const TokenizeRuleAction* action_pointer = &action;
 		if (deep_copy) {
@@ -2135,6 +2137,7 @@ namespace ECSEngine {
 	}
 
 	void TokenizeRuleMatcher::AddPostExcludeAction(const TokenizeRuleAction& action, bool deep_copy) {
+		is_compiled = false;
 		TokenizeRuleAction copy;
 		const TokenizeRuleAction* action_pointer = &action;
 		if (deep_copy) {
@@ -2146,6 +2149,151 @@ namespace ECSEngine {
 		post_exclude_actions.Add(action_pointer);
 	}
 
+	// Adds the bit to the mask of the given string, in the compiled table
+	static void AddTokenizeMatcherStringMask(TokenizeRuleMatcher* matcher, Stream<char> string, size_t bit) {
+		size_t* mask = matcher->compiled_string_masks.TryGetValuePtr(string);
+		if (mask != nullptr) {
+			*mask |= bit;
+		}
+		else {
+			matcher->compiled_string_masks.InsertDynamic(matcher->Allocator(), bit, string);
+		}
+	}
+
+	// Adds the bit to the mask of the given token type, in the compiled table
+	static void AddTokenizeMatcherTypeMask(TokenizeRuleMatcher* matcher, unsigned int type, size_t bit) {
+		size_t* mask = matcher->compiled_type_masks.TryGetValuePtr(type);
+		if (mask != nullptr) {
+			*mask |= bit;
+		}
+		else {
+			matcher->compiled_type_masks.InsertDynamic(matcher->Allocator(), bit, type);
+		}
+	}
+
+	static bool AddTokenizeRuleFirstTokens(TokenizeRuleMatcher* matcher, const TokenizeRule& rule, size_t bit);
+
+	// Adds the bit to the masks of the tokens that the entry can start with. Returns true if the entry can
+	// Match zero tokens, in which case the tokens of the entry that follows it can start the match as well
+	static bool AddTokenizeEntryFirstTokens(TokenizeRuleMatcher* matcher, const TokenizeRuleEntry& entry, size_t bit) {
+		bool can_be_empty = entry.count_type == ECS_TOKENIZE_RULE_ZERO_OR_ONE || entry.count_type == ECS_TOKENIZE_RULE_ZERO_OR_MORE;
+		if (entry.is_selection_negated) {
+			// A negated selection accepts almost any token, and a negated $T can match zero tokens when backtracking
+			matcher->compiled_any_token_mask |= bit;
+			return can_be_empty || entry.selection_type == ECS_TOKENIZE_RULE_SELECTION_ANY;
+		}
+
+		switch (entry.selection_type) {
+		case ECS_TOKENIZE_RULE_SELECTION_ANY:
+			matcher->compiled_any_token_mask |= bit;
+			break;
+		case ECS_TOKENIZE_RULE_SELECTION_GENERAL:
+			matcher->compiled_general_token_mask |= bit;
+			break;
+		case ECS_TOKENIZE_RULE_SELECTION_SEPARATOR:
+			matcher->compiled_separator_token_mask |= bit;
+			break;
+		case ECS_TOKENIZE_RULE_SELECTION_MATCH_BY_STRING:
+		{
+			if (entry.selection_data.is_multiple_strings) {
+				for (size_t index = 0; index < entry.selection_data.strings.size; index++) {
+					AddTokenizeMatcherStringMask(matcher, entry.selection_data.strings[index], bit);
+				}
+			}
+			else {
+				AddTokenizeMatcherStringMask(matcher, entry.selection_data.string, bit);
+			}
+		}
+		break;
+		case ECS_TOKENIZE_RULE_SELECTION_MATCH_BY_TYPE:
+		{
+			if (entry.selection_data.is_multiple_type_indices) {
+				for (size_t index = 0; index < entry.selection_data.type_indices.size; index++) {
+					AddTokenizeMatcherTypeMask(matcher, entry.selection_data.type_indices[index], bit);
+				}
+			}
+			else {
+				AddTokenizeMatcherTypeMask(matcher, entry.selection_data.type_index, bit);
+			}
+		}
+		break;
+		case ECS_TOKENIZE_RULE_SELECTION_MATCH_BY_SUBRULE:
+			can_be_empty |= AddTokenizeRuleFirstTokens(matcher, entry.selection_data.subrule, bit);
+			break;
+		default:
+			ECS_ASSERT(false, "Invalid tokenize rule selection type");
+		}
+		return can_be_empty;
+	}
+
+	// Adds the bit to the masks of the tokens that any of the sets of the rule can start with.
+	// Returns true if one of the sets can match zero tokens
+	static bool AddTokenizeRuleFirstTokens(TokenizeRuleMatcher* matcher, const TokenizeRule& rule, size_t bit) {
+		bool can_be_empty = false;
+		for (size_t set_index = 0; set_index < rule.sets.size; set_index++) {
+			Stream<TokenizeRuleEntry> set = rule.sets[set_index].entries;
+			size_t entry_index = 0;
+			for (; entry_index < set.size; entry_index++) {
+				if (!AddTokenizeEntryFirstTokens(matcher, set[entry_index], bit)) {
+					break;
+				}
+			}
+			can_be_empty |= entry_index == set.size;
+		}
+		return can_be_empty;
+	}
+
+	void TokenizeRuleMatcher::Compile() {
+		size_t rule_count = pre_exclude_actions.size + exclude_rules.size + post_exclude_actions.size;
+		ECS_ASSERT(rule_count <= sizeof(size_t) * 8, "A TokenizeRuleMatcher can compile at most 64 rules and actions");
+
+		compiled_string_masks.Deallocate(Allocator());
+		compiled_type_masks.Deallocate(Allocator());
+		compiled_string_masks.Initialize(Allocator(), 32);
+		compiled_type_masks.Initialize(Allocator(), 16);
+		compiled_any_token_mask = 0;
+		compiled_general_token_mask = 0;
+		compiled_separator_token_mask = 0;
+
+		// A match cannot be empty, since the matchers advance by at least a token, so the sets that
+		// Can match zero tokens don't need any special handling
+		size_t rule_index = 0;
+		for (unsigned int index = 0; index < pre_exclude_actions.size; index++) {
+			AddTokenizeRuleFirstTokens(this, pre_exclude_actions[index].rule, (size_t)1 << rule_index++);
+		}
+		for (unsigned int index = 0; index < exclude_rules.size; index++) {
+			AddTokenizeRuleFirstTokens(this, exclude_rules[index], (size_t)1 << rule_index++);
+		}
+		for (unsigned int index = 0; index < post_exclude_actions.size; index++) {
+			AddTokenizeRuleFirstTokens(this, post_exclude_actions[index].rule, (size_t)1 << rule_index++);
+		}
+		is_compiled = true;
+	}
+
+	size_t TokenizeRuleMatcher::GetCandidateRuleMask(const TokenizedString& string, unsigned int token_index) const {
+		if (!is_compiled) {
+			return SIZE_MAX;
+		}
+
+		size_t mask = compiled_any_token_mask;
+		unsigned int token_type = string.tokens[token_index].type;
+		if (token_type == ECS_TOKEN_TYPE_GENERAL) {
+			mask |= compiled_general_token_mask;
+		}
+		else if (token_type == ECS_TOKEN_TYPE_SEPARATOR) {
+			mask |= compiled_separator_token_mask;
+		}
+
+		size_t table_mask = 0;
+		if (compiled_type_masks.TryGetValue(token_type, table_mask)) {
+			mask |= table_mask;
+		}
+		if (compiled_string_masks.TryGetValue(string[token_index], table_mask)) {
+			mask |= table_mask;
+		}
+		return mask;
+	}
+
 	void TokenizeRuleMatcher::Deallocate(bool deallocate_exclude_rules, bool deallocate_actions) {
 		if (deallocate_exclude_rules) {
 			StreamDeallocateElements(exclude_rules, Allocator());
@@ -2165,6 +2313,9 @@ namespace ECSEngine {
 		pre_exclude_actions.FreeBuffer();
 		post_exclude_actions.FreeBuffer();
 		custom_subrange_order.FreeBuffer();
+		compiled_string_masks.Deallocate(Allocator());
+		compiled_type_masks.Deallocate(Allocator());
+		is_compiled = false;
 	}
 
 	void TokenizeRuleMatcher::Initialize(AllocatorPolymorphic allocator) {
@@ -2172,6 +2323,9 @@ namespace ECSEngine {
 		pre_exclude_actions.Initialize(allocator, 0);
 		post_exclude_actions.Initialize(allocator, 0);
 		custom_subrange_order.Initialize(allocator, 0);
+		is_compiled = false;
+		compiled_string_masks.Reset();
+		compiled_type_masks.Reset();
 	}
 
 	ECS_TOKENIZE_MATCHER_RESULT TokenizeRuleMatcher::MatchBacktracking(const TokenizedString& string, TokenizedString::Subrange subrange, void* call_specific_data) const {
@@ -2188,6 +2342,9 @@ namespace ECSEngine {
 		}
 
 		while (subrange.count > 0) {
+			// All the tested subranges start with the same token, so the rules that cannot start with it are skipped
+			size_t candidate_mask = GetCandidateRuleMask(string, subrange[0]);
+
 			// Returns 2 boolean values. The first one indicates whether the subrange was matched, and the second one
 			// If the action callback returned true, to early exit
 			auto test_subrange_count = [&](unsigned int sequence_count) -> bool2 {
@@ -2196,6 +2353,9 @@ namespace ECSEngine {
 				// Try the pre exclude rules first
 				unsigned int pre_action_rule_index = 0;
 				for (; pre_action_rule_index < pre_exclude_actions.size; pre_action_rule_index++) {
+					if (!IsCandidateRule(candidate_mask, pre_action_rule_index)) {
+						continue;
+					}
 					unsigned int set_index_that_matched = -1;
 					if (MatchTokenizeRuleBacktracking(string, current_subrange, pre_exclude_actions[pre_action_rule_index].rule, &set_index_that_matched)) {
 						TokenizeRuleCallbackData callback_data(string);
@@ -2216,7 +2376,7 @@ namespace ECSEngine {
 				// Try to match the exclude rules now
 				unsigned int exclude_index = 0;
 				for (; exclude_index < exclude_rules.size; exclude_index++) {
-					if (MatchTokenizeRuleBacktracking(string, current_subrange, exclude_rules[exclude_index])) {
+					if (IsCandidateRule(candidate_mask, pre_exclude_actions.size + exclude_index) && MatchTokenizeRuleBacktracking(string, current_subrange, exclude_rules[exclude_index])) {
 						return { true, false };
 					}
 				}
@@ -2224,6 +2384,9 @@ namespace ECSEngine {
 				// The exclude rules did not match this subrange, try the post exclude rules
 				unsigned int post_action_rule_index = 0;
 				for (; post_action_rule_index < post_exclude_actions.size; post_action_rule_index++) {
+					if (!IsCandidateRule(candidate_mask, pre_exclude_actions.size + exclude_rules.size + post_action_rule_index)) {
+						continue;
+					}
 					unsigned int set_index_that_matched = -1;
 					if (MatchTokenizeRuleBacktracking(string, current_subrange, post_exclude_actions[post_action_rule_index].rule, &set_index_that_matched)) {
 						TokenizeRuleCallbackData callback_data(string);
@@ -2333,8 +2496,13 @@ namespace ECSEngine {
 
 		while (subrange.count > 0) {
 			matched_entries.Clear();
+			// Only the rules that can start with the current token need to be evaluated
+			size_t candidate_mask = GetCandidateRuleMask(string, subrange[0]);
 
 			for (size_t index = 0; index < pre_exclude_actions.size; index++) {
+				if (!IsCandidateRule(candidate_mask, index)) {
+					continue;
+				}
 				unsigned int set_index = 0;
 				unsigned int current_count = FindTokenizeRuleMatchingRange(string, pre_exclude_actions[index].rule, subrange, &set_index);
 				if (current_count != -1) {
@@ -2343,6 +2511,9 @@ namespace ECSEngine {
 			}
 
 			for (size_t index = 0; index < exclude_rules.size; index++) {
+				if (!IsCandidateRule(candidate_mask, pre_exclude_actions.size + index)) {
+					continue;
+				}
 				unsigned int set_index = 0;
 				unsigned int current_count = FindTokenizeRuleMatchingRange(string, exclude_rules[index], subrange, &set_index);
 				if (current_count != -1) {
@@ -2351,6 +2522,9 @@ namespace ECSEngine {
 			}
 
 			for (size_t index = 0; index < post_exclude_actions.size; index++) {
+				if (!IsCandidateRule(candidate_mask, pre_exclude_actions.size + exclude_rules.size + index)) {
+					continue;
+				}
 				unsigned int set_index = 0;
 				unsigned int current_count = FindTokenizeRuleMatchingRange(string, post_exclude_actions[index].rule, subrange, &set_index);
 				if (current_count != -1) {
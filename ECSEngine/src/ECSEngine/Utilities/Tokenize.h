@@ -2,6 +2,7 @@
 #include "../Core.h"
 #include "BasicTypes.h"
 #include "../Containers/Stream.h"
+#include "../Containers/HashTable.h"
 #include <vector>
 
 namespace ECSEngine {
@@ -336,11 +337,26 @@ namespace ECSEngine {
 		// By default, it will make a deep copy of both the rule and the callback. You can disable that with the last argument
 		void AddPostExcludeAction(const TokenizeRuleAction& action, bool deep_copy = true);
 
+		// Builds a table out of the tokens that each rule can start with, such that the match functions look up the current
+		// Token once for all rules and evaluate only the rules that can accept it, instead of trying every rule at every position.
+		// The matches are the same as without it. Adding rules or actions discards the table, so this needs to be called again
+		// Afterwards. At most 64 rules and actions, in total, can be compiled
+		void Compile();
+
 		// If no deep copies were made per each type, you can omit them from deallocating
 		void Deallocate(bool deallocate_exclude_rules = true, bool deallocate_actions = true);
 
+		// Returns a mask with the bits of the rules that can start at the given token. The bits are assigned in the order
+		// Pre exclude actions, exclude rules and post exclude actions. If the matcher is not compiled, all bits are set
+		size_t GetCandidateRuleMask(const TokenizedString& string, unsigned int token_index) const;
+
 		void Initialize(AllocatorPolymorphic allocator);
 
+		// The rule index is in the order pre exclude actions, exclude rules and post exclude actions
+		ECS_INLINE bool IsCandidateRule(size_t candidate_mask, size_t rule_index) const {
+			return !is_compiled || (candidate_mask & ((size_t)1 << rule_index)) != 0;
+		}
+
 		// It will match the given token string subrange with the stored actions, by using a backtracking search. It returns true if it early existed, else false.
 		// The call specific data will be passed to callbacks, to use it as they see fit
 		ECS_TOKENIZE_MATCHER_RESULT MatchBacktracking(const TokenizedString& string, TokenizedString::Subrange subrange, void* call_specific_data) const;
@@ -361,6 +377,15 @@ namespace ECSEngine {
 		// The user can supplies the order the subranges are tested in, such that the rule has a chance
 		// To be called on a subrange count value before another one
 		ResizableStream<unsigned int> custom_subrange_order;
+
+		// The fields below are filled in by Compile
+		bool is_compiled;
+		// The rules that can start with any token, because of $T or negated selections
+		size_t compiled_any_token_mask;
+		size_t compiled_general_token_mask;
+		size_t compiled_separator_token_mask;
+		HashTableDefault<size_t> compiled_string_masks;
+		HashTable<size_t, unsigned int, HashFunctionPowerOfTwo> compiled_type_masks;
 	};
 
 	// The rules for a TokenizeRule made out of strings - which is easier to write down than to create each individual
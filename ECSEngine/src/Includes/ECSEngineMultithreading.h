@@ -3,4 +3,5 @@
 #include "../ECSEngine/Multithreading/TaskManager.h"
 #include "../ECSEngine/Multithreading/ConcurrentPrimitives.h"
 #include "../ECSEngine/Multithreading/TaskScheduler.h"
-#include "../ECSEngine/Multithreading/TaskStealing.h"
\ No newline at end of file
+#include "../ECSEngine/Multithreading/TaskStealing.h"
+#include "../ECSEngine/Multithreading/ParallelFor.h"
\ No newline at end of file
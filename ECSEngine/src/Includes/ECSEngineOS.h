@@ -4,6 +4,7 @@
 #include "../ECSEngine/OS/ExceptionHandling.h"
 #include "../ECSEngine/OS/FileExplorer.h"
 #include "../ECSEngine/OS/FileOS.h"
+#include "../ECSEngine/OS/FileWatcher.h"
 #include "../ECSEngine/OS/Memory.h"
 #include "../ECSEngine/OS/Misc.h"
 #include "../ECSEngine/OS/Thread.h"
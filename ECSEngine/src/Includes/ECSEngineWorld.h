@@ -4,4 +4,6 @@
 // Include the archetype query cache since it may get used
 #include "../ECSEngine/ECS/ArchetypeQueryCache.h"
 // Include the crash wrapper as well
-#include "../ECSEngine/ECS/WorldCrashHandler.h"
\ No newline at end of file
+#include "../ECSEngine/ECS/WorldCrashHandler.h"
+// The headless runner for the batch and determinism runs
+#include "../ECSEngine/ECS/HeadlessWorldRunner.h"
\ No newline at end of file
@@ -1547,10 +1547,18 @@ enum GetOutOfDateAssetsType {
 	GET_OUT_OF_DATE_ASSETS_TARGET
 };
 
+// When the candidate handles are specified, only those are checked, else all the assets are checked
 template<GetOutOfDateAssetsType stamp_type>
-Stream<Stream<unsigned int>> GetOutOfDateAssetsImpl(EditorState* editor_state, AllocatorPolymorphic allocator, bool update_stamp, bool include_dependencies) {
+Stream<Stream<unsigned int>> GetOutOfDateAssetsImpl(
+	EditorState* editor_state, 
+	AllocatorPolymorphic allocator, 
+	bool update_stamp, 
+	bool include_dependencies, 
+	Stream<Stream<unsigned int>> candidate_handles = {}
+) {
 	Stream<Stream<unsigned int>> handles;
 	handles.Initialize(allocator, ECS_ASSET_TYPE_COUNT);
+	unsigned int handle_capacities[ECS_ASSET_TYPE_COUNT];
 
 	ECS_STACK_CAPACITY_STREAM(wchar_t, assets_folder, 512);
 	if constexpr (stamp_type == GET_OUT_OF_DATE_ASSETS_BOTH || stamp_type == GET_OUT_OF_DATE_ASSETS_TARGET) {
@@ -1560,12 +1568,14 @@ Stream<Stream<unsigned int>> GetOutOfDateAssetsImpl(EditorState* editor_state, A
 	ECS_STACK_CAPACITY_STREAM(unsigned int, out_of_date_temporary, ECS_KB * 8);
 	for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
 		ECS_ASSET_TYPE current_type = (ECS_ASSET_TYPE)index;
-		unsigned int asset_count = editor_state->asset_database->GetAssetCount(current_type);
+		unsigned int asset_count = candidate_handles.size > 0 ? (unsigned int)candidate_handles[current_type].size : editor_state->asset_database->GetAssetCount(current_type);
 		handles[current_type].Initialize(allocator, asset_count);
 		handles[current_type].size = 0;
+		handle_capacities[current_type] = asset_count;
 
 		for (unsigned int subindex = 0; subindex < asset_count; subindex++) {
-			unsigned int current_handle = editor_state->asset_database->GetAssetHandleFromIndex(subindex, current_type);
+			unsigned int current_handle = candidate_handles.size > 0 ? candidate_handles[current_type][subindex] 
+				: editor_state->asset_database->GetAssetHandleFromIndex(subindex, current_type);
 			const void* metadata = editor_state->asset_database->GetAssetConst(current_handle, current_type);
 			size_t external_time_stamp = 0;
 			if constexpr (stamp_type == GET_OUT_OF_DATE_ASSETS_BOTH) {
@@ -1602,7 +1612,7 @@ Stream<Stream<unsigned int>> GetOutOfDateAssetsImpl(EditorState* editor_state, A
 		// Use the capacity streams as a way to resize when there is not enough capacity
 		ECS_STACK_CAPACITY_STREAM(CapacityStream<unsigned int>, current_handles, ECS_ASSET_TYPE_COUNT);
 		for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
-			current_handles[index] = { handles[index].buffer, (unsigned int)handles[index].size, editor_state->asset_database->GetAssetCount((ECS_ASSET_TYPE)index) };
+			current_handles[index] = { handles[index].buffer, (unsigned int)handles[index].size, handle_capacities[index] };
 		}
 
 		for (size_t index = 0; index < std::size(ECS_ASSET_TYPES_WITH_DEPENDENCIES); index++) {
@@ -1664,6 +1674,104 @@ Stream<Stream<unsigned int>> GetOutOfDateAssetsTargetFile(EditorState* editor_st
 
 // ----------------------------------------------------------------------------------------------
 
+Stream<Stream<unsigned int>> GetOutOfDateAssetsMetadataFrom(
+	EditorState* editor_state, 
+	Stream<Stream<unsigned int>> candidate_handles, 
+	AllocatorPolymorphic allocator, 
+	bool update_stamp, 
+	bool include_dependencies
+)
+{
+	ECS_ASSERT(candidate_handles.size == ECS_ASSET_TYPE_COUNT);
+	return GetOutOfDateAssetsImpl<GET_OUT_OF_DATE_ASSETS_METADATA>(editor_state, allocator, update_stamp, include_dependencies, candidate_handles);
+}
+
+// ----------------------------------------------------------------------------------------------
+
+Stream<Stream<unsigned int>> GetOutOfDateAssetsTargetFileFrom(
+	EditorState* editor_state, 
+	Stream<Stream<unsigned int>> candidate_handles, 
+	AllocatorPolymorphic allocator, 
+	bool update_stamp, 
+	bool include_dependencies
+)
+{
+	ECS_ASSERT(candidate_handles.size == ECS_ASSET_TYPE_COUNT);
+	return GetOutOfDateAssetsImpl<GET_OUT_OF_DATE_ASSETS_TARGET>(editor_state, allocator, update_stamp, include_dependencies, candidate_handles);
+}
+
+// ----------------------------------------------------------------------------------------------
+
+// The paths are compared with the absolute separator, since the relative asset files can use the relative one
+static void NormalizeChangedFilePath(Stream<wchar_t> path) {
+	ReplaceCharacter(path, ECS_OS_PATH_SEPARATOR_REL, ECS_OS_PATH_SEPARATOR);
+}
+
+void GetAssetsForChangedFiles(
+	const EditorState* editor_state,
+	Stream<Stream<wchar_t>> changed_files,
+	AllocatorPolymorphic allocator,
+	Stream<Stream<unsigned int>>& metadata_handles,
+	Stream<Stream<unsigned int>>& target_file_handles
+) {
+	metadata_handles.Initialize(allocator, ECS_ASSET_TYPE_COUNT);
+	target_file_handles.Initialize(allocator, ECS_ASSET_TYPE_COUNT);
+
+	HashTableDefault<bool> changed_table;
+	changed_table.Initialize(allocator, HashTablePowerOfTwoCapacityForElements(changed_files.size));
+	for (size_t index = 0; index < changed_files.size; index++) {
+		Stream<wchar_t> normalized_path = changed_files[index].Copy(allocator);
+		NormalizeChangedFilePath(normalized_path);
+		if (changed_table.Find(normalized_path) == -1) {
+			changed_table.InsertDynamic(allocator, true, normalized_path);
+		}
+	}
+
+	auto is_changed = [&](Stream<wchar_t> path) {
+		NormalizeChangedFilePath(path);
+		return changed_table.Find(path) != -1;
+	};
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, assets_folder, 512);
+	GetProjectAssetsFolder(editor_state, assets_folder);
+
+	// Building the paths of the assets is only string work, the disk is not accessed
+	for (size_t index = 0; index < ECS_ASSET_TYPE_COUNT; index++) {
+		ECS_ASSET_TYPE current_type = (ECS_ASSET_TYPE)index;
+		unsigned int asset_count = editor_state->asset_database->GetAssetCount(current_type);
+		ResizableStream<unsigned int> current_metadata_handles(allocator, 0);
+		ResizableStream<unsigned int> current_target_file_handles(allocator, 0);
+
+		for (unsigned int subindex = 0; subindex < asset_count; subindex++) {
+			unsigned int handle = editor_state->asset_database->GetAssetHandleFromIndex(subindex, current_type);
+			const void* metadata = editor_state->asset_database->GetAssetConst(handle, current_type);
+
+			ECS_STACK_CAPACITY_STREAM(wchar_t, metadata_path, 512);
+			AssetMetadataTimeStampPath(editor_state, metadata, current_type, metadata_path);
+			if (is_changed(metadata_path)) {
+				current_metadata_handles.Add(handle);
+			}
+
+			ECS_STACK_CAPACITY_STREAM(wchar_t, target_file_storage, 512);
+			Stream<wchar_t> target_file = AssetTargetFileTimeStampPath(metadata, current_type, assets_folder, target_file_storage);
+			if (target_file.size > 0) {
+				// The absolute files are returned as is, they need to be copied for the normalization
+				if (target_file.buffer != target_file_storage.buffer) {
+					target_file_storage.CopyOther(target_file);
+				}
+				if (is_changed(target_file_storage)) {
+					current_target_file_handles.Add(handle);
+				}
+			}
+		}
+
+		metadata_handles[current_type] = current_metadata_handles.ToStream();
+		target_file_handles[current_type] = current_target_file_handles.ToStream();
+	}
+}
+
+// ----------------------------------------------------------------------------------------------
+
 Stream<Stream<unsigned int>> GetDependentAssetsFor(
 	const EditorState* editor_state, 
 	const void* metadata, 
@@ -310,6 +310,34 @@ Stream<Stream<unsigned int>> GetOutOfDateAssetsMetadata(EditorState* editor_stat
 // outdated list of assets
 Stream<Stream<unsigned int>> GetOutOfDateAssetsTargetFile(EditorState* editor_state, AllocatorPolymorphic allocator, bool update_stamp = true, bool include_dependencies = true);
 
+// The same as GetOutOfDateAssetsMetadata, but only the candidate handles, given per asset type, are checked
+Stream<Stream<unsigned int>> GetOutOfDateAssetsMetadataFrom(
+	EditorState* editor_state, 
+	Stream<Stream<unsigned int>> candidate_handles, 
+	AllocatorPolymorphic allocator, 
+	bool update_stamp = true, 
+	bool include_dependencies = true
+);
+
+// The same as GetOutOfDateAssetsTargetFile, but only the candidate handles, given per asset type, are checked
+Stream<Stream<unsigned int>> GetOutOfDateAssetsTargetFileFrom(
+	EditorState* editor_state,
+	Stream<Stream<unsigned int>> candidate_handles,
+	AllocatorPolymorphic allocator,
+	bool update_stamp = true,
+	bool include_dependencies = true
+);
+
+// Fills in, per asset type, the handles of the assets whose metadata file is one of the changed files and separately
+// Those whose target file is one of the changed files. The changed files must be absolute paths. The disk is not accessed
+void GetAssetsForChangedFiles(
+	const EditorState* editor_state,
+	Stream<Stream<wchar_t>> changed_files,
+	AllocatorPolymorphic allocator,
+	Stream<Stream<unsigned int>>& metadata_handles,
+	Stream<Stream<unsigned int>>& target_file_handles
+);
+
 Stream<Stream<unsigned int>> GetDependentAssetsFor(const EditorState* editor_state, const void* metadata, ECS_ASSET_TYPE type, AllocatorPolymorphic allocator, bool include_itself = false);
 
 // For meshes, textures, shaders and misc assets it will get the time stamp for both the metadata and the 
@@ -3,14 +3,69 @@
 #include "../Editor/EditorState.h"
 #include "AssetManagement.h"
 #include "EditorSandboxAssets.h"
+#include "../Project/ProjectFolders.h"
 
 using namespace ECSEngine;
 
+enum ASSET_FILE_WATCHER_STATUS : unsigned char {
+	ASSET_FILE_WATCHER_NO_CHANGES,
+	// Only the assets that reference the changed files need to be checked
+	ASSET_FILE_WATCHER_CHANGES,
+	// The watcher was just created or notifications were lost, everything needs to be checked
+	ASSET_FILE_WATCHER_FULL_SCAN
+};
+
+// Walking all the assets and their metadata is expensive for large projects, so the file watcher is used to
+// Check only the assets whose files changed inside the assets or the metadata folder since the last call.
+// The changes are left in the watcher, the caller must clear them
+static ASSET_FILE_WATCHER_STATUS UpdateAssetFileWatcher(EditorState* editor_state) {
+	OS::FileWatcher* file_watcher = &editor_state->asset_file_watcher;
+	if (!file_watcher->IsInitialized() || file_watcher->directory != editor_state->project_file->path) {
+		// It is the first tick or the project was changed
+		file_watcher->Deallocate();
+
+		Stream<wchar_t> include_paths[] = { PROJECT_ASSETS_RELATIVE_PATH, PROJECT_METADATA_RELATIVE_PATH };
+		OS::FileWatcherOptions options;
+		options.include_paths = { include_paths, ECS_COUNTOF(include_paths) };
+		file_watcher->Initialize(editor_state->EditorAllocator(), editor_state->project_file->path, options);
+		// Perform a full check for the initial state
+		return ASSET_FILE_WATCHER_FULL_SCAN;
+	}
+
+	file_watcher->Update();
+	if (file_watcher->IsOverflowed()) {
+		return ASSET_FILE_WATCHER_FULL_SCAN;
+	}
+	if (editor_state->asset_file_watcher_full_scan_pending && !EditorStateHasFlag(editor_state, EDITOR_STATE_PREVENT_RESOURCE_LOADING)) {
+		return ASSET_FILE_WATCHER_FULL_SCAN;
+	}
+	return file_watcher->HasChanges() ? ASSET_FILE_WATCHER_CHANGES : ASSET_FILE_WATCHER_NO_CHANGES;
+}
+
+// Returns true if files were added, removed or renamed, in which case the metadata files need to be created or deleted
+static bool HasAssetFileWatcherStructuralChanges(const OS::FileWatcher* file_watcher) {
+	Stream<OS::FileWatcherChange> changes = file_watcher->GetChanges();
+	for (size_t index = 0; index < changes.size; index++) {
+		if (HasFlag(changes[index].flags, OS::ECS_FILE_WATCHER_CHANGE_ADDED | OS::ECS_FILE_WATCHER_CHANGE_REMOVED | OS::ECS_FILE_WATCHER_CHANGE_RENAMED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void TickAsset(EditorState* editor_state) {
 	// Every half a second check for updates to asset settings
 	if (EditorStateLazyEvaluationTrue(editor_state, EDITOR_LAZY_EVALUATION_METADATA_FOR_ASSETS, 500)) {
-		CreateAssetDefaultSetting(editor_state);
-		DeleteMissingAssetSettings(editor_state);
+		ASSET_FILE_WATCHER_STATUS watcher_status = UpdateAssetFileWatcher(editor_state);
+		if (watcher_status == ASSET_FILE_WATCHER_NO_CHANGES) {
+			return;
+		}
+
+		OS::FileWatcher* file_watcher = &editor_state->asset_file_watcher;
+		if (watcher_status == ASSET_FILE_WATCHER_FULL_SCAN || HasAssetFileWatcherStructuralChanges(file_watcher)) {
+			CreateAssetDefaultSetting(editor_state);
+			DeleteMissingAssetSettings(editor_state);
+		}
 
 		// Check to see if the assets have become out of date - only if we can indeed unload or load
 		if (!EditorStateHasFlag(editor_state, EDITOR_STATE_PREVENT_RESOURCE_LOADING)) {
@@ -18,12 +73,40 @@ void TickAsset(EditorState* editor_state) {
 			ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(_stack_allocator, ECS_KB * 96, ECS_MB);
 			AllocatorPolymorphic allocator = &_stack_allocator;
 
-			Stream<Stream<unsigned int>> metadata_out_of_date_assets = GetOutOfDateAssetsMetadata(editor_state, allocator, true, false);
-			ReloadAssetsMetadataChange(editor_state, metadata_out_of_date_assets);
-			_stack_allocator.Clear();
+			if (watcher_status == ASSET_FILE_WATCHER_FULL_SCAN) {
+				editor_state->asset_file_watcher_full_scan_pending = false;
+				Stream<Stream<unsigned int>> metadata_out_of_date_assets = GetOutOfDateAssetsMetadata(editor_state, allocator, true, false);
+				ReloadAssetsMetadataChange(editor_state, metadata_out_of_date_assets);
+				_stack_allocator.Clear();
+
+				Stream<Stream<unsigned int>> target_file_out_of_date_assets = GetOutOfDateAssetsTargetFile(editor_state, allocator);
+				ReloadAssets(editor_state, target_file_out_of_date_assets);
+			}
+			else {
+				// Map the changed files to the assets that reference them and check only those
+				Stream<OS::FileWatcherChange> changes = file_watcher->GetChanges();
+				Stream<Stream<wchar_t>> changed_files;
+				changed_files.Initialize(allocator, changes.size);
+				for (size_t index = 0; index < changes.size; index++) {
+					changed_files[index] = MountPath(changes[index].path, file_watcher->directory, allocator);
+				}
 
-			Stream<Stream<unsigned int>> target_file_out_of_date_assets = GetOutOfDateAssetsTargetFile(editor_state, allocator);
-			ReloadAssets(editor_state, target_file_out_of_date_assets);
+				Stream<Stream<unsigned int>> metadata_candidates;
+				Stream<Stream<unsigned int>> target_file_candidates;
+				GetAssetsForChangedFiles(editor_state, changed_files, allocator, metadata_candidates, target_file_candidates);
+
+				Stream<Stream<unsigned int>> metadata_out_of_date_assets = GetOutOfDateAssetsMetadataFrom(editor_state, metadata_candidates, allocator, true, false);
+				ReloadAssetsMetadataChange(editor_state, metadata_out_of_date_assets);
+
+				Stream<Stream<unsigned int>> target_file_out_of_date_assets = GetOutOfDateAssetsTargetFileFrom(editor_state, target_file_candidates, allocator);
+				ReloadAssets(editor_state, target_file_out_of_date_assets);
+			}
 		}
+		else {
+			// The changes are cleared below without being checked, the next tick that can load must check everything
+			editor_state->asset_file_watcher_full_scan_pending = true;
+		}
+
+		file_watcher->ClearChanges();
 	}
-}
\ No newline at end of file
+}
@@ -619,6 +619,8 @@ void EditorComponents::RecoverData(
 					unsigned int base_count = archetype->GetBaseCount();
 					for (unsigned int base_index = 0; base_index < base_count; base_index++) {
 						ArchetypeBase* base = archetype->GetBase(base_index);
+						// The data is deserialized in place, a storage shared with a copy on write must be cloned
+						base->EnsureUniqueBuffers();
 						unsigned int entity_count = base->EntityCount();
 
 						void* component_buffer = base->GetComponentByIndex(0, component_index);
@@ -674,6 +676,8 @@ void EditorComponents::RecoverData(
 					unsigned int base_count = archetype->GetBaseCount();
 					for (unsigned int base_index = 0; base_index < base_count; base_index++) {
 						ArchetypeBase* base = archetype->GetBase(base_index);
+						// The data is deserialized in place, a storage shared with a copy on write must be cloned
+						base->EnsureUniqueBuffers();
 						unsigned int entity_count = base->EntityCount();
 
 						const void* component_buffer = base->GetComponentByIndex(0, component_index);
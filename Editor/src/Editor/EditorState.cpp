@@ -34,6 +34,9 @@ bool DISPLAY_LOCKED_FILES_SIZE = false;
 #define LAZY_EVALUATION_GRAPHICS_MODULE_STATUS 300
 #define LAZY_EVALUATION_TASK_ALLOCATOR_RESET 500
 
+// Relative to the working directory. The reflection parse results are cached here between runs
+#define REFLECTION_PARSE_CACHE_DIRECTORY L"ReflectionCache"
+
 // These are used to differentiate between the main thread, the background threads,
 // And the simulation threads
 static size_t MAIN_THREAD_ID;
@@ -559,6 +562,7 @@ void EditorStateInitialize(Application* application, EditorState* editor_state,
 	// Will then inherit all types. In this way, these internal types are not associated with a folder hierarchy inside
 	// The module reflection and it allows us to convert module index to hierarchy index directly, without adjustments.
 	Reflection::ReflectionManager editor_reflection_manager(editor_allocator);
+	editor_reflection_manager.SetParseCacheDirectory(REFLECTION_PARSE_CACHE_DIRECTORY);
 	editor_reflection_manager.CreateFolderHierarchy(L"C:\\Users\\Andrei\\C++\\ECSEngine\\ECSEngine\\src");
 	editor_reflection_manager.CreateFolderHierarchy(L"C:\\Users\\Andrei\\C++\\ECSEngine\\Editor\\src");
 	ECS_STACK_CAPACITY_STREAM(char, error_message, 256);
@@ -579,6 +583,7 @@ void EditorStateInitialize(Application* application, EditorState* editor_state,
 
 	Reflection::ReflectionManager* module_reflection_manager = (Reflection::ReflectionManager*)Malloc(sizeof(Reflection::ReflectionManager));
 	*module_reflection_manager = Reflection::ReflectionManager(editor_allocator);
+	module_reflection_manager->SetParseCacheDirectory(REFLECTION_PARSE_CACHE_DIRECTORY);
 
 	// Inherit everything from the ui_reflection. Bind them to the hierarchy -2, such that they don't conflict with the -1 hierarchy
 	// Which is used for other purposes, of inheriting instantiated templates
@@ -648,6 +653,9 @@ void EditorStateInitialize(Application* application, EditorState* editor_state,
 	editor_state->gpu_tasks.m_queue.Initialize(editor_state->EditorAllocator(), 8);
 	editor_state->pending_background_tasks.Initialize(editor_state->EditorAllocator(), 8);
 	editor_state->loading_assets.Initialize(editor_state->EditorAllocator(), 0);
+	// The asset tick creates the watcher once the project is known
+	memset(&editor_state->asset_file_watcher, 0, sizeof(editor_state->asset_file_watcher));
+	editor_state->asset_file_watcher_full_scan_pending = false;
 	editor_state->prefabs.Initialize(editor_state->EditorAllocator(), 16);
 	editor_state->prefabs_allocator = MemoryManager(ECS_MB * 2, ECS_KB * 4, ECS_MB * 8, editor_state->EditorAllocator());
 	editor_state->tick_processing_events.Initialize(editor_state->EditorAllocator(), 8);
@@ -706,6 +714,9 @@ void EditorStateDestroy(EditorState* editor_state) {
 	editor_state->task_manager->DestroyThreads();
 	editor_state->render_task_manager->DestroyThreads();
 
+	// The pending directory read must be cancelled and its handles closed before the memory is released
+	editor_state->asset_file_watcher.Deallocate();
+
 	DestroyGraphics(editor_state->ui_system->m_graphics);
 	FreeAllocator(editor_state->GlobalMemoryManager());
 
@@ -149,6 +149,13 @@ struct EditorState {
 	// Loading. At the moment, make this single threaded
 	ECSEngine::ResizableStream<ECSEngine::AssetTypedHandle> loading_assets;
 
+	// Reports the changes inside the assets and metadata folders, such that the out of date
+	// Assets are searched for only when something changed on disk
+	ECSEngine::OS::FileWatcher asset_file_watcher;
+	// Set when the changes were consumed while the resource loading was prevented, such that the out of date
+	// Assets are searched for in full once the loading is allowed again
+	bool asset_file_watcher_full_scan_pending;
+
 	// These will be played back on the main thread. If multithreaded tasks are desired,
 	// use the AddBackgroundTask function. It is used in a multithreaded context
 	ECSEngine::ThreadSafeResizableQueue<EditorEvent> event_queue;
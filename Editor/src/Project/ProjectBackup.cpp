@@ -48,16 +48,375 @@ void AddProjectNeedsBackupTime(EditorState* editor_state, size_t second_count)
 
 // -------------------------------------------------------------------------------------------------
 
-bool SaveProjectBackup(const EditorState* editor_state)
+// The snapshot of each backup is a manifest with the chunks that make up each file. The chunks themselves are stored
+// Only once, in a folder shared by all the snapshots, and they are named after their content hash
+#define BACKUP_MANIFEST_FILE_NAME L"Snapshot.ecsbackup"
+#define BACKUP_MANIFEST_VERSION 0
+#define BACKUP_CHUNK_FOLDER_NAME L".chunks"
+#define BACKUP_RESTORE_FOLDER_NAME L".restore"
+#define BACKUP_CHUNK_EXTENSION L".chunk"
+#define BACKUP_CHUNK_TEMPORARY_EXTENSION L".temp"
+
+#define BACKUP_CHUNK_MIN_SIZE (ECS_KB * 2)
+#define BACKUP_CHUNK_MAX_SIZE (ECS_KB * 64)
+// A boundary is placed when the top 13 bits of the rolling hash are 0, which gives chunks of 8KB on average past the minimum
+#define BACKUP_CHUNK_BOUNDARY_MASK 0xFFF8000000000000ULL
+
+struct BackupChunk {
+	uint64_t hash[2];
+	size_t byte_size;
+};
+
+struct BackupManifestEntry {
+	// Relative to the project root
+	Stream<wchar_t> path;
+	size_t byte_size;
+	size_t last_write;
+	Stream<BackupChunk> chunks;
+};
+
+struct BackupManifestHeader {
+	unsigned int version;
+	unsigned int entry_count;
+};
+
+struct BackupManifestEntryHeader {
+	size_t byte_size;
+	size_t last_write;
+	unsigned int path_size;
+	unsigned int chunk_count;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+static const uint64_t* GetBackupGearTable() {
+	static uint64_t table[256];
+	static bool initialized = false;
+
+	if (!initialized) {
+		// Use a splitmix sequence with a fixed seed - the table must be the same from run to run,
+		// Otherwise the chunk boundaries would move and nothing would be deduplicated
+		uint64_t state = 0x9E3779B97F4A7C15ULL;
+		for (size_t index = 0; index < std::size(table); index++) {
+			state += 0x9E3779B97F4A7C15ULL;
+			uint64_t value = state;
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+			table[index] = value ^ (value >> 31);
+		}
+		initialized = true;
+	}
+	return table;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Returns the byte size of the next chunk. The boundaries depend only on the bytes right before them, such that
+// An edit inside a file changes only the chunks around it, instead of all the following ones like with fixed size chunks
+static size_t GetBackupChunkSize(const unsigned char* data, size_t size) {
+	if (size <= BACKUP_CHUNK_MIN_SIZE) {
+		return size;
+	}
+
+	const uint64_t* gear_table = GetBackupGearTable();
+	size_t limit = ClampMax(size, (size_t)BACKUP_CHUNK_MAX_SIZE);
+	uint64_t hash = 0;
+	for (size_t index = BACKUP_CHUNK_MIN_SIZE; index < limit; index++) {
+		hash = (hash << 1) + gear_table[data[index]];
+		if ((hash & BACKUP_CHUNK_BOUNDARY_MASK) == 0) {
+			return index + 1;
+		}
+	}
+	return limit;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// The content of the chunks is never compared, so the identity of a chunk is made out of 2 independent 64 bit hashes
+static void HashBackupChunk(Stream<void> data, uint64_t hash[2]) {
+	const unsigned char* bytes = (const unsigned char*)data.buffer;
+
+	// FNV-1a 64
+	uint64_t fnv = 0xCBF29CE484222325ULL;
+	for (size_t index = 0; index < data.size; index++) {
+		fnv = (fnv ^ bytes[index]) * 0x100000001B3ULL;
+	}
+
+	// A multiply-rotate hash over 8 byte words, with a murmur finalizer
+	uint64_t mix = 0x27D4EB2F165667C5ULL ^ (data.size * 0x9E3779B97F4A7C15ULL);
+	size_t index = 0;
+	for (; index + sizeof(uint64_t) <= data.size; index += sizeof(uint64_t)) {
+		uint64_t value;
+		memcpy(&value, bytes + index, sizeof(value));
+		value *= 0xC2B2AE3D27D4EB4FULL;
+		value = (value << 31) | (value >> 33);
+		mix ^= value * 0x9E3779B97F4A7C15ULL;
+		mix = ((mix << 27) | (mix >> 37)) * 0x9E3779B97F4A7C15ULL + 0x85EBCA77C2B2AE63ULL;
+	}
+	for (; index < data.size; index++) {
+		mix ^= bytes[index] * 0x27D4EB2F165667C5ULL;
+		mix = ((mix << 11) | (mix >> 53)) * 0x9E3779B97F4A7C15ULL;
+	}
+	mix ^= mix >> 33;
+	mix *= 0xFF51AFD7ED558CCDULL;
+	mix ^= mix >> 33;
+	mix *= 0xC4CEB9FE1A85EC53ULL;
+	mix ^= mix >> 33;
+
+	hash[0] = fnv;
+	hash[1] = mix;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void GetBackupChunkPath(Stream<wchar_t> chunk_folder, const BackupChunk& chunk, CapacityStream<wchar_t>& path) {
+	path.CopyOther(chunk_folder);
+	path.Add(ECS_OS_PATH_SEPARATOR);
+	ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(path, chunk.hash[0]);
+	ConvertIntToHex<ECS_CONVERT_INT_TO_HEX_DO_NOT_WRITE_0X>(path, chunk.hash[1]);
+	path.AddStreamAssert(BACKUP_CHUNK_EXTENSION);
+	path[path.size] = L'\0';
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// The snapshot folder is the parent of the manifest, and the chunk folder is its sibling
+static void GetBackupChunkFolder(Stream<wchar_t> snapshot_folder, CapacityStream<wchar_t>& path) {
+	path.CopyOther(PathParent(snapshot_folder));
+	path.Add(ECS_OS_PATH_SEPARATOR);
+	path.AddStreamAssert(BACKUP_CHUNK_FOLDER_NAME);
+	path[path.size] = L'\0';
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void GetBackupManifestPath(Stream<wchar_t> snapshot_folder, CapacityStream<wchar_t>& path) {
+	path.CopyOther(snapshot_folder);
+	path.Add(ECS_OS_PATH_SEPARATOR);
+	path.AddStreamAssert(BACKUP_MANIFEST_FILE_NAME);
+	path[path.size] = L'\0';
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Returns false if the manifest could not be read or if it is corrupted. The paths of the entries reference
+// The file contents, which are allocated from the given allocator
+static bool ReadBackupManifest(Stream<wchar_t> snapshot_folder, AllocatorPolymorphic allocator, ResizableStream<BackupManifestEntry>& entries) {
+	ECS_STACK_CAPACITY_STREAM(wchar_t, manifest_path, 512);
+	GetBackupManifestPath(snapshot_folder, manifest_path);
+
+	Stream<void> contents = ReadWholeFileBinary(manifest_path, allocator);
+	if (contents.size < sizeof(BackupManifestHeader)) {
+		return false;
+	}
+
+	const unsigned char* ptr = (const unsigned char*)contents.buffer;
+	const unsigned char* end = ptr + contents.size;
+
+	BackupManifestHeader header;
+	memcpy(&header, ptr, sizeof(header));
+	ptr += sizeof(header);
+	if (header.version != BACKUP_MANIFEST_VERSION) {
+		return false;
+	}
+
+	for (unsigned int index = 0; index < header.entry_count; index++) {
+		if ((size_t)(end - ptr) < sizeof(BackupManifestEntryHeader)) {
+			return false;
+		}
+
+		BackupManifestEntryHeader entry_header;
+		memcpy(&entry_header, ptr, sizeof(entry_header));
+		ptr += sizeof(entry_header);
+
+		size_t path_byte_size = (size_t)entry_header.path_size * sizeof(wchar_t);
+		size_t chunks_byte_size = (size_t)entry_header.chunk_count * sizeof(BackupChunk);
+		if ((size_t)(end - ptr) < path_byte_size + chunks_byte_size) {
+			return false;
+		}
+
+		BackupManifestEntry entry;
+		entry.byte_size = entry_header.byte_size;
+		entry.last_write = entry_header.last_write;
+		entry.path = { (wchar_t*)ptr, entry_header.path_size };
+		ptr += path_byte_size;
+		// The chunks are not necessarily aligned inside the file
+		entry.chunks.Initialize(allocator, entry_header.chunk_count);
+		memcpy(entry.chunks.buffer, ptr, chunks_byte_size);
+		ptr += chunks_byte_size;
+		entries.Add(&entry);
+	}
+
+	return ptr == end;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Returns the number of bytes written or -1 if it failed
+static size_t WriteBackupManifest(Stream<wchar_t> snapshot_folder, Stream<BackupManifestEntry> entries) {
+	size_t total_byte_size = sizeof(BackupManifestHeader);
+	for (size_t index = 0; index < entries.size; index++) {
+		total_byte_size += sizeof(BackupManifestEntryHeader) + entries[index].path.MemoryOf(entries[index].path.size) + entries[index].chunks.MemoryOf(entries[index].chunks.size);
+	}
+
+	unsigned char* buffer = (unsigned char*)Malloc(total_byte_size);
+	unsigned char* ptr = buffer;
+
+	BackupManifestHeader header;
+	header.version = BACKUP_MANIFEST_VERSION;
+	header.entry_count = (unsigned int)entries.size;
+	memcpy(ptr, &header, sizeof(header));
+	ptr += sizeof(header);
+
+	for (size_t index = 0; index < entries.size; index++) {
+		BackupManifestEntryHeader entry_header;
+		entry_header.byte_size = entries[index].byte_size;
+		entry_header.last_write = entries[index].last_write;
+		entry_header.path_size = (unsigned int)entries[index].path.size;
+		entry_header.chunk_count = (unsigned int)entries[index].chunks.size;
+		memcpy(ptr, &entry_header, sizeof(entry_header));
+		ptr += sizeof(entry_header);
+		entries[index].path.CopyTo(ptr);
+		ptr += entries[index].path.MemoryOf(entries[index].path.size);
+		entries[index].chunks.CopyTo(ptr);
+		ptr += entries[index].chunks.MemoryOf(entries[index].chunks.size);
+	}
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, manifest_path, 512);
+	GetBackupManifestPath(snapshot_folder, manifest_path);
+	ECS_FILE_STATUS_FLAGS status = WriteBufferToFileBinary(manifest_path, { buffer, total_byte_size });
+	Free(buffer);
+	return status == ECS_FILE_STATUS_OK ? total_byte_size : -1;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Fills in the snapshot folder with the latest date that has a manifest. If there is none, the path is left empty
+static void GetLatestBackupSnapshot(Stream<wchar_t> backup_folder, CapacityStream<wchar_t>& snapshot_folder) {
+	snapshot_folder.size = 0;
+	Date latest_date;
+	memset(&latest_date, 0, sizeof(latest_date));
+
+	ForEachDirectory(backup_folder, [&](Stream<wchar_t> path) {
+		if (IsProjectBackupSnapshotFolder(path)) {
+			ECS_STACK_CAPACITY_STREAM(wchar_t, manifest_path, 512);
+			GetBackupManifestPath(path, manifest_path);
+			if (ExistsFileOrFolder(manifest_path)) {
+				Date date = ConvertStringToDate(PathFilename(path), ECS_FORMAT_DATE_ALL_FROM_MINUTES);
+				if (snapshot_folder.size == 0 || IsDateLater(latest_date, date)) {
+					latest_date = date;
+					snapshot_folder.CopyOther(path);
+				}
+			}
+		}
+		return true;
+	});
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// Gathers all the files that are part of a backup, as paths relative to the project root
+static void GetProjectBackupFiles(const EditorState* editor_state, AllocatorPolymorphic allocator, ResizableStream<Stream<wchar_t>>& paths) {
+	ECS_STACK_CAPACITY_STREAM(wchar_t, project_root, 512);
+	GetProjectRootPath(editor_state, project_root);
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, absolute_path, 512);
+	auto add_absolute_path = [&](Stream<wchar_t> path) {
+		Stream<wchar_t> relative_path = PathRelativeToAbsolute(path, project_root);
+		if (relative_path.size > 0) {
+			paths.Add(relative_path.Copy(allocator));
+		}
+	};
+
+	// The singular files
+	GetProjectFilePath(editor_state->project_file, absolute_path);
+	add_absolute_path(absolute_path);
+	absolute_path.size = 0;
+	GetProjectModulesFilePath(editor_state, absolute_path);
+	add_absolute_path(absolute_path);
+	absolute_path.size = 0;
+	GetProjectSandboxFile(editor_state, absolute_path);
+	add_absolute_path(absolute_path);
+
+	// The folders that are saved entirely
+	typedef void (*GetPath)(const EditorState* editor_state, CapacityStream<wchar_t>& path);
+	GetPath get_folders[] = {
+		GetProjectUIFolder,
+		GetProjectConfigurationFolder,
+		GetProjectMetadataFolder
+	};
+	for (size_t index = 0; index < std::size(get_folders); index++) {
+		absolute_path.size = 0;
+		get_folders[index](editor_state, absolute_path);
+		ForEachFileInDirectoryRecursive(absolute_path, [&](Stream<wchar_t> path) {
+			add_absolute_path(path);
+			return true;
+		});
+	}
+
+	// The asset thunk or forwarding files and the scenes are relative to the assets folder
+	auto add_asset_relative_path = [&](Stream<wchar_t> path) {
+		absolute_path.CopyOther(PROJECT_ASSETS_RELATIVE_PATH);
+		absolute_path.Add(ECS_OS_PATH_SEPARATOR);
+		absolute_path.AddStreamAssert(path);
+		if (paths.ToStream().Find(absolute_path) == -1) {
+			paths.Add(absolute_path.Copy(allocator));
+		}
+	};
+
+	ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 128, ECS_MB);
+	Stream<Stream<wchar_t>> asset_paths = GetAssetsFromAssetsFolder(editor_state, &stack_allocator);
+	for (size_t index = 0; index < asset_paths.size; index++) {
+		add_asset_relative_path(asset_paths[index]);
+	}
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, assets_folder, 512);
+	GetProjectAssetsFolder(editor_state, assets_folder);
+
+	// The scenes in use by the sandboxes, excluding the temporary sandboxes
+	ECS_STACK_CAPACITY_STREAM(wchar_t, sandbox_scene_path, 512);
+	SandboxAction(editor_state, -1, [&](unsigned int sandbox_handle) -> void {
+		sandbox_scene_path.size = 0;
+		GetSandboxScenePath(editor_state, sandbox_handle, sandbox_scene_path);
+		if (sandbox_scene_path.size > 0) {
+			Stream<wchar_t> relative_path = PathRelativeToAbsolute(sandbox_scene_path, assets_folder);
+			if (relative_path.size > 0) {
+				add_asset_relative_path(relative_path);
+			}
+		}
+	}, true);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool IsProjectBackupSnapshotFolder(Stream<wchar_t> folder)
 {
-	// Copy the files for singular one and the folders for the rest
-	
+	// The chunk store and the temporary restore folder start with a dot
+	Stream<wchar_t> filename = PathFilename(folder);
+	return filename.size > 0 && filename[0] != L'.';
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool SaveProjectBackup(const EditorState* editor_state, ProjectBackupStatistics* statistics)
+{
+	Timer timer;
+	ProjectBackupStatistics backup_statistics;
+	memset(&backup_statistics, 0, sizeof(backup_statistics));
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, backup_folder, 512);
+	GetProjectBackupFolder(editor_state, backup_folder);
+
 	// The name of the backup will reflect the date at which the backup is realized
 	ECS_STACK_CAPACITY_STREAM(wchar_t, path, 512);
-	GetProjectBackupFolder(editor_state, path);
+	path.CopyOther(backup_folder);
 	path.Add(ECS_OS_PATH_SEPARATOR);
 	Date date = OS::GetLocalTime();
 	ConvertDateToString(date, path, ECS_FORMAT_DATE_ALL_FROM_MINUTES);
+	path[path.size] = L'\0';
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_folder, 512);
+	GetBackupChunkFolder(path, chunk_folder);
 
 	auto error_lambda = [&](Stream<char> reason) {
 		ECS_STACK_CAPACITY_STREAM(char, message, 1024);
@@ -65,6 +424,7 @@ bool SaveProjectBackup(const EditorState* editor_state)
 		message.AddStreamSafe(reason);
 
 		EditorSetConsoleError(message);
+		// The chunks that were already written are left in place, the next backups can reference them
 		bool success = RemoveFolder(path);
 		if (!success) {
 			ECS_FORMAT_TEMP_STRING(error_message, "An error occured when trying to remove the backup folder which failed. Consider doing this manually. "
@@ -73,6 +433,22 @@ bool SaveProjectBackup(const EditorState* editor_state)
 		}
 	};
 
+	// Create the chunk store the first time a backup is made
+	if (!ExistsFileOrFolder(chunk_folder)) {
+		if (!ExistsFileOrFolder(backup_folder) && !CreateFolder(backup_folder)) {
+			EditorSetConsoleError("An error has occured when a project backup was saved. The backup folder could not be created.");
+			return false;
+		}
+		if (!CreateFolder(chunk_folder)) {
+			EditorSetConsoleError("An error has occured when a project backup was saved. The chunk folder could not be created.");
+			return false;
+		}
+	}
+
+	// The previous snapshot is used to skip the files whose size and last write time did not change
+	ECS_STACK_CAPACITY_STREAM(wchar_t, previous_snapshot, 512);
+	GetLatestBackupSnapshot(backup_folder, previous_snapshot);
+
 	// Create the folder
 	bool success = CreateFolder(path);
 	if (!success) {
@@ -80,156 +456,282 @@ bool SaveProjectBackup(const EditorState* editor_state)
 		return false;
 	}
 
-	// Copy the .ecsproj file
-	ECS_STACK_CAPACITY_STREAM(wchar_t, file_or_folder_to_copy, 512);
-	GetProjectFilePath(editor_state->project_file, file_or_folder_to_copy);
-	success = FileCopy(file_or_folder_to_copy, path, true);
-	if (!success) {
-		error_lambda("Could not copy the project file.");
-		return false;
-	}
+	ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(_stack_allocator, ECS_KB * 128, ECS_MB * 4);
+	AllocatorPolymorphic stack_allocator = &_stack_allocator;
 
-	// Copy the .ecsmodules file
-	file_or_folder_to_copy.size = 0;
-	GetProjectModulesFilePath(editor_state, file_or_folder_to_copy);
-	success = FileCopy(file_or_folder_to_copy, path, true);
-	if (!success) {
-		error_lambda("Could not copy the project modules file");
-		return false;
+	ResizableStream<BackupManifestEntry> previous_entries(stack_allocator, 0);
+	if (previous_snapshot.size > 0 && !ReadBackupManifest(previous_snapshot, stack_allocator, previous_entries)) {
+		// Not fatal, all the files will be hashed again
+		previous_entries.size = 0;
+		ECS_FORMAT_TEMP_STRING(warn_message, "The project backup {#} is corrupted. It will not be used as a reference for the new backup.", PathFilename(previous_snapshot));
+		EditorSetConsoleWarn(warn_message);
 	}
 
-	// Copy the .ecss file
-	file_or_folder_to_copy.size = 0;
-	GetProjectSandboxFile(editor_state, file_or_folder_to_copy);
-	success = FileCopy(file_or_folder_to_copy, path, true);
-	if (!success) {
-		error_lambda("Could not copy the project sandbox file");
-		return false;
+	HashTableDefault<unsigned int> previous_table;
+	previous_table.Initialize(stack_allocator, HashTablePowerOfTwoCapacityForElements(previous_entries.size));
+	for (unsigned int index = 0; index < previous_entries.size; index++) {
+		previous_table.Insert(index, previous_entries[index].path);
 	}
 
-	// Copy the UI folder
-	file_or_folder_to_copy.size = 0;
-	GetProjectUIFolder(editor_state, file_or_folder_to_copy);
-	success = FolderCopy(file_or_folder_to_copy, path);
-	if (!success) {
-		error_lambda("The project's UI folder could not be copied.");
-		return false;
+	ResizableStream<Stream<wchar_t>> relative_paths(stack_allocator, 0);
+	GetProjectBackupFiles(editor_state, stack_allocator, relative_paths);
+
+	ResizableStream<BackupManifestEntry> entries(stack_allocator, relative_paths.size);
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, absolute_path, 512);
+	GetProjectRootPath(editor_state, absolute_path);
+	absolute_path.Add(ECS_OS_PATH_SEPARATOR);
+	unsigned int absolute_path_base_size = absolute_path.size;
+
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_path, 512);
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_temp_path, 512);
+	for (unsigned int index = 0; index < relative_paths.size; index++) {
+		absolute_path.size = absolute_path_base_size;
+		absolute_path.AddStreamAssert(relative_paths[index]);
+		absolute_path[absolute_path.size] = L'\0';
+
+		BackupManifestEntry entry;
+		entry.path = relative_paths[index];
+		entry.byte_size = GetFileByteSize(absolute_path);
+		entry.last_write = 0;
+		if (!OS::GetFileTimes(absolute_path, nullptr, nullptr, &entry.last_write)) {
+			ECS_FORMAT_TEMP_STRING(error_message, "The file {#} could not be accessed.", relative_paths[index]);
+			error_lambda(error_message);
+			return false;
+		}
+
+		backup_statistics.snapshot_byte_size += entry.byte_size;
+		unsigned int previous_index = previous_table.Find(entry.path);
+		if (previous_index != -1) {
+			const BackupManifestEntry& previous_entry = previous_entries[previous_table.GetValueFromIndex(previous_index)];
+			if (previous_entry.byte_size == entry.byte_size && previous_entry.last_write == entry.last_write) {
+				entry.chunks = previous_entry.chunks;
+				backup_statistics.chunk_count += entry.chunks.size;
+				entries.Add(&entry);
+				continue;
+			}
+		}
+
+		bool empty_file = false;
+		Stream<void> contents = ReadWholeFileBinary(absolute_path, ECS_MALLOC_ALLOCATOR, &empty_file);
+		if (contents.size == 0 && !empty_file) {
+			ECS_FORMAT_TEMP_STRING(error_message, "The file {#} could not be read.", relative_paths[index]);
+			error_lambda(error_message);
+			return false;
+		}
+		backup_statistics.hashed_file_count++;
+		// Record the size that was actually read, in case the file was modified in between
+		backup_statistics.snapshot_byte_size -= entry.byte_size;
+		entry.byte_size = contents.size;
+		backup_statistics.snapshot_byte_size += entry.byte_size;
+
+		entry.chunks.Initialize(stack_allocator, contents.size / BACKUP_CHUNK_MIN_SIZE + 1);
+		entry.chunks.size = 0;
+		const unsigned char* bytes = (const unsigned char*)contents.buffer;
+		size_t offset = 0;
+		while (offset < contents.size) {
+			BackupChunk chunk;
+			chunk.byte_size = GetBackupChunkSize(bytes + offset, contents.size - offset);
+			Stream<void> chunk_data = { bytes + offset, chunk.byte_size };
+			HashBackupChunk(chunk_data, chunk.hash);
+
+			GetBackupChunkPath(chunk_folder, chunk, chunk_path);
+			bool reuse_chunk = false;
+			if (ExistsFileOrFolder(chunk_path)) {
+				// A chunk left truncated by an interrupted backup must not be reused
+				reuse_chunk = GetFileByteSize(chunk_path) == chunk.byte_size;
+				if (!reuse_chunk) {
+					RemoveFile(chunk_path);
+				}
+			}
+
+			if (!reuse_chunk) {
+				// Write the chunk into a temporary file first and rename it into place only
+				// After it was fully written, such that a partial chunk is never visible
+				chunk_temp_path.CopyOther(chunk_path);
+				chunk_temp_path.AddStreamAssert(BACKUP_CHUNK_TEMPORARY_EXTENSION);
+				chunk_temp_path[chunk_temp_path.size] = L'\0';
+				bool write_success = WriteBufferToFileBinary(chunk_temp_path, chunk_data) == ECS_FILE_STATUS_OK;
+				if (write_success) {
+					write_success = RenameFileAbsolute(chunk_temp_path, chunk_path);
+				}
+				if (!write_success) {
+					RemoveFile(chunk_temp_path);
+					Free(contents.buffer);
+					ECS_FORMAT_TEMP_STRING(error_message, "A chunk of the file {#} could not be written.", relative_paths[index]);
+					error_lambda(error_message);
+					return false;
+				}
+				backup_statistics.new_chunk_count++;
+				backup_statistics.written_byte_size += chunk.byte_size;
+			}
+
+			entry.chunks.Add(chunk);
+			offset += chunk.byte_size;
+		}
+		backup_statistics.chunk_count += entry.chunks.size;
+		if (contents.buffer != nullptr) {
+			Free(contents.buffer);
+		}
+		entries.Add(&entry);
 	}
 
-	// Copy the Configuration folder
-	file_or_folder_to_copy.size = 0;
-	GetProjectConfigurationFolder(editor_state, file_or_folder_to_copy);
-	success = FolderCopy(file_or_folder_to_copy, path);
-	if (!success) {
-		error_lambda("The project's Configuration folder could not be copied.");
+	size_t manifest_byte_size = WriteBackupManifest(path, entries.ToStream());
+	if (manifest_byte_size == -1) {
+		error_lambda("The backup manifest could not be written.");
 		return false;
 	}
 
-	// Copy the Metadata folder
-	file_or_folder_to_copy.size = 0;
-	GetProjectMetadataFolder(editor_state, file_or_folder_to_copy);
-	success = FolderCopy(file_or_folder_to_copy, path);
-	if (!success) {
-		error_lambda("The project's Metadata folder could not be copied.");
-		return false;
+	if (statistics != nullptr) {
+		backup_statistics.file_count = entries.size;
+		backup_statistics.written_byte_size += manifest_byte_size;
+		backup_statistics.duration_ms = timer.GetDuration(ECS_TIMER_DURATION_MS);
+		*statistics = backup_statistics;
 	}
+	return true;
+}
 
-	// Copy the asset files now - we need to gather them
-	CapacityStream<wchar_t> backup_assets_path = path;
-	backup_assets_path.Add(ECS_OS_PATH_SEPARATOR);
-	backup_assets_path.AddStreamAssert(PROJECT_ASSETS_RELATIVE_PATH);
+// -------------------------------------------------------------------------------------------------
 
-	success = CreateFolder(backup_assets_path);
-	if (!success) {
-		error_lambda("The project's Assets directory could not be created.");
-		return false;
+void RemoveUnreferencedProjectBackupChunks(const EditorState* editor_state)
+{
+	ECS_STACK_CAPACITY_STREAM(wchar_t, backup_folder, 512);
+	GetProjectBackupFolder(editor_state, backup_folder);
+
+	ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(_stack_allocator, ECS_KB * 128, ECS_MB * 4);
+	AllocatorPolymorphic stack_allocator = &_stack_allocator;
+
+	// Gather all the chunks referenced by the snapshots that are still around
+	ResizableStream<BackupManifestEntry> entries(stack_allocator, 0);
+	bool all_manifests_read = true;
+	ForEachDirectory(backup_folder, [&](Stream<wchar_t> path) {
+		if (IsProjectBackupSnapshotFolder(path)) {
+			ECS_STACK_CAPACITY_STREAM(wchar_t, manifest_path, 512);
+			GetBackupManifestPath(path, manifest_path);
+			if (ExistsFileOrFolder(manifest_path)) {
+				all_manifests_read &= ReadBackupManifest(path, stack_allocator, entries);
+			}
+		}
+		return true;
+	});
+
+	// If a manifest could not be read, removing any chunk might break that snapshot even further
+	if (!all_manifests_read) {
+		EditorSetConsoleWarn("A project backup manifest could not be read. The unreferenced backup chunks were not removed.");
+		return;
 	}
 
-	ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(stack_allocator, ECS_KB * 128, ECS_MB);
+	size_t chunk_count = 0;
+	for (unsigned int index = 0; index < entries.size; index++) {
+		chunk_count += entries[index].chunks.size;
+	}
 
-	ECS_STACK_CAPACITY_STREAM(Stream<wchar_t>, assets_folder_directories_storage, ECS_KB);
-	AdditionStream<Stream<wchar_t>> asset_folder_directories = &assets_folder_directories_storage;
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_folder, 512);
+	chunk_folder.CopyOther(backup_folder);
+	chunk_folder.Add(ECS_OS_PATH_SEPARATOR);
+	chunk_folder.AddStreamAssert(BACKUP_CHUNK_FOLDER_NAME);
+	chunk_folder[chunk_folder.size] = L'\0';
+
+	HashTableEmpty<ResourceIdentifier, HashFunctionPowerOfTwo> referenced_chunks;
+	referenced_chunks.Initialize(stack_allocator, HashTablePowerOfTwoCapacityForElements(chunk_count));
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_path, 512);
+	for (unsigned int index = 0; index < entries.size; index++) {
+		for (size_t chunk_index = 0; chunk_index < entries[index].chunks.size; chunk_index++) {
+			GetBackupChunkPath(chunk_folder, entries[index].chunks[chunk_index], chunk_path);
+			Stream<wchar_t> filename = PathFilename(chunk_path);
+			if (referenced_chunks.Find(filename) == -1) {
+				referenced_chunks.Insert(filename.Copy(stack_allocator));
+			}
+		}
+	}
 
-	// Create all the folders in the assets folder such that we don't need to check manually for each asset file
-	// If its parent exist or not
-	ECS_STACK_CAPACITY_STREAM(wchar_t, assets_folder, 512);
-	GetProjectAssetsFolder(editor_state, assets_folder);
-	GetDirectoriesOrFilesOptions get_directories_options;
-	get_directories_options.relative_root = assets_folder;
+	ForEachFileInDirectory(chunk_folder, [&](Stream<wchar_t> path) {
+		if (referenced_chunks.Find(PathFilename(path)) == -1) {
+			RemoveFile(path);
+		}
+		return true;
+	});
+}
 
-	GetDirectoriesRecursive(assets_folder, &stack_allocator, asset_folder_directories, get_directories_options);
+// -------------------------------------------------------------------------------------------------
 
-	// Create the directories first
-	unsigned int backup_asset_folder_base_size = backup_assets_path.size;
-	for (unsigned int index = 0; index < asset_folder_directories.Size(); index++) {
-		backup_assets_path.size = backup_asset_folder_base_size;
-		backup_assets_path.Add(ECS_OS_PATH_SEPARATOR);
-		backup_assets_path.AddStreamAssert(asset_folder_directories[index]);
-		ReplaceCharacter(backup_assets_path, ECS_OS_PATH_SEPARATOR_REL, ECS_OS_PATH_SEPARATOR);
+// Writes the files of the snapshot into the destination, with the same layout as the project
+static bool RestoreBackupSnapshot(Stream<wchar_t> snapshot_folder, Stream<wchar_t> destination) {
+	ECS_STACK_RESIZABLE_LINEAR_ALLOCATOR(_stack_allocator, ECS_KB * 128, ECS_MB * 4);
+	AllocatorPolymorphic stack_allocator = &_stack_allocator;
 
-		success = CreateFolder(backup_assets_path);
-		if (!success) {
-			error_lambda("The project's Assets child directories could not be created.");
-			return false;
-		}
+	ResizableStream<BackupManifestEntry> entries(stack_allocator, 0);
+	if (!ReadBackupManifest(snapshot_folder, stack_allocator, entries)) {
+		ECS_FORMAT_TEMP_STRING(error_message, "The manifest of the project backup {#} could not be read.", PathFilename(snapshot_folder));
+		EditorSetConsoleError(error_message);
+		return false;
 	}
 
-	stack_allocator.Clear();
-	
-	Stream<Stream<wchar_t>> asset_paths = GetAssetsFromAssetsFolder(editor_state, &stack_allocator);
-	unsigned int asset_folder_size = assets_folder.size;
-	// Now copy the asset thunk or forwarding files
-	for (size_t index = 0; index < asset_paths.size; index++) {
-		backup_assets_path.size = backup_asset_folder_base_size;
-		backup_assets_path.Add(ECS_OS_PATH_SEPARATOR);
-		backup_assets_path.AddStreamAssert(asset_paths[index]);
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_folder, 512);
+	GetBackupChunkFolder(snapshot_folder, chunk_folder);
 
-		assets_folder.size = asset_folder_size;
-		assets_folder.Add(ECS_OS_PATH_SEPARATOR);
-		assets_folder.AddStreamAssert(asset_paths[index]);
+	ECS_STACK_CAPACITY_STREAM(wchar_t, file_path, 512);
+	file_path.CopyOther(destination);
+	file_path.Add(ECS_OS_PATH_SEPARATOR);
+	unsigned int file_path_base_size = file_path.size;
 
-		success = FileCopy(assets_folder, backup_assets_path, false);
-		if (!success) {
-			error_lambda("The project's Asset forward facing files could not be copied.");
+	// The folders are copied as a whole when restoring, they must exist even when they were empty
+	const wchar_t* folders[] = {
+		PROJECT_UI_RELATIVE_PATH,
+		PROJECT_CONFIGURATION_RELATIVE_PATH,
+		PROJECT_METADATA_RELATIVE_PATH,
+		PROJECT_ASSETS_RELATIVE_PATH
+	};
+	for (size_t index = 0; index < std::size(folders); index++) {
+		file_path.size = file_path_base_size;
+		file_path.AddStreamAssert(folders[index]);
+		file_path[file_path.size] = L'\0';
+		if (!CreateFolder(file_path)) {
+			EditorSetConsoleError("The project backup could not be restored. A temporary folder could not be created.");
 			return false;
 		}
 	}
 
-	assets_folder.size = asset_folder_size;
-	backup_assets_path.size = backup_asset_folder_base_size;
-
-	// In this array, we record the stem of the scenes that were already copied
-	// Such that we don't try to copy again the same scene
-	ECS_STACK_CAPACITY_STREAM(Stream<wchar_t>, copied_sandbox_scenes, 512);
-
-	ECS_STACK_CAPACITY_STREAM(wchar_t, sandbox_scene_path, 512);
-	// Now copy the scenes in use by the sandboxes
-	// Exclude temporary sandboxes
-	if (SandboxAction<true>(editor_state, -1, [&](unsigned int sandbox_handle) -> bool {
-		sandbox_scene_path.size = 0;
-		Stream<wchar_t> scene_path = GetSandbox(editor_state, sandbox_handle)->scene_path;
-		if (copied_sandbox_scenes.Find(scene_path) == -1) {
-			copied_sandbox_scenes.AddAssert(scene_path);
-			GetSandboxScenePath(editor_state, sandbox_handle, sandbox_scene_path);
-			if (sandbox_scene_path.size > 0) {
-				// Copy the scene
-				Stream<wchar_t> relative_path = PathRelativeToAbsolute(sandbox_scene_path, assets_folder);
-				backup_assets_path.size = backup_asset_folder_base_size;
-				backup_assets_path.Add(ECS_OS_PATH_SEPARATOR);
-				backup_assets_path.AddStreamAssert(relative_path);
-
-				success = FileCopy(sandbox_scene_path, backup_assets_path, false);
-				if (!success) {
-					ECS_FORMAT_TEMP_STRING(error_message, "The project's scene {#} could not be copied.", relative_path);
-					error_lambda(error_message);
-					return true;
+	ECS_STACK_CAPACITY_STREAM(wchar_t, chunk_path, 512);
+	for (unsigned int index = 0; index < entries.size; index++) {
+		const BackupManifestEntry& entry = entries[index];
+		file_path.size = file_path_base_size;
+		file_path.AddStreamAssert(entry.path);
+		file_path[file_path.size] = L'\0';
+
+		// Create the parent directories which don't exist yet
+		for (size_t path_index = 0; path_index < entry.path.size; path_index++) {
+			if (entry.path[path_index] == ECS_OS_PATH_SEPARATOR) {
+				Stream<wchar_t> parent = { file_path.buffer, file_path_base_size + path_index };
+				if (!ExistsFileOrFolder(parent) && !CreateFolder(parent)) {
+					ECS_FORMAT_TEMP_STRING(error_message, "The project backup could not be restored. The folder for {#} could not be created.", entry.path);
+					EditorSetConsoleError(error_message);
+					return false;
 				}
 			}
 		}
 
-		return false;
-	}, true)) {
-		return false;
+		ECS_FILE_HANDLE file_handle = -1;
+		if (FileCreate(file_path, &file_handle, ECS_FILE_ACCESS_WRITE_BINARY_TRUNCATE) != ECS_FILE_STATUS_OK) {
+			ECS_FORMAT_TEMP_STRING(error_message, "The project backup could not be restored. The file {#} could not be created.", entry.path);
+			EditorSetConsoleError(error_message);
+			return false;
+		}
+		ScopedFile scoped_file({ file_handle });
+
+		for (size_t chunk_index = 0; chunk_index < entry.chunks.size; chunk_index++) {
+			GetBackupChunkPath(chunk_folder, entry.chunks[chunk_index], chunk_path);
+			Stream<void> chunk_data = ReadWholeFileBinary(chunk_path);
+			bool chunk_success = chunk_data.size == entry.chunks[chunk_index].byte_size && WriteFile(file_handle, chunk_data);
+			if (chunk_data.buffer != nullptr) {
+				Free(chunk_data.buffer);
+			}
+			if (!chunk_success) {
+				ECS_FORMAT_TEMP_STRING(error_message, "The project backup could not be restored. A chunk of the file {#} is missing or it could not be written.", entry.path);
+				EditorSetConsoleError(error_message);
+				return false;
+			}
+		}
 	}
 
 	return true;
@@ -237,20 +739,8 @@ bool SaveProjectBackup(const EditorState* editor_state)
 
 // -------------------------------------------------------------------------------------------------
 
-bool LoadProjectBackup(const EditorState* editor_state, Stream<wchar_t> folder)
-{
-	ProjectBackupFiles files_mask[PROJECT_BACKUP_COUNT];
-	for (size_t index = 0; index < PROJECT_BACKUP_COUNT; index++) {
-		files_mask[index] = (ProjectBackupFiles)index;
-	}
-
-	return LoadProjectBackup(editor_state, folder, { files_mask, PROJECT_BACKUP_COUNT });
-}
-
-// -------------------------------------------------------------------------------------------------
-
-bool LoadProjectBackup(const EditorState* editor_state, Stream<wchar_t> folder, Stream<ProjectBackupFiles> file_mask)
-{
+// Restores from a folder that has the files laid out like in the project
+static bool LoadProjectBackupFolder(const EditorState* editor_state, Stream<wchar_t> folder, Stream<ProjectBackupFiles> file_mask) {
 	bool valid_files[PROJECT_BACKUP_COUNT] = { false };
 
 	for (size_t index = 0; index < file_mask.size; index++) {
@@ -486,3 +976,54 @@ bool LoadProjectBackup(const EditorState* editor_state, Stream<wchar_t> folder,
 }
 
 // -------------------------------------------------------------------------------------------------
+
+bool LoadProjectBackup(const EditorState* editor_state, Stream<wchar_t> folder)
+{
+	ProjectBackupFiles files_mask[PROJECT_BACKUP_COUNT];
+	for (size_t index = 0; index < PROJECT_BACKUP_COUNT; index++) {
+		files_mask[index] = (ProjectBackupFiles)index;
+	}
+
+	return LoadProjectBackup(editor_state, folder, { files_mask, PROJECT_BACKUP_COUNT });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+bool LoadProjectBackup(const EditorState* editor_state, Stream<wchar_t> folder, Stream<ProjectBackupFiles> file_mask)
+{
+	ECS_STACK_CAPACITY_STREAM(wchar_t, manifest_path, 512);
+	GetBackupManifestPath(folder, manifest_path);
+	if (!ExistsFileOrFolder(manifest_path)) {
+		// The backups made before the snapshots were introduced contain full copies of the files
+		return LoadProjectBackupFolder(editor_state, folder, file_mask);
+	}
+
+	// Rebuild the files of the snapshot into a temporary folder and then restore from it like from a full copy
+	ECS_STACK_CAPACITY_STREAM(wchar_t, restore_folder, 512);
+	restore_folder.CopyOther(PathParent(folder));
+	restore_folder.Add(ECS_OS_PATH_SEPARATOR);
+	restore_folder.AddStreamAssert(BACKUP_RESTORE_FOLDER_NAME);
+	restore_folder[restore_folder.size] = L'\0';
+
+	// It can be left behind if the editor was closed while restoring
+	if (ExistsFileOrFolder(restore_folder)) {
+		RemoveFolder(restore_folder);
+	}
+	if (!CreateFolder(restore_folder)) {
+		EditorSetConsoleError("The project backup could not be restored. The temporary folder could not be created.");
+		return false;
+	}
+
+	bool success = RestoreBackupSnapshot(folder, restore_folder);
+	if (success) {
+		success = LoadProjectBackupFolder(editor_state, restore_folder, file_mask);
+	}
+
+	if (!RemoveFolder(restore_folder)) {
+		ECS_FORMAT_TEMP_STRING(error_message, "The temporary backup folder {#} could not be removed. Consider deleting it manually.", restore_folder);
+		EditorSetConsoleWarn(error_message);
+	}
+	return success;
+}
+
+// -------------------------------------------------------------------------------------------------
@@ -15,6 +15,20 @@ enum ProjectBackupFiles : unsigned char {
 
 extern ECSEngine::Stream<char> PROJECT_BACKUP_FILE_NAMES[];
 
+struct ProjectBackupStatistics {
+	size_t duration_ms;
+	unsigned int file_count;
+	// The files whose size or last write time changed since the previous backup, which had to be read and chunked
+	unsigned int hashed_file_count;
+	size_t chunk_count;
+	// The chunks that were not already in the chunk store
+	size_t new_chunk_count;
+	// The new chunks and the manifest
+	size_t written_byte_size;
+	// The total byte size of the files that make up the backup
+	size_t snapshot_byte_size;
+};
+
 bool ProjectNeedsBackup(EditorState* editor_state);
 
 void ResetProjectNeedsBackup(EditorState* editor_state);
@@ -27,8 +41,17 @@ void AddProjectNeedsBackupTime(EditorState* editor_state, size_t second_count);
 bool LoadProjectBackup(const EditorState* editor_state, ECSEngine::Stream<wchar_t> folder);
 
 // Returns whether or not it succeeded in copying the files from the backup folder into the current directory
-// The folder path must be fully qualified (absolute). The file mask tells which parts to be recovered
+// The folder path must be fully qualified (absolute). The folder can be a snapshot, whose files are rebuilt from
+// The chunk store, or a full copy made by the previous versions. The file mask tells which parts to be recovered
 bool LoadProjectBackup(const EditorState* editor_state, ECSEngine::Stream<wchar_t> folder, ECSEngine::Stream<ProjectBackupFiles> file_mask);
 
-// Returns whether or not it succeeded in saving the project's file
-bool SaveProjectBackup(const EditorState* editor_state);
\ No newline at end of file
+// Returns false for the folders that the backups use internally, like the chunk store
+bool IsProjectBackupSnapshotFolder(ECSEngine::Stream<wchar_t> folder);
+
+// Deletes the chunks that are no longer referenced by any backup. Should be called after backups are removed
+void RemoveUnreferencedProjectBackupChunks(const EditorState* editor_state);
+
+// Returns whether or not it succeeded in saving the project's file. The backup is a snapshot that references content
+// Defined chunks of the files, which are written only once. The files whose size and last write time are the same as
+// In the previous snapshot are not read again. The statistics can be used to measure the backup
+bool SaveProjectBackup(const EditorState* editor_state, ProjectBackupStatistics* statistics = nullptr);
\ No newline at end of file
@@ -1437,7 +1437,12 @@ void* GetSandboxSharedInstance(
 	EDITOR_SANDBOX_VIEWPORT viewport
 )
 {
-	return (void*)GetSandboxSharedInstance((const EditorState*)editor_state, sandbox_handle, component, instance, viewport);
+	void* instance_data = (void*)GetSandboxSharedInstance((const EditorState*)editor_state, sandbox_handle, component, instance, viewport);
+	if (instance_data != nullptr) {
+		// The caller can write the instance in place, which changes its hash
+		GetSandboxEntityManager(editor_state, sandbox_handle, viewport)->MarkSharedComponentHashIndexDirty(component);
+	}
+	return instance_data;
 }
 
 // ------------------------------------------------------------------------------------------------------------------------------
@@ -1470,7 +1475,12 @@ void* GetSandboxEntityComponentEx(
 )
 {
 	// The cast should be fine here
-	return (void*)GetSandboxEntityComponentEx((const EditorState*)editor_state, sandbox_handle, entity, component, shared, viewport);
+	void* component_data = (void*)GetSandboxEntityComponentEx((const EditorState*)editor_state, sandbox_handle, entity, component, shared, viewport);
+	if (shared && component_data != nullptr) {
+		// The caller can write the instance in place, which changes its hash
+		GetSandboxEntityManager(editor_state, sandbox_handle, viewport)->MarkSharedComponentHashIndexDirty(component);
+	}
+	return component_data;
 }
 
 // ------------------------------------------------------------------------------------------------------------------------------
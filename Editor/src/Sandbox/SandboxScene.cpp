@@ -117,8 +117,9 @@ void CopySandboxRuntimeWorldFromOther(EditorState* editor_state, unsigned int so
 	const EditorSandbox* source_sandbox = GetSandbox(editor_state, source_sandbox_index);
 	EditorSandbox* destination_sandbox = GetSandbox(editor_state, destination_sandbox_index);
 
-	// Copy the world
-	CopyWorld(&destination_sandbox->sandbox_world, &source_sandbox->sandbox_world);
+	// Copy the world. The archetype storage is shared until one of the sandboxes writes to it, which
+	// Avoids copying the archetypes that are never modified by the destination
+	CopyWorld(&destination_sandbox->sandbox_world, &source_sandbox->sandbox_world, true);
 	
 	// We shouldn't change the sandbox asset references. The asset snapshot will take care of that.
 	// Just clear the asset snapshot
@@ -85,6 +85,9 @@ void DeleteBackupAction(ActionData* action_data) {
 	if (!success) {
 		EditorSetConsoleError("Could not delete backup.");
 	}
+	else {
+		RemoveUnreferencedProjectBackupChunks(data->editor_state);
+	}
 }
 
 // ----------------------------------------------------------------------------------------------------------------
@@ -140,6 +143,9 @@ void BackupsDraw(void* window_data, UIDrawerDescriptor* drawer_descriptor, bool
 
 		ForEachDirectory(backup_folder, &data, [](Stream<wchar_t> path, void* _data) {
 			FunctorData* data = (FunctorData*)_data;
+			if (!IsProjectBackupSnapshotFolder(path)) {
+				return true;
+			}
 
 			Stream<wchar_t> filename = PathFilename(path);
 			Date date = ConvertStringToDate(filename, ECS_FORMAT_DATE_ALL_FROM_MINUTES);
@@ -174,6 +180,9 @@ void BackupsDraw(void* window_data, UIDrawerDescriptor* drawer_descriptor, bool
 	// Can quickly find the latest entries
 	ForEachDirectory(backup_folder, data, [](Stream<wchar_t> path, void* _data) {
 		BackupsWindowData* data = (BackupsWindowData*)_data;
+		if (!IsProjectBackupSnapshotFolder(path)) {
+			return true;
+		}
 		
 		PathEntry path_entry;
 		path_entry.path = path.Copy(&data->temporary_allocator);
@@ -271,10 +280,15 @@ void BackupsDraw(void* window_data, UIDrawerDescriptor* drawer_descriptor, bool
 		UI_UNPACK_ACTION_DATA;
 
 		EditorState* editor_state = (EditorState*)_data;
-		bool success = SaveProjectBackup(editor_state);
+		ProjectBackupStatistics statistics;
+		bool success = SaveProjectBackup(editor_state, &statistics);
 		if (success) {
 			// Delay the backup time by a minute such that there will be no folder conflicts
-			EditorSetConsoleInfo("Manual backup saved successfully.");
+			ECS_STACK_CAPACITY_STREAM(char, written_size, 64);
+			ConvertByteSizeToString(statistics.written_byte_size, written_size);
+			ECS_FORMAT_TEMP_STRING(message, "Manual backup saved successfully in {#} ms. {#} out of {#} files changed, {#} written.", 
+				statistics.duration_ms, statistics.hashed_file_count, statistics.file_count, written_size);
+			EditorSetConsoleInfo(message);
 			AddProjectNeedsBackupTime(editor_state, 60);
 		}
 		else {
@@ -1894,6 +1894,8 @@ void InspectorDrawEntity(EditorState* editor_state, unsigned int inspector_index
 	};
 
 	auto get_shared_data = [&](size_t index) {
+		// The UI writes the instance in place, which changes its hash
+		entity_manager->MarkSharedComponentHashIndexDirty(shared_signature.indices[index]);
 		return entity_manager->GetSharedData(shared_signature.indices[index], shared_signature.instances[index]);
 	};
 
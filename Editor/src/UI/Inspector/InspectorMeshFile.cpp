@@ -174,6 +174,14 @@ void InspectorDrawMeshFile(EditorState* editor_state, unsigned int inspector_ind
 		);
 		drawer->NextRow();
 
+		// This removed the combo callback
+		config.flag_count--;
+
+		config.AddFlag(float_input_callback);
+		drawer->FloatInput(base_configuration | UI_CONFIG_TEXT_INPUT_CALLBACK | UI_CONFIG_NUMBER_INPUT_DEFAULT | UI_CONFIG_NUMBER_INPUT_RANGE,
+			config, "Simplification ratio", &data->current_metadata.simplification_ratio, 0.0f, 0.0f, 0.99f);
+		drawer->NextRow();
+
 		drawer->CrossLine();
 	}
 
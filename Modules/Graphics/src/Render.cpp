@@ -24,21 +24,36 @@ ECS_INLINE unsigned int GizmoRenderIndex(unsigned int instance_index, bool extra
 	return GenerateRenderInstanceValue(instance_index, extra_thick ? ECS_GENERATE_INSTANCE_FRAMEBUFFER_MAX_PIXEL_THICKNESS : GIZMO_THICKNESS);
 }
 
-struct DrawMeshTaskData {
-	Matrix camera_matrix;
-	float3 camera_translation;
+// The culling is split into batches of at least this many objects
+#define CULLING_MIN_BATCH_SIZE 2048
+#define CULLING_MAX_BATCH_COUNT 64
+
+// The draw key is made out of the material, the mesh and the depth, from the most significant bits to the least
+// significant ones, such that the draws that share the state are consecutive and are drawn front to back
+#define DRAW_KEY_MATERIAL_BITS 20
+#define DRAW_KEY_MESH_BITS 20
+#define DRAW_KEY_DEPTH_BITS 24
+
+struct DrawMeshElement {
+	const RenderMesh* render_mesh;
+	Matrix object_matrix;
+};
+
+struct GatherDrawMeshTaskData {
+	ResizableStream<DrawMeshElement>* elements;
+	ResizableStream<AABBScalar>* bounds;
 	const GraphicsDebugData* debug_data;
 };
 
 template<bool check_for_debug>
-static void DrawMeshTask(
+static void GatherDrawMeshTask(
 	ForEachEntityData* for_each_data,
 	const RenderMesh* render_mesh,
 	const Translation* translation,
 	const Rotation* rotation,
 	const Scale* scale
 ) {
-	DrawMeshTaskData* data = (DrawMeshTaskData*)for_each_data->user_data;
+	GatherDrawMeshTaskData* data = (GatherDrawMeshTaskData*)for_each_data->user_data;
 
 	if constexpr (check_for_debug) {
 		if (data->debug_data->entities_table.Find(for_each_data->entity) != -1) {
@@ -47,8 +62,6 @@ static void DrawMeshTask(
 		}
 	}
 
-	Graphics* graphics = for_each_data->world->graphics;
-
 	if (render_mesh->Validate()) {
 		float3 translation_value = { 0.0f, 0.0f, 0.0f };
 		float4 rotation_value = QuaternionIdentityScalar();
@@ -82,25 +95,119 @@ static void DrawMeshTask(
 			//matrix_scale = MatrixIdentity();
 		}
 
-		Matrix object_matrix = MatrixTRS(matrix_translation, matrix_rotation, matrix_scale);
-		Matrix mvp_matrix = object_matrix * data->camera_matrix;
+		DrawMeshElement element;
+		element.render_mesh = render_mesh;
+		element.object_matrix = MatrixTRS(matrix_translation, matrix_rotation, matrix_scale);
+		data->elements->Add(element);
+		data->bounds->Add(TransformAABB(render_mesh->mesh->mesh.bounds, translation_value, matrix_rotation, scale_value));
+	}
+}
+
+// Writes the indices of the meshes whose bounds intersect the camera frustum and returns their count.
+// The visible indices must have bounds.size entries
+static size_t FrustumCullMeshes(TaskManager* task_manager, Stream<AABBScalar> bounds, Matrix camera_matrix, unsigned int* visible_indices) {
+	FrustumPlanes frustum = GetFrustumPlanes(camera_matrix);
+
+	// Each batch writes its visible indices at its own offset, they are compacted afterwards
+	size_t batch_offsets[CULLING_MAX_BATCH_COUNT];
+	size_t batch_visible_counts[CULLING_MAX_BATCH_COUNT];
+	size_t batch_count = ParallelForBatches(task_manager, bounds.size, CULLING_MIN_BATCH_SIZE, CULLING_MAX_BATCH_COUNT, 
+		[&](size_t batch_offset, size_t batch_size, size_t batch_index) {
+			batch_offsets[batch_index] = batch_offset;
+			batch_visible_counts[batch_index] = FrustumCullAABBs(
+				{ bounds.buffer + batch_offset, batch_size }, 
+				frustum, 
+				visible_indices + batch_offset, 
+				(unsigned int)batch_offset
+			);
+		}
+	);
+
+	size_t visible_count = 0;
+	for (size_t index = 0; index < batch_count; index++) {
+		memmove(visible_indices + visible_count, visible_indices + batch_offsets[index], sizeof(unsigned int) * batch_visible_counts[index]);
+		visible_count += batch_visible_counts[index];
+	}
+	return visible_count;
+}
+
+struct DrawMeshPacket {
+	size_t key;
+	unsigned int element_index;
+};
+
+static size_t DrawKeyPointerBits(const void* pointer, size_t bit_count) {
+	// Fibonacci hashing, such that the upper bits depend on all the bits of the pointer. A collision
+	// only splits a run of draws that share the state, the submission compares the actual pointers
+	return ((size_t)pointer * 11400714819323198485ull) >> (64 - bit_count);
+}
+
+static size_t DrawMeshKey(const RenderMesh* render_mesh, float camera_distance_squared) {
+	// The positive floats sort in the same order as their bits
+	unsigned int depth_bits = *(unsigned int*)&camera_distance_squared >> (32 - DRAW_KEY_DEPTH_BITS);
+	return (DrawKeyPointerBits(render_mesh->material, DRAW_KEY_MATERIAL_BITS) << (DRAW_KEY_MESH_BITS + DRAW_KEY_DEPTH_BITS))
+		| (DrawKeyPointerBits(render_mesh->mesh, DRAW_KEY_MESH_BITS) << DRAW_KEY_DEPTH_BITS) | (size_t)depth_bits;
+}
+
+// Fills in the packets for the visible elements and sorts them by their key. The packets must have
+// 2 * visible_indices.size entries, the second half is used as temporary for the sort
+static void SortDrawMeshPackets(
+	TaskManager* task_manager,
+	const DrawMeshElement* elements,
+	const AABBScalar* bounds,
+	Stream<unsigned int> visible_indices,
+	float3 camera_translation,
+	DrawMeshPacket* packets
+) {
+	ParallelForBatches(task_manager, visible_indices.size, CULLING_MIN_BATCH_SIZE, CULLING_MAX_BATCH_COUNT,
+		[&](size_t batch_offset, size_t batch_size, size_t batch_index) {
+			for (size_t index = batch_offset; index < batch_offset + batch_size; index++) {
+				unsigned int element_index = visible_indices[index];
+				float camera_distance_squared = SquareLength(AABBCenter(bounds[element_index]) - camera_translation);
+				packets[index] = { DrawMeshKey(elements[element_index].render_mesh, camera_distance_squared), element_index };
+			}
+		}
+	);
+
+	RadixSort64(packets, packets + visible_indices.size, visible_indices.size, [](const DrawMeshPacket& packet) {
+		return packet.key;
+	});
+}
+
+// The bound mesh and material are updated, such that consecutive draws with the same mesh or material do not rebind them
+static void DrawMesh(
+	Graphics* graphics, 
+	const DrawMeshElement& element, 
+	Matrix camera_matrix, 
+	float3 camera_translation, 
+	const CoalescedMesh** bound_mesh,
+	const Material** bound_material
+) {
+	const RenderMesh* render_mesh = element.render_mesh;
+	Matrix object_matrix = element.object_matrix;
+	Matrix mvp_matrix = object_matrix * camera_matrix;
 
-		object_matrix = MatrixGPU(object_matrix);
-		mvp_matrix = MatrixGPU(mvp_matrix);
+	object_matrix = MatrixGPU(object_matrix);
+	mvp_matrix = MatrixGPU(mvp_matrix);
 
-		float3 camera_position = data->camera_translation;
-		const void* injected_values[ECS_CB_INJECT_TAG_COUNT];
-		injected_values[ECS_CB_INJECT_CAMERA_POSITION] = &camera_position;
-		injected_values[ECS_CB_INJECT_MVP_MATRIX] = &mvp_matrix;
-		injected_values[ECS_CB_INJECT_OBJECT_MATRIX] = &object_matrix;
+	float3 camera_position = camera_translation;
+	const void* injected_values[ECS_CB_INJECT_TAG_COUNT];
+	injected_values[ECS_CB_INJECT_CAMERA_POSITION] = &camera_position;
+	injected_values[ECS_CB_INJECT_MVP_MATRIX] = &mvp_matrix;
+	injected_values[ECS_CB_INJECT_OBJECT_MATRIX] = &object_matrix;
 
-		BindConstantBufferInjectedCB(graphics, render_mesh->material, injected_values);
+	BindConstantBufferInjectedCB(graphics, render_mesh->material, injected_values);
 
+	if (*bound_mesh != render_mesh->mesh) {
 		graphics->BindMesh(render_mesh->mesh->mesh);
+		*bound_mesh = render_mesh->mesh;
+	}
+	if (*bound_material != render_mesh->material) {
 		graphics->BindMaterial(*render_mesh->material);
-
-		graphics->DrawCoalescedMeshCommand(*render_mesh->mesh);
+		*bound_material = render_mesh->material;
 	}
+
+	graphics->DrawCoalescedMeshCommand(*render_mesh->mesh);
 }
 
 template<bool schedule_element>
@@ -120,13 +227,40 @@ ECS_THREAD_TASK(DrawMeshes) {
 			float3 camera_translation = camera.translation;
 			world->debug_drawer->UpdateCameraMatrix(camera_matrix);
 
+			// Gather the meshes with their world space bounds, cull them and then draw only the visible ones,
+			// sorted such that the state changes between them are minimal
+			ResizableStream<DrawMeshElement> elements;
+			elements.Initialize(world->memory, 0);
+			ResizableStream<AABBScalar> bounds;
+			bounds.Initialize(world->memory, 0);
+
 			const GraphicsDebugData* debug_data = GetGraphicsDebugData(world);
-			DrawMeshTaskData draw_data = { camera_matrix, camera_translation, debug_data };
-			auto draw_function = DrawMeshTask<false>;
+			GatherDrawMeshTaskData gather_data = { &elements, &bounds, debug_data };
+			auto gather_function = GatherDrawMeshTask<false>;
 			if (debug_data != nullptr && debug_data->groups.size > 0) {
-				draw_function = DrawMeshTask<true>;
+				gather_function = GatherDrawMeshTask<true>;
 			}
-			kernel.Function(draw_function, &draw_data, sizeof(draw_data));
+			kernel.Function(gather_function, &gather_data, sizeof(gather_data));
+
+			if (elements.size > 0) {
+				unsigned int* visible_indices = (unsigned int*)world->memory->Allocate(sizeof(unsigned int) * elements.size);
+				size_t visible_count = FrustumCullMeshes(world->task_manager, bounds.ToStream(), camera_matrix, visible_indices);
+				if (visible_count > 0) {
+					DrawMeshPacket* packets = (DrawMeshPacket*)world->memory->Allocate(sizeof(DrawMeshPacket) * visible_count * 2);
+					SortDrawMeshPackets(world->task_manager, elements.buffer, bounds.buffer, { visible_indices, visible_count }, camera_translation, packets);
+
+					const CoalescedMesh* bound_mesh = nullptr;
+					const Material* bound_material = nullptr;
+					for (size_t index = 0; index < visible_count; index++) {
+						DrawMesh(world->graphics, elements[packets[index].element_index], camera_matrix, camera_translation, &bound_mesh, &bound_material);
+					}
+					world->memory->Deallocate(packets);
+				}
+				world->memory->Deallocate(visible_indices);
+			}
+
+			bounds.FreeBuffer();
+			elements.FreeBuffer();
 		}
 	}
 }
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "ECSEngineContainersCommon.h"
+#include "ECSEngineEntities.h"
+
+using namespace ECSEngine;
+
+// Small pools, such that the reservations span multiple of them
+#define POOL_POWER_OF_TWO 5
+
+static unsigned int failure_count = 0;
+
+#define CHECK(condition) if (!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); failure_count++; }
+
+// The entities that carry the reserved info, but were not created, must not be valid
+static void TestReservedSentinel(MemoryManager* memory) {
+	EntityPool entity_pool(memory, POOL_POWER_OF_TWO);
+
+	Entity normal_entity = entity_pool.Allocate(0, 0, 0);
+	CHECK(entity_pool.IsValid(normal_entity));
+	CHECK(!entity_pool.IsReserved(normal_entity));
+
+	// An entity allocated with the sentinel values directly is rejected as well
+	Entity sentinel_entity = entity_pool.Allocate(ECS_MAIN_ARCHETYPE_MAX_COUNT - 1, ECS_BASE_ARCHETYPE_MAX_COUNT - 1, ECS_ENTITY_POOL_RESERVED_STREAM_INDEX);
+	CHECK(!entity_pool.IsValid(sentinel_entity));
+	CHECK(entity_pool.TryGetEntityInfo(sentinel_entity) == nullptr);
+
+	entity_pool.PrepareReservations(2);
+	Entity reserved_entity = entity_pool.Reserve();
+	CHECK(reserved_entity != Entity::Invalid());
+	CHECK(!entity_pool.IsValid(reserved_entity));
+	CHECK(entity_pool.IsReserved(reserved_entity));
+	CHECK(entity_pool.TryGetEntityInfo(reserved_entity) == nullptr);
+
+	// The virtual entities must not alias the reserved slots
+	Entity virtual_entity = entity_pool.GetVirtualEntity();
+	CHECK(virtual_entity != reserved_entity);
+
+	entity_pool.AllocateReserved({ &reserved_entity, 1 }, { 0, 0 }, 1);
+	CHECK(entity_pool.IsValid(reserved_entity));
+	CHECK(!entity_pool.IsReserved(reserved_entity));
+	CHECK(entity_pool.GetInfo(reserved_entity).stream_index == 1);
+
+	// The created entity is kept and the slot that was not handed out is released
+	CHECK(entity_pool.FlushReservations() == 0);
+	CHECK(entity_pool.IsValid(reserved_entity));
+
+	// A reserved entity that is not created is rolled back
+	entity_pool.PrepareReservations(1);
+	Entity abandoned_entity = entity_pool.Reserve();
+	CHECK(entity_pool.IsReserved(abandoned_entity));
+	CHECK(entity_pool.FlushReservations() == 1);
+	CHECK(!entity_pool.IsValid(abandoned_entity));
+	CHECK(!entity_pool.IsReserved(abandoned_entity));
+
+	// The slots are exhausted, the reservation fails instead of handing out an unprepared entity
+	entity_pool.PrepareReservations(1);
+	Entity reservations[2];
+	CHECK(!entity_pool.Reserve({ reservations, 2 }));
+	CHECK(entity_pool.Reserve() != Entity::Invalid());
+	CHECK(entity_pool.Reserve() == Entity::Invalid());
+	CHECK(entity_pool.FlushReservations() == 1);
+}
+
+int main(int argc, const char** argv) {
+	MemoryManager memory(ECS_MB, ECS_KB, ECS_MB * 4, ECS_MALLOC_ALLOCATOR);
+
+	TestReservedSentinel(&memory);
+
+	memory.Free();
+	if (failure_count > 0) {
+		fprintf(stderr, "%u checks failed\n", failure_count);
+		return 1;
+	}
+	printf("All the checks passed\n");
+	return 0;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include "ECSEngineContainersCommon.h"
+#include "ECSEngineUtilities.h"
+#include "ECSEngineWorld.h"
+#include "ECSEngineModule.h"
+
+using namespace ECSEngine;
+
+#define DEFAULT_WORLD_COUNT 2
+#define DEFAULT_FRAME_COUNT 600
+#define MAX_MODULE_COUNT 64
+
+static void PrintUsage() {
+	fprintf(stderr,
+		"usage: HeadlessWorldRunner [options] <module.dll>...\n"
+		"Runs multiple copies of a world with the tasks of the given modules, in parallel and without graphics, and checks\n"
+		"That every copy produces the same entity state on every frame. Options:\n"
+		"\t--worlds <count>\tThe number of world copies to run (default %d)\n"
+		"\t--frames <count>\tThe number of frames to run each world (default %d)\n"
+		"\t--threads <count>\tThe total number of threads (default the hardware concurrency)\n"
+		"\t--concurrent <count>\tThe number of worlds stepped at the same time (default as many as the threads allow)\n"
+		"\t--delta-time <seconds>\tThe fixed delta time of a frame (default 1/60)\n",
+		DEFAULT_WORLD_COUNT,
+		DEFAULT_FRAME_COUNT
+	);
+}
+
+static bool AddModuleTasks(HeadlessWorldRunnerFunctionData* data) {
+	Stream<Stream<TaskSchedulerElement>>* module_tasks = (Stream<Stream<TaskSchedulerElement>>*)data->user_data;
+	for (size_t index = 0; index < module_tasks->size; index++) {
+		data->world->task_scheduler->Add(module_tasks->buffer[index]);
+	}
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	unsigned int world_count = DEFAULT_WORLD_COUNT;
+	size_t frame_count = DEFAULT_FRAME_COUNT;
+	float delta_time = ECS_HEADLESS_WORLD_RUNNER_DEFAULT_DELTA_TIME;
+	HeadlessWorldRunnerOptions options;
+	ECS_STACK_CAPACITY_STREAM(Stream<char>, module_paths, MAX_MODULE_COUNT);
+
+	for (int index = 1; index < argc; index++) {
+		Stream<char> argument = argv[index];
+		if (argument.size > 2 && argument[0] == '-' && argument[1] == '-') {
+			if (index + 1 == argc) {
+				fprintf(stderr, "error: Missing the value for option %s\n", argv[index]);
+				PrintUsage();
+				return 1;
+			}
+
+			Stream<char> value = argv[++index];
+			if (argument == "--delta-time") {
+				delta_time = ConvertCharactersToFloat(value);
+				if (delta_time <= 0.0f) {
+					fprintf(stderr, "error: Invalid delta time %s\n", argv[index]);
+					return 1;
+				}
+				continue;
+			}
+
+			bool success = false;
+			int64_t integer = ConvertCharactersToIntStrict(value, success);
+			if (!success || integer < 0) {
+				fprintf(stderr, "error: Invalid value %s for option %s\n", argv[index], argv[index - 1]);
+				return 1;
+			}
+
+			if (argument == "--worlds") {
+				world_count = (unsigned int)integer;
+			}
+			else if (argument == "--frames") {
+				frame_count = (size_t)integer;
+			}
+			else if (argument == "--threads") {
+				options.thread_count = (unsigned int)integer;
+			}
+			else if (argument == "--concurrent") {
+				options.concurrent_world_count = (unsigned int)integer;
+			}
+			else {
+				fprintf(stderr, "error: Unknown option %s\n", argv[index - 1]);
+				PrintUsage();
+				return 1;
+			}
+		}
+		else {
+			if (module_paths.size == module_paths.capacity) {
+				fprintf(stderr, "error: Too many modules, at most %d can be given\n", MAX_MODULE_COUNT);
+				return 1;
+			}
+			module_paths.Add(argument);
+		}
+	}
+
+	if (module_paths.size == 0 || world_count < 2) {
+		PrintUsage();
+		return 1;
+	}
+
+	GlobalMemoryManager allocator(ECS_MB * 32, ECS_KB * 4, ECS_MB * 256, ECS_MALLOC_ALLOCATOR);
+
+	// Load the modules once, all the worlds share their code
+	ECS_STACK_CAPACITY_STREAM(Module, modules, MAX_MODULE_COUNT);
+	ECS_STACK_CAPACITY_STREAM(Stream<TaskSchedulerElement>, module_tasks, MAX_MODULE_COUNT);
+	// The modules are released before the allocator is freed, such that nothing runs after their memory is gone.
+	// It is a single scope in order to keep this order on all the return paths
+	auto release_resources = StackScope([&]() {
+		for (unsigned int index = 0; index < modules.size; index++) {
+			ReleaseModule(modules.buffer + index);
+		}
+		allocator.Free();
+	});
+
+	for (unsigned int index = 0; index < module_paths.size; index++) {
+		ECS_STACK_CAPACITY_STREAM(wchar_t, module_path, 512);
+		if (module_paths[index].size > module_path.capacity) {
+			fprintf(stderr, "error: The module path %s is too long\n", module_paths[index].buffer);
+			return 1;
+		}
+		ConvertASCIIToWide(module_path, module_paths[index]);
+
+		Module module = LoadModule(module_path);
+		if (module.code != ECS_GET_MODULE_OK) {
+			fprintf(stderr, "error: Failed to load the module %s\n", module_paths[index].buffer);
+			return 1;
+		}
+		modules.Add(module);
+
+		ECS_STACK_CAPACITY_STREAM(char, error_message, ECS_KB * 2);
+		Stream<TaskSchedulerElement> tasks = LoadModuleTasks(&module, &allocator, &error_message);
+		if (error_message.size > 0) {
+			fprintf(stderr, "error: Failed to load the tasks of the module %s. Reason: %.*s\n", module_paths[index].buffer, (int)error_message.size, error_message.buffer);
+			return 1;
+		}
+		module_tasks.Add(tasks);
+	}
+
+	Stream<Stream<TaskSchedulerElement>> module_tasks_stream = module_tasks;
+	Stream<HeadlessWorldRunnerEntry> entries;
+	entries.Initialize(&allocator, world_count);
+	for (unsigned int index = 0; index < world_count; index++) {
+		entries[index] = HeadlessWorldRunnerEntry();
+		entries[index].descriptor = GetDefaultWorldDescriptor();
+		entries[index].setup_function = AddModuleTasks;
+		entries[index].user_data = &module_tasks_stream;
+		entries[index].frame_count = frame_count;
+		entries[index].delta_time = delta_time;
+		// All the copies are compared against the first one
+		entries[index].reference_index = index == 0 ? -1 : 0;
+	}
+
+	Stream<HeadlessWorldRunnerResult> results = RunHeadlessWorlds(entries, &allocator, options);
+
+	int exit_code = 0;
+	for (unsigned int index = 0; index < results.size; index++) {
+		const HeadlessWorldRunnerResult& result = results[index];
+		switch (result.status) {
+		case ECS_HEADLESS_WORLD_RUNNER_PASSED:
+			printf("World %u: passed %llu frames\n", index, (unsigned long long)result.frame_hashes.size);
+			break;
+		case ECS_HEADLESS_WORLD_RUNNER_INVALID_DESCRIPTOR:
+			printf("World %u: invalid world descriptor\n", index);
+			break;
+		case ECS_HEADLESS_WORLD_RUNNER_SETUP_FAILED:
+			printf("World %u: setup failed\n", index);
+			break;
+		case ECS_HEADLESS_WORLD_RUNNER_MISMATCH:
+			printf("World %u: diverged from world 0 at frame %llu\n", index, (unsigned long long)result.first_mismatch_frame);
+			break;
+		case ECS_HEADLESS_WORLD_RUNNER_REFERENCE_FAILED:
+			printf("World %u: not compared, the reference world failed\n", index);
+			break;
+		}
+
+		if (!result.Passed()) {
+			exit_code = 1;
+		}
+	}
+
+	return exit_code;
+}